@@ -0,0 +1,137 @@
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "bench_utils.h"
+
+/*
+ * Pointer chasing over lists built with and without locality hints.
+ *
+ *  - chase/<lists>:  walks <lists> linked lists node by node. The lists are built round-robin
+ *                    in a fragmented arena, either with em_alloc ("em_alloc") or with each node
+ *                    hinted at its predecessor through em_alloc_near ("em_alloc_near"). Best fit
+ *                    scatters consecutive nodes over the holes of the whole arena; hinted nodes
+ *                    take the holes next to their predecessor and share its cache lines and pages.
+ *  - place/<lists>:  the price of the hint: one node allocation next to a list node plus its
+ *                    free, against the same pair through em_alloc.
+ *
+ * The arena is far larger than the caches, so every scattered link is a likely cache and
+ * dTLB miss (see --counters).
+*/
+
+#define FILLER_BLOCKS   (1 << 18)
+#define NODES_PER_LIST  (1 << 12)
+
+typedef struct Node {
+    struct Node *next;
+    uint64_t value;
+    uint8_t payload[48];
+} Node;
+
+typedef struct {
+    EM *em;
+    Node **heads;
+    size_t lists;
+    Node *cursor;
+    size_t list;
+} Ctx;
+
+static uint32_t rng_state = 0x7F4A7C15u;
+
+static uint32_t next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void chase_op(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    uint64_t sum = 0;
+    Node *node = ctx->cursor;
+    for (size_t i = 0; i < ops; i++) {
+        if (node == NULL) {
+            ctx->list = (ctx->list + 1) % ctx->lists;
+            node = ctx->heads[ctx->list];
+        }
+        sum += node->value;
+        node = node->next;
+    }
+    ctx->cursor = node;
+    bench_escape(&sum);
+}
+
+static void place_plain_op(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t i = 0; i < ops; i++) {
+        void *p = em_alloc(ctx->em, sizeof(Node));
+        bench_escape(p);
+        em_free(p);
+    }
+}
+
+static void place_near_op(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t i = 0; i < ops; i++) {
+        void *p = em_alloc_near(ctx->em, sizeof(Node), ctx->heads[i % ctx->lists]);
+        bench_escape(p);
+        em_free(p);
+    }
+}
+
+/*
+ * Fill the arena with blocks of random sizes, free every other one, then build the lists
+ * round-robin so that list nodes compete for the same holes
+*/
+static bool build_lists(Ctx *ctx, bool hinted) {
+    ctx->em = em_create((size_t)FILLER_BLOCKS * 256 + ctx->lists * NODES_PER_LIST * 2 * sizeof(Node));
+    void **filler = (void **)malloc(FILLER_BLOCKS * sizeof(void *));
+    Node **tails = (Node **)calloc(ctx->lists, sizeof(Node *));
+    if (!ctx->em || !filler || !tails) return false;
+
+    for (size_t i = 0; i < FILLER_BLOCKS; i++) filler[i] = em_alloc(ctx->em, 16 + next_random() % 200);
+    for (size_t i = 0; i < FILLER_BLOCKS; i += 2) em_free(filler[i]);
+    free(filler);
+
+    for (size_t n = 0; n < NODES_PER_LIST; n++) {
+        for (size_t l = 0; l < ctx->lists; l++) {
+            Node *node = hinted ? (Node *)em_alloc_near(ctx->em, sizeof(Node), tails[l]) : (Node *)em_alloc(ctx->em, sizeof(Node));
+            if (!node) return false;
+            node->next = NULL;
+            node->value = n;
+            if (tails[l] != NULL) tails[l]->next = node;
+            else ctx->heads[l] = node;
+            tails[l] = node;
+        }
+    }
+    free(tails);
+    ctx->cursor = ctx->heads[0];
+    ctx->list = 0;
+    return true;
+}
+
+int main(int argc, char **argv) {
+    bench_init("alloc_near", argc, argv);
+
+    const size_t lists[] = { 4, 64 };
+    for (size_t i = 0; i < sizeof(lists) / sizeof(lists[0]); i++) {
+        char chase_name[64];
+        char place_name[64];
+        snprintf(chase_name, sizeof(chase_name), "chase/%zu", lists[i]);
+        snprintf(place_name, sizeof(place_name), "place/%zu", lists[i]);
+        if (!bench_selected(chase_name) && !bench_selected(place_name)) continue;
+
+        for (int hinted = 0; hinted < 2; hinted++) {
+            const char *variant = hinted ? "em_alloc_near" : "em_alloc";
+            Ctx ctx = { NULL, (Node **)calloc(lists[i], sizeof(Node *)), lists[i], NULL, 0 };
+            if (!ctx.heads || !build_lists(&ctx, hinted != 0)) { fprintf(stderr, "alloc_near setup failed\n"); exit(1); }
+
+            if (bench_selected(chase_name)) bench_run(chase_name, variant, chase_op, &ctx, lists[i] * NODES_PER_LIST);
+            if (bench_selected(place_name)) bench_run(place_name, variant, hinted ? place_near_op : place_plain_op, &ctx, 100000);
+
+            em_destroy(ctx.em);
+            free(ctx.heads);
+        }
+    }
+
+    return 0;
+}
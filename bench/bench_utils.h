@@ -0,0 +1,366 @@
+#ifndef BENCH_UTILS_H
+#define BENCH_UTILS_H
+
+/*
+ * Shared benchmark harness for easy_memory.
+ *
+ * Every benchmark is a batch function timed as a whole: a sample runs the batch over
+ * 'ops' operations and records ns/op, the harness collects many samples and reports
+ * percentiles over them. Timing whole batches keeps the clock overhead (~20 ns) out
+ * of the numbers while still exposing jitter and outliers.
+ *
+ * Results are emitted one record per line, either as JSON Lines (default) or CSV,
+ * so runs from different releases can be diffed and plotted by scripts.
+ *
+ * With --counters, every benchmark also reports hardware counters per operation (cycles,
+ * instructions, L1D/LLC/dTLB misses, branch misses) read through the raw perf_event_open
+ * syscall. Counters the kernel or the CPU refuses (perf_event_paranoid, containers, VMs,
+ * other platforms) are reported as null / empty and the timings are unaffected.
+ *
+ * Include after easy_memory.h: the configuration block reports the EM build flags.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#if defined(__linux__)
+#   include <unistd.h>
+#   include <sys/ioctl.h>
+#   include <sys/syscall.h>
+#   include <linux/perf_event.h>
+#endif
+
+#define BENCH_DEFAULT_SAMPLES 101
+#define BENCH_WARMUP_SAMPLES  3
+#define BENCH_COUNTER_COUNT   6
+
+typedef void (*BenchFn)(void *ctx, size_t ops);
+
+typedef struct {
+    size_t samples;       // Number of timed samples per benchmark
+    size_t threads;       // Upper bound on thread count for MT benchmarks (0 = online CPUs)
+    const char *filter;   // Substring filter on benchmark names (NULL = all)
+    const char *suite;    // Suite name reported in every record
+    bool csv;             // CSV instead of JSON Lines
+    bool quick;           // Scale down op counts (smoke runs, CI)
+    bool counters;        // Collect hardware counters through perf_event_open
+    uint8_t padding[5];
+} BenchConfig;
+
+/*
+ * Hardware event counts, scaled for multiplexing and summed over every measured window.
+*/
+typedef struct {
+    double counts[BENCH_COUNTER_COUNT];
+    bool available[BENCH_COUNTER_COUNT];
+    uint8_t padding[8 - BENCH_COUNTER_COUNT % 8];
+} BenchCounters;
+
+typedef struct {
+    double min;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+    double mean;
+    BenchCounters counters;
+} BenchStats;
+
+static BenchConfig bench_config = { BENCH_DEFAULT_SAMPLES, 0, NULL, "bench", false, false, false, {0} };
+static bool bench_header_printed = false;
+
+/*
+ * Functions prototypes for benchmarks
+*/
+void bench_init(const char *suite, int argc, char **argv);
+double bench_now_ns(void);
+size_t bench_ops(size_t ops);
+bool bench_selected(const char *name);
+BenchStats bench_measure(BenchFn fn, void *ctx, size_t ops);
+void bench_report(const char *name, const char *impl, size_t ops, const BenchStats *stats);
+void bench_run(const char *name, const char *impl, BenchFn fn, void *ctx, size_t ops);
+uint64_t bench_rand(uint64_t *state);
+size_t bench_rss_bytes(void);
+void bench_counters_begin(void);
+void bench_counters_end(BenchCounters *counters);
+void bench_counters_print(const BenchCounters *counters, double ops);
+
+/*
+ * Compiler barrier: keeps results alive without adding memory traffic.
+*/
+#if defined(__GNUC__) || defined(__clang__)
+#   define bench_escape(ptr) __asm__ volatile("" : : "g"(ptr) : "memory")
+#else
+#   define bench_escape(ptr) do { volatile const void *bench_sink_ = (ptr); (void)bench_sink_; } while (0)
+#endif
+
+void bench_init(const char *suite, int argc, char **argv) {
+    bench_config.suite = suite;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--csv") == 0) {
+            bench_config.csv = true;
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            bench_config.quick = true;
+        } else if (strcmp(argv[i], "--counters") == 0) {
+            bench_config.counters = true;
+        } else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            long value = strtol(argv[++i], NULL, 10);
+            bench_config.samples = value > 0 ? (size_t)value : BENCH_DEFAULT_SAMPLES;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            long value = strtol(argv[++i], NULL, 10);
+            bench_config.threads = value > 0 ? (size_t)value : 0;
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            bench_config.filter = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--csv] [--quick] [--counters] [--samples N] [--threads N] [--filter SUBSTRING]\n", argv[0]);
+            exit(2);
+        }
+    }
+    if (bench_config.quick && bench_config.samples > 11) bench_config.samples = 11;
+}
+
+double bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+size_t bench_ops(size_t ops) {
+    if (!bench_config.quick) return ops;
+    return ops / 16 > 0 ? ops / 16 : 1;
+}
+
+bool bench_selected(const char *name) {
+    return bench_config.filter == NULL || strstr(name, bench_config.filter) != NULL;
+}
+
+static int bench_compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double bench_percentile(const double *sorted, size_t count, double pct) {
+    size_t index = (size_t)(pct * (double)(count - 1) / 100.0 + 0.5);
+    return sorted[index < count ? index : count - 1];
+}
+
+BenchStats bench_measure(BenchFn fn, void *ctx, size_t ops) {
+    BenchStats stats;
+    memset(&stats, 0, sizeof(stats));
+
+    size_t count = bench_config.samples;
+    double *samples = (double *)malloc(count * sizeof(double));
+    if (!samples) return stats;
+
+    for (size_t i = 0; i < BENCH_WARMUP_SAMPLES; i++) fn(ctx, ops);
+
+    double sum = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        bench_counters_begin();
+        double start = bench_now_ns();
+        fn(ctx, ops);
+        double elapsed = bench_now_ns() - start;
+        bench_counters_end(&stats.counters);
+        samples[i] = elapsed / (double)ops;
+        sum += samples[i];
+    }
+
+    qsort(samples, count, sizeof(double), bench_compare_doubles);
+    stats.min  = samples[0];
+    stats.p50  = bench_percentile(samples, count, 50.0);
+    stats.p90  = bench_percentile(samples, count, 90.0);
+    stats.p99  = bench_percentile(samples, count, 99.0);
+    stats.max  = samples[count - 1];
+    stats.mean = sum / (double)count;
+
+    free(samples);
+    return stats;
+}
+
+/*
+ * Hardware counters.
+ *
+ * Each event is opened on its own rather than as a group, so a CPU lacking one event
+ * (many VMs have no dTLB or LLC events) still reports the others. Events are user-space
+ * only and inherited by threads created while they are enabled, which covers the
+ * workers of the multi-threaded benchmarks once they are joined.
+*/
+#define BENCH_COUNTER_CSV_HEADER ",cycles,instructions,l1d_misses,llc_misses,dtlb_misses,branch_misses"
+
+static const char *const bench_counter_names[BENCH_COUNTER_COUNT] = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "dtlb_misses", "branch_misses"
+};
+
+#if defined(__linux__)
+#define BENCH_CACHE_READ_MISS(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const struct { uint64_t config; uint32_t type; uint32_t padding; } bench_counter_events[BENCH_COUNTER_COUNT] = {
+    { PERF_COUNT_HW_CPU_CYCLES, PERF_TYPE_HARDWARE, 0 },
+    { PERF_COUNT_HW_INSTRUCTIONS, PERF_TYPE_HARDWARE, 0 },
+    { BENCH_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D), PERF_TYPE_HW_CACHE, 0 },
+    { PERF_COUNT_HW_CACHE_MISSES, PERF_TYPE_HARDWARE, 0 },
+    { BENCH_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB), PERF_TYPE_HW_CACHE, 0 },
+    { PERF_COUNT_HW_BRANCH_MISSES, PERF_TYPE_HARDWARE, 0 },
+};
+
+static int bench_counter_fds[BENCH_COUNTER_COUNT];
+static bool bench_counters_opened = false;
+
+static void bench_counters_open(void) {
+    bench_counters_opened = true;
+    size_t opened = 0;
+    for (size_t c = 0; c < BENCH_COUNTER_COUNT; c++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = bench_counter_events[c].type;
+        attr.config = bench_counter_events[c].config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        bench_counter_fds[c] = (int)fd;
+        if (fd >= 0) opened++;
+    }
+    if (opened < BENCH_COUNTER_COUNT) {
+        fprintf(stderr, "bench: %zu of %d hardware counters available (check /proc/sys/kernel/perf_event_paranoid)\n",
+                opened, BENCH_COUNTER_COUNT);
+    }
+}
+#endif
+
+void bench_counters_begin(void) {
+#if defined(__linux__)
+    if (!bench_config.counters) return;
+    if (!bench_counters_opened) bench_counters_open();
+    for (size_t c = 0; c < BENCH_COUNTER_COUNT; c++) {
+        if (bench_counter_fds[c] < 0) continue;
+        ioctl(bench_counter_fds[c], PERF_EVENT_IOC_RESET, 0);
+        ioctl(bench_counter_fds[c], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+void bench_counters_end(BenchCounters *counters) {
+#if defined(__linux__)
+    if (!bench_config.counters) return;
+    for (size_t c = 0; c < BENCH_COUNTER_COUNT; c++) {
+        if (bench_counter_fds[c] >= 0) ioctl(bench_counter_fds[c], PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (size_t c = 0; c < BENCH_COUNTER_COUNT; c++) {
+        uint64_t value[3];  // count, time enabled, time running
+        if (bench_counter_fds[c] < 0) continue;
+        if (read(bench_counter_fds[c], value, sizeof(value)) != (ssize_t)sizeof(value) || value[2] == 0) continue;
+        // Scale up when the kernel multiplexed the event with others
+        counters->counts[c] += (double)value[0] * ((double)value[1] / (double)value[2]);
+        counters->available[c] = true;
+    }
+#else
+    (void)counters;
+#endif
+}
+
+/*
+ * Appends the per-operation counts to the current record: CSV columns matching
+ * BENCH_COUNTER_CSV_HEADER (empty when unavailable) or a JSON "counters_per_op" object.
+*/
+void bench_counters_print(const BenchCounters *counters, double ops) {
+    if (!bench_config.counters) return;
+    if (!bench_config.csv) printf(",\"counters_per_op\":{");
+    for (size_t c = 0; c < BENCH_COUNTER_COUNT; c++) {
+        const char *separator = bench_config.csv || c > 0 ? "," : "";
+        if (!bench_config.csv) printf("%s\"%s\":", separator, bench_counter_names[c]);
+        else printf("%s", separator);
+
+        if (counters->available[c] && ops > 0.0) printf("%.3f", counters->counts[c] / ops);
+        else if (!bench_config.csv) printf("null");
+    }
+    if (!bench_config.csv) printf("}");
+}
+
+/*
+ * Build configuration of the easy_memory instance under test, reported with every record.
+*/
+#ifdef EM_POISONING
+#   define BENCH_POISONING 1
+#else
+#   define BENCH_POISONING 0
+#endif
+#ifdef EM_FREE_TLSF
+#   define BENCH_FREE_LISTS "tlsf"
+#elif defined(EM_FREE_TREE_AUGMENT)
+#   define BENCH_FREE_LISTS "tree+bounds"
+#else
+#   define BENCH_FREE_LISTS "tree"
+#endif
+
+void bench_report(const char *name, const char *impl, size_t ops, const BenchStats *stats) {
+    if (bench_config.csv) {
+        if (!bench_header_printed) {
+            printf("suite,bench,impl,ops_per_sample,samples,min_ns,p50_ns,p90_ns,p99_ns,max_ns,mean_ns,"
+                   "safety_policy,poisoning,default_alignment,min_buffer_size,free_lists%s\n",
+                   bench_config.counters ? BENCH_COUNTER_CSV_HEADER : "");
+            bench_header_printed = true;
+        }
+        printf("%s,%s,%s,%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%d,%d,%zu,%zu,%s",
+               bench_config.suite, name, impl, ops, bench_config.samples,
+               stats->min, stats->p50, stats->p90, stats->p99, stats->max, stats->mean,
+               EM_SAFETY_POLICY, BENCH_POISONING, (size_t)EM_DEFAULT_ALIGNMENT, (size_t)EM_MIN_BUFFER_SIZE, BENCH_FREE_LISTS);
+    } else {
+        printf("{\"suite\":\"%s\",\"bench\":\"%s\",\"impl\":\"%s\",\"ops_per_sample\":%zu,\"samples\":%zu,"
+               "\"ns_per_op\":{\"min\":%.3f,\"p50\":%.3f,\"p90\":%.3f,\"p99\":%.3f,\"max\":%.3f,\"mean\":%.3f},"
+               "\"config\":{\"safety_policy\":%d,\"poisoning\":%d,\"default_alignment\":%zu,\"min_buffer_size\":%zu,\"free_lists\":\"%s\"}",
+               bench_config.suite, name, impl, ops, bench_config.samples,
+               stats->min, stats->p50, stats->p90, stats->p99, stats->max, stats->mean,
+               EM_SAFETY_POLICY, BENCH_POISONING, (size_t)EM_DEFAULT_ALIGNMENT, (size_t)EM_MIN_BUFFER_SIZE, BENCH_FREE_LISTS);
+    }
+    bench_counters_print(&stats->counters, (double)ops * (double)bench_config.samples);
+    printf(bench_config.csv ? "\n" : "}\n");
+    fflush(stdout);
+}
+
+void bench_run(const char *name, const char *impl, BenchFn fn, void *ctx, size_t ops) {
+    if (!bench_selected(name)) return;
+    ops = bench_ops(ops);
+    BenchStats stats = bench_measure(fn, ctx, ops);
+    bench_report(name, impl, ops, &stats);
+}
+
+/*
+ * xorshift64*: deterministic, fast and good enough for workload generation.
+*/
+uint64_t bench_rand(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+/*
+ * Current resident set size of the process, 0 where it cannot be queried.
+*/
+size_t bench_rss_bytes(void) {
+#if defined(__linux__)
+    FILE *statm = fopen("/proc/self/statm", "r");
+    if (!statm) return 0;
+    unsigned long pages_total = 0, pages_resident = 0;
+    int matched = fscanf(statm, "%lu %lu", &pages_total, &pages_resident);
+    fclose(statm);
+    if (matched != 2) return 0;
+    return (size_t)pages_resident * (size_t)sysconf(_SC_PAGESIZE);
+#else
+    return 0;
+#endif
+}
+
+#endif // BENCH_UTILS_H
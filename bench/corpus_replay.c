@@ -0,0 +1,209 @@
+/*
+ * corpus_replay: a fuzz corpus as a performance regression suite.
+ *
+ * The fuzz target is compiled like a benchmark (optimized, no sanitizers, no libFuzzer,
+ * FUZZ_LOG compiled out) and driven by this main() instead of libFuzzer. Every corpus
+ * file becomes one benchmark record timing LLVMFuzzerTestOneInput on it, so an input
+ * that got slower after an internal change stands out by name; a final "corpus/all"
+ * record times one pass over the whole corpus (ns/op = per input).
+ *
+ *   make bench_corpus                  (every fuzzer with a fuzzers/[name]_corpus directory)
+ *   ./bench/corpus_chaos [--csv] [--quick] [--counters] fuzzers/chaos_corpus crash-1234
+ *
+ * Arguments are corpus directories or single files, mixed with the usual bench options.
+ * The slowest inputs are listed on stderr at the end.
+ *
+ * FUZZ_SOURCE selects the fuzzer and FUZZ_NAME the suite name (set by the Makefile).
+*/
+
+#include FUZZ_SOURCE
+#include "bench_utils.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#define CORPUS_SAMPLE_NS  200000.0  // Target duration of one timed sample
+#define CORPUS_MAX_OPS    (1 << 16)
+#define CORPUS_SLOWEST    5
+
+typedef struct {
+    char *name;
+    uint8_t *data;
+    size_t size;
+    double p50;
+} CorpusInput;
+
+typedef struct {
+    CorpusInput *inputs;
+    size_t count;
+    size_t capacity;
+} Corpus;
+
+int main(int argc, char **argv);
+
+static void run_input(void *ctx, size_t ops) {
+    const CorpusInput *input = (const CorpusInput *)ctx;
+    for (size_t i = 0; i < ops; i++) LLVMFuzzerTestOneInput(input->data, input->size);
+}
+
+static void run_corpus(void *ctx, size_t ops) {
+    const Corpus *corpus = (const Corpus *)ctx;
+    size_t passes = ops / corpus->count;
+    for (size_t pass = 0; pass < passes; pass++) {
+        for (size_t i = 0; i < corpus->count; i++) LLVMFuzzerTestOneInput(corpus->inputs[i].data, corpus->inputs[i].size);
+    }
+}
+
+static bool corpus_load_file(Corpus *corpus, const char *path, const char *name) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return false;
+    uint8_t *data = NULL;
+    size_t size = 0, capacity = 0;
+    for (;;) {
+        if (size == capacity) {
+            capacity = capacity ? capacity * 2 : 4096;
+            uint8_t *grown = (uint8_t *)realloc(data, capacity);
+            if (!grown) break;
+            data = grown;
+        }
+        size_t got = fread(data + size, 1, capacity - size, file);
+        if (got == 0) break;
+        size += got;
+    }
+    fclose(file);
+
+    if (corpus->count == corpus->capacity) {
+        size_t grown_capacity = corpus->capacity ? corpus->capacity * 2 : 64;
+        CorpusInput *grown = (CorpusInput *)realloc(corpus->inputs, grown_capacity * sizeof(CorpusInput));
+        if (!grown) {
+            free(data);
+            return false;
+        }
+        corpus->inputs = grown;
+        corpus->capacity = grown_capacity;
+    }
+    CorpusInput *input = &corpus->inputs[corpus->count++];
+    input->name = strdup(name);
+    input->data = data;
+    input->size = size;
+    input->p50 = 0.0;
+    return input->name != NULL;
+}
+
+/*
+ * A directory contributes its regular, non-hidden files (libFuzzer corpus layout);
+ * anything else is loaded as a single input named by its path.
+*/
+static bool corpus_load(Corpus *corpus, const char *path) {
+    struct stat info;
+    if (stat(path, &info) != 0) {
+        fprintf(stderr, "corpus_replay: cannot read '%s'\n", path);
+        return false;
+    }
+    if (!S_ISDIR(info.st_mode)) return corpus_load_file(corpus, path, path);
+
+    DIR *directory = opendir(path);
+    if (!directory) return false;
+    bool ok = true;
+    struct dirent *entry;
+    while (ok && (entry = readdir(directory)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        char file_path[4096];
+        snprintf(file_path, sizeof(file_path), "%s/%s", path, entry->d_name);
+        if (stat(file_path, &info) != 0 || !S_ISREG(info.st_mode)) continue;
+        ok = corpus_load_file(corpus, file_path, entry->d_name);
+    }
+    closedir(directory);
+    return ok;
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp(((const CorpusInput *)a)->name, ((const CorpusInput *)b)->name);
+}
+
+static int compare_slowest(const void *a, const void *b) {
+    double x = ((const CorpusInput *)a)->p50;
+    double y = ((const CorpusInput *)b)->p50;
+    return (x < y) - (x > y);
+}
+
+/*
+ * Enough calls per sample to keep the clock overhead out of fast inputs.
+*/
+static size_t calibrate_ops(BenchFn fn, void *ctx, size_t unit) {
+    double start = bench_now_ns();
+    fn(ctx, unit);
+    double elapsed = bench_now_ns() - start;
+    size_t ops = (elapsed > 0.0) ? (size_t)(CORPUS_SAMPLE_NS / elapsed) * unit : CORPUS_MAX_OPS;
+    if (ops < unit) ops = unit;
+    if (ops > CORPUS_MAX_OPS) ops = CORPUS_MAX_OPS - CORPUS_MAX_OPS % unit;
+    return bench_config.quick ? unit : ops;
+}
+
+int main(int argc, char **argv) {
+    // Paths go to the corpus, everything else to the shared bench option parser
+    char **options = (char **)calloc((size_t)argc + 1, sizeof(char *));
+    const char **paths = (const char **)calloc((size_t)argc + 1, sizeof(char *));
+    if (!options || !paths) return 1;
+    int option_count = 0;
+    size_t path_count = 0;
+    options[option_count++] = argv[0];
+    for (int i = 1; i < argc; i++) {
+        bool takes_value = strcmp(argv[i], "--samples") == 0 || strcmp(argv[i], "--threads") == 0 ||
+                           strcmp(argv[i], "--filter") == 0;
+        if (argv[i][0] != '-') {
+            paths[path_count++] = argv[i];
+        } else {
+            options[option_count++] = argv[i];
+            if (takes_value && i + 1 < argc) options[option_count++] = argv[++i];
+        }
+    }
+    bench_init("corpus_" FUZZ_NAME, option_count, options);
+    if (path_count == 0) {
+        fprintf(stderr, "usage: %s [bench options] corpus-dir-or-file...\n", argv[0]);
+        return 2;
+    }
+
+    Corpus corpus = { NULL, 0, 0 };
+    for (size_t p = 0; p < path_count; p++) {
+        if (!corpus_load(&corpus, paths[p])) return 1;
+    }
+    if (corpus.count == 0) {
+        fprintf(stderr, "corpus_replay: no inputs found\n");
+        return 1;
+    }
+    qsort(corpus.inputs, corpus.count, sizeof(CorpusInput), compare_names);
+
+    char name[512];
+    for (size_t i = 0; i < corpus.count; i++) {
+        CorpusInput *input = &corpus.inputs[i];
+        snprintf(name, sizeof(name), "%s/%s", FUZZ_NAME, input->name);
+        if (!bench_selected(name)) continue;
+
+        size_t ops = calibrate_ops(run_input, input, 1);
+        BenchStats stats = bench_measure(run_input, input, ops);
+        input->p50 = stats.p50;
+        bench_report(name, "em", ops, &stats);
+    }
+
+    if (bench_selected("corpus/all")) {
+        size_t ops = calibrate_ops(run_corpus, &corpus, corpus.count);
+        BenchStats stats = bench_measure(run_corpus, &corpus, ops);
+        bench_report("corpus/all", "em", ops, &stats);
+    }
+
+    qsort(corpus.inputs, corpus.count, sizeof(CorpusInput), compare_slowest);
+    fprintf(stderr, "corpus_%s: %zu inputs, slowest (p50 ns/input):\n", FUZZ_NAME, corpus.count);
+    for (size_t i = 0; i < corpus.count && i < CORPUS_SLOWEST && corpus.inputs[i].p50 > 0.0; i++) {
+        fprintf(stderr, "  %12.1f  %s (%zu bytes)\n", corpus.inputs[i].p50, corpus.inputs[i].name, corpus.inputs[i].size);
+    }
+
+    for (size_t i = 0; i < corpus.count; i++) {
+        free(corpus.inputs[i].name);
+        free(corpus.inputs[i].data);
+    }
+    free(corpus.inputs);
+    free(options);
+    free(paths);
+    return 0;
+}
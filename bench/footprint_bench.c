@@ -0,0 +1,536 @@
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#define EM_STATS
+#define EM_WALK
+#define EM_LIFETIME
+#include "easy_memory.h"
+#include "bench_utils.h"
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#   include <malloc.h>
+#   include <sys/wait.h>
+#   define FOOTPRINT_HAS_MALLINFO 1
+#else
+#   define FOOTPRINT_HAS_MALLINFO 0
+#endif
+
+/*
+ * Fragmentation and footprint suite.
+ *
+ * Speed is measured elsewhere; this suite measures how much memory an allocator needs
+ * to hold a workload. Each workload is a deterministic stream of allocations and frees
+ * shaped after a real program, replayed against easy_memory and against the system
+ * malloc. Footprint is the high-water mark of touched capacity: for EM the distance
+ * from the arena start to the tail, for glibc the heap below its top chunk plus mmapped
+ * chunks (mallinfo2 arena - keepcost + hblkhd, relative to the start of the workload).
+ * Each workload runs in a forked child so glibc starts from a pristine heap every time.
+ *
+ * Every CHECKPOINTS-th of a workload a "series" record is emitted:
+ *   live_bytes      Bytes requested by live allocations
+ *   footprint       Touched capacity (see above)
+ *   header_bytes    Block headers (sizeof(Block) per live, free, held and tail block; one word per chunk for glibc)
+ *   padding_bytes   Payload beyond the request: size rounding and alignment padding inside blocks
+ *   hole_bytes      Free bytes below the footprint (EM: free tree and held short-lived payload, glibc: fordblks - keepcost)
+ *   holes           Number of such free regions
+ *   largest_hole    Largest of them (EM only)
+ *   fragmentation   1 - largest_hole / hole_bytes (EM only): 0 = one reusable hole, ~1 = dust
+ * and one "summary" record per workload with the maximum of every column.
+ *
+ * "em_lifetime" replays the same streams through em_alloc_ex, passing EM_LIFETIME_SHORT for
+ * the allocations a workload drops at the end of its request or frame. Its footprint
+ * counts the short-lived region at the top of the arena on top of the chain below the tail,
+ * and its holes include the short-lived blocks freed out of order that the region still holds.
+ *
+ * Build a matrix of EM configurations (EM_MIN_BUFFER_SIZE, EM_DEFAULT_ALIGNMENT,
+ * EM_PLACEMENT_POLICY and EM_FREE_TLSF) with `make bench_footprint_matrix`, which writes footprint_output.txt.
+*/
+
+#define ARENA_SIZE   ((size_t)512 << 20)
+#define MAX_LIVE     65536
+#define CHECKPOINTS  64
+
+typedef struct {
+    size_t live_bytes;
+    size_t footprint;
+    size_t header_bytes;
+    size_t padding_bytes;
+    size_t hole_bytes;
+    size_t holes;
+    size_t largest_hole;
+    double fragmentation;
+} Footprint;
+
+typedef struct {
+    void *pointer;
+    size_t size;
+} LiveObject;
+
+/*
+ * Allocator under test plus the bookkeeping shared by every workload
+ */
+typedef struct Sim {
+    const char *impl;
+    void *(*alloc)(struct Sim *sim, size_t size, size_t alignment);
+    void (*release)(struct Sim *sim, void *pointer);
+    void (*measure)(struct Sim *sim, Footprint *out);
+    EM *em;
+    LiveObject *live;
+    size_t live_count;
+    size_t live_bytes;
+    size_t usable_bytes;   // malloc_usable_size total (malloc only)
+    size_t baseline;       // System bytes held before the workload (malloc only)
+    size_t steps;
+    size_t total_steps;
+    size_t next_checkpoint;
+    const char *workload;
+    Footprint peak;
+    uint64_t rng;
+    bool transient;        // The workload will drop the next allocations at the end of its request or frame
+    uint8_t padding[sizeof(uint64_t) - 1];
+} Sim;
+
+/*
+ * easy_memory: fresh arena per workload
+ */
+static void *em_sim_alloc(Sim *sim, size_t size, size_t alignment) {
+    return alignment > EM_DEFAULT_ALIGNMENT ? em_alloc_aligned(sim->em, size, alignment) : em_alloc(sim->em, size);
+}
+
+static void *em_lifetime_sim_alloc(Sim *sim, size_t size, size_t alignment) {
+    size_t effective = alignment > EM_DEFAULT_ALIGNMENT ? alignment : EM_DEFAULT_ALIGNMENT;
+    return em_alloc_ex(sim->em, size, effective, sim->transient ? EM_LIFETIME_SHORT : EM_LIFETIME_LONG);
+}
+
+/*
+ * Touched capacity: the chain up to the tail plus the short-lived region, without the
+ * untouched space between them and above the region
+ */
+static size_t em_touched_bytes(const EMStats *stats) {
+    size_t touched = stats->capacity - stats->free_tail_bytes;
+    if (stats->short_region_bytes > 0) touched -= stats->capacity - stats->short_region_top;
+    return touched;
+}
+
+static void em_sim_release(Sim *sim, void *pointer) {
+    (void)sim;
+    em_free(pointer);
+}
+
+static bool largest_hole_cb(const EMWalkEntry *entry, void *context) {
+    size_t *largest = (size_t *)context;
+    if (entry->kind == EM_WALK_FREE && entry->size > *largest) *largest = entry->size;
+    return true;
+}
+
+static void em_sim_measure(Sim *sim, Footprint *out) {
+    EMStats stats = em_get_stats(sim->em);
+    out->live_bytes = sim->live_bytes;
+    out->footprint = em_touched_bytes(&stats);
+    out->header_bytes = (stats.live_blocks + stats.free_tree_blocks + stats.short_held_blocks + 1) * sizeof(Block);
+    out->padding_bytes = stats.used_bytes - sim->live_bytes;
+    out->hole_bytes = stats.free_tree_bytes + stats.short_held_bytes;
+    out->holes = stats.free_tree_blocks + stats.short_held_blocks;
+    out->largest_hole = 0;
+    em_walk(sim->em, largest_hole_cb, &out->largest_hole);
+    out->fragmentation = out->hole_bytes ? 1.0 - (double)out->largest_hole / (double)out->hole_bytes : 0.0;
+}
+
+#if FOOTPRINT_HAS_MALLINFO
+/*
+ * glibc malloc
+ */
+static size_t malloc_touched_bytes(const struct mallinfo2 *info) {
+    return info->arena - info->keepcost + info->hblkhd;
+}
+
+static void *malloc_sim_alloc(Sim *sim, size_t size, size_t alignment) {
+    void *pointer = NULL;
+    if (alignment > 2 * sizeof(size_t)) {
+        if (posix_memalign(&pointer, alignment, size) != 0) return NULL;
+    } else {
+        pointer = malloc(size);
+    }
+    if (pointer) sim->usable_bytes += malloc_usable_size(pointer);
+    return pointer;
+}
+
+static void malloc_sim_release(Sim *sim, void *pointer) {
+    sim->usable_bytes -= malloc_usable_size(pointer);
+    free(pointer);
+}
+
+static void malloc_sim_measure(Sim *sim, Footprint *out) {
+    struct mallinfo2 info = mallinfo2();
+    size_t touched = malloc_touched_bytes(&info);
+    out->live_bytes = sim->live_bytes;
+    out->footprint = touched > sim->baseline ? touched - sim->baseline : 0;
+    out->header_bytes = sim->live_count * sizeof(size_t);
+    out->padding_bytes = sim->usable_bytes - sim->live_bytes;
+    out->hole_bytes = info.fordblks - info.keepcost;
+    out->holes = info.ordblks;
+    out->largest_hole = 0;
+    out->fragmentation = 0.0;
+}
+#endif
+
+/*
+ * Reporting
+ */
+static void report_header(void) {
+    if (bench_config.csv && !bench_header_printed) {
+        printf("suite,bench,impl,kind,step,live_bytes,footprint,header_bytes,padding_bytes,hole_bytes,holes,"
+               "largest_hole,fragmentation,min_buffer_size,default_alignment,placement_policy,free_lists\n");
+        bench_header_printed = true;
+    }
+}
+
+static void report(const Sim *sim, const char *kind, size_t step, const Footprint *f) {
+    if (bench_config.csv) {
+        printf("%s,%s,%s,%s,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%.4f,%zu,%zu,%d,%s\n",
+               bench_config.suite, sim->workload, sim->impl, kind, step,
+               f->live_bytes, f->footprint, f->header_bytes, f->padding_bytes, f->hole_bytes, f->holes,
+               f->largest_hole, f->fragmentation,
+               (size_t)EM_MIN_BUFFER_SIZE, (size_t)EM_DEFAULT_ALIGNMENT, EM_PLACEMENT_POLICY, BENCH_FREE_LISTS);
+    } else {
+        printf("{\"suite\":\"%s\",\"bench\":\"%s\",\"impl\":\"%s\",\"kind\":\"%s\",\"step\":%zu,"
+               "\"live_bytes\":%zu,\"footprint\":%zu,\"header_bytes\":%zu,\"padding_bytes\":%zu,"
+               "\"hole_bytes\":%zu,\"holes\":%zu,\"largest_hole\":%zu,\"fragmentation\":%.4f,"
+               "\"config\":{\"min_buffer_size\":%zu,\"default_alignment\":%zu,\"placement_policy\":%d,\"free_lists\":\"%s\"}}\n",
+               bench_config.suite, sim->workload, sim->impl, kind, step,
+               f->live_bytes, f->footprint, f->header_bytes, f->padding_bytes, f->hole_bytes, f->holes,
+               f->largest_hole, f->fragmentation,
+               (size_t)EM_MIN_BUFFER_SIZE, (size_t)EM_DEFAULT_ALIGNMENT, EM_PLACEMENT_POLICY, BENCH_FREE_LISTS);
+    }
+}
+
+#define PEAK(field) if (now.field > sim->peak.field) sim->peak.field = now.field
+
+/*
+ * Called after every operation: tracks the peaks, emits the series at checkpoints
+ */
+static void observe(Sim *sim) {
+    sim->steps++;
+    bool checkpoint = sim->steps >= sim->next_checkpoint;
+
+    Footprint now;
+    if (checkpoint) {
+        sim->measure(sim, &now);
+        sim->next_checkpoint += sim->total_steps / CHECKPOINTS > 0 ? sim->total_steps / CHECKPOINTS : 1;
+        report(sim, "series", sim->steps, &now);
+    } else if (sim->em != NULL) {
+        // O(1) footprint between checkpoints, the walk is kept for the checkpoints
+        EMStats stats = em_get_stats(sim->em);
+        memset(&now, 0, sizeof(now));
+        now.live_bytes = sim->live_bytes;
+        now.footprint = em_touched_bytes(&stats);
+        now.hole_bytes = stats.free_tree_bytes + stats.short_held_bytes;
+        now.holes = stats.free_tree_blocks + stats.short_held_blocks;
+    } else {
+        sim->measure(sim, &now);
+    }
+
+    PEAK(live_bytes);
+    PEAK(footprint);
+    PEAK(header_bytes);
+    PEAK(padding_bytes);
+    PEAK(hole_bytes);
+    PEAK(holes);
+    PEAK(largest_hole);
+    PEAK(fragmentation);
+}
+
+/*
+ * Allocate and keep track of an object; returns its slot or MAX_LIVE on failure
+ */
+static size_t sim_alloc(Sim *sim, size_t size, size_t alignment) {
+    if (sim->live_count == MAX_LIVE) return MAX_LIVE;
+    void *pointer = sim->alloc(sim, size, alignment);
+    if (pointer == NULL) return MAX_LIVE;
+
+    memset(pointer, 0xA5, size < 64 ? size : 64);
+    size_t slot = sim->live_count++;
+    sim->live[slot].pointer = pointer;
+    sim->live[slot].size = size;
+    sim->live_bytes += size;
+    observe(sim);
+    return slot;
+}
+
+/*
+ * Free the object in 'slot'; the last object moves into the hole
+ */
+static void sim_free(Sim *sim, size_t slot) {
+    sim->release(sim, sim->live[slot].pointer);
+    sim->live_bytes -= sim->live[slot].size;
+    sim->live[slot] = sim->live[--sim->live_count];
+    observe(sim);
+}
+
+static void sim_free_from(Sim *sim, size_t first) {
+    while (sim->live_count > first) sim_free(sim, sim->live_count - 1);
+}
+
+static size_t rand_range(Sim *sim, size_t low, size_t high) {
+    return low + (size_t)(bench_rand(&sim->rng) % (uint64_t)(high - low + 1));
+}
+
+/*
+ * Log-uniform size in [low, high] (density ~ 1/size): most requests small, a long tail of large ones
+ */
+static size_t rand_log_uniform(Sim *sim, size_t low, size_t high) {
+    size_t low_bits = 0, high_bits = 0;
+    while (((size_t)2 << low_bits) <= low) low_bits++;
+    while (((size_t)2 << high_bits) <= high) high_bits++;
+
+    size_t bits = rand_range(sim, low_bits, high_bits);
+    size_t size = rand_range(sim, (size_t)1 << bits, ((size_t)2 << bits) - 1);
+    return size < low ? low : (size > high ? high : size);
+}
+
+/*
+ * Workloads. Each is a pure function of the RNG seed, so every allocator sees the same stream.
+ */
+
+// Web server: per-request arena of headers, parsed fields and a body buffer, plus long-lived sessions
+static void workload_http(Sim *sim, size_t requests) {
+    size_t sessions = sim->live_count;
+    for (size_t r = 0; r < requests; r++) {
+        if (r % 64 == 0) (void)sim_alloc(sim, rand_range(sim, 256, 2048), 0);
+
+        size_t first = sim->live_count;
+        size_t headers = rand_range(sim, 8, 40);
+        sim->transient = true;
+        for (size_t h = 0; h < headers; h++) (void)sim_alloc(sim, rand_range(sim, 16, 256), 0);
+        (void)sim_alloc(sim, rand_range(sim, 512, 16384), 0);
+        (void)sim_alloc(sim, rand_range(sim, 1024, 8192), 0);
+        sim->transient = false;
+
+        sim_free_from(sim, first);
+
+        if (r % 256 == 255 && sim->live_count > sessions) {
+            sim_free(sim, sessions + rand_range(sim, 0, sim->live_count - sessions - 1));
+        }
+    }
+}
+
+// JSON parse tree: nodes, strings and arrays grown by doubling (realloc pattern), then the whole document freed
+static void workload_json(Sim *sim, size_t documents) {
+    for (size_t d = 0; d < documents; d++) {
+        size_t first = sim->live_count;
+        size_t nodes = rand_range(sim, 200, 4000);
+        size_t array_slot = MAX_LIVE;
+        size_t array_capacity = 0;
+        size_t array_length = 0;
+
+        for (size_t n = 0; n < nodes; n++) {
+            (void)sim_alloc(sim, 32, 0);
+            if (bench_rand(&sim->rng) % 2) (void)sim_alloc(sim, rand_range(sim, 4, 64), 0);
+
+            if (array_length == array_capacity) {
+                size_t grown = array_capacity ? array_capacity * 2 : 4;
+                size_t slot = sim_alloc(sim, grown * sizeof(void *), 0);
+                if (slot == MAX_LIVE) break;
+                if (array_slot != MAX_LIVE) {
+                    // sim_free moves the last object (the new array) into the freed slot
+                    sim_free(sim, array_slot);
+                    slot = array_slot;
+                }
+                array_slot = slot;
+                array_capacity = grown;
+            }
+            array_length++;
+            if (array_length > 64 && bench_rand(&sim->rng) % 32 == 0) {
+                array_slot = MAX_LIVE;
+                array_capacity = 0;
+                array_length = 0;
+            }
+        }
+        sim_free_from(sim, first);
+    }
+}
+
+// Game loop: per-frame scratch (some SIMD-aligned) dropped at frame end, entities with multi-frame lifetimes
+static void workload_game(Sim *sim, size_t frames) {
+    for (size_t f = 0; f < frames; f++) {
+        size_t spawns = rand_range(sim, 0, 6);
+        for (size_t s = 0; s < spawns; s++) (void)sim_alloc(sim, rand_range(sim, 64, 1024), 0);
+
+        size_t first = sim->live_count;
+        size_t transient = rand_range(sim, 50, 300);
+        sim->transient = true;
+        for (size_t t = 0; t < transient; t++) {
+            size_t alignment = bench_rand(&sim->rng) % 8 == 0 ? 64 : 0;
+            (void)sim_alloc(sim, rand_range(sim, 16, 512), alignment);
+        }
+        sim->transient = false;
+        sim_free_from(sim, first);
+
+        size_t despawns = rand_range(sim, 0, 6);
+        for (size_t s = 0; s < despawns && sim->live_count > 0; s++) {
+            sim_free(sim, rand_range(sim, 0, sim->live_count - 1));
+        }
+    }
+}
+
+// Long-lived cache: fixed entry budget, every miss evicts a random entry and inserts a differently sized one
+static void workload_cache(Sim *sim, size_t operations) {
+    const size_t entries = 8192;
+    while (sim->live_count < entries) {
+        if (sim_alloc(sim, rand_range(sim, 64, 4096), 0) == MAX_LIVE) return;
+    }
+    for (size_t i = 0; i < operations; i++) {
+        sim_free(sim, rand_range(sim, 0, sim->live_count - 1));
+        (void)sim_alloc(sim, rand_range(sim, 64, 4096), 0);
+    }
+}
+
+// Power-law (log-uniform) sizes and lifetimes: the classic fragmentation stress
+static void workload_power_law(Sim *sim, size_t operations) {
+    for (size_t i = 0; i < operations; i++) {
+        if (sim->live_count > 0 && (sim->live_count >= 20000 || bench_rand(&sim->rng) % 2)) {
+            // Young objects die first: pick from the end with a power-law distance
+            size_t distance = rand_log_uniform(sim, 1, sim->live_count) - 1;
+            sim_free(sim, sim->live_count - 1 - distance);
+        } else {
+            (void)sim_alloc(sim, rand_log_uniform(sim, 16, 65536), 0);
+        }
+    }
+}
+
+// Compiler pass: temporaries dropped at the end of every unit, with the symbols and IR that survive it allocated in between
+static void workload_compile(Sim *sim, size_t units) {
+    for (size_t u = 0; u < units; u++) {
+        size_t first = sim->live_count;
+        size_t temporaries = rand_range(sim, 100, 1000);
+        size_t survivors = 0;
+        sim->transient = true;
+        for (size_t t = 0; t < temporaries; t++) {
+            if (bench_rand(&sim->rng) % 16 == 0) {
+                // Survivors are kept below the temporaries of the unit so that sim_free_from spares them
+                sim->transient = false;
+                size_t slot = sim_alloc(sim, rand_range(sim, 32, 256), 0);
+                sim->transient = true;
+                if (slot == MAX_LIVE) continue;
+                LiveObject survivor = sim->live[slot];
+                sim->live[slot] = sim->live[first + survivors];
+                sim->live[first + survivors] = survivor;
+                survivors++;
+            }
+            else {
+                (void)sim_alloc(sim, rand_range(sim, 16, 1024), 0);
+            }
+        }
+        sim->transient = false;
+        sim_free_from(sim, first + survivors);
+
+        // Old symbols are retired once the table outgrows its budget
+        while (sim->live_count > 4096) sim_free(sim, rand_range(sim, 0, sim->live_count - 1));
+    }
+}
+
+typedef struct {
+    const char *name;
+    void (*run)(Sim *sim, size_t count);
+    size_t count;
+    size_t steps;   // Rough operation count, spaces the checkpoints
+} Workload;
+
+static const Workload workloads[] = {
+    { "http_request", workload_http,      20000,  20000 * 52 },
+    { "json_tree",    workload_json,      200,    200 * 6300 },
+    { "game_frame",   workload_game,      10000,  10000 * 356 },
+    { "cache_churn",  workload_cache,     500000, 8192 + 1000000 },
+    { "power_law",    workload_power_law, 1000000, 1000000 },
+    { "compile_unit", workload_compile,   4000,   4000 * 1100 },
+};
+
+static void run_workload(Sim *sim, const Workload *workload) {
+    sim->workload = workload->name;
+    sim->live_count = 0;
+    sim->live_bytes = 0;
+    sim->usable_bytes = 0;
+    sim->steps = 0;
+    sim->total_steps = bench_ops(workload->steps);
+    sim->next_checkpoint = sim->total_steps / CHECKPOINTS > 0 ? sim->total_steps / CHECKPOINTS : 1;
+    sim->rng = 0x9E3779B97F4A7C15ull;
+    memset(&sim->peak, 0, sizeof(sim->peak));
+
+    workload->run(sim, bench_ops(workload->count));
+    report(sim, "summary", sim->steps, &sim->peak);
+    sim->next_checkpoint = SIZE_MAX;
+    sim_free_from(sim, 0);
+    fflush(stdout);
+}
+
+/*
+ * One workload against every allocator
+ */
+static bool run_pair(Sim *sim, const Workload *workload) {
+    sim->impl = "em";
+    sim->alloc = em_sim_alloc;
+    sim->release = em_sim_release;
+    sim->measure = em_sim_measure;
+    sim->em = em_create(ARENA_SIZE);
+    if (!sim->em) {
+        fprintf(stderr, "footprint_bench: cannot create the arena\n");
+        return false;
+    }
+    run_workload(sim, workload);
+    em_destroy(sim->em);
+
+    sim->impl = "em_lifetime";
+    sim->alloc = em_lifetime_sim_alloc;
+    sim->em = em_create(ARENA_SIZE);
+    if (!sim->em) {
+        fprintf(stderr, "footprint_bench: cannot create the arena\n");
+        return false;
+    }
+    run_workload(sim, workload);
+    em_destroy(sim->em);
+    sim->em = NULL;
+
+#if FOOTPRINT_HAS_MALLINFO
+    sim->impl = "malloc";
+    sim->alloc = malloc_sim_alloc;
+    sim->release = malloc_sim_release;
+    sim->measure = malloc_sim_measure;
+    malloc_trim(0);
+    struct mallinfo2 info = mallinfo2();
+    sim->baseline = malloc_touched_bytes(&info);
+    run_workload(sim, workload);
+#endif
+    return true;
+}
+
+static LiveObject live_objects[MAX_LIVE];
+
+int main(int argc, char **argv) {
+    bench_init("footprint", argc, argv);
+    report_header();
+
+    Sim sim;
+    memset(&sim, 0, sizeof(sim));
+    sim.live = live_objects;
+
+    for (size_t w = 0; w < sizeof(workloads) / sizeof(workloads[0]); w++) {
+        if (!bench_selected(workloads[w].name)) continue;
+
+#if FOOTPRINT_HAS_MALLINFO
+        fflush(stdout);
+        pid_t child = fork();
+        if (child == 0) {
+            bool ok = run_pair(&sim, &workloads[w]);
+            fflush(stdout);
+            _exit(ok ? 0 : 1);
+        }
+        if (child > 0) {
+            int status = 0;
+            if (waitpid(child, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) return 1;
+            continue;
+        }
+#endif
+        if (!run_pair(&sim, &workloads[w])) return 1;
+    }
+
+    return 0;
+}
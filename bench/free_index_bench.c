@@ -0,0 +1,113 @@
+#ifndef EM_FREE_TLSF  // Built with -DEM_FREE_TLSF it times the TLSF lists instead
+#define EM_FREE_INDEX
+#endif
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "bench_utils.h"
+
+/*
+ * Best fit searches over a heavily fragmented arena, with and without EM_FREE_INDEX.
+ *
+ *  - best_fit/<holes>:  em_alloc + em_free of a random size against <holes> free blocks of
+ *                       random sizes. Every call searches the free blocks, splits the chosen
+ *                       one and merges it back, through the free tree ("tree") or through
+ *                       the side index ("index"), or with EM_FREE_TLSF through the
+ *                       segregated lists ("tlsf").
+ *  - reject/<holes>:    em_alloc + em_free of a block larger than every hole. The search
+ *                       finds nothing and the tail serves it; with EM_FREE_TREE_AUGMENT
+ *                       the tree is skipped without being walked.
+ *
+ * Holes are spread over an arena far larger than the caches, so each free tree level is a
+ * likely cache miss while the index nodes stay packed in their own buffer.
+*/
+
+#define REQUESTS    4096
+
+typedef struct {
+    EM *em;
+    size_t *sizes;
+} Ctx;
+
+static uint32_t rng_state = 0x1B873593u;
+
+static uint32_t next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void best_fit_op(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t i = 0; i < ops; i++) {
+        void *p = em_alloc(ctx->em, ctx->sizes[i % REQUESTS]);
+        bench_escape(p);
+        em_free(p);
+    }
+}
+
+static void reject_op(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t i = 0; i < ops; i++) {
+        void *p = em_alloc(ctx->em, 2048 + ctx->sizes[i % REQUESTS]);
+        bench_escape(p);
+        em_free(p);
+    }
+}
+
+/*
+ * Fill the arena with blocks of random sizes and free every other one
+*/
+static EM *fragmented_arena(size_t holes) {
+    EM *em = em_create(holes * 2 * 1024);
+    void **blocks = (void **)malloc(holes * 2 * sizeof(void *));
+    if (!em || !blocks) return NULL;
+    for (size_t i = 0; i < holes * 2; i++) blocks[i] = em_alloc(em, 64 + next_random() % 896);
+    for (size_t i = 0; i < holes * 2; i += 2) em_free(blocks[i]);
+    free(blocks);
+    return em;
+}
+
+int main(int argc, char **argv) {
+    bench_init("free_index", argc, argv);
+
+    size_t sizes[REQUESTS];
+    for (size_t i = 0; i < REQUESTS; i++) sizes[i] = 32 + next_random() % 512;
+
+    const size_t holes[] = { 1000, 10000, 50000 };
+    for (size_t i = 0; i < sizeof(holes) / sizeof(holes[0]); i++) {
+        char reject_name[64];
+        char name[64];
+        snprintf(reject_name, sizeof(reject_name), "reject/%zu", holes[i]);
+        snprintf(name, sizeof(name), "best_fit/%zu", holes[i]);
+        if (!bench_selected(reject_name) && !bench_selected(name)) continue;
+
+        // Rejected requests leave the holes as they were, so both benches share one arena
+        Ctx ctx = { fragmented_arena(holes[i]), sizes };
+        if (!ctx.em) { fprintf(stderr, "free_index setup failed\n"); exit(1); }
+        if (bench_selected(reject_name)) bench_run(reject_name, BENCH_FREE_LISTS, reject_op, &ctx, 1000000);
+        if (!bench_selected(name)) {
+            em_destroy(ctx.em);
+            continue;
+        }
+
+        #ifdef EM_FREE_TLSF
+        bench_run(name, "tlsf", best_fit_op, &ctx, 1000000);
+        #else
+        size_t index_size = EM_PLAN_FREE_INDEX_SIZE(holes[i] + 16);
+        void *index_memory = malloc(index_size);
+        if (!index_memory) { fprintf(stderr, "free_index setup failed\n"); exit(1); }
+
+        bench_run(name, "tree", best_fit_op, &ctx, 1000000);
+        em_free_index_attach(ctx.em, index_memory, index_size);
+        bench_run(name, "index", best_fit_op, &ctx, 1000000);
+        em_free_index_detach(ctx.em);
+
+        free(index_memory);
+        #endif
+        em_destroy(ctx.em);
+    }
+
+    return 0;
+}
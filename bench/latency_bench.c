@@ -0,0 +1,372 @@
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "bench_utils.h"
+
+/*
+ * Worst-case latency harness for real-time budgets.
+ *
+ * Unlike the throughput suites, every single call is timed (rdtsc on x86, the virtual
+ * counter on AArch64, clock_gettime elsewhere) and recorded into a log-linear histogram:
+ * 8 sub-buckets per power of two, so any latency is known within 12.5%, plus the exact
+ * maximum. The timer's own cost is calibrated once and subtracted from every sample.
+ *
+ * Workloads are randomized (mixed sizes and lifetimes) or adversarial: a free tree packed
+ * with distinct sizes so every miss walks the full height, frees that merge on both sides,
+ * large alignments served from a fragmented arena, and sub-allocators driven to their
+ * limits. Records are named "<workload>/<call>"; each carries the histogram and the
+ * percentiles of one call site.
+ *
+ * Build the matrix of safety policies and poisoning settings with `make bench_latency_matrix`,
+ * or a single configuration with EXTRA_CFLAGS="-DEM_SAFETY_POLICY=0 -DEM_POISONING".
+*/
+
+#define ARENA_SIZE      ((size_t)64 << 20)
+#define POOL            8192
+#define CALLS           (1 << 18)
+#define HOLES           2048
+#define SUB_BUCKETS     8
+#define SUB_BITS        3
+#define BUCKET_COUNT    (2 * SUB_BUCKETS + (64 - SUB_BITS - 1) * SUB_BUCKETS)
+#define CALIBRATE_NS    20000000.0
+
+/*
+ * Per-call timer
+*/
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#   include <x86intrin.h>
+#   define LATENCY_TIMER "rdtsc"
+static inline uint64_t latency_ticks(void) {
+    _mm_lfence();
+    uint64_t ticks = __rdtsc();
+    _mm_lfence();
+    return ticks;
+}
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+#   define LATENCY_TIMER "cntvct"
+static inline uint64_t latency_ticks(void) {
+    uint64_t ticks;
+    __asm__ volatile("isb\n\tmrs %0, cntvct_el0" : "=r"(ticks) : : "memory");
+    return ticks;
+}
+#else
+#   define LATENCY_TIMER "clock_gettime"
+static inline uint64_t latency_ticks(void) {
+    return (uint64_t)bench_now_ns();
+}
+#endif
+
+static double ns_per_tick = 1.0;
+static uint64_t timer_overhead = 0;
+
+static void calibrate_timer(void) {
+    double start_ns = bench_now_ns();
+    uint64_t start = latency_ticks();
+    while (bench_now_ns() - start_ns < CALIBRATE_NS) {}
+    uint64_t ticks = latency_ticks() - start;
+    ns_per_tick = (bench_now_ns() - start_ns) / (double)(ticks ? ticks : 1);
+
+    timer_overhead = UINT64_MAX;
+    for (int i = 0; i < 100000; i++) {
+        uint64_t t0 = latency_ticks();
+        uint64_t t1 = latency_ticks();
+        if (t1 - t0 < timer_overhead) timer_overhead = t1 - t0;
+    }
+}
+
+/*
+ * Log-linear latency histogram (values in ticks)
+*/
+typedef struct {
+    uint64_t counts[BUCKET_COUNT];
+    uint64_t calls;
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+} Histogram;
+
+static size_t bucket_of(uint64_t value) {
+    if (value < 2 * SUB_BUCKETS) return (size_t)value;
+    size_t exponent = 63 - (size_t)__builtin_clzll(value);
+    size_t sub = (size_t)(value >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1);
+    return 2 * SUB_BUCKETS + (exponent - SUB_BITS - 1) * SUB_BUCKETS + sub;
+}
+
+// Largest value that falls into 'bucket'
+static uint64_t bucket_limit(size_t bucket) {
+    if (bucket < 2 * SUB_BUCKETS) return bucket;
+    size_t exponent = (bucket - 2 * SUB_BUCKETS) / SUB_BUCKETS + SUB_BITS + 1;
+    uint64_t sub = (uint64_t)((bucket - 2 * SUB_BUCKETS) % SUB_BUCKETS);
+    return ((SUB_BUCKETS + sub + 1) << (exponent - SUB_BITS)) - 1;
+}
+
+static void histogram_reset(Histogram *h) {
+    memset(h, 0, sizeof(*h));
+    h->min = UINT64_MAX;
+}
+
+static inline void histogram_record(Histogram *h, uint64_t start, uint64_t end) {
+    uint64_t elapsed = end - start;
+    elapsed = elapsed > timer_overhead ? elapsed - timer_overhead : 0;
+    h->counts[bucket_of(elapsed)]++;
+    h->calls++;
+    h->total += elapsed;
+    if (elapsed < h->min) h->min = elapsed;
+    if (elapsed > h->max) h->max = elapsed;
+}
+
+static double histogram_percentile(const Histogram *h, double pct) {
+    uint64_t rank = (uint64_t)(pct / 100.0 * (double)(h->calls - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < BUCKET_COUNT; b++) {
+        seen += h->counts[b];
+        if (seen >= rank) {
+            uint64_t limit = bucket_limit(b);
+            return (double)(limit < h->max ? limit : h->max) * ns_per_tick;
+        }
+    }
+    return (double)h->max * ns_per_tick;
+}
+
+static void histogram_report(const char *name, const Histogram *h) {
+    if (!bench_selected(name) || h->calls == 0) return;
+
+    double mean = (double)h->total / (double)h->calls * ns_per_tick;
+    if (bench_config.csv) {
+        if (!bench_header_printed) {
+            printf("suite,bench,timer,calls,min_ns,p50_ns,p99_ns,p999_ns,p9999_ns,max_ns,mean_ns,"
+                   "safety_policy,poisoning,default_alignment\n");
+            bench_header_printed = true;
+        }
+        printf("%s,%s,%s,%llu,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%d,%d,%zu\n",
+               bench_config.suite, name, LATENCY_TIMER, (unsigned long long)h->calls,
+               (double)h->min * ns_per_tick, histogram_percentile(h, 50.0), histogram_percentile(h, 99.0),
+               histogram_percentile(h, 99.9), histogram_percentile(h, 99.99), (double)h->max * ns_per_tick, mean,
+               EM_SAFETY_POLICY, BENCH_POISONING, (size_t)EM_DEFAULT_ALIGNMENT);
+        fflush(stdout);
+        return;
+    }
+
+    printf("{\"suite\":\"%s\",\"bench\":\"%s\",\"impl\":\"em\",\"timer\":\"%s\",\"calls\":%llu,"
+           "\"ns\":{\"min\":%.1f,\"p50\":%.1f,\"p99\":%.1f,\"p999\":%.1f,\"p9999\":%.1f,\"max\":%.1f,\"mean\":%.1f},"
+           "\"histogram_ns\":[",
+           bench_config.suite, name, LATENCY_TIMER, (unsigned long long)h->calls,
+           (double)h->min * ns_per_tick, histogram_percentile(h, 50.0), histogram_percentile(h, 99.0),
+           histogram_percentile(h, 99.9), histogram_percentile(h, 99.99), (double)h->max * ns_per_tick, mean);
+
+    // Non-empty buckets only, as [upper bound in ns, count]
+    bool first = true;
+    for (size_t b = 0; b < BUCKET_COUNT; b++) {
+        if (h->counts[b] == 0) continue;
+        printf("%s[%.1f,%llu]", first ? "" : ",", (double)bucket_limit(b) * ns_per_tick, (unsigned long long)h->counts[b]);
+        first = false;
+    }
+    printf("],\"config\":{\"safety_policy\":%d,\"poisoning\":%d,\"default_alignment\":%zu}}\n",
+           EM_SAFETY_POLICY, BENCH_POISONING, (size_t)EM_DEFAULT_ALIGNMENT);
+    fflush(stdout);
+}
+
+#define TIMED(histogram, call) do {        \
+        uint64_t t0_ = latency_ticks();     \
+        call;                               \
+        histogram_record((histogram), t0_, latency_ticks()); \
+    } while (0)
+
+static void *pool[POOL];
+static Histogram h_alloc, h_free, h_aligned, h_other;
+
+static void reset_histograms(void) {
+    histogram_reset(&h_alloc);
+    histogram_reset(&h_free);
+    histogram_reset(&h_aligned);
+    histogram_reset(&h_other);
+}
+
+/* --- Randomized: mixed sizes, alignments and lifetimes over a pool of live blocks --- */
+
+static void run_random(EM *em) {
+    static const size_t alignments[] = { 16, 32, 64, 256, EMMAX_ALIGNMENT };
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    reset_histograms();
+    memset(pool, 0, sizeof(pool));
+
+    for (size_t i = 0; i < bench_ops(CALLS); i++) {
+        uint64_t r = bench_rand(&seed);
+        size_t slot = (size_t)(r % POOL);
+        size_t size = 8 + (size_t)((r >> 16) % 2048);
+        void *p = NULL;
+
+        if (pool[slot] != NULL) {
+            TIMED(&h_free, em_free(pool[slot]));
+            pool[slot] = NULL;
+        } else if ((r >> 40) % 8 == 0) {
+            TIMED(&h_aligned, p = em_alloc_aligned(em, size, alignments[(r >> 44) % 5]));
+            pool[slot] = p;
+        } else {
+            TIMED(&h_alloc, p = em_alloc(em, size));
+            pool[slot] = p;
+        }
+    }
+    for (size_t i = 0; i < POOL; i++) {
+        if (pool[i]) em_free(pool[i]);
+    }
+
+    histogram_report("random/em_alloc", &h_alloc);
+    histogram_report("random/em_free", &h_free);
+    histogram_report("random/em_alloc_aligned", &h_aligned);
+}
+
+/*
+ * Fill the free tree with HOLES blocks of distinct sizes that cannot merge: every hole
+ * is fenced by a small live block, so the tree reaches its full height for this population.
+*/
+static void build_holes(EM *em) {
+    for (size_t i = 0; i < 2 * HOLES; i++) pool[i] = em_alloc(em, (i % 2) ? 16 : 16 + (i / 2) * 16);
+    for (size_t i = 0; i < 2 * HOLES; i += 2) em_free(pool[i]);
+}
+
+/* --- Adversarial: full-height free tree, misses, exact fits and double-sided merges --- */
+
+static void run_adversarial(EM *em) {
+    reset_histograms();
+
+    // Misses: larger than every hole, so the search fails at the bottom and falls back to the tail
+    em_reset(em);
+    build_holes(em);
+    for (size_t i = 0; i < bench_ops(CALLS / 64); i++) {
+        void *p = NULL;
+        TIMED(&h_alloc, p = em_alloc(em, 16 + HOLES * 16 + 64));
+        if (p) TIMED(&h_free, em_free(p));
+    }
+    histogram_report("tree_miss/em_alloc", &h_alloc);
+    histogram_report("tree_miss/em_free", &h_free);
+
+    // Exact fits taken from and returned to a full tree: detach plus rebalancing insert
+    reset_histograms();
+    uint64_t seed = 42;
+    for (size_t i = 0; i < bench_ops(CALLS / 64); i++) {
+        size_t hole = (size_t)(bench_rand(&seed) % HOLES);
+        void *p = NULL;
+        TIMED(&h_alloc, p = em_alloc(em, 16 + hole * 16));
+        if (p) TIMED(&h_free, em_free(p));
+    }
+    histogram_report("tree_fit/em_alloc", &h_alloc);
+    histogram_report("tree_fit/em_free", &h_free);
+
+    // Frees of the fences: each merges a hole on both sides (two detaches, one insert)
+    reset_histograms();
+    for (size_t round = 0; round < (bench_config.quick ? 1u : 8u); round++) {
+        em_reset(em);
+        build_holes(em);
+        for (size_t i = 1; i + 1 < 2 * HOLES; i += 2) TIMED(&h_free, em_free(pool[i]));
+    }
+    histogram_report("tree_merge/em_free", &h_free);
+
+    // Large alignments served from the fragmented arena: padding recycling on every call
+    reset_histograms();
+    em_reset(em);
+    build_holes(em);
+    for (size_t i = 0; i < bench_ops(CALLS / 64); i++) {
+        void *p = NULL;
+        TIMED(&h_aligned, p = em_alloc_aligned(em, 200, EMMAX_ALIGNMENT));
+        if (p) TIMED(&h_free, em_free(p));
+    }
+    histogram_report("tree_aligned/em_alloc_aligned", &h_aligned);
+    histogram_report("tree_aligned/em_free", &h_free);
+}
+
+/* --- Nested arenas and scratch: create / destroy on a fragmented parent --- */
+
+static void run_nested(EM *em) {
+    reset_histograms();
+    em_reset(em);
+    build_holes(em);
+
+    for (size_t i = 0; i < bench_ops(CALLS / 64); i++) {
+        EM *nested = NULL;
+        TIMED(&h_alloc, nested = em_create_nested(em, 32768));
+        if (nested) TIMED(&h_free, em_destroy(nested));
+        void *scratch = NULL;
+        TIMED(&h_other, scratch = em_alloc_scratch(em, 4096));
+        if (scratch) em_free(scratch);
+    }
+    histogram_report("nested/em_create_nested", &h_alloc);
+    histogram_report("nested/em_destroy", &h_free);
+    histogram_report("scratch/em_alloc_scratch", &h_other);
+}
+
+/* --- Sub-allocators: bump to exhaustion, random slab churn, stack push / pop bursts --- */
+
+static void run_sub_allocators(EM *em) {
+    uint64_t seed = 7;
+    em_reset(em);
+
+    reset_histograms();
+    Bump *bump = em_bump_create(em, 1 << 20);
+    for (size_t i = 0; i < bench_ops(CALLS / 4); i++) {
+        void *p = NULL;
+        TIMED(&h_alloc, p = em_bump_alloc(bump, 8 + (size_t)(bench_rand(&seed) % 256)));
+        if (p == NULL) TIMED(&h_other, em_bump_reset(bump));
+    }
+    em_bump_destroy(bump);
+    histogram_report("bump/em_bump_alloc", &h_alloc);
+    histogram_report("bump/em_bump_reset", &h_other);
+
+    reset_histograms();
+    memset(pool, 0, sizeof(pool));
+    Slab *slab = em_slab_create(em, (size_t)POOL * 64, 48);
+    for (size_t i = 0; i < bench_ops(CALLS); i++) {
+        size_t slot = (size_t)(bench_rand(&seed) % POOL);
+        void *p = NULL;
+        if (pool[slot]) {
+            TIMED(&h_free, em_slab_free(slab, pool[slot]));
+            pool[slot] = NULL;
+        } else {
+            TIMED(&h_alloc, p = em_slab_alloc(slab));
+            pool[slot] = p;
+        }
+    }
+    em_slab_destroy(slab);
+    histogram_report("slab/em_slab_alloc", &h_alloc);
+    histogram_report("slab/em_slab_free", &h_free);
+
+    reset_histograms();
+    Stack *stack = em_stack_create(em, 1 << 20);
+    for (size_t done = 0; done < bench_ops(CALLS); done += 256) {
+        size_t depth = 0;
+        for (; depth < 256; depth++) {
+            void *p = NULL;
+            TIMED(&h_alloc, p = em_stack_alloc(stack, 16 + (size_t)(bench_rand(&seed) % 512)));
+            if (p == NULL) break;
+            pool[depth] = p;
+        }
+        while (depth-- > 0) TIMED(&h_free, em_stack_free(stack, pool[depth]));
+    }
+    em_stack_destroy(stack);
+    histogram_report("stack/em_stack_alloc", &h_alloc);
+    histogram_report("stack/em_stack_free", &h_free);
+}
+
+int main(int argc, char **argv) {
+    bench_init("latency", argc, argv);
+    calibrate_timer();
+
+    EM *em = em_create(ARENA_SIZE);
+    if (!em) {
+        fprintf(stderr, "latency_bench: cannot create the arena\n");
+        return 1;
+    }
+
+    // Touch the whole arena once so page faults do not pollute the first records
+    void *warm = em_alloc(em, ARENA_SIZE / 2);
+    if (warm) memset(warm, 0, ARENA_SIZE / 2);
+    em_reset(em);
+
+    run_random(em);
+    run_adversarial(em);
+    run_nested(em);
+    run_sub_allocators(em);
+
+    em_destroy(em);
+    return 0;
+}
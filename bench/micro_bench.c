@@ -0,0 +1,361 @@
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "bench_utils.h"
+
+/*
+ * Microbenchmarks for every public allocation path, each paired with the closest
+ * glibc malloc equivalent. Names follow "<api>/<path>" so the same record can be
+ * tracked across releases; "impl" tells the two sides apart.
+*/
+
+#define ARENA_SIZE      ((size_t)64 << 20)
+#define BURST           1024
+#define TREE_POOL       4096
+#define SMALL           64
+
+typedef struct {
+    EM *em;
+    void **ptrs;
+    size_t count;
+    size_t size;
+    size_t alignment;
+    uint64_t seed;
+} Ctx;
+
+static void *ptr_storage[TREE_POOL * 2];
+static const size_t tree_sizes[] = { 24, 40, 56, 72, 96, 120, 168, 200 };
+#define TREE_SIZES (sizeof(tree_sizes) / sizeof(tree_sizes[0]))
+
+
+
+/* --- em_alloc / em_free: LIFO pair on the tail (block == tail fast path) --- */
+
+static void em_tail_lifo(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t i = 0; i < ops; i++) {
+        void *p = em_alloc(ctx->em, ctx->size);
+        bench_escape(p);
+        em_free(p);
+    }
+}
+
+static void malloc_lifo(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t i = 0; i < ops; i++) {
+        void *p = malloc(ctx->size);
+        bench_escape(p);
+        free(p);
+    }
+}
+
+/* --- Burst: BURST allocations from the tail, released in reverse (LIFO) order --- */
+
+static void em_tail_burst(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t done = 0; done < ops; done += BURST) {
+        for (size_t i = 0; i < BURST; i++) ctx->ptrs[i] = em_alloc(ctx->em, ctx->size);
+        for (size_t i = BURST; i-- > 0;) em_free(ctx->ptrs[i]);
+    }
+}
+
+static void malloc_burst(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t done = 0; done < ops; done += BURST) {
+        for (size_t i = 0; i < BURST; i++) ctx->ptrs[i] = malloc(ctx->size);
+        for (size_t i = BURST; i-- > 0;) free(ctx->ptrs[i]);
+    }
+}
+
+/* --- FIFO: same burst, released in allocation order (merges + tree inserts) --- */
+
+static void em_fifo(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t done = 0; done < ops; done += BURST) {
+        for (size_t i = 0; i < BURST; i++) ctx->ptrs[i] = em_alloc(ctx->em, ctx->size);
+        for (size_t i = 0; i < BURST; i++) em_free(ctx->ptrs[i]);
+    }
+}
+
+static void malloc_fifo(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t done = 0; done < ops; done += BURST) {
+        for (size_t i = 0; i < BURST; i++) ctx->ptrs[i] = malloc(ctx->size);
+        for (size_t i = 0; i < BURST; i++) free(ctx->ptrs[i]);
+    }
+}
+
+/*
+ * Tree path: a checkerboard of live blocks keeps TREE_POOL holes of mixed sizes in the
+ * free tree. Every op frees a random live block and allocates a random size, which is
+ * served by find_best_fit and returned through the merge/insert path.
+*/
+static void tree_prepare(Ctx *ctx, bool use_em) {
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < TREE_POOL * 2; i++) {
+        size_t size = tree_sizes[bench_rand(&seed) % TREE_SIZES];
+        ctx->ptrs[i] = use_em ? em_alloc(ctx->em, size) : malloc(size);
+    }
+    for (size_t i = 0; i < TREE_POOL * 2; i += 2) {
+        if (use_em) em_free(ctx->ptrs[i]); else free(ctx->ptrs[i]);
+        ctx->ptrs[i] = NULL;
+    }
+    ctx->seed = seed;
+}
+
+static void em_tree(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t i = 0; i < ops; i++) {
+        size_t slot = (size_t)(bench_rand(&ctx->seed) % (TREE_POOL * 2)) | 1;
+        em_free(ctx->ptrs[slot]);
+        ctx->ptrs[slot] = em_alloc(ctx->em, tree_sizes[bench_rand(&ctx->seed) % TREE_SIZES]);
+    }
+}
+
+static void malloc_tree(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t i = 0; i < ops; i++) {
+        size_t slot = (size_t)(bench_rand(&ctx->seed) % (TREE_POOL * 2)) | 1;
+        free(ctx->ptrs[slot]);
+        ctx->ptrs[slot] = malloc(tree_sizes[bench_rand(&ctx->seed) % TREE_SIZES]);
+    }
+}
+
+/* --- Aligned allocations --- */
+
+static void em_aligned(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t done = 0; done < ops; done += BURST) {
+        for (size_t i = 0; i < BURST; i++) ctx->ptrs[i] = em_alloc_aligned(ctx->em, ctx->size, ctx->alignment);
+        for (size_t i = BURST; i-- > 0;) em_free(ctx->ptrs[i]);
+    }
+}
+
+static void malloc_aligned(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t done = 0; done < ops; done += BURST) {
+        for (size_t i = 0; i < BURST; i++) {
+            if (posix_memalign(&ctx->ptrs[i], ctx->alignment, ctx->size) != 0) ctx->ptrs[i] = NULL;
+        }
+        for (size_t i = BURST; i-- > 0;) free(ctx->ptrs[i]);
+    }
+}
+
+/* --- Nested arenas --- */
+
+static void em_nested(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t i = 0; i < ops; i++) {
+        EM *nested = em_create_nested(ctx->em, ctx->size);
+        void *p = em_alloc(nested, SMALL);
+        bench_escape(p);
+        em_destroy(nested);
+    }
+}
+
+static void malloc_nested(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t i = 0; i < ops; i++) {
+        void *block = malloc(ctx->size);
+        bench_escape(block);
+        free(block);
+    }
+}
+
+/* --- Scratchpad --- */
+
+static void em_scratch(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t i = 0; i < ops; i++) {
+        void *p = em_alloc_scratch(ctx->em, ctx->size);
+        bench_escape(p);
+        em_free(p);
+    }
+}
+
+/* --- Bump: BURST allocations then a bulk reset --- */
+
+static void em_bump(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    Bump *bump = (Bump *)ctx->ptrs[0];
+    for (size_t done = 0; done < ops; done += BURST) {
+        for (size_t i = 0; i < BURST; i++) {
+            void *p = em_bump_alloc(bump, ctx->size);
+            bench_escape(p);
+        }
+        em_bump_reset(bump);
+    }
+}
+
+/* --- Slab: steady alloc/free pairs plus bursts --- */
+
+static void em_slab_burst(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    Slab *slab = (Slab *)ctx->ptrs[TREE_POOL * 2 - 1];
+    for (size_t done = 0; done < ops; done += BURST) {
+        for (size_t i = 0; i < BURST; i++) ctx->ptrs[i] = em_slab_alloc(slab);
+        for (size_t i = 0; i < BURST; i++) em_slab_free(slab, ctx->ptrs[i]);
+    }
+}
+
+/* --- Stack: push/pop bursts --- */
+
+static void em_stack_burst(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    Stack *stack = (Stack *)ctx->ptrs[TREE_POOL * 2 - 1];
+    for (size_t done = 0; done < ops; done += BURST) {
+        for (size_t i = 0; i < BURST; i++) ctx->ptrs[i] = em_stack_alloc(stack, ctx->size);
+        for (size_t i = BURST; i-- > 0;) em_stack_free(stack, ctx->ptrs[i]);
+    }
+}
+
+/* --- Calloc --- */
+
+static void em_calloc_pair(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t i = 0; i < ops; i++) {
+        void *p = em_calloc(ctx->em, 1, ctx->size);
+        bench_escape(p);
+        em_free(p);
+    }
+}
+
+static void malloc_calloc_pair(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t i = 0; i < ops; i++) {
+        void *p = calloc(1, ctx->size);
+        bench_escape(p);
+        free(p);
+    }
+}
+
+/* --- Reset zero: ctx->size is the arena capacity, compared against a plain memset --- */
+
+static void em_reset_zero_op(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t i = 0; i < ops; i++) {
+        void *p = em_alloc(ctx->em, SMALL);
+        bench_escape(p);
+        em_reset_zero(ctx->em);
+    }
+}
+
+static void memset_op(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t i = 0; i < ops; i++) {
+        memset(ctx->ptrs[0], 0, ctx->size);
+        bench_escape(ctx->ptrs[0]);
+    }
+}
+
+
+
+static void run_core(void) {
+    Ctx ctx = { em_create(ARENA_SIZE), ptr_storage, 0, SMALL, EM_DEFAULT_ALIGNMENT, 1 };
+    if (!ctx.em) { fprintf(stderr, "arena creation failed\n"); exit(1); }
+
+    bench_run("alloc_free/tail_lifo", "em",     em_tail_lifo,  &ctx, 1 << 20);
+    bench_run("alloc_free/tail_lifo", "malloc", malloc_lifo,   &ctx, 1 << 20);
+    bench_run("alloc_free/burst_lifo", "em",     em_tail_burst, &ctx, 1 << 20);
+    bench_run("alloc_free/burst_lifo", "malloc", malloc_burst,  &ctx, 1 << 20);
+    bench_run("alloc_free/burst_fifo", "em",     em_fifo,       &ctx, 1 << 20);
+    bench_run("alloc_free/burst_fifo", "malloc", malloc_fifo,   &ctx, 1 << 20);
+
+    if (bench_selected("alloc_free/tree")) {
+        em_reset(ctx.em);
+        tree_prepare(&ctx, true);
+        bench_run("alloc_free/tree", "em", em_tree, &ctx, 1 << 18);
+        em_reset(ctx.em);
+
+        tree_prepare(&ctx, false);
+        bench_run("alloc_free/tree", "malloc", malloc_tree, &ctx, 1 << 18);
+        for (size_t i = 0; i < TREE_POOL * 2; i++) free(ctx.ptrs[i]);
+    }
+
+    static const size_t alignments[] = { 16, 64, 256, 1024 };
+    for (size_t a = 0; a < sizeof(alignments) / sizeof(alignments[0]); a++) {
+        char name[64];
+        snprintf(name, sizeof(name), "alloc_aligned/%zu", alignments[a]);
+        ctx.alignment = alignments[a];
+        ctx.size = 100;
+        bench_run(name, "em",     em_aligned,     &ctx, 1 << 18);
+        bench_run(name, "malloc", malloc_aligned, &ctx, 1 << 18);
+    }
+
+    ctx.size = 4096;
+    bench_run("nested/create_destroy", "em",     em_nested,     &ctx, 1 << 18);
+    bench_run("nested/create_destroy", "malloc", malloc_nested, &ctx, 1 << 18);
+
+    ctx.size = 4096;
+    bench_run("scratch/alloc_free", "em",     em_scratch,  &ctx, 1 << 20);
+    bench_run("scratch/alloc_free", "malloc", malloc_lifo, &ctx, 1 << 20);
+
+    const size_t calloc_sizes[] = { 64, 4096 };
+    for (size_t i = 0; i < 2; i++) {
+        char name[64];
+        snprintf(name, sizeof(name), "calloc/%zu", calloc_sizes[i]);
+        ctx.size = calloc_sizes[i];
+        bench_run(name, "em",     em_calloc_pair,     &ctx, 1 << 18);
+        bench_run(name, "malloc", malloc_calloc_pair, &ctx, 1 << 18);
+    }
+
+    em_destroy(ctx.em);
+}
+
+static void run_sub_allocators(void) {
+    Ctx ctx = { em_create(ARENA_SIZE), ptr_storage, 0, 32, EM_DEFAULT_ALIGNMENT, 1 };
+    if (!ctx.em) { fprintf(stderr, "arena creation failed\n"); exit(1); }
+
+    Bump *bump = em_bump_create(ctx.em, BURST * 64 + 64);
+    ctx.ptrs[0] = bump;
+    bench_run("bump/alloc_reset", "em",     em_bump,      &ctx, 1 << 20);
+    ctx.ptrs[0] = NULL;
+    bench_run("bump/alloc_reset", "malloc", malloc_burst, &ctx, 1 << 20);
+    em_bump_destroy(bump);
+
+    Slab *slab = em_slab_create(ctx.em, BURST * 32, 32);
+    ctx.ptrs[TREE_POOL * 2 - 1] = slab;
+    bench_run("slab/alloc_free", "em",     em_slab_burst, &ctx, 1 << 20);
+    bench_run("slab/alloc_free", "malloc", malloc_fifo,   &ctx, 1 << 20);
+    em_slab_destroy(slab);
+
+    Stack *stack = em_stack_create(ctx.em, BURST * 48 + 4096);
+    ctx.ptrs[TREE_POOL * 2 - 1] = stack;
+    bench_run("stack/push_pop", "em",     em_stack_burst, &ctx, 1 << 20);
+    bench_run("stack/push_pop", "malloc", malloc_burst,   &ctx, 1 << 20);
+    em_stack_destroy(stack);
+    ctx.ptrs[TREE_POOL * 2 - 1] = NULL;
+
+    em_destroy(ctx.em);
+}
+
+static void run_reset_zero(void) {
+    const size_t sizes[] = { (size_t)64 << 10, (size_t)1 << 20, (size_t)16 << 20 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        char name[64];
+        snprintf(name, sizeof(name), "reset_zero/%zuKiB", sizes[i] >> 10);
+        if (!bench_selected(name)) continue;
+
+        Ctx ctx = { em_create(sizes[i]), ptr_storage, 0, sizes[i], EM_DEFAULT_ALIGNMENT, 1 };
+        ctx.ptrs[0] = malloc(sizes[i]);
+        if (!ctx.em || !ctx.ptrs[0]) { fprintf(stderr, "reset_zero setup failed\n"); exit(1); }
+
+        size_t ops = ((size_t)64 << 20) / sizes[i];
+        bench_run(name, "em",     em_reset_zero_op, &ctx, ops);
+        bench_run(name, "memset", memset_op,        &ctx, ops);
+
+        free(ctx.ptrs[0]);
+        ctx.ptrs[0] = NULL;
+        em_destroy(ctx.em);
+    }
+}
+
+int main(int argc, char **argv) {
+    bench_init("micro", argc, argv);
+
+    run_core();
+    run_sub_allocators();
+    run_reset_zero();
+
+    return 0;
+}
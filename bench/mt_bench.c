@@ -0,0 +1,384 @@
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "bench_utils.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+/*
+ * Thread scaling of the one-arena-per-thread model.
+ *
+ * Every thread owns a private EM (or a Bump / Slab inside it) and runs the same
+ * workload as a glibc malloc thread in the same process:
+ *
+ *  - larson:     a fixed set of live slots, each op frees a random slot and refills it
+ *                with a random size (steady-state churn). Cross-thread frees of the
+ *                original larson are omitted: an arena is owned by exactly one thread.
+ *  - threadtest: batches of equal-sized objects allocated and released in bulk.
+ *
+ * Arenas live in one shared region in two layouts:
+ *
+ *  - packed:  arenas carved back-to-back, so the hot EM header of arena i shares a
+ *             cache line with the last bytes of arena i-1.
+ *  - padded:  every arena starts on a fresh cache line with a two-line guard gap,
+ *             which also defeats the adjacent-line prefetcher.
+ *
+ * Comparing the two at the same thread count isolates the cost of false sharing
+ * between neighbouring arenas; comparing against malloc shows contention costs.
+ * Every arena is sized with the layout planner so threadtest fills it to the last line.
+ * RSS is sampled at the end of each run, while all arenas and malloc blocks are live.
+*/
+
+#define LARSON_SLOTS      1024
+#define LARSON_MIN_SIZE   16
+#define LARSON_MAX_SIZE   256
+#define BATCH             1024
+#define BATCH_SIZE        64
+#define CACHE_LINE        64
+#define GUARD             (2 * CACHE_LINE)
+
+#define LARSON_ARENA      EM_PLAN_STATIC_SIZE(EM_DEFAULT_ALIGNMENT, \
+                            EM_PLAN_ALLOCS(LARSON_MAX_SIZE, EM_DEFAULT_ALIGNMENT, LARSON_SLOTS + LARSON_SLOTS / 4, EM_DEFAULT_ALIGNMENT))
+#define THREADTEST_ARENA  EM_PLAN_STATIC_SIZE(EM_DEFAULT_ALIGNMENT, \
+                            EM_PLAN_ALLOCS(BATCH_SIZE, EM_DEFAULT_ALIGNMENT, BATCH, EM_DEFAULT_ALIGNMENT))
+#define BUMP_SIZE         EM_PLAN_BUMP_SIZE(BATCH_SIZE, EM_DEFAULT_ALIGNMENT, BATCH, EM_DEFAULT_ALIGNMENT)
+#define BUMP_ARENA        EM_PLAN_STATIC_SIZE(EM_DEFAULT_ALIGNMENT, \
+                            EM_PLAN_ALLOC(BUMP_SIZE, EM_DEFAULT_ALIGNMENT, EM_DEFAULT_ALIGNMENT))
+#define SLAB_SIZE         EM_PLAN_SLAB_SIZE(BATCH_SIZE, BATCH)
+#define SLAB_ARENA        EM_PLAN_STATIC_SIZE(EM_DEFAULT_ALIGNMENT, \
+                            EM_PLAN_ALLOC(SLAB_SIZE, EM_DEFAULT_ALIGNMENT, EM_DEFAULT_ALIGNMENT))
+
+typedef enum { WORKLOAD_LARSON, WORKLOAD_THREADTEST } Workload;
+typedef enum { IMPL_EM, IMPL_BUMP, IMPL_SLAB, IMPL_MALLOC } Impl;
+typedef enum { LAYOUT_PACKED, LAYOUT_PADDED, LAYOUT_NONE } Layout;
+
+static const char *const workload_names[] = { "larson", "threadtest" };
+static const char *const impl_names[]     = { "em", "bump", "slab", "malloc" };
+static const char *const layout_names[]   = { "packed", "padded", "none" };
+
+typedef struct {
+    pthread_barrier_t *barrier;
+    size_t ops;
+    size_t cpus;
+    Workload workload;
+    Impl impl;
+} Run;
+
+/*
+ * One per thread, each in its own cache-line pair so the harness adds no sharing.
+*/
+typedef struct {
+    const Run *run;
+    EM *em;
+    void *sub;
+    void **slots;
+    uint64_t seed;
+    size_t index;
+    size_t failures;
+    double elapsed_ns;
+} Worker;
+
+typedef struct {
+    double ns_min;
+    double ns_p50;
+    double ns_p99;
+    double ns_max;
+    double total_mops;
+    double per_thread_mops;
+    size_t failures;
+    size_t rss_bytes;
+    size_t runs;                // Repetitions the counters were summed over
+    BenchCounters counters;
+} MtResult;
+
+
+
+static size_t random_size(uint64_t *seed) {
+    return LARSON_MIN_SIZE + (size_t)(bench_rand(seed) % (LARSON_MAX_SIZE - LARSON_MIN_SIZE + 1));
+}
+
+static void larson_em(Worker *w) {
+    for (size_t i = 0; i < LARSON_SLOTS; i++) w->slots[i] = em_alloc(w->em, random_size(&w->seed));
+    for (size_t i = 0; i < w->run->ops; i++) {
+        size_t slot = (size_t)(bench_rand(&w->seed) % LARSON_SLOTS);
+        if (w->slots[slot]) em_free(w->slots[slot]);
+        w->slots[slot] = em_alloc(w->em, random_size(&w->seed));
+        if (!w->slots[slot]) w->failures++;
+    }
+    for (size_t i = 0; i < LARSON_SLOTS; i++) if (w->slots[i]) em_free(w->slots[i]);
+}
+
+static void larson_malloc(Worker *w) {
+    for (size_t i = 0; i < LARSON_SLOTS; i++) w->slots[i] = malloc(random_size(&w->seed));
+    for (size_t i = 0; i < w->run->ops; i++) {
+        size_t slot = (size_t)(bench_rand(&w->seed) % LARSON_SLOTS);
+        free(w->slots[slot]);
+        w->slots[slot] = malloc(random_size(&w->seed));
+        if (!w->slots[slot]) w->failures++;
+    }
+    for (size_t i = 0; i < LARSON_SLOTS; i++) free(w->slots[i]);
+}
+
+static void threadtest_em(Worker *w) {
+    for (size_t done = 0; done < w->run->ops; done += BATCH) {
+        for (size_t i = 0; i < BATCH; i++) {
+            w->slots[i] = em_alloc(w->em, BATCH_SIZE);
+            if (w->slots[i]) memset(w->slots[i], (int)i, BATCH_SIZE); else w->failures++;
+        }
+        for (size_t i = 0; i < BATCH; i++) if (w->slots[i]) em_free(w->slots[i]);
+    }
+}
+
+static void threadtest_bump(Worker *w) {
+    Bump *bump = (Bump *)w->sub;
+    for (size_t done = 0; done < w->run->ops; done += BATCH) {
+        for (size_t i = 0; i < BATCH; i++) {
+            void *ptr = em_bump_alloc(bump, BATCH_SIZE);
+            if (ptr) memset(ptr, (int)i, BATCH_SIZE); else w->failures++;
+        }
+        em_bump_reset(bump);
+    }
+}
+
+static void threadtest_slab(Worker *w) {
+    Slab *slab = (Slab *)w->sub;
+    for (size_t done = 0; done < w->run->ops; done += BATCH) {
+        for (size_t i = 0; i < BATCH; i++) {
+            w->slots[i] = em_slab_alloc(slab);
+            if (w->slots[i]) memset(w->slots[i], (int)i, BATCH_SIZE); else w->failures++;
+        }
+        for (size_t i = 0; i < BATCH; i++) if (w->slots[i]) em_slab_free(slab, w->slots[i]);
+    }
+}
+
+static void threadtest_malloc(Worker *w) {
+    for (size_t done = 0; done < w->run->ops; done += BATCH) {
+        for (size_t i = 0; i < BATCH; i++) {
+            w->slots[i] = malloc(BATCH_SIZE);
+            if (w->slots[i]) memset(w->slots[i], (int)i, BATCH_SIZE); else w->failures++;
+        }
+        for (size_t i = 0; i < BATCH; i++) free(w->slots[i]);
+    }
+}
+
+static void pin_to_cpu(size_t index, size_t cpus) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(index % cpus, &set);
+    (void)pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)index;
+    (void)cpus;
+#endif
+}
+
+static void *worker_main(void *arg) {
+    Worker *w = (Worker *)arg;
+    pin_to_cpu(w->index, w->run->cpus);
+    pthread_barrier_wait(w->run->barrier);
+
+    double start = bench_now_ns();
+    if (w->run->workload == WORKLOAD_LARSON) {
+        if (w->run->impl == IMPL_MALLOC) larson_malloc(w); else larson_em(w);
+    } else {
+        switch (w->run->impl) {
+            case IMPL_EM:     threadtest_em(w);     break;
+            case IMPL_BUMP:   threadtest_bump(w);   break;
+            case IMPL_SLAB:   threadtest_slab(w);   break;
+            case IMPL_MALLOC: threadtest_malloc(w); break;
+        }
+    }
+    w->elapsed_ns = bench_now_ns() - start;
+    return NULL;
+}
+
+
+
+static size_t arena_size_for(Workload workload, Impl impl) {
+    if (workload == WORKLOAD_LARSON) return LARSON_ARENA;
+    if (impl == IMPL_BUMP) return BUMP_ARENA;
+    if (impl == IMPL_SLAB) return SLAB_ARENA;
+    return THREADTEST_ARENA;
+}
+
+/*
+ * Carves one static arena per thread out of 'region' and builds the sub-allocator
+ * the workload needs. Returns false if any arena could not be set up.
+*/
+static bool setup_arenas(Worker **workers, size_t threads, uint8_t *region, size_t stride, size_t arena_size, Impl impl) {
+    for (size_t t = 0; t < threads; t++) {
+        Worker *w = workers[t];
+        w->em = em_create_static(region + t * stride, arena_size);
+        if (!w->em) return false;
+        if (impl == IMPL_BUMP) w->sub = em_bump_create(w->em, BUMP_SIZE);
+        if (impl == IMPL_SLAB) w->sub = em_slab_create(w->em, SLAB_SIZE, BATCH_SIZE);
+        if ((impl == IMPL_BUMP || impl == IMPL_SLAB) && !w->sub) return false;
+    }
+    return true;
+}
+
+static bool run_once(const Run *run, Layout layout, size_t threads, Worker **workers, double *thread_ns, double *total_mops, size_t *failures, size_t *rss, BenchCounters *counters) {
+    size_t arena_size = arena_size_for(run->workload, run->impl);
+    size_t stride = (layout == LAYOUT_PADDED) ? align_up(arena_size, CACHE_LINE) + GUARD : arena_size;
+    uint8_t *region = NULL;
+
+    if (layout != LAYOUT_NONE) {
+        void *memory = NULL;
+        if (posix_memalign(&memory, 4096, stride * threads) != 0) return false;
+        region = (uint8_t *)memory;
+        if (!setup_arenas(workers, threads, region, stride, arena_size, run->impl)) { free(region); return false; }
+    }
+
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, (unsigned)threads);
+    Run local = *run;
+    local.barrier = &barrier;
+
+    for (size_t t = 0; t < threads; t++) {
+        workers[t]->run = &local;
+        workers[t]->index = t;
+        workers[t]->failures = 0;
+        workers[t]->seed = 0x9E3779B97F4A7C15ULL ^ (uint64_t)(t + 1);
+    }
+
+    pthread_t handles[256];
+    bench_counters_begin();
+    for (size_t t = 1; t < threads; t++) pthread_create(&handles[t], NULL, worker_main, workers[t]);
+    worker_main(workers[0]);
+    for (size_t t = 1; t < threads; t++) pthread_join(handles[t], NULL);
+    bench_counters_end(counters);
+    size_t rss_after = bench_rss_bytes();
+
+    double wall = 0.0;
+    for (size_t t = 0; t < threads; t++) {
+        thread_ns[t] = workers[t]->elapsed_ns / (double)run->ops;
+        if (workers[t]->elapsed_ns > wall) wall = workers[t]->elapsed_ns;
+        *failures += workers[t]->failures;
+    }
+    *total_mops = (double)(run->ops * threads) * 1e3 / wall;
+    if (rss_after > *rss) *rss = rss_after;
+
+    pthread_barrier_destroy(&barrier);
+    free(region);
+    for (size_t t = 0; t < threads; t++) { workers[t]->em = NULL; workers[t]->sub = NULL; }
+    return true;
+}
+
+static bool measure(const Run *run, Layout layout, size_t threads, Worker **workers, MtResult *result) {
+    size_t reps = bench_config.samples < 9 ? bench_config.samples : 9;
+    double *thread_ns = (double *)malloc(reps * threads * sizeof(double));
+    double *totals = (double *)malloc(reps * sizeof(double));
+    if (!thread_ns || !totals) { free(thread_ns); free(totals); return false; }
+
+    memset(result, 0, sizeof(*result));
+    bool ok = true;
+    for (size_t r = 0; r < reps && ok; r++) {
+        ok = run_once(run, layout, threads, workers, thread_ns + r * threads, &totals[r], &result->failures, &result->rss_bytes, &result->counters);
+    }
+
+    if (ok) {
+        size_t count = reps * threads;
+        result->runs = reps;
+        qsort(thread_ns, count, sizeof(double), bench_compare_doubles);
+        qsort(totals, reps, sizeof(double), bench_compare_doubles);
+        result->ns_min = thread_ns[0];
+        result->ns_p50 = bench_percentile(thread_ns, count, 50.0);
+        result->ns_p99 = bench_percentile(thread_ns, count, 99.0);
+        result->ns_max = thread_ns[count - 1];
+        result->total_mops = bench_percentile(totals, reps, 50.0);
+        result->per_thread_mops = result->total_mops / (double)threads;
+    }
+
+    free(thread_ns);
+    free(totals);
+    return ok;
+}
+
+static void mt_report(const char *name, const char *impl, const char *layout, size_t threads, size_t ops, const MtResult *r, double scaling) {
+    static bool header_printed = false;
+    if (bench_config.csv) {
+        if (!header_printed) {
+            printf("suite,bench,impl,layout,threads,ops_per_thread,min_ns,p50_ns,p99_ns,max_ns,"
+                   "total_mops,per_thread_mops,scaling,failed_allocs,rss_kib%s\n",
+                   bench_config.counters ? BENCH_COUNTER_CSV_HEADER : "");
+            header_printed = true;
+        }
+        printf("%s,%s,%s,%s,%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%zu,%zu",
+               bench_config.suite, name, impl, layout, threads, ops,
+               r->ns_min, r->ns_p50, r->ns_p99, r->ns_max,
+               r->total_mops, r->per_thread_mops, scaling, r->failures, r->rss_bytes >> 10);
+        bench_counters_print(&r->counters, (double)r->runs * (double)threads * (double)ops);
+        printf("\n");
+    } else {
+        printf("{\"suite\":\"%s\",\"bench\":\"%s\",\"impl\":\"%s\",\"layout\":\"%s\",\"threads\":%zu,\"ops_per_thread\":%zu,"
+               "\"ns_per_op\":{\"min\":%.3f,\"p50\":%.3f,\"p99\":%.3f,\"max\":%.3f},"
+               "\"total_mops\":%.3f,\"per_thread_mops\":%.3f,\"scaling\":%.3f,\"failed_allocs\":%zu,\"rss_kib\":%zu",
+               bench_config.suite, name, impl, layout, threads, ops,
+               r->ns_min, r->ns_p50, r->ns_p99, r->ns_max,
+               r->total_mops, r->per_thread_mops, scaling, r->failures, r->rss_bytes >> 10);
+        bench_counters_print(&r->counters, (double)r->runs * (double)threads * (double)ops);
+        printf("}\n");
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+    bench_init("mt", argc, argv);
+
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t cpus = online > 0 ? (size_t)online : 1;
+    size_t max_threads = bench_config.threads ? bench_config.threads : cpus;
+    if (max_threads > 256) max_threads = 256;
+
+    Worker *workers[256];
+    for (size_t t = 0; t < max_threads; t++) {
+        void *memory = NULL;
+        if (posix_memalign(&memory, 2 * CACHE_LINE, sizeof(Worker)) != 0) return 1;
+        workers[t] = (Worker *)memory;
+        memset(workers[t], 0, sizeof(Worker));
+        workers[t]->slots = (void **)calloc(LARSON_SLOTS > BATCH ? LARSON_SLOTS : BATCH, sizeof(void *));
+        if (!workers[t]->slots) return 1;
+    }
+
+    static const struct { Workload workload; Impl impl; size_t ops; } cases[] = {
+        { WORKLOAD_LARSON,     IMPL_EM,     1 << 20 },
+        { WORKLOAD_LARSON,     IMPL_MALLOC, 1 << 20 },
+        { WORKLOAD_THREADTEST, IMPL_EM,     1 << 21 },
+        { WORKLOAD_THREADTEST, IMPL_BUMP,   1 << 21 },
+        { WORKLOAD_THREADTEST, IMPL_SLAB,   1 << 21 },
+        { WORKLOAD_THREADTEST, IMPL_MALLOC, 1 << 21 },
+    };
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        const char *name = workload_names[cases[c].workload];
+        if (!bench_selected(name)) continue;
+
+        Run run = { NULL, align_up(bench_ops(cases[c].ops), BATCH), cpus, cases[c].workload, cases[c].impl };
+        Layout first = (run.impl == IMPL_MALLOC) ? LAYOUT_NONE : LAYOUT_PACKED;
+        Layout last  = (run.impl == IMPL_MALLOC) ? LAYOUT_NONE : LAYOUT_PADDED;
+
+        for (int layout = (int)first; layout <= (int)last; layout++) {
+            double single_thread_mops = 0.0;
+            // Thread counts: powers of two up to the limit, plus the limit itself
+            for (size_t threads = 1; threads <= max_threads; threads = (threads * 2 > max_threads && threads < max_threads) ? max_threads : threads * 2) {
+                MtResult result;
+                if (!measure(&run, (Layout)layout, threads, workers, &result)) {
+                    fprintf(stderr, "%s/%s: setup failed at %zu threads\n", name, impl_names[run.impl], threads);
+                    break;
+                }
+                if (threads == 1) single_thread_mops = result.per_thread_mops;
+                double scaling = single_thread_mops > 0.0 ? result.per_thread_mops / single_thread_mops : 0.0;
+                mt_report(name, impl_names[run.impl], layout_names[layout], threads, run.ops, &result, scaling);
+                if (threads == max_threads) break;
+            }
+        }
+    }
+
+    for (size_t t = 0; t < max_threads; t++) {
+        free(workers[t]->slots);
+        free(workers[t]);
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+#define EM_BULK_ZERO
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "bench_utils.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+/*
+ * Large reset_zero pauses under EM_BULK_ZERO.
+ *
+ *  - reset_zero/<size>:      em_reset_zero of a dirtied arena, against a plain memset of the
+ *                            same range ("memset"), with streaming stores ("em") and with the
+ *                            range split across threads through em_bulk_zero_set_workers ("em_mt").
+ *  - reset_zero_hot/<size>:  the same reset followed by one pass over a 256 KiB working set,
+ *                            showing what the zeroing evicted from the caches.
+ *
+ * The worker hook starts its threads on every call; a real pool would keep them parked,
+ * so "em_mt" slightly overstates the cost of going parallel.
+*/
+
+#define HOT_SIZE        ((size_t)256 << 10)
+#define MAX_WORKERS     16
+
+typedef struct {
+    EM *em;
+    uint8_t *plain;
+    uint8_t *hot;
+    size_t size;
+} Ctx;
+
+typedef struct {
+    void *data;
+    size_t size;
+} Part;
+
+static size_t worker_count = 1;
+
+static void *zero_part(void *arg) {
+    Part *part = (Part *)arg;
+    em_bulk_zero(part->data, part->size);
+    return NULL;
+}
+
+static void spawn_workers(void *data, size_t size, void *context) {
+    (void)context;
+    pthread_t handles[MAX_WORKERS];
+    Part parts[MAX_WORKERS];
+    size_t slice = (size / worker_count) & ~(size_t)63;
+
+    for (size_t i = 0; i < worker_count; i++) {
+        parts[i].data = (char *)data + i * slice;
+        parts[i].size = (i == worker_count - 1) ? size - i * slice : slice;
+    }
+    for (size_t i = 1; i < worker_count; i++) pthread_create(&handles[i], NULL, zero_part, &parts[i]);
+    zero_part(&parts[0]);
+    for (size_t i = 1; i < worker_count; i++) pthread_join(handles[i], NULL);
+}
+
+static uint64_t touch_hot(const uint8_t *hot) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < HOT_SIZE; i += 64) sum += hot[i];
+    return sum;
+}
+
+static void em_reset_zero_op(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t i = 0; i < ops; i++) {
+        void *p = em_alloc(ctx->em, 64);
+        bench_escape(p);
+        em_reset_zero(ctx->em);
+    }
+}
+
+static void memset_op(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t i = 0; i < ops; i++) {
+        memset(ctx->plain, 0, ctx->size);
+        bench_escape(ctx->plain);
+    }
+}
+
+static void em_reset_zero_hot_op(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t i = 0; i < ops; i++) {
+        touch_hot(ctx->hot);
+        em_reset_zero(ctx->em);
+        uint64_t sum = touch_hot(ctx->hot);
+        bench_escape(&sum);
+    }
+}
+
+static void memset_hot_op(void *c, size_t ops) {
+    Ctx *ctx = (Ctx *)c;
+    for (size_t i = 0; i < ops; i++) {
+        touch_hot(ctx->hot);
+        memset(ctx->plain, 0, ctx->size);
+        uint64_t sum = touch_hot(ctx->hot);
+        bench_escape(&sum);
+    }
+}
+
+int main(int argc, char **argv) {
+    bench_init("zero", argc, argv);
+
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t cpus = online > 0 ? (size_t)online : 1;
+    worker_count = bench_config.threads ? bench_config.threads : cpus;
+    if (worker_count > MAX_WORKERS) worker_count = MAX_WORKERS;
+
+    const size_t sizes[] = { (size_t)4 << 20, (size_t)64 << 20, (size_t)256 << 20 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        char name[64], hot_name[64];
+        snprintf(name, sizeof(name), "reset_zero/%zuMiB", sizes[i] >> 20);
+        snprintf(hot_name, sizeof(hot_name), "reset_zero_hot/%zuMiB", sizes[i] >> 20);
+        if (!bench_selected(name) && !bench_selected(hot_name)) continue;
+
+        Ctx ctx = { em_create(sizes[i]), (uint8_t *)malloc(sizes[i]), (uint8_t *)malloc(HOT_SIZE), sizes[i] };
+        if (!ctx.em || !ctx.plain || !ctx.hot) { fprintf(stderr, "zero setup failed\n"); exit(1); }
+        memset(ctx.hot, 1, HOT_SIZE);
+
+        size_t ops = ((size_t)512 << 20) / sizes[i];
+        if (bench_selected(name)) {
+            bench_run(name, "memset", memset_op, &ctx, ops);
+            bench_run(name, "em", em_reset_zero_op, &ctx, ops);
+            em_bulk_zero_set_workers(spawn_workers, (size_t)4 << 20, NULL);
+            bench_run(name, "em_mt", em_reset_zero_op, &ctx, ops);
+            em_bulk_zero_set_workers(NULL, 0, NULL);
+        }
+        if (bench_selected(hot_name)) {
+            bench_run(hot_name, "memset", memset_hot_op, &ctx, ops);
+            bench_run(hot_name, "em", em_reset_zero_hot_op, &ctx, ops);
+        }
+
+        free(ctx.plain);
+        free(ctx.hot);
+        em_destroy(ctx.em);
+    }
+
+    return 0;
+}
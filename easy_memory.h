@@ -63,6 +63,49 @@
  *    #define EM_POISONING         // Force ENABLE poisoning (even in Release)
  *    #define EM_NO_POISONING      // Force DISABLE poisoning (even in Debug)
  *    #define EM_POISON_BYTE 0xDD  // Custom byte pattern for freed memory
+ *    #define EM_ASAN              // Poison free memory in the AddressSanitizer shadow instead (needs -fsanitize=address)
+ *    #define EM_ASAN_REDZONE <value>  // Poisoned bytes behind every em_alloc under EM_ASAN (default 2 words)
+ *
+ *  STATISTICS:
+ *    #define EM_STATS             // Maintain O(1) per-arena counters, exposed through em_get_stats
+ *
+ *  PROFILING:
+ *    #define EM_PROFILE           // Count which internal paths allocations and frees take (see em_get_profile)
+ *
+ *  HEAP WALK:
+ *    #define EM_WALK              // Physical heap iterator and binary heap dump (em_walk, em_dump)
+ *
+ *  HEAP VERIFICATION:
+ *    #define EM_VERIFY            // Full and incremental heap integrity checks (em_verify, em_verify_step)
+ *
+ *  ZEROING:
+ *    #define EM_DIRTY_TRACKING    // Track never-written memory so calloc and the reset_zero paths skip it (em_mark_zeroed)
+ *    #define EM_BULK_ZERO         // Non-temporal streaming stores and a worker hook for large reset_zero ranges (em_bulk_zero)
+ *    #define EM_BULK_ZERO_THRESHOLD <value>  // Smallest range zeroed with streaming stores, smaller ones use memset (default 8 MiB)
+ *
+ *  FREE INDEX:
+ *    #define EM_FREE_INDEX        // Side B+-tree over the free blocks, searched with SIMD compares (em_free_index_attach)
+ *    #define EM_FREE_TREE_AUGMENT // Subtree bounds in the free tree: O(1) rejection of requests no free block can hold
+ *    #define EM_FREE_TLSF         // Two-level segregated-fit free lists in place of the free tree: O(1) alloc and free
+ *    #define EM_TLSF_SL_LOG2 <value>  // log2 of the free lists per power of two, 1..3 (default 2)
+ *    #define EM_TLSF_FL_MAX <value>   // log2 of the largest size class, caps the arena size (default 32 on 64-bit)
+ *
+ *  HANDLES:
+ *    #define EM_HANDLES           // Relocatable handle allocations and incremental compaction (em_halloc, em_compact)
+ *
+ *  LIFETIME:
+ *    #define EM_LIFETIME          // Short-lived allocations grow down from the top of the arena (em_alloc_ex)
+ *
+ *  SAMPLING:
+ *    #define EM_SAMPLE            // Sample live allocations with backtraces, export folded stacks / pprof (em_sample_start)
+ *    #define EM_SAMPLE_TLS <kw>   // Storage class for the sampler state, e.g. _Thread_local (per-thread samplers)
+ *    #define EM_SAMPLE_MAX_FRAMES <value>  // Frames kept per sample (default 16)
+ *
+ *  TRACING:
+ *    #define EM_TRACE             // Record every public operation into a binary trace (see em_trace_set_writer)
+ *    #define EM_TRACE_TLS <kw>    // Storage class for the recorder state, e.g. _Thread_local (per-thread traces)
+ *    #define EM_USDT              // USDT probes "easy_memory:<op>" at every public operation (bpftrace, perf, SystemTap)
+ *    #define EM_USDT_NO_SDT_H     // Use the built-in probe definition even when <sys/sdt.h> is available
  *
  *  SYSTEM & LINKAGE:
  *    #define EM_NO_MALLOC         // Disable stdlib dependencies (Bare Metal mode)
@@ -74,6 +117,8 @@
  *    #define EM_MAGIC             <value>  // Custom magic number for block validation
  *    #define EM_DEFAULT_ALIGNMENT <value>  // Global alignment baseline
  *    #define EM_MIN_BUFFER_SIZE   <value>  // Minimum split block size
+ *    #define EM_PLACEMENT_POLICY  <N>      // 0: BEST_FIT (reuse holes first) [Default], 1: TAIL_FIRST (carve the tail first)
+ *    #define EM_NEAR_SEARCH_BLOCKS <N>     // Neighbours em_alloc_near checks on each side of its hint (default 16)
  * ============================================================================
 */
 
@@ -189,11 +234,11 @@ EM_STATIC_ASSERT(EM_INTERNAL_CHAR_BIT == 8, "EasyMem requires 8-bit byte archite
 #       elif defined(_MSC_VER)
 #           define EM_ASSERT(cond) __assume(cond)
 #       else
-#           define EM_ASSERT(cond) ((void)0)
+#           define EM_ASSERT(cond) ((void)sizeof(cond))
 #       endif
 #   else
-        // Default Release: Safe No-op
-#       define EM_ASSERT(cond) ((void)0)
+        // Default Release: Safe No-op (sizeof keeps the operands "used" without evaluating them)
+#       define EM_ASSERT(cond) ((void)sizeof(cond))
 #   endif
 #endif
 
@@ -365,6 +410,45 @@ EM_STATIC_ASSERT(EM_INTERNAL_CHAR_BIT == 8, "EasyMem requires 8-bit byte archite
 #endif
 EM_STATIC_ASSERT((EM_POISON_BYTE >= 0x00) && (EM_POISON_BYTE <= 0xFF), "EM_POISON_BYTE must be a valid byte value (0x00 to 0xFF).");
 
+/*
+ * Configuration: AddressSanitizer Poisoning
+ * With EM_ASAN defined and the translation unit built with -fsanitize=address, memory the
+ * allocator does not currently hand out is marked in the ASan shadow instead of being filled
+ * with EM_POISON_BYTE: free blocks and the free tail, the alignment gap and rounding slack of
+ * every allocation, a redzone of EM_ASAN_REDZONE bytes behind it, Bump space past the offset,
+ * free Slab chunks (except their free-list link) and popped Stack frames. Any access to them
+ * is reported at the faulting instruction, and nothing is written on free.
+ * Block headers stay addressable, the library walks them on every operation.
+ * Without ASan in the build EM_ASAN has no effect; with it, it replaces EM_POISONING.
+*/
+#if defined(EM_ASAN)
+#   if defined(__SANITIZE_ADDRESS__)
+#       define EM_HAS_ASAN
+#   elif defined(__has_feature)
+#       if __has_feature(address_sanitizer)
+#           define EM_HAS_ASAN
+#       endif
+#   endif
+#endif
+
+#ifdef EM_HAS_ASAN
+void __asan_poison_memory_region(void const volatile *addr, size_t size);
+void __asan_unpoison_memory_region(void const volatile *addr, size_t size);
+void *__asan_region_is_poisoned(void *beg, size_t size);
+
+#   undef EM_POISONING
+#   ifndef EM_ASAN_REDZONE
+#       define EM_ASAN_REDZONE (2 * sizeof(uintptr_t))
+#   endif
+#   define EM_ASAN_POISON(address, size)   __asan_poison_memory_region((const void *)(address), (size_t)(size))
+#   define EM_ASAN_UNPOISON(address, size) __asan_unpoison_memory_region((const void *)(address), (size_t)(size))
+#else
+#   undef EM_ASAN_REDZONE
+#   define EM_ASAN_REDZONE 0
+#   define EM_ASAN_POISON(address, size)   ((void)0)
+#   define EM_ASAN_UNPOISON(address, size) ((void)0)
+#endif
+
 /*
  * Configuration: Minimum Buffer Size
  * Defines the minimum size of the usable memory buffer within a block.
@@ -378,6 +462,58 @@ EM_STATIC_ASSERT((EM_POISON_BYTE >= 0x00) && (EM_POISON_BYTE <= 0xFF), "EM_POISO
 #endif
 EM_STATIC_ASSERT(EM_MIN_BUFFER_SIZE > 0, "MIN_BUFFER_SIZE must be a positive value to prevent creation of useless zero-sized free blocks.");
 
+/*
+ * Configuration: Placement Policy
+ * Decides where a general allocation is placed when both a free hole and the tail could serve it.
+ *
+ * EM_PLACEMENT_BEST_FIT (0) [DEFAULT]:
+ *   - Searches the free tree for the tightest hole first and touches the tail only on a miss.
+ *   - Keeps the footprint (high-water mark of the tail) as low as the workload allows.
+ *
+ * EM_PLACEMENT_TAIL_FIRST (1):
+ *   - Carves from the tail while it lasts and reuses holes only once it is exhausted.
+ *   - Skips the tree search on the hot path at the cost of a larger footprint; holes
+ *     still coalesce, so long-running arenas settle back into best-fit behaviour.
+*/
+#define EM_PLACEMENT_BEST_FIT   0
+#define EM_PLACEMENT_TAIL_FIRST 1
+
+#ifndef EM_PLACEMENT_POLICY
+#   define EM_PLACEMENT_POLICY EM_PLACEMENT_BEST_FIT
+#endif
+EM_STATIC_ASSERT((EM_PLACEMENT_POLICY == EM_PLACEMENT_BEST_FIT) || (EM_PLACEMENT_POLICY == EM_PLACEMENT_TAIL_FIRST), "EM_PLACEMENT_POLICY must be EM_PLACEMENT_BEST_FIT or EM_PLACEMENT_TAIL_FIRST.");
+
+/*
+ * Configuration: Locality Search Window
+ * Number of physical neighbours em_alloc_near checks on each side of its hint before it
+ * falls back to the normal placement. Bounds the walk, so a hint never costs more than
+ * 2 * EM_NEAR_SEARCH_BLOCKS header reads.
+ * Default is 16, can be customized by defining EM_NEAR_SEARCH_BLOCKS before including this header.
+*/
+#ifndef EM_NEAR_SEARCH_BLOCKS
+#   define EM_NEAR_SEARCH_BLOCKS 16
+#endif
+EM_STATIC_ASSERT(EM_NEAR_SEARCH_BLOCKS > 0, "EM_NEAR_SEARCH_BLOCKS must be a positive value.");
+
+/*
+ * Configuration: Cost Probes
+ * The hidden, data-dependent part of an operation is the length of its walks. Define
+ * EM_COST_PROBE(site, value) before including this header to receive each walk length,
+ * e.g. to steer a fuzzer towards expensive inputs (fuzzers/cost_fuzzer.c). By default
+ * it expands to nothing and the walkers do not count.
+*/
+#define EM_COST_INSERT_DEPTH 0  // insert_block: depth at which a free block is attached
+#define EM_COST_SEARCH_DEPTH 1  // find_best_fit: free-tree nodes visited
+#define EM_COST_DETACH_DEPTH 2  // detach_block_by_ptr: free-tree nodes visited to locate a block
+#define EM_COST_PARENT_WALK  3  // get_parent_em: physical neighbours walked back
+#define EM_COST_SITE_COUNT   4
+
+#ifdef EM_COST_PROBE
+#   define EM_HAS_COST_PROBE
+#else
+#   define EM_COST_PROBE(site, value) ((void)0)
+#endif
+
 /*
  * Configuration: Magic Number
  * Unique identifier used to validate memory blocks and detect corruption.
@@ -637,6 +773,31 @@ EM_STATIC_ASSERT(EM_DEFAULT_ALIGNMENT <= EMMAX_ALIGNMENT, "EM_DEFAULT_ALIGNMENT
 
 
 
+/*
+ * Constant: Sub-Allocator Tags
+ * Ordinary occupied blocks have zero reserved bits, so Bump and Stack headers mark bits [4..3]
+ * of WORD 0 to be told apart from them by a heap walker. A Slab uses all five reserved bits for
+ * its chunk size and marks the low bit of its parent pointer instead. Only the builds that walk
+ * the heap (EM_WALK, EM_VERIFY, EM_HANDLES) write these tags; elsewhere they are zero, and
+ * get_em has no tag to mask off.
+ * Outside EMSUBALLOC_TAG_MASK, bit 2 marks the blocks of em_halloc (EM_HANDLES), which
+ * em_compact may move, and bit 1 the em_alloc blocks EM_SAMPLE tracks.
+ */
+#define EMSUBALLOC_TAG_MASK ((size_t)0x18)
+#define EMHANDLE_TAG        ((size_t)0x04)
+#define EMSAMPLED_TAG       ((size_t)0x02)
+#if defined(EM_WALK) || defined(EM_VERIFY) || defined(EM_HANDLES)
+#   define EMBUMP_TAG       ((size_t)0x10)
+#   define EMSTACK_TAG      ((size_t)0x18)
+#   define EMSLAB_EM_TAG    ((uintptr_t)1)
+#else
+#   define EMBUMP_TAG       ((size_t)0)
+#   define EMSTACK_TAG      ((size_t)0)
+#   define EMSLAB_EM_TAG    ((uintptr_t)0)
+#endif
+
+
+
 /*
  * Constant: EM Color Definitions
  * Defines the color values for blocks in the red-black tree.
@@ -654,7 +815,7 @@ EM_STATIC_ASSERT(EM_DEFAULT_ALIGNMENT <= EMMAX_ALIGNMENT, "EM_DEFAULT_ALIGNMENT
  * Constant: Minimum EM Size
  * The minimum size required to create a valid EM instance.
 */
-#define EMMIN_SIZE       (sizeof(EM) + EMBLOCK_MIN_SIZE)
+#define EMMIN_SIZE       (EM_HEADER_SIZE + EMBLOCK_MIN_SIZE)
 
 /*
  * Constant: Maximum EM Size
@@ -694,6 +855,15 @@ EM_STATIC_ASSERT(EM_DEFAULT_ALIGNMENT <= EMMAX_ALIGNMENT, "EM_DEFAULT_ALIGNMENT
  *                         metadata (alignment is resolved dynamically via padding/addresses).
  *          *Note: These 5 guaranteed zero bits are reserved for future sub-allocators (e.g. Slab).*
  *
+ *        ► IF IT'S A FREE TREE NODE (EM_FREE_TREE_AUGMENT only):
+ *          Free blocks have no sub-allocator to tag, so the bits hold the best alignment
+ *          quality found in the node's subtree (see EMTREE_QUALITY_MAX). They are cleared
+ *          again when the block leaves the tree.
+ *
+ *        ► IF IT'S A HANDLE BLOCK (EM_HANDLES only):
+ *          Bit 2 holds EMHANDLE_TAG, and the magic word holds (slot << 1) | 1 instead of
+ *          the XOR magic. The odd word makes em_free refuse the block.
+ *
  *        ► IF IT'S AN ARENA HEADER (Nested EM / Root EM masquerading as a Block):
  *          - Bits [4..3]: Still Zero (arena capacity is also rounded).
  *          - Bits [2..0]: Store the Arena's Baseline Alignment Exponent.
@@ -815,6 +985,270 @@ EM_STATIC_ASSERT(offsetof(EM, as.self.tail) == offsetof(Block, as.occupied.em),
     EM_tail_offset_mismatch);
 EM_STATIC_ASSERT((sizeof(EM) == sizeof(Block)), Size_mismatch_between_Bump_and_Block);
 
+/*
+ * EM Header Extension
+ *
+ * Optional per-arena bookkeeping stored right after the EM header, before the first block.
+ * It only exists when a feature needs it (EM_STATS, EM_PROFILE, EM_VERIFY, EM_DIRTY_TRACKING,
+ * EM_FREE_INDEX, EM_FREE_TLSF, EM_FREE_TREE_AUGMENT, EM_HANDLES, EM_LIFETIME), so the default
+ * layout is untouched.
+ *
+ *  [ EM Header (4 words) ] [ EMExtension ... | Detector ] [ Alignment Gap ] [ FIRST BLOCK ]
+ *
+ * With an extension present the first block is never adjacent to the EM header, so the
+ * Magic LSB Padding Detector is always written. The last word of the extension is reserved
+ * for it: when the first block directly follows the extension, the detector lands there
+ * instead of on top of a counter.
+ *
+ * EM_HEADER_SIZE rounds the extension up to two words, so the first block keeps the
+ * alignment of the bare header whatever features are enabled: a 16-byte aligned request
+ * needs no more padding in an arena with an extension than in one without.
+ */
+#if defined(EM_STATS) || defined(EM_PROFILE) || defined(EM_VERIFY) || defined(EM_DIRTY_TRACKING) || \
+    defined(EM_FREE_INDEX) || defined(EM_FREE_TLSF) || defined(EM_FREE_TREE_AUGMENT) || defined(EM_HANDLES) || \
+    defined(EM_LIFETIME)
+#   define EM_HAS_EXTENSION
+#endif
+
+#ifdef EM_PROFILE
+/*
+ * Allocation Path Profile (em_get_profile)
+ *
+ * Event counters accumulated since creation (or the last em_profile_reset).
+ * Tail hits and LIFO frees are the O(1) paths; tree hits, detaches and inserts
+ * walk the free tree, and the path totals tell how deep those walks go.
+ */
+typedef struct {
+    size_t tail_hits;             // Allocations served from the tail block
+    size_t tree_hits;             // Allocations served from the free tree
+    size_t gap_blocks_recycled;   // Alignment gaps in the tail turned into free blocks
+    size_t splits;                // Blocks split to return a remainder
+    size_t merges;                // Physical merges of adjacent free blocks
+    size_t lifo_tail_frees;       // Frees of the tail block itself (block == tail)
+    size_t lifo_next_tail_frees;  // Frees of the block right before a free tail (next == tail)
+    size_t detach_calls;          // Removals of a known block from the free tree
+    size_t detach_path_total;     // Nodes visited to locate those blocks
+    size_t detach_path_max;       // Longest such path
+    size_t insert_calls;          // Insertions into the free tree
+    size_t insert_depth_total;    // Depth at which blocks were attached
+    size_t insert_depth_max;      // Deepest attachment
+    size_t tree_rebuilds;         // Free tree rebuilds forced by EM_MAX_TREE_HEIGHT
+} EMProfile;
+#endif // EM_PROFILE
+
+#ifdef EM_FREE_INDEX
+/*
+ * Free Index (EM_FREE_INDEX)
+ *
+ * An out-of-band B+-tree over the free blocks, kept in a caller-provided buffer. Keys are
+ * (size, block address) pairs packed into parallel arrays: the sizes of a node fill one
+ * cache line on 64-bit targets and are compared against the request in a handful of SIMD
+ * instructions (AVX2, SSE4.2, NEON, SSE2 on 32-bit x86; a branchless loop elsewhere). A best
+ * fit search touches one node per level and then the leaf chain, never a block header;
+ * only the chosen block is dereferenced. Blocks that do not fit into a full buffer stay in
+ * the regular free tree, which is searched as well.
+ *
+ *  [ EMFreeIndex ] [ gap to 64 bytes ] [ EMIndexNode ] [ EMIndexNode ] ...
+ *
+ * Internal nodes route on separators: child i holds the keys from sizes[i]/blocks[i] up to
+ * the next separator; slot 0 holds the (0, 0) sentinel. Unused slots hold UINTPTR_MAX sizes
+ * so that the SIMD rank over all slots equals the rank over the used ones.
+ */
+#define EM_INDEX_FANOUT      8
+#define EM_INDEX_MAX_HEIGHT  32
+
+typedef struct EMIndexNode EMIndexNode;
+struct EMIndexNode {
+    uintptr_t sizes[EM_INDEX_FANOUT];        // Primary keys, ascending (one cache line on 64-bit)
+    uintptr_t blocks[EM_INDEX_FANOUT];       // Secondary keys: block header addresses
+    EMIndexNode *children[EM_INDEX_FANOUT];  // Internal nodes only
+    EMIndexNode *next;                       // Leaves: right neighbour; unused nodes: recycle list
+    uintptr_t count;                         // Keys (leaves) or children (internal nodes) in use
+    uint8_t padding[(64 - (3 * EM_INDEX_FANOUT + 2) * sizeof(uintptr_t) % 64) % 64];
+};
+
+typedef struct {
+    EMIndexNode *root;       // NULL when empty
+    EMIndexNode *recycled;   // Nodes released by merges
+    EMIndexNode *unused;     // First node never handed out
+    EMIndexNode *end;        // End of the node pool
+    size_t height;           // Levels, 1 when the root is a leaf
+    size_t available;        // Recycled plus never used nodes
+    size_t count;            // Indexed free blocks
+    size_t nodes;            // Pool capacity in nodes
+} EMFreeIndex;
+
+/*
+ * Buffer size for em_free_index_attach that indexes 'blocks' free blocks without spilling
+ * into the free tree (leaves stay at least half full).
+ */
+#define EM_PLAN_FREE_INDEX_SIZE(blocks) \
+    (sizeof(EMFreeIndex) + 64 + ((size_t)(blocks) / 3 + 2 + EM_INDEX_MAX_HEIGHT) * sizeof(EMIndexNode))
+#endif // EM_FREE_INDEX
+
+#ifdef EM_FREE_TLSF
+#ifdef EM_FREE_INDEX
+#   error "EM_FREE_TLSF and EM_FREE_INDEX cannot be combined: the side index works on top of the free tree the lists replace"
+#endif
+#ifdef EM_FREE_TREE_AUGMENT
+#   error "EM_FREE_TLSF and EM_FREE_TREE_AUGMENT cannot be combined: root arenas keep no free tree to augment"
+#endif
+/*
+ * TLSF Free Lists (EM_FREE_TLSF)
+ *
+ * Two-level segregated fit in place of the free tree. A free block belongs to the class of
+ * its size: the first level is the power of two (below 1 << EM_TLSF_FL_SHIFT, one shared
+ * class), the second level one of EM_TLSF_SL_COUNT equal steps inside it. Each class keeps
+ * a doubly-linked list threaded through the left_free (next) and right_free (previous)
+ * slots of the block headers, and one bitmap bit per non-empty list. A search rounds the
+ * request up to the start of the next class, so every block found there fits, and finds
+ * the first non-empty class with two bit scans: insert, remove and search take constant
+ * time, at the price of up to 1 / EM_TLSF_SL_COUNT of a block left to the split.
+ *
+ * The lists take about 1 KiB, so only root arenas of at least EM_TLSF_MIN_ARENA bytes keep
+ * them, right after the header extension. Smaller, nested and scratch arenas go on using
+ * the free tree.
+ */
+#ifndef EM_TLSF_SL_LOG2
+#   define EM_TLSF_SL_LOG2 2
+#endif
+#if EM_TLSF_SL_LOG2 < 1 || EM_TLSF_SL_LOG2 > 3
+#   error "EM_TLSF_SL_LOG2 must be between 1 and 3"
+#endif
+
+#ifndef EM_TLSF_FL_MAX
+#   if UINTPTR_MAX > 0xFFFFFFFFUL
+#       define EM_TLSF_FL_MAX 32  // Arenas below 8 GiB; raise it for larger ones
+#   elif UINTPTR_MAX > 0xFFFFUL
+#       define EM_TLSF_FL_MAX 28  // Every size up to EMMAX_SIZE
+#   else
+#       define EM_TLSF_FL_MAX 12
+#   endif
+#endif
+
+#define EM_TLSF_SL_COUNT   (1 << EM_TLSF_SL_LOG2)
+#define EM_TLSF_WORD_LOG2  ((sizeof(uintptr_t) == 8) ? 3 : (sizeof(uintptr_t) == 4) ? 2 : 1)
+#define EM_TLSF_FL_SHIFT   (EM_TLSF_SL_LOG2 + EM_TLSF_WORD_LOG2)
+#define EM_TLSF_FL_COUNT   (EM_TLSF_FL_MAX - EM_TLSF_FL_SHIFT + 2)
+#define EM_TLSF_MAX_SIZE   (((size_t)2 << EM_TLSF_FL_MAX) - 1)  // Largest size with a class
+
+typedef struct {
+    size_t fl_bitmap;                                   // First-level classes with a non-empty list
+    // An odd number of words, so the lists add an even number of words to the header
+    uint8_t sl_bitmap[((EM_TLSF_FL_COUNT + sizeof(uintptr_t) - 1) / sizeof(uintptr_t) | 1) * sizeof(uintptr_t)];
+    Block *heads[EM_TLSF_FL_COUNT][EM_TLSF_SL_COUNT];  // First block of each list, NULL when empty
+    size_t largest;                                     // Size of the largest listed block (0 when empty)
+    uintptr_t detector;                                 // Reserved for the Magic LSB Padding Detector
+} EMTlsf;
+
+#ifndef EM_TLSF_MIN_ARENA
+#   define EM_TLSF_MIN_ARENA (16 * sizeof(EMTlsf))  // Smallest root arena given the lists (they take 1/16 of it at most)
+#endif
+#endif // EM_FREE_TLSF
+
+#ifdef EM_HANDLES
+/*
+ * Handle Table (EM_HANDLES)
+ *
+ * em_halloc blocks are named by a slot of this table instead of by their address, which lets
+ * em_compact slide them towards the arena start. The table is an ordinary, immovable block of
+ * the arena itself. A live slot holds the data pointer of its block, whose header carries
+ * EMHANDLE_TAG and the slot number in place of the XOR magic; a free slot holds the next free
+ * slot, tagged with the low bit.
+ *
+ *  [ EMHandleTable ] [ slot 0 ] [ slot 1 ] ... [ slot capacity - 1 ]
+ */
+typedef size_t EMHandle;  // Slot + 1; 0 is never a handle
+
+/*
+ * Relocation Hook (em_compact)
+ * Moves 'size' bytes of a handle block from 'from' to 'to', which is always the lower address.
+ * The ranges overlap when the hole is smaller than the block, so the move must run front to
+ * back, as memmove does.
+ */
+typedef void (*EMRelocateFunc)(void *to, void *from, size_t size, void *context);
+
+typedef struct {
+    size_t capacity;          // Slots following the table
+    size_t live;              // Slots naming a block
+    size_t free_head;         // First free slot + 1 (0: table full)
+    Block *cursor;            // Block em_compact resumes from (NULL: start a new pass)
+    EMRelocateFunc relocate;  // NULL: memmove
+    void *context;            // Passed to 'relocate'
+} EMHandleTable;
+#endif // EM_HANDLES
+
+#ifdef EM_LIFETIME
+/*
+ * Allocation Lifetime Hint (em_alloc_ex)
+ *
+ * Long-lived blocks take the normal placement: free blocks, then the tail growing up.
+ * Short-lived blocks are stacked down from the top of the free space, so they never sit
+ * between the tail and the long-lived blocks below it.
+ *
+ *  [ long-lived blocks ... | TAIL -> free space <- | short-lived region ] [ scratch ]
+ *                                                  ^ floor              ^ top
+ */
+typedef enum {
+    EM_LIFETIME_LONG = 0,   // Normal placement
+    EM_LIFETIME_SHORT = 1   // Short-lived region at the top of the free space
+} EMLifetime;
+#endif // EM_LIFETIME
+
+#ifdef EM_HAS_EXTENSION
+typedef struct {
+    #ifdef EM_STATS
+    size_t used_bytes;        // Payload bytes held by live blocks (alignment padding included)
+    size_t peak_used_bytes;   // High-water mark of used_bytes
+    size_t live_blocks;       // Occupied blocks outside the scratchpad
+    size_t free_tree_bytes;   // Payload bytes of blocks in the free tree
+    size_t free_tree_blocks;  // Number of blocks in the free tree
+    #endif
+    #ifdef EM_PROFILE
+    EMProfile profile;        // Path counters, see EMProfile
+    #endif
+    #ifdef EM_VERIFY
+    Block *verify_cursor;     // Next block em_verify_step checks (NULL: start a new pass)
+    #endif
+    #ifdef EM_DIRTY_TRACKING
+    uintptr_t clean_start;    // [clean_start, clean_end) holds only zero bytes, live block headers aside
+    uintptr_t clean_end;      // Lowered by the scratchpad, which writes at the end of the arena
+    #endif
+    #ifdef EM_FREE_INDEX
+    EMFreeIndex *free_index;  // Side index over the free blocks (NULL: free tree only)
+    #endif
+    #ifdef EM_FREE_TLSF
+    EMTlsf *tlsf;             // Segregated free lists of a root arena (NULL: free tree)
+    #endif
+    #if defined(EM_STATS) || defined(EM_FREE_TREE_AUGMENT)
+    size_t free_tree_largest; // Size of the largest block in the free tree (0 when empty)
+    #endif
+    #ifdef EM_HANDLES
+    EMHandleTable *handles;   // Handle table of em_halloc (NULL: none created)
+    #endif
+    #ifdef EM_LIFETIME
+    Block *short_floor;       // Lowest block of the short-lived region (NULL: region empty)
+    uintptr_t short_top;      // End of the short-lived region, where it started (0: region empty)
+    #ifdef EM_STATS
+    size_t short_held_bytes;  // Payload bytes of short-lived blocks freed above the floor
+    size_t short_held_blocks; // Number of those blocks, held until the floor passes them
+    #endif
+    #endif
+    uintptr_t detector;       // Reserved for the Magic LSB Padding Detector
+} EMExtension;
+
+#   define EM_HEADER_SIZE (sizeof(EM) + ((sizeof(EMExtension) + 2 * sizeof(uintptr_t) - 1) & ~(2 * sizeof(uintptr_t) - 1)))
+#else
+#   define EM_HEADER_SIZE (sizeof(EM))
+#endif
+
+// Bytes of TLSF class lists a root arena of 'arena_size' bytes keeps after its header
+#ifdef EM_FREE_TLSF
+#   define EM_TLSF_LISTS_SIZE(arena_size) (((size_t)(arena_size) >= EM_TLSF_MIN_ARENA) ? sizeof(EMTlsf) : (size_t)0)
+#else
+#   define EM_TLSF_LISTS_SIZE(arena_size) ((size_t)0)
+#endif
+
 
 
 
@@ -831,9 +1265,10 @@ EM_STATIC_ASSERT((sizeof(EM) == sizeof(Block)), Size_mismatch_between_Bump_and_B
  *  │                               Capacity                                      │  Reserved  │
  *  │  [63/31/15 ............................................................ 5]  │   [4..0]   │
  *  └─────────────────────────────────────────────────────────────────────────────┴────────────┘
- *    - Reserved  (5 bits): Always 0. Because a Bump allocator is allocated from the parent arena
- *                          as a standard block, its total size is inherently rounded to a multiple
- *                          of 4, guaranteeing these bits remain empty.
+ *    - Reserved  (5 bits): Hold EMBUMP_TAG. Because a Bump allocator is allocated from the parent
+ *                          arena as a standard block, its total size is inherently rounded to a
+ *                          multiple of 4, so these bits are free to identify the header (see em_walk;
+ *                          zero in builds that do not walk the heap).
  *    - Capacity  (N bits): Total payload capacity carved out from the parent (shifted left by 3).
  * 
  *  [ WORD 1: as.self.prev ] -> Maps to Block.prev
@@ -908,11 +1343,13 @@ EM_STATIC_ASSERT((sizeof(Bump) == sizeof(Block)), Size_mismatch_between_Bump_and
  *    - Address: Pointer to the physically preceding Block (if any). 
  *               Essential for O(1) merging when the Slab allocator is destroyed.
  *
- *  [ WORD 2: as.self.em ] -> Maps to Block.as.occupied.em (NO POINTER TAGGING NEEDED)
- *  ┌──────────────────────────────────────────────────────────────────────────────────────────┐
- *  │                               Parent EM Address                                          │
- *  │  [63/31/15 ......................................................................... 0]  │
- *  └──────────────────────────────────────────────────────────────────────────────────────────┘
+ *  [ WORD 2: as.self.em ] -> Maps to Block.as.occupied.em (POINTER TAGGING ENABLED)
+ *  ┌────────────────────────────────────────────────────────────────────────────────┬─────────┐
+ *  │                               Parent EM Address                                │ Is Slab │
+ *  │  [63/31/15 ............................................................... 1]  │   [0]   │
+ *  └────────────────────────────────────────────────────────────────────────────────┴─────────┘
+ *    - Is Slab (Bit 0): 1 (EMSLAB_EM_TAG) in builds that walk the heap. WORD 0 has no spare bits
+ *                       left to identify the header, so the tag lives here; get_em masks it off.
  *    - Parent Addr: Direct pointer to the Easy Memory instance that created this Slab allocator.
  *
  *  [ WORD 3: as.self.free_index_and_chunk_high ] -> Maps to Block.as.occupied.magic
@@ -969,6 +1406,8 @@ EM_STATIC_ASSERT((sizeof(Slab) == sizeof(Block)), Size_mismatch_between_Slab_and
  *  │  [63/31/15 ............................................................ 5]  │   [4..0]   │
  *  └─────────────────────────────────────────────────────────────────────────────┴────────────┘
  *    - Meta Type (2 bits used of 5): The 2 lowest bits store the 2-bit compressed metadata size.
+ *                            Bits [4..3] hold EMSTACK_TAG to identify the header (see em_walk;
+ *                            zero in builds that do not walk the heap).
  *                            - Value `0`: uint8_t offsets (capacity < 256 B)
  *                            - Value `1`: uint16_t offsets (capacity < 64 KB)
  *                            - Value `2`: uint32_t offsets (capacity < 4 GB)
@@ -1035,9 +1474,399 @@ typedef struct {
     uintptr_t magic;  // XOR-encoded verification signature (EM_MAGIC ^ stack_address)
 } StackMarker;
 
+#ifdef EM_STATS
+/*
+ * Arena Statistics Snapshot (em_get_stats)
+ *
+ * Byte counts are block payload sizes: alignment padding inside a block counts
+ * as used, block headers are not counted anywhere except in 'capacity'.
+ */
+typedef struct {
+    size_t capacity;                // Total bytes managed by the arena, headers included
+    size_t used_bytes;              // Payload bytes held by live blocks
+    size_t peak_used_bytes;         // High-water mark of used_bytes since creation
+    size_t live_blocks;             // Live blocks (a nested arena or sub-allocator counts as one)
+    size_t free_tree_bytes;         // Payload bytes of the reusable free blocks
+    size_t free_tree_blocks;        // Number of reusable free blocks
+    size_t free_tail_bytes;         // Untouched bytes after the tail block
+    size_t scratch_bytes;           // Bytes reserved by the scratchpad (0 if none)
+    #ifdef EM_LIFETIME
+    size_t short_region_bytes;      // Bytes spanned by the short-lived region, headers included (0 if empty)
+    size_t short_region_top;        // Offset of the region's end from the arena start (0 if empty)
+    size_t short_held_bytes;        // Payload bytes of freed short-lived blocks not yet reclaimed
+    size_t short_held_blocks;       // Number of such blocks (free, but neither reusable nor in the tree)
+    #endif
+    size_t largest_free_block;      // Largest single free region (free tree or tail)
+} EMStats;
+#endif // EM_STATS
+
+#ifdef EM_VERIFY
+/*
+ * Heap Verification Report (em_verify, em_verify_step)
+ *
+ * 'block' and 'reason' stay NULL while every check passes. On corruption 'block' is the
+ * header that failed (the EM header for arena-level damage) and 'reason' a static string.
+ */
+typedef struct {
+    const void *block;  // Offending header, NULL if none
+    const char *reason; // Failed check, NULL if none
+    size_t checked;     // Blocks checked by this call
+    size_t passes;      // Passes over the whole arena completed by this call
+} EMVerifyReport;
+#endif // EM_VERIFY
+
+#ifdef EM_WALK
+/*
+ * Heap Walk Entry Kinds (em_walk)
+ *
+ * Containers (NESTED, BUMP, SLAB, STACK) are reported first, followed by their contents
+ * one level deeper. SUB_* entries describe the inside of Bump, Slab and Stack allocators.
+ */
+typedef enum {
+    EM_WALK_USED = 0,   // Occupied block (size: payload)
+    EM_WALK_FREE,       // Free block linked into the free tree
+    EM_WALK_TAIL,       // Never-used space at the end (address: free tail header, or first byte after an occupied tail)
+    EM_WALK_SCRATCH,    // Scratchpad allocation at the arena end
+    EM_WALK_NESTED,     // Nested or scratch arena (size: capacity), contents follow at depth + 1
+    EM_WALK_BUMP,       // Bump allocator header (size: capacity)
+    EM_WALK_SLAB,       // Slab allocator header (size: capacity)
+    EM_WALK_STACK,      // Stack allocator header (size: capacity)
+    EM_WALK_SUB_USED,   // Bytes handed out by a Bump / Slab, or one Stack frame
+    EM_WALK_SUB_FREE,   // Bytes still available inside a Bump / Slab / Stack
+    EM_WALK_KIND_COUNT
+} EMWalkKind;
+
+/*
+ * Heap Walk Entry
+ * One physical region as seen by em_walk. Valid only for the duration of the callback.
+ */
+typedef struct {
+    const void *address;  // Block header, or first byte of the region for SUB_* entries
+    const EM *owner;      // Arena the entry belongs to
+    size_t size;          // Bytes described by the entry (see EMWalkKind)
+    unsigned depth;       // 0 for the walked arena, +1 per nesting level
+    EMWalkKind kind;
+} EMWalkEntry;
+
+/*
+ * Heap Walk Callback
+ * Return false to stop the walk.
+ */
+typedef bool (*EMWalkCallback)(const EMWalkEntry *entry, void *context);
+
+/*
+ * Heap Dump Writer
+ * Receives the encoded dump in chunks (see HEAP DUMP FORMAT).
+ */
+typedef void (*EMDumpWriter)(const void *data, size_t size, void *context);
+
+/* ==============================================================================================
+ *  HEAP DUMP FORMAT (EM_WALK)
+ * ==============================================================================================
+ *  em_dump serializes the em_walk sequence without formatting a single line of text:
+ *
+ *      [ 'E' 'M' 'H' 'D' ][ version ][ sizeof(uintptr_t) ][ root ][ capacity ]  [ entry ] ...
+ *
+ *  'root' and 'capacity' describe the dumped arena; every entry is three LEB128 varints:
+ *
+ *      [ kind | depth << 4 ][ address ][ size ]
+ *
+ *  Addresses use the trace encoding: zigzag(address - previous address) + 1, starting from
+ *  'root', so neighbouring blocks cost one or two bytes. A typical entry takes 3-6 bytes.
+ * ==============================================================================================
+ */
+#define EM_DUMP_VERSION 1
+#endif // EM_WALK
+
+
+
+
+
+/* ==============================================================================================
+ *  COMPILE-TIME LAYOUT PLANNER (Static Arena Sizing)
+ * ==============================================================================================
+ *  Block headers (4 words), end padding and alignment gaps make the true footprint of a static 
+ *  arena non-obvious. The EM_PLAN_* macros below reproduce the allocator's own layout math as 
+ *  integer constant expressions, so a buffer can be sized (and checked) at compile time:
+ *
+ *      #define ARENA_PLAN (EM_PLAN_ALLOCS(48, 16, 100, 16)            \
+ *                        + EM_PLAN_ALLOC(4096, 64, 16)                \
+ *                        + EM_PLAN_ALLOC(EM_PLAN_SLAB_SIZE(32, 64), 16, 16))
+ *
+ *      static uint8_t arena_memory[EM_PLAN_STATIC_SIZE(16, ARENA_PLAN)];
+ *      EM_PLAN_ASSERT_FITS(sizeof(arena_memory), EM_PLAN_STATIC_SIZE(16, ARENA_PLAN));
+ *
+ *  Every entry is the worst-case number of bytes the request consumes from the arena tail, 
+ *  measured from one data pointer to the next one (header of the following block included):
+ *
+ *      [ Block Header ][ Align Gap ][ User Data ][ End Pad ] [ Next Block Header ] ...
+ *                                  ^                                            ^
+ *                                  └──────────── one EM_PLAN_ALLOC ─────────────┘
+ *
+ *  The sum does not depend on the order of allocations nor on where the buffer lands in 
+ *  memory (the self-alignment shift of em_create_static_aligned is included), so a plan that 
+ *  fits on one build fits on every build with the same configuration.
+ *  Sub-allocators are planned by their creation size: a Bump, Slab, Stack or nested EM costs 
+ *  exactly one EM_PLAN_ALLOC of the 'size' passed to its create function. The *_SIZE helpers 
+ *  compute that size from the content you intend to put inside.
+ *
+ *  Note: Plans assume a fresh arena filled from the tail. Blocks reused from the free tree after 
+ *        em_free are never larger than the tail path would have consumed, so freeing and 
+ *        re-allocating entries of the plan never requires extra capacity.
+ * ==============================================================================================
+ */
+
+/*
+ * Planner Helper: Align Up / Max (constant-expression versions of align_up and max)
+*/
+#define EM_PLAN_ALIGN_UP(value, alignment) \
+    (((size_t)(value) + (size_t)(alignment) - 1) & ~((size_t)(alignment) - 1))
+#define EM_PLAN_MAX(a, b) (((size_t)(a) > (size_t)(b)) ? (size_t)(a) : (size_t)(b))
+
+/*
+ * Planner Helper: Over-Alignment Gap
+ * Worst-case padding inserted before user data when the requested alignment exceeds the 
+ * baseline alignment of the arena (data pointers are always aligned to the baseline).
+*/
+#define EM_PLAN_ALIGN_GAP(alignment, arena_alignment) \
+    (((size_t)(alignment) > (size_t)(arena_alignment)) ? (size_t)(alignment) - (size_t)(arena_alignment) : (size_t)0)
+
+/*
+ * Planner: Single Allocation
+ * Footprint of one em_alloc_aligned(size, alignment) in an arena with 'arena_alignment'.
+ * Covers the block header, the alignment gap and the end padding that keeps the next block aligned.
+ * Pass the arena alignment as 'alignment' for plain em_alloc / em_calloc calls.
+ * Under EM_ASAN the redzone behind the allocation is included.
+*/
+#define EM_PLAN_ALLOC(size, alignment, arena_alignment) \
+    (EM_PLAN_ALIGN_GAP(alignment, arena_alignment) + EM_PLAN_ALIGN_UP((size_t)(size) + EM_ASAN_REDZONE + sizeof(Block), arena_alignment))
+
+/*
+ * Planner: Repeated Allocations
+ * Footprint of 'count' identical allocations.
+*/
+#define EM_PLAN_ALLOCS(size, alignment, count, arena_alignment) \
+    ((size_t)(count) * EM_PLAN_ALLOC(size, alignment, arena_alignment))
+
+/*
+ * Planner: Scratchpad
+ * Footprint of one em_alloc_scratch_aligned(size, alignment) carved from the arena end:
+ * block header, payload, alignment gap, the trailing size word and the word-rounding of the end.
+*/
+#define EM_PLAN_SCRATCH(size, alignment) \
+    (sizeof(Block) + (size_t)(size) + ((size_t)(alignment) - 1) + sizeof(uintptr_t) + (EMMIN_ALIGNMENT - 1))
+
+/*
+ * Planner: Bump Capacity
+ * The 'size' to pass to em_bump_create so that 'count' allocations of (size, alignment) fit.
+ * The extra byte accounts for the strict capacity comparison in em_bump_alloc.
+*/
+#define EM_PLAN_BUMP_SIZE(size, alignment, count, arena_alignment) \
+    ((size_t)(count) * EM_PLAN_ALIGN_UP(size, alignment) + EM_PLAN_ALIGN_GAP(alignment, arena_alignment) + 1)
+
+/*
+ * Planner: Slab Capacity
+ * The 'slab_size' to pass to em_slab_create so that 'count' chunks of 'chunk_size' fit.
+ * Chunks are rounded to the machine word exactly like slab_set_chunk_size does.
+*/
+#define EM_PLAN_SLAB_SIZE(chunk_size, count) \
+    EM_PLAN_MAX((size_t)(count) * EM_PLAN_ALIGN_UP(chunk_size, EMMIN_ALIGNMENT), EM_MIN_BUFFER_SIZE)
+
+/*
+ * Planner: Stack Frames
+ * Payload bytes consumed by 'count' em_stack_alloc_aligned(size, alignment) frames.
+ * Several frame kinds can be summed together before being passed to EM_PLAN_STACK_SIZE.
+*/
+#define EM_PLAN_STACK_FRAMES(size, alignment, count) \
+    ((size_t)(count) * (EM_PLAN_ALIGN_UP(size, EMMIN_ALIGNMENT) + (size_t)(alignment) - EMMIN_ALIGNMENT))
+
+/*
+ * Planner Helper: Stack Metadata Width
+ * Width of one offset entry for a stack of the given capacity (mirrors stack_calculate_meta_type).
+*/
+#define EM_PLAN_STACK_META_WIDTH(capacity) \
+    (((size_t)(capacity) <= 0xFFU) ? (size_t)1 : ((size_t)(capacity) <= 0xFFFFU) ? (size_t)2 : \
+     ((uint64_t)(capacity) <= 0xFFFFFFFFULL) ? (size_t)4 : (size_t)8)
+
+/*
+ * Planner: Stack Capacity
+ * The 'stack_size' to pass to em_stack_create for 'frame_count' frames occupying 'frame_bytes'.
+ * The metadata width is derived from an upper bound of the final capacity, so the plan never 
+ * lands in a wider metadata class than it budgeted for.
+*/
+#define EM_PLAN_STACK_SIZE(frame_bytes, frame_count) \
+    (sizeof(Stack) + (size_t)(frame_bytes) + (size_t)(frame_count) * EM_PLAN_STACK_META_WIDTH( \
+        sizeof(Stack) + (size_t)(frame_bytes) + (size_t)(frame_count) * sizeof(uint64_t) + EMMAX_ALIGNMENT))
+
+/*
+ * Planner: Static Arena Size
+ * Total buffer size for em_create_static_aligned(memory, size, arena_alignment) able to hold a 
+ * plan whose entries sum up to 'footprint'. Includes the self-alignment shift of an arbitrary 
+ * buffer, the EM header, the first block header and its alignment gap, and with EM_FREE_TLSF the
+ * class lists of a root arena that large.
+ * The same value is the 'size' for em_create_nested_aligned when the plan describes a nested arena
+ * (which keeps no class lists, so it may be a little larger than needed there).
+*/
+#define EM_PLAN_STATIC_SIZE(arena_alignment, footprint) \
+    EM_PLAN_MAX(EMMIN_SIZE + (EMMIN_ALIGNMENT - 1), \
+        EM_PLAN_STATIC_BASE(arena_alignment, footprint) + EM_TLSF_LISTS_SIZE(EM_PLAN_STATIC_BASE(arena_alignment, footprint)))
+#define EM_PLAN_STATIC_BASE(arena_alignment, footprint) \
+    ((EMMIN_ALIGNMENT - 1) + EM_HEADER_SIZE + sizeof(Block) + ((size_t)(arena_alignment) - EMMIN_ALIGNMENT) + (size_t)(footprint))
+
+/*
+ * Planner: Fit Check
+ * Fails compilation if a buffer of 'buffer_size' bytes cannot hold a plan of 'plan_size' bytes.
+*/
+#define EM_PLAN_ASSERT_FITS(buffer_size, plan_size) \
+    EM_STATIC_ASSERT((size_t)(buffer_size) >= (size_t)(plan_size), Static_arena_buffer_is_too_small_for_its_plan)
+
+
+
+
+
+/* ==============================================================================================
+ *  ALLOCATION TRACE FORMAT (EM_TRACE)
+ * ==============================================================================================
+ *  With EM_TRACE defined, every public operation (creation, allocation, free, reset, destroy 
+ *  of arenas and sub-allocators) is encoded into a compact binary event and handed to a 
+ *  user-provided writer. The library itself never buffers, allocates or performs I/O: the 
+ *  writer decides whether events go to a file, a ring buffer or a UART.
+ *
+ *  Stream layout:
+ *
+ *      [ 'E' 'M' 'T' 'R' ][ version ][ sizeof(uintptr_t) ]  [ event ] [ event ] ...
+ *
+ *  Every event has the same five fields, each encoded as an unsigned LEB128 varint:
+ *
+ *      [ op ][ object ][ result ][ size ][ extra ]
+ *
+ *    - op:     EMTraceOp value.
+ *    - object: The arena / sub-allocator the operation acts on (or the parent for creations).
+ *    - result: The handle or pointer produced (creations, allocations) or consumed (frees).
+ *    - size:   Requested size (nmemb for em_calloc, rollback index for stack markers).
+ *    - extra:  Alignment (0 = unaligned bump allocation), chunk size for slabs, size for em_calloc,
+ *              the handle for em_halloc / em_hfree, bytes moved for em_compact, and for
+ *              em_alloc_near the hint as an offset from the arena plus one (0 = NULL hint).
+ *
+ *  Addresses are delta-encoded against the previous address of the same class (handles for 
+ *  arenas and sub-allocators, pointers for user data) and zigzag-mapped, so sequential 
+ *  allocations cost one or two bytes per address. 0 encodes NULL: failed allocations are 
+ *  recorded too, so a replay sees exactly the request stream the application produced.
+ *  Operations rejected by EM_CHECK (invalid arguments) are not recorded.
+ *
+ *      encoded = (address == NULL) ? 0 : zigzag(address - previous_of_class) + 1
+ *
+ *  Addresses are identities only: a replayer maps them to its own objects, which makes traces 
+ *  portable across builds with different alignment, policy or buffer settings.
+ * ==============================================================================================
+ */
+#define EM_TRACE_VERSION 1
+
+typedef enum {
+    EM_TRACE_CREATE = 1,            // em_create_aligned             object: -       result: em
+    EM_TRACE_CREATE_STATIC,         // em_create_static_aligned      object: -       result: em
+    EM_TRACE_CREATE_NESTED,         // em_create_nested_aligned      object: parent  result: em
+    EM_TRACE_CREATE_SCRATCH,        // em_create_scratch_aligned     object: parent  result: em
+    EM_TRACE_DESTROY,               // em_destroy                    object: em
+    EM_TRACE_RESET,                 // em_reset                      object: em
+    EM_TRACE_RESET_ZERO,            // em_reset_zero                 object: em
+    EM_TRACE_ALLOC,                 // em_alloc / em_alloc_aligned   object: em      result: pointer
+    EM_TRACE_ALLOC_SCRATCH,         // em_alloc_scratch(_aligned)    object: em      result: pointer
+    EM_TRACE_CALLOC,                // em_calloc                     object: em      result: pointer
+    EM_TRACE_FREE,                  // em_free                       object: em      result: pointer
+    EM_TRACE_BUMP_CREATE,           // em_bump_create                object: parent  result: bump
+    EM_TRACE_BUMP_CREATE_SCRATCH,   // em_bump_create_scratch        object: parent  result: bump
+    EM_TRACE_BUMP_ALLOC,            // em_bump_alloc(_aligned)       object: bump    result: pointer
+    EM_TRACE_BUMP_TRIM,             // em_bump_trim                  object: bump
+    EM_TRACE_BUMP_RESET,            // em_bump_reset                 object: bump
+    EM_TRACE_BUMP_DESTROY,          // em_bump_destroy               object: bump
+    EM_TRACE_SLAB_CREATE,           // em_slab_create                object: parent  result: slab
+    EM_TRACE_SLAB_CREATE_SCRATCH,   // em_slab_create_scratch        object: parent  result: slab
+    EM_TRACE_SLAB_ALLOC,            // em_slab_alloc                 object: slab    result: pointer
+    EM_TRACE_SLAB_FREE,             // em_slab_free                  object: slab    result: pointer
+    EM_TRACE_SLAB_RESET,            // em_slab_reset                 object: slab
+    EM_TRACE_SLAB_RESET_ZERO,       // em_slab_reset_zero            object: slab
+    EM_TRACE_SLAB_DESTROY,          // em_slab_destroy               object: slab
+    EM_TRACE_STACK_CREATE,          // em_stack_create               object: parent  result: stack
+    EM_TRACE_STACK_CREATE_SCRATCH,  // em_stack_create_scratch       object: parent  result: stack
+    EM_TRACE_STACK_ALLOC,           // em_stack_alloc(_aligned)      object: stack   result: pointer
+    EM_TRACE_STACK_FREE,            // em_stack_free                 object: stack   result: pointer
+    EM_TRACE_STACK_FREE_TO_MARKER,  // em_stack_free_to_marker       object: stack   size: index
+    EM_TRACE_STACK_RESET,           // em_stack_reset                object: stack
+    EM_TRACE_STACK_RESET_ZERO,      // em_stack_reset_zero           object: stack
+    EM_TRACE_STACK_DESTROY,         // em_stack_destroy              object: stack
+    EM_TRACE_HANDLES_CREATE,        // em_handles_create             object: em      size: capacity
+    EM_TRACE_HANDLES_DESTROY,       // em_handles_destroy            object: em
+    EM_TRACE_HALLOC,                // em_halloc                     object: em      result: pointer
+    EM_TRACE_HFREE,                 // em_hfree                      object: em      result: pointer
+    EM_TRACE_COMPACT,               // em_compact                    object: em      size: budget
+    EM_TRACE_ALLOC_NEAR,            // em_alloc_near                 object: em      result: pointer
+    EM_TRACE_ALLOC_SHORT,           // em_alloc_ex (short-lived)     object: em      result: pointer
+    EM_TRACE_OP_COUNT
+} EMTraceOp;
+
+/*
+ * Address class of the 'result' field: creations produce handles, everything else user pointers.
+*/
+#define EM_TRACE_RESULT_IS_HANDLE(op) \
+    ((op) <= EM_TRACE_CREATE_SCRATCH || \
+     (op) == EM_TRACE_BUMP_CREATE    || (op) == EM_TRACE_BUMP_CREATE_SCRATCH  || \
+     (op) == EM_TRACE_SLAB_CREATE    || (op) == EM_TRACE_SLAB_CREATE_SCRATCH  || \
+     (op) == EM_TRACE_STACK_CREATE   || (op) == EM_TRACE_STACK_CREATE_SCRATCH)
+
+#ifdef EM_TRACE
+typedef void (*EMTraceWriter)(const void *data, size_t size, void *context);
+#endif // EM_TRACE
+
+#ifdef EM_SAMPLE
+#ifndef EM_SAMPLE_MAX_FRAMES
+#   define EM_SAMPLE_MAX_FRAMES 16
+#endif
+
+/*
+ * Allocation Sample (EM_SAMPLE)
+ * One sampled live allocation. The sampler keeps these in caller-provided storage,
+ * an open-addressed table keyed by 'pointer' (NULL marks an empty slot).
+ */
+typedef struct {
+    const void *pointer;                  // Sampled allocation
+    size_t size;                          // Requested bytes
+    size_t depth;                         // Valid entries in 'frames', innermost first
+    void *frames[EM_SAMPLE_MAX_FRAMES];   // Return addresses captured at allocation time
+} EMSample;
+
+/*
+ * Backtrace Capture
+ * Fills 'frames' with up to 'max_frames' return addresses, innermost first, and returns the
+ * count. glibc's backtrace() or _Unwind_Backtrace fit; the library has no unwinder of its own.
+ */
+typedef size_t (*EMBacktraceFunc)(void **frames, size_t max_frames);
 
+/*
+ * Sample Profile Formats (em_sample_write)
+ *   - EM_SAMPLE_FOLDED: "outer;...;inner weight" lines for flamegraph.pl / inferno / speedscope.
+ *                       The weight is the estimated number of live bytes the sample stands for.
+ *   - EM_SAMPLE_PPROF:  Legacy text heap profile ("heap profile: ... @ heap_v2/<rate>") read by
+ *                       pprof, which unsamples it itself. Append /proc/self/maps after a
+ *                       "MAPPED_LIBRARIES:" line to let pprof symbolize the addresses.
+ */
+typedef enum {
+    EM_SAMPLE_FOLDED = 0,
+    EM_SAMPLE_PPROF
+} EMSampleFormat;
 
+typedef void (*EMSampleWriter)(const void *data, size_t size, void *context);
+#endif // EM_SAMPLE
 
+#ifdef EM_BULK_ZERO
+/*
+ * Parallel Zeroing Hook (EM_BULK_ZERO)
+ * Receives a reset_zero range of at least the installed minimum size and must have zeroed
+ * all of it when it returns, typically by splitting it across a worker pool whose threads
+ * call em_bulk_zero on their part. The library never starts threads of its own.
+ */
+typedef void (*EMZeroWorkers)(void *data, size_t size, void *context);
+#endif // EM_BULK_ZERO
 
 /* 
  * ======================================================================================
@@ -1094,6 +1923,35 @@ EMDEF void em_reset(EM *EM_RESTRICT em);
 EMDEF void em_reset_zero(EM *EM_RESTRICT em);
 EMDEF void em_destroy(EM *em);
 
+#ifdef EM_DIRTY_TRACKING
+EMDEF void em_mark_zeroed(EM *EM_RESTRICT em);
+#endif // EM_DIRTY_TRACKING
+
+#ifdef EM_BULK_ZERO
+EMDEF void em_bulk_zero(void *data, size_t size);
+EMDEF void em_bulk_zero_set_workers(EMZeroWorkers workers, size_t min_size, void *context);
+#endif // EM_BULK_ZERO
+
+#ifdef EM_FREE_INDEX
+EMDEF bool em_free_index_attach(EM *EM_RESTRICT em, void *memory, size_t size);
+EMDEF void em_free_index_detach(EM *EM_RESTRICT em);
+#endif // EM_FREE_INDEX
+
+#ifdef EM_HANDLES
+EMDEF bool em_handles_create(EM *EM_RESTRICT em, size_t capacity, EMRelocateFunc relocate, void *context);
+EMDEF void em_handles_destroy(EM *EM_RESTRICT em);
+EMDEF EM_ATTR_WARN_UNUSED
+EMHandle em_halloc(EM *EM_RESTRICT em, size_t size);
+EMDEF void *em_hget(EM *EM_RESTRICT em, EMHandle handle);
+EMDEF void em_hfree(EM *EM_RESTRICT em, EMHandle handle);
+EMDEF size_t em_compact(EM *EM_RESTRICT em, size_t budget);
+#endif // EM_HANDLES
+
+#ifdef EM_LIFETIME
+EMDEF EM_ATTR_MALLOC EM_ATTR_WARN_UNUSED EM_ATTR_ALLOC_SIZE(2, size)
+void *em_alloc_ex(EM *EM_RESTRICT em, size_t size, size_t alignment, EMLifetime lifetime);
+#endif // EM_LIFETIME
+
 
 // --- Allocation Core ---
 
@@ -1103,6 +1961,9 @@ void *em_alloc(EM *EM_RESTRICT em, size_t size);
 EMDEF EM_ATTR_MALLOC EM_ATTR_WARN_UNUSED EM_ATTR_ALLOC_SIZE(2, size) 
 void *em_alloc_aligned(EM *EM_RESTRICT em, size_t size, size_t alignment);
 
+EMDEF EM_ATTR_MALLOC EM_ATTR_WARN_UNUSED EM_ATTR_ALLOC_SIZE(2, size) 
+void *em_alloc_near(EM *EM_RESTRICT em, size_t size, const void *hint);
+
 EMDEF EM_ATTR_MALLOC EM_ATTR_WARN_UNUSED EM_ATTR_ALLOC_SIZE(2, size) 
 void *em_alloc_scratch(EM *EM_RESTRICT em, size_t size);
 
@@ -1187,6 +2048,62 @@ EMDEF void em_stack_destroy(Stack *stack);
 
 
 
+// --- Heap Walk & Dump ---
+
+#ifdef EM_WALK
+EMDEF bool em_walk(EM *em, EMWalkCallback callback, void *context);
+EMDEF bool em_dump(EM *em, EMDumpWriter writer, void *context);
+#endif // EM_WALK
+
+
+
+// --- Statistics ---
+
+#ifdef EM_STATS
+EMDEF EMStats em_get_stats(const EM *em);
+#endif // EM_STATS
+
+
+
+// --- Verification ---
+
+#ifdef EM_VERIFY
+EMDEF EMVerifyReport em_verify(EM *em);
+EMDEF EMVerifyReport em_verify_step(EM *em, size_t budget);
+#endif // EM_VERIFY
+
+
+
+// --- Profiling ---
+
+#ifdef EM_PROFILE
+#include <stdio.h>
+EMDEF EMProfile em_get_profile(const EM *em);
+EMDEF void em_profile_reset(EM *em);
+EMDEF void em_print_profile(const EM *em);
+#endif // EM_PROFILE
+
+
+
+// --- Tracing ---
+
+#ifdef EM_TRACE
+EMDEF void em_trace_set_writer(EMTraceWriter writer, void *context);
+#endif // EM_TRACE
+
+
+
+// --- Sampling ---
+
+#ifdef EM_SAMPLE
+EMDEF bool em_sample_start(EMSample *storage, size_t capacity, size_t sample_rate, EMBacktraceFunc backtrace);
+EMDEF void em_sample_stop(void);
+EMDEF size_t em_sample_count(void);
+EMDEF size_t em_sample_write(EMSampleFormat format, EMSampleWriter writer, void *context);
+#endif // EM_SAMPLE
+
+
+
 
 #ifdef EASY_MEMORY_IMPLEMENTATION
 
@@ -1238,17 +2155,46 @@ static inline size_t min_exponent_of(size_t num) {
 }
 
 /*
- * Helper function to safely multiply two size_t values.
- * Returns true if successful, false if an integer overflow occurred.
- * Uses zero-cost compiler intrinsics and ALU flags where available.
+ * Helper function to find maximum exponent of a number
+ * Returns the position of the most significant set bit
  */
-static inline bool safe_mul(size_t a, size_t b, size_t *out_result) {
-    /* 
-     * WHY DOING THIS? (Hardware-Accelerated Zero-Cost Safety)
-     *
-     * 1. THE PROBLEM: The Cost of Naive Validation
-     * To prevent critical failures (like buffer overflows in 'calloc' or state-machine 
-     * corruption in 'Slab'), we must validate that 'a * b' does not exceed SIZE_MAX. 
+static inline size_t max_exponent_of(size_t num) {
+    if (num == 0) return 0; // Undefined for zero, return 0 as a safe default
+
+    #if (defined(__GNUC__) || defined(__clang__)) && !defined(EM_FORCE_GENERIC)
+        #if UINTPTR_MAX > 0xFFFFFFFF
+            return sizeof(unsigned long long) * 8 - 1 - (size_t)__builtin_clzll((unsigned long long)num);
+        #else
+            return sizeof(unsigned int) * 8 - 1 - (size_t)__builtin_clz((unsigned int)num);  // 16-bit targets have a 16-bit int
+        #endif
+    #elif defined(_MSC_VER) && !defined(EM_FORCE_GENERIC)
+        unsigned long index;
+        #if defined(_M_X64) || defined(_M_ARM64)
+            _BitScanReverse64(&index, num);
+        #else
+            _BitScanReverse(&index, num);
+        #endif
+        return index;
+    #else
+        size_t s = num;
+        size_t exponent = 0;
+        while (s >>= 1) exponent++;
+        return exponent;
+    #endif
+}
+
+/*
+ * Helper function to safely multiply two size_t values.
+ * Returns true if successful, false if an integer overflow occurred.
+ * Uses zero-cost compiler intrinsics and ALU flags where available.
+ */
+static inline bool safe_mul(size_t a, size_t b, size_t *out_result) {
+    /* 
+     * WHY DOING THIS? (Hardware-Accelerated Zero-Cost Safety)
+     *
+     * 1. THE PROBLEM: The Cost of Naive Validation
+     * To prevent critical failures (like buffer overflows in 'calloc' or state-machine 
+     * corruption in 'Slab'), we must validate that 'a * b' does not exceed SIZE_MAX. 
      * The standard C approach is: 'if (a > SIZE_MAX / b)'. 
      * However, this forces a hardware division (DIV) on every call, which is 
      * notoriously slow (20-40+ cycles) and kills performance in allocation hot-paths.
@@ -1342,6 +2288,188 @@ static inline bool safe_mul(size_t a, size_t b, size_t *out_result) {
 }
 
 
+/*
+ * Allocation trace recorder (EM_TRACE)
+ * Encodes one event per public operation (format described next to EMTraceOp) and hands it 
+ * to the user writer. Stateless apart from the two delta registers, no buffering, no allocations.
+ * The state is process-wide by default; define EM_TRACE_TLS as a thread-local storage class 
+ * to record one independent trace per thread (matching the one-arena-per-thread model).
+ */
+#if defined(EM_TRACE) || defined(EM_WALK)
+/*
+ * Binary encoders shared by the trace recorder and the heap dump
+ * LEB128 varints and zigzag-mapped address deltas (0 is reserved for NULL).
+ */
+#define EM_VARINT_MAX   ((sizeof(uintptr_t) * 8 + 6) / 7)
+
+static inline size_t em_put_varint(uint8_t *out, uintptr_t value) {
+    size_t length = 0;
+    while (value >= 0x80) {
+        out[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (uint8_t)value;
+    return length;
+}
+
+static inline size_t em_put_address(uint8_t *out, const void *address, uintptr_t *last) {
+    if (address == NULL) return em_put_varint(out, 0);
+
+    uintptr_t delta = (uintptr_t)address - *last;  // Two's complement difference
+    uintptr_t sign = (uintptr_t)0 - (delta >> (sizeof(uintptr_t) * 8 - 1));
+    *last = (uintptr_t)address;
+
+    return em_put_varint(out, ((delta << 1) ^ sign) + 1);
+}
+#endif // EM_TRACE || EM_WALK
+
+#ifdef EM_TRACE
+#ifndef EM_TRACE_TLS
+#   define EM_TRACE_TLS
+#endif
+
+#define EM_TRACE_EVENT_MAX    (1 + 4 * EM_VARINT_MAX)
+
+static EM_TRACE_TLS EMTraceWriter em_trace_writer = NULL;
+static EM_TRACE_TLS void *em_trace_context = NULL;
+static EM_TRACE_TLS uintptr_t em_trace_last_handle = 0;
+static EM_TRACE_TLS uintptr_t em_trace_last_pointer = 0;
+
+
+static void em_trace_record(EMTraceOp op, const void *object, const void *result, size_t size, size_t extra) {
+    if (em_trace_writer == NULL) return;
+
+    uint8_t event[EM_TRACE_EVENT_MAX];
+    size_t length = em_put_varint(event, (uintptr_t)op);
+    length += em_put_address(event + length, object, &em_trace_last_handle);
+    length += em_put_address(event + length, result, 
+                                   EM_TRACE_RESULT_IS_HANDLE(op) ? &em_trace_last_handle : &em_trace_last_pointer);
+    length += em_put_varint(event + length, (uintptr_t)size);
+    length += em_put_varint(event + length, (uintptr_t)extra);
+
+    em_trace_writer(event, length, em_trace_context);
+}
+
+#   define EM_TRACE_RECORD(op, object, result, size, extra) \
+        em_trace_record((op), (const void *)(object), (const void *)(result), (size_t)(size), (size_t)(extra))
+#else
+#   define EM_TRACE_RECORD(op, object, result, size, extra) ((void)0)
+#endif // EM_TRACE
+
+/*
+ * USDT probes (EM_USDT)
+ * Every trace event is also a static probe "easy_memory:<name>" with the same arguments
+ * (object, result, size, extra) as unsigned machine words. Probe names are the EMTraceOp
+ * names in lower case without the prefix: alloc, free, create_nested, slab_alloc, ...
+ *
+ * An unattached probe is one nop plus a .note.stapsdt entry that tools (bpftrace, perf,
+ * SystemTap) read to find and patch it. <sys/sdt.h> is used when available; otherwise the
+ * same note is emitted here for GCC/Clang on x86, x86-64 and AArch64 ELF targets, and on
+ * any other target the probes compile to nothing.
+*/
+#ifdef EM_USDT
+#   if !defined(EM_USDT_NO_SDT_H) && defined(__has_include)
+#       if __has_include(<sys/sdt.h>)
+#           include <sys/sdt.h>
+#           define EM_USDT_FIRE(name, a0, a1, a2, a3) STAP_PROBE4(easy_memory, name, a0, a1, a2, a3)
+#       endif
+#   endif
+#   if !defined(EM_USDT_FIRE) && (defined(__GNUC__) || defined(__clang__)) && defined(__ELF__) && \
+       (defined(__x86_64__) || defined(__i386__) || defined(__aarch64__))
+#       if UINTPTR_MAX > 0xFFFFFFFFu
+#           define EM_USDT_ADDRESS ".8byte "
+#           define EM_USDT_ARG     "8@"
+#       else
+#           define EM_USDT_ADDRESS ".4byte "
+#           define EM_USDT_ARG     "4@"
+#       endif
+#       define EM_USDT_STRING(name) #name
+        // Layout of a SystemTap SDT v3 note: probe address, base address, semaphore (none),
+        // provider, name and argument specs. '_.stapsdt.base' lets tools detect prelinking.
+#       define EM_USDT_NOTE(name, a0, a1, a2, a3) \
+            __asm__ __volatile__( \
+                "990: nop\n" \
+                ".pushsection .note.stapsdt,\"?\",\"note\"\n" \
+                ".balign 4\n" \
+                ".4byte 992f-991f, 994f-993f, 3\n" \
+                "991: .asciz \"stapsdt\"\n" \
+                "992: .balign 4\n" \
+                "993: " EM_USDT_ADDRESS "990b\n" \
+                EM_USDT_ADDRESS "_.stapsdt.base\n" \
+                EM_USDT_ADDRESS "0\n" \
+                ".asciz \"easy_memory\"\n" \
+                ".asciz \"" EM_USDT_STRING(name) "\"\n" \
+                ".asciz \"" EM_USDT_ARG "%0 " EM_USDT_ARG "%1 " EM_USDT_ARG "%2 " EM_USDT_ARG "%3\"\n" \
+                "994: .balign 4\n" \
+                ".popsection\n" \
+                ".ifndef _.stapsdt.base\n" \
+                ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" \
+                ".weak _.stapsdt.base\n" \
+                ".hidden _.stapsdt.base\n" \
+                "_.stapsdt.base: .space 1\n" \
+                ".size _.stapsdt.base, 1\n" \
+                ".popsection\n" \
+                ".endif\n" \
+                : : "nor"(a0), "nor"(a1), "nor"(a2), "nor"(a3))
+#       define EM_USDT_FIRE(name, a0, a1, a2, a3) EM_USDT_NOTE(name, a0, a1, a2, a3)
+#   endif
+#endif // EM_USDT
+
+#ifdef EM_USDT_FIRE
+#   define EM_USDT_NAME_EM_TRACE_CREATE               create
+#   define EM_USDT_NAME_EM_TRACE_CREATE_STATIC        create_static
+#   define EM_USDT_NAME_EM_TRACE_CREATE_NESTED        create_nested
+#   define EM_USDT_NAME_EM_TRACE_CREATE_SCRATCH       create_scratch
+#   define EM_USDT_NAME_EM_TRACE_DESTROY              destroy
+#   define EM_USDT_NAME_EM_TRACE_RESET                reset
+#   define EM_USDT_NAME_EM_TRACE_RESET_ZERO           reset_zero
+#   define EM_USDT_NAME_EM_TRACE_ALLOC                alloc
+#   define EM_USDT_NAME_EM_TRACE_ALLOC_SCRATCH        alloc_scratch
+#   define EM_USDT_NAME_EM_TRACE_CALLOC               calloc
+#   define EM_USDT_NAME_EM_TRACE_FREE                 free
+#   define EM_USDT_NAME_EM_TRACE_BUMP_CREATE          bump_create
+#   define EM_USDT_NAME_EM_TRACE_BUMP_CREATE_SCRATCH  bump_create_scratch
+#   define EM_USDT_NAME_EM_TRACE_BUMP_ALLOC           bump_alloc
+#   define EM_USDT_NAME_EM_TRACE_BUMP_TRIM            bump_trim
+#   define EM_USDT_NAME_EM_TRACE_BUMP_RESET           bump_reset
+#   define EM_USDT_NAME_EM_TRACE_BUMP_DESTROY         bump_destroy
+#   define EM_USDT_NAME_EM_TRACE_SLAB_CREATE          slab_create
+#   define EM_USDT_NAME_EM_TRACE_SLAB_CREATE_SCRATCH  slab_create_scratch
+#   define EM_USDT_NAME_EM_TRACE_SLAB_ALLOC           slab_alloc
+#   define EM_USDT_NAME_EM_TRACE_SLAB_FREE            slab_free
+#   define EM_USDT_NAME_EM_TRACE_SLAB_RESET           slab_reset
+#   define EM_USDT_NAME_EM_TRACE_SLAB_RESET_ZERO      slab_reset_zero
+#   define EM_USDT_NAME_EM_TRACE_SLAB_DESTROY         slab_destroy
+#   define EM_USDT_NAME_EM_TRACE_STACK_CREATE         stack_create
+#   define EM_USDT_NAME_EM_TRACE_STACK_CREATE_SCRATCH stack_create_scratch
+#   define EM_USDT_NAME_EM_TRACE_STACK_ALLOC          stack_alloc
+#   define EM_USDT_NAME_EM_TRACE_STACK_FREE           stack_free
+#   define EM_USDT_NAME_EM_TRACE_STACK_FREE_TO_MARKER stack_free_to_marker
+#   define EM_USDT_NAME_EM_TRACE_STACK_RESET          stack_reset
+#   define EM_USDT_NAME_EM_TRACE_STACK_RESET_ZERO     stack_reset_zero
+#   define EM_USDT_NAME_EM_TRACE_STACK_DESTROY        stack_destroy
+#   define EM_USDT_NAME_EM_TRACE_HANDLES_CREATE       handles_create
+#   define EM_USDT_NAME_EM_TRACE_HANDLES_DESTROY      handles_destroy
+#   define EM_USDT_NAME_EM_TRACE_HALLOC               halloc
+#   define EM_USDT_NAME_EM_TRACE_HFREE                hfree
+#   define EM_USDT_NAME_EM_TRACE_COMPACT              compact
+#   define EM_USDT_NAME_EM_TRACE_ALLOC_NEAR           alloc_near
+#   define EM_USDT_NAME_EM_TRACE_ALLOC_SHORT          alloc_short
+    // One extra expansion level so the name macro is replaced before EM_USDT_FIRE sees it
+#   define EM_USDT_EXPAND(name, a0, a1, a2, a3) EM_USDT_FIRE(name, a0, a1, a2, a3)
+#   define EM_USDT_EVENT(op, object, result, size, extra) \
+        EM_USDT_EXPAND(EM_USDT_NAME_##op, (uintptr_t)(object), (uintptr_t)(result), (uintptr_t)(size), (uintptr_t)(extra))
+#else
+#   define EM_USDT_EVENT(op, object, result, size, extra) ((void)0)
+#endif
+
+/*
+ * Event hook at every public entry point: trace record (EM_TRACE) and USDT probe (EM_USDT).
+*/
+#define EM_TRACE_EVENT(op, object, result, size, extra) \
+    do { EM_TRACE_RECORD(op, object, result, size, extra); EM_USDT_EVENT(op, object, result, size, extra); } while (0)
+
+
 /*
  * Get reserved bits from block
  * Extracts the reserved bits information stored in the block's size_and_reserved field
@@ -1643,7 +2771,7 @@ static inline bool is_valid_magic(const Block *block, const void *user_ptr) {
  */
 static inline EM *get_em(const Block *block) {
     EM_ASSERT((block != NULL) && "Internal Error: 'get_em' called on NULL block");
-    return block->as.occupied.em; // Return easy memory pointer
+    return (EM *)((uintptr_t)block->as.occupied.em & ~EMSLAB_EM_TAG); // Return easy memory pointer (without the Slab tag)
 }
 
 /*
@@ -2002,6 +3130,19 @@ static inline void em_set_alignment(EM *em, size_t alignment) {
 }
 
 
+/*
+ * Get header size of easy memory
+ * The EM header with its extension, and with EM_FREE_TLSF the class lists of a root arena
+ */
+static inline size_t em_get_header_size(const EM *em) {
+    #ifdef EM_FREE_TLSF
+    if (((const EMExtension *)(const void *)((const char *)em + sizeof(EM)))->tlsf != NULL) return EM_HEADER_SIZE + sizeof(EMTlsf);
+    #else
+    (void)em;
+    #endif
+    return EM_HEADER_SIZE;
+}
+
 /*
  * Get first block in easy memory
  * Calculates the pointer to the first block in the easy memory based on its alignment
@@ -2022,13 +3163,303 @@ static inline Block *em_get_first_block(const EM *em) {
     */
 
     size_t align = em_get_alignment(em); // Get easy memory alignment
-    uintptr_t raw_start = (uintptr_t)em + sizeof(EM); // Calculate raw start address of the first block
+    uintptr_t raw_start = (uintptr_t)em + em_get_header_size(em); // Calculate raw start address of the first block
 
     uintptr_t aligned_start = align_up(raw_start + sizeof(Block), align) - sizeof(Block); // Align the start address to the easy memory's alignment
     
     return (Block *)aligned_start;
 }
 
+#ifdef EM_HAS_EXTENSION
+/*
+ * Get header extension of easy memory
+ * Returns the optional bookkeeping area placed right after the EM header
+ */
+static inline EMExtension *em_get_extension(EM *em) {
+    EM_ASSERT((em != NULL) && "Internal Error: 'em_get_extension' called on NULL easy memory");
+
+    return (EMExtension *)(void *)((char *)em + sizeof(EM));
+}
+#endif // EM_HAS_EXTENSION
+
+#ifdef EM_STATS
+/*
+ * Statistics counters
+ * Kept in step with the block state machine: a block is counted as live while occupied
+ * (outside the scratchpad) and as a tree block while linked into the free tree.
+ */
+static inline void em_stats_occupy(EM *em, size_t size) {
+    EMExtension *extension = em_get_extension(em);
+    extension->used_bytes += size;
+    extension->live_blocks++;
+    if (extension->used_bytes > extension->peak_used_bytes) extension->peak_used_bytes = extension->used_bytes;
+}
+
+static inline void em_stats_release(EM *em, size_t size) {
+    EMExtension *extension = em_get_extension(em);
+    extension->used_bytes -= size;
+    extension->live_blocks--;
+}
+
+static inline void em_stats_shrink(EM *em, size_t size) {
+    em_get_extension(em)->used_bytes -= size;
+}
+
+static inline void em_stats_tree_add(EM *em, const Block *block) {
+    EMExtension *extension = em_get_extension(em);
+    extension->free_tree_bytes += get_size(block);
+    extension->free_tree_blocks++;
+}
+
+static inline void em_stats_tree_remove(EM *em, const Block *block) {
+    EMExtension *extension = em_get_extension(em);
+    extension->free_tree_bytes -= get_size(block);
+    extension->free_tree_blocks--;
+}
+
+#ifdef EM_LIFETIME
+static inline void em_stats_short_hold(EM *em, const Block *block) {
+    EMExtension *extension = em_get_extension(em);
+    extension->short_held_bytes += get_size(block);
+    extension->short_held_blocks++;
+}
+
+static inline void em_stats_short_unhold(EM *em, const Block *block) {
+    EMExtension *extension = em_get_extension(em);
+    extension->short_held_bytes -= get_size(block);
+    extension->short_held_blocks--;
+}
+
+static inline void em_stats_short_clear(EM *em) {
+    EMExtension *extension = em_get_extension(em);
+    extension->short_held_bytes = 0;
+    extension->short_held_blocks = 0;
+}
+#endif // EM_LIFETIME
+
+#   define EM_STATS_OCCUPY(em, size)        em_stats_occupy((em), (size))
+#   define EM_STATS_RELEASE(em, size)       em_stats_release((em), (size))
+#   define EM_STATS_SHRINK(em, size)        em_stats_shrink((em), (size))
+#   define EM_STATS_TREE_ADD(em, block)     em_stats_tree_add((em), (block))
+#   define EM_STATS_TREE_REMOVE(em, block)  em_stats_tree_remove((em), (block))
+#   define EM_STATS_SHORT_HOLD(em, block)   em_stats_short_hold((em), (block))
+#   define EM_STATS_SHORT_UNHOLD(em, block) em_stats_short_unhold((em), (block))
+#   define EM_STATS_SHORT_CLEAR(em)         em_stats_short_clear(em)
+#else
+#   define EM_STATS_OCCUPY(em, size)        ((void)0)
+#   define EM_STATS_RELEASE(em, size)       ((void)0)
+#   define EM_STATS_SHRINK(em, size)        ((void)0)
+#   define EM_STATS_TREE_ADD(em, block)     ((void)0)
+#   define EM_STATS_TREE_REMOVE(em, block)  ((void)0)
+#   define EM_STATS_SHORT_HOLD(em, block)   ((void)0)
+#   define EM_STATS_SHORT_UNHOLD(em, block) ((void)0)
+#   define EM_STATS_SHORT_CLEAR(em)         ((void)0)
+#endif // EM_STATS
+
+#ifdef EM_VERIFY
+/*
+ * Verification cursor upkeep
+ * em_verify_step resumes from a block header, so every path that dissolves a header
+ * (merges, tail absorption) hands the cursor over to the block that swallowed it.
+ */
+static inline void em_verify_forget(EM *em, const Block *dead, Block *survivor) {
+    EMExtension *extension = em_get_extension(em);
+    if (extension->verify_cursor == dead) extension->verify_cursor = survivor;
+}
+
+#   define EM_VERIFY_FORGET(em, dead, survivor) em_verify_forget((em), (dead), (survivor))
+#   define EM_VERIFY_RESTART(em)                (em_get_extension(em)->verify_cursor = NULL)
+#else
+#   define EM_VERIFY_FORGET(em, dead, survivor) ((void)0)
+#   define EM_VERIFY_RESTART(em)                ((void)0)
+#endif // EM_VERIFY
+
+#ifdef EM_HANDLES
+/*
+ * Compaction cursor upkeep
+ * em_compact resumes from a block header too, and hands its cursor over the same way.
+ */
+static inline void em_compact_forget(EM *em, const Block *dead, Block *survivor) {
+    EMHandleTable *table = em_get_extension(em)->handles;
+    if (table != NULL && table->cursor == dead) table->cursor = survivor;
+}
+
+#   define EM_COMPACT_FORGET(em, dead, survivor) em_compact_forget((em), (dead), (survivor))
+#else
+#   define EM_COMPACT_FORGET(em, dead, survivor) ((void)0)
+#endif // EM_HANDLES
+
+#ifdef EM_BULK_ZERO
+/*
+ * Bulk zeroing engine (EM_BULK_ZERO)
+ * Ranges past EM_BULK_ZERO_THRESHOLD are cleared with non-temporal stores: whole cache lines
+ * go straight to memory instead of evicting the working set, which is what a multi-megabyte
+ * reset_zero at a frame boundary otherwise does. SSE2 is the x86 baseline; AVX2 is picked at
+ * run time where GCC/Clang can compile it on demand. Other targets keep memset, whose libc
+ * versions already switch to streaming or DC ZVA paths for large sizes.
+ */
+#ifndef EM_BULK_ZERO_THRESHOLD
+#   define EM_BULK_ZERO_THRESHOLD ((size_t)8 << 20)
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define EM_BULK_ZERO_SSE2
+#   if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#       include <immintrin.h>
+#       define EM_BULK_ZERO_AVX2
+#   endif
+#endif
+
+#define EM_BULK_ZERO_LINE 64
+
+static EMZeroWorkers em_zero_workers = NULL;
+static void *em_zero_context = NULL;
+static size_t em_zero_min_size = 0;
+
+#ifdef EM_BULK_ZERO_SSE2
+static void em_stream_zero_sse2(char *lines, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    for (size_t i = 0; i < count; i++, lines += EM_BULK_ZERO_LINE) {
+        _mm_stream_si128((__m128i *)(void *)lines, zero);
+        _mm_stream_si128((__m128i *)(void *)(lines + 16), zero);
+        _mm_stream_si128((__m128i *)(void *)(lines + 32), zero);
+        _mm_stream_si128((__m128i *)(void *)(lines + 48), zero);
+    }
+}
+#endif // EM_BULK_ZERO_SSE2
+
+#ifdef EM_BULK_ZERO_AVX2
+__attribute__((target("avx2")))
+static void em_stream_zero_avx2(char *lines, size_t count) {
+    const __m256i zero = _mm256_setzero_si256();
+    for (size_t i = 0; i < count; i++, lines += EM_BULK_ZERO_LINE) {
+        _mm256_stream_si256((__m256i *)(void *)lines, zero);
+        _mm256_stream_si256((__m256i *)(void *)(lines + 32), zero);
+    }
+}
+#endif // EM_BULK_ZERO_AVX2
+
+/*
+ * Zero a reset_zero range: through the installed workers when it is large enough
+ */
+static inline void em_zero_dispatch(void *data, size_t size) {
+    if (em_zero_workers != NULL && size >= em_zero_min_size) {
+        em_zero_workers(data, size, em_zero_context);
+        return;
+    }
+    em_bulk_zero(data, size);
+}
+
+#   define EM_ZERO_BULK(data, size)     em_zero_dispatch((data), (size))
+#else
+#   define EM_ZERO_BULK(data, size)     memset((data), 0, (size))
+#endif // EM_BULK_ZERO
+
+#ifdef EM_DIRTY_TRACKING
+/*
+ * Clean window upkeep
+ * Every byte in [clean_start, clean_end) is zero, except for the headers of live blocks.
+ * Handing memory out or writing into it raises clean_start past the written range; the
+ * scratchpad writes at the very end and lowers clean_end instead. A header that dissolves
+ * inside the window (merge, tail absorption) is zeroed on the spot, 4 words instead of
+ * giving up the window. An empty window (clean_start >= clean_end) means "all dirty".
+ */
+static inline void em_dirty_touch(EM *em, uintptr_t start, uintptr_t end) {
+    EMExtension *extension = em_get_extension(em);
+    if (start < extension->clean_end && end > extension->clean_start) {
+        extension->clean_start = (end < extension->clean_end) ? end : extension->clean_end;
+    }
+}
+
+static inline void em_dirty_clip(EM *em, uintptr_t start) {
+    EMExtension *extension = em_get_extension(em);
+    if (start < extension->clean_end) extension->clean_end = start;
+}
+
+static inline void em_dirty_drop_header(EM *em, Block *header) {
+    EMExtension *extension = em_get_extension(em);
+    uintptr_t address = (uintptr_t)header;
+    if (address < extension->clean_end && address + sizeof(Block) > extension->clean_start) {
+        memset(header, 0, sizeof(Block));
+    }
+}
+
+/*
+ * Zero [start, start + size), skipping the part that overlaps the clean window.
+ * 'bulk' routes the writes through the reset_zero engine (EM_ZERO_BULK).
+ */
+static inline void em_dirty_zero(EM *em, uintptr_t start, size_t size, bool bulk) {
+    EMExtension *extension = em_get_extension(em);
+    uintptr_t end = start + size;
+    uintptr_t clean_from = (start > extension->clean_start) ? start : extension->clean_start;
+    uintptr_t clean_to = (end < extension->clean_end) ? end : extension->clean_end;
+
+    if (clean_from >= clean_to) clean_from = clean_to = end;
+
+    if (bulk) {
+        EM_ZERO_BULK((void *)start, clean_from - start);
+        EM_ZERO_BULK((void *)clean_to, end - clean_to);
+        return;
+    }
+    memset((void *)start, 0, clean_from - start);
+    memset((void *)clean_to, 0, end - clean_to);
+}
+
+/*
+ * [start, end) was just zeroed: widen the window over it when the two touch
+ */
+static inline void em_dirty_zeroed(EM *em, uintptr_t start, uintptr_t end) {
+    EMExtension *extension = em_get_extension(em);
+    if (extension->clean_start >= extension->clean_end) {
+        extension->clean_start = start;
+        extension->clean_end = end;
+        return;
+    }
+    if (start <= extension->clean_start && end >= extension->clean_start) extension->clean_start = start;
+    if (end >= extension->clean_end && start <= extension->clean_end) extension->clean_end = end;
+}
+
+/*
+ * Zero a whole region for a reset_zero path: only its dirty part is written
+ */
+static inline void em_dirty_reset_zero(EM *em, void *data, size_t size) {
+    em_dirty_zero(em, (uintptr_t)data, size, true);
+    em_dirty_zeroed(em, (uintptr_t)data, (uintptr_t)data + size);
+}
+
+#   define EM_DIRTY_TOUCH(em, start, end)      em_dirty_touch((em), (uintptr_t)(start), (uintptr_t)(end))
+#   define EM_DIRTY_CLIP(em, start)            em_dirty_clip((em), (uintptr_t)(start))
+#   define EM_DIRTY_DROP_HEADER(em, header)    em_dirty_drop_header((em), (header))
+#   define EM_RESET_ZERO(em, data, size)       em_dirty_reset_zero((em), (data), (size))
+#else
+#   define EM_DIRTY_TOUCH(em, start, end)      ((void)0)
+#   define EM_DIRTY_CLIP(em, start)            ((void)0)
+#   define EM_DIRTY_DROP_HEADER(em, header)    ((void)0)
+#   define EM_RESET_ZERO(em, data, size)       EM_ZERO_BULK((data), (size))
+#endif // EM_DIRTY_TRACKING
+
+#ifdef EM_PROFILE
+/*
+ * Profiling counters
+ * The free-tree walkers take the profile as an extra parameter only in profiling builds
+ * (EM_PROFILE_PARAM / EM_PROFILE_ARG), so the regular build keeps their original code.
+ */
+static inline void em_profile_path(size_t *calls, size_t *total, size_t *max, size_t length) {
+    (*calls)++;
+    *total += length;
+    if (length > *max) *max = length;
+}
+
+#   define EM_PROFILE_COUNT(em, counter)  (em_get_extension(em)->profile.counter++)
+#   define EM_PROFILE_PARAM               , EMProfile *profile
+#   define EM_PROFILE_ARG(em)             , &em_get_extension(em)->profile
+#else
+#   define EM_PROFILE_COUNT(em, counter)  ((void)0)
+#   define EM_PROFILE_PARAM
+#   define EM_PROFILE_ARG(em)
+#endif // EM_PROFILE
+
 
 
 
@@ -2288,7 +3719,7 @@ static inline EM *slab_get_em(const Slab *slab) {
 static inline void slab_set_em(Slab *slab, EM *em) {
     EM_ASSERT((slab != NULL)  && "Internal Error: 'slab_set_em' called on NULL slab");
     EM_ASSERT((em != NULL)    && "Internal Error: 'slab_set_em' called on NULL easy memory");
-    set_em(&(slab->as.block_representation), em); // Set pointer to the parent easy memory
+    slab->as.self.em = (EM *)((uintptr_t)em | EMSLAB_EM_TAG); // Set tagged pointer to the parent easy memory
 }
 
 
@@ -2409,7 +3840,7 @@ static inline size_t stack_calculate_meta_type(size_t capacity) {
  * Fetches the relative offset stored at the specified index.
  * Adapts to the stack's dynamic bit-width using compile-time guarded type casting.
  */
-static inline size_t stack_read_meta(Stack *stack, size_t meta_type, size_t index) {
+static inline size_t stack_read_meta(const Stack *stack, size_t meta_type, size_t index) {
     uintptr_t end_of_stack_header = (uintptr_t)stack + sizeof(Stack);
     uint8_t *meta8 = (uint8_t *)(void *)end_of_stack_header;
     uint16_t *meta16 = (uint16_t *)(void *)end_of_stack_header;
@@ -2497,6 +3928,12 @@ static inline size_t free_size_in_tail(const EM *em) {
     if (!tail || !get_is_free(tail)) return 0;  // If tail is NULL or not free, that means no free space in tail
 
     size_t occupied_relative_to_em = (uintptr_t)tail + sizeof(Block) + get_size(tail) - (uintptr_t)em;
+
+    #ifdef EM_LIFETIME
+    // The short-lived region sits on top of the free space, the tail ends at its floor
+    const Block *short_floor = ((const EMExtension *)(const void *)((const char *)em + sizeof(EM)))->short_floor;
+    if (short_floor != NULL) return (size_t)((uintptr_t)short_floor - (uintptr_t)em) - occupied_relative_to_em;
+    #endif
     
     size_t em_capacity = em_get_capacity(em);
 
@@ -2570,6 +4007,7 @@ static inline Block *create_block(void *point) {
     EM_ASSERT((point != NULL) && "Internal Error: 'create_block' called on NULL pointer");
     
     Block *block = (Block *)point;
+    EM_ASAN_UNPOISON(block, sizeof(Block)); // New headers are carved out of poisoned free space
     
     block->size_and_reserved = 0;
     block->prev = NULL;
@@ -2620,6 +4058,10 @@ static inline void merge_blocks_logic(EM *em, Block *target, Block *source) {
     EM_ASSERT((source != NULL)  && "Internal Error: 'merge_blocks_logic' called on NULL source");
     EM_ASSERT((next_block_unsafe(target) == source) && "Internal Error: 'merge_blocks_logic' called with non-adjacent blocks");
 
+    EM_PROFILE_COUNT(em, merges);
+    EM_VERIFY_FORGET(em, source, target);
+    EM_COMPACT_FORGET(em, source, target);
+
     size_t new_size = get_size(target) + sizeof(Block) + get_size(source);
     set_size(target, new_size);
 
@@ -2627,11 +4069,92 @@ static inline void merge_blocks_logic(EM *em, Block *target, Block *source) {
     if (following) {
         set_prev(following, target);
     }
+    EM_DIRTY_DROP_HEADER(em, source);
+}
+
+
+
+
+
+#ifdef EM_FREE_TREE_AUGMENT
+/*
+ * Constant: Tree Quality Cap (EM_FREE_TREE_AUGMENT)
+ * Alignment quality is the exponent of the largest power of two dividing a block's data
+ * pointer. No request is aligned beyond EMMAX_ALIGNMENT, so qualities are capped at its
+ * exponent, which keeps them within the reserved bits of a free block.
+*/
+#define EMTREE_QUALITY_MAX ((size_t)(8 + EMMIN_EXPONENT))
+EM_STATIC_ASSERT(EMTREE_QUALITY_MAX <= EMALL_RESERVED_MASK, "Tree quality must fit into the reserved bits.");
+
+static inline size_t tree_quality_of(const Block *block) {
+    size_t quality = min_exponent_of((uintptr_t)block_data(block));
+    return quality < EMTREE_QUALITY_MAX ? quality : EMTREE_QUALITY_MAX;
+}
+
+/*
+ * Subtree bound (EM_FREE_TREE_AUGMENT)
+ * The reserved bits of a free tree node hold an upper bound on the alignment quality of
+ * every node below it, itself included. Rotations and inserts recompute it from the
+ * children; a detach may leave the ancestors of the removed node with a stale, higher
+ * bound, which only makes the search prune less.
+*/
+static inline size_t get_tree_bound(const Block *block) {
+    return (block != NULL) ? get_reserved_bits(block) : 0;
+}
+
+static inline void update_tree_bound(Block *block) {
+    size_t bound = tree_quality_of(block);
+    size_t left = get_tree_bound(get_left_tree(block));
+    size_t right = get_tree_bound(get_right_tree(block));
+    if (left > bound) bound = left;
+    if (right > bound) bound = right;
+    set_reserved_bits(block, bound);
 }
 
+/*
+ * Recompute every bound after rebuild_tree, children first
+ * The rebuilt tree is complete, so its height stays far below EM_MAX_TREE_HEIGHT.
+ */
+static void refresh_tree_bounds(Block *root) {
+    Block *path[EM_MAX_TREE_HEIGHT];
+    size_t depth = 0;
+    Block *current = root;
+    Block *last = NULL;
 
+    while (current != NULL || depth > 0) {
+        if (current != NULL) {
+            EM_ASSERT((depth < EM_MAX_TREE_HEIGHT) && "Internal Error: 'refresh_tree_bounds' called on an unbalanced tree");
+            path[depth++] = current;
+            current = get_left_tree(current);
+            continue;
+        }
+        Block *top = path[depth - 1];
+        if (get_right_tree(top) != NULL && get_right_tree(top) != last) {
+            current = get_right_tree(top);
+        } else {
+            update_tree_bound(top);
+            last = top;
+            depth--;
+        }
+    }
+}
 
+/*
+ * Can a subtree hold the request at all?
+ * 'upper' bounds the sizes in the subtree. A node whose quality is below the alignment
+ * exponent needs padding, and padding comes in multiples of EMMIN_ALIGNMENT.
+ */
+static inline bool tree_may_fit(const Block *subtree, size_t upper, size_t size, size_t alignment) {
+    size_t padding = (get_tree_bound(subtree) < min_exponent_of(alignment)) ? EMMIN_ALIGNMENT : 0;
+    return upper >= size + padding;
+}
 
+#   define EM_TREE_BOUND_UPDATE(block) update_tree_bound(block)
+#   define EM_TREE_BOUND_CLEAR(block)  set_reserved_bits((block), 0)
+#else
+#   define EM_TREE_BOUND_UPDATE(block) ((void)0)
+#   define EM_TREE_BOUND_CLEAR(block)  ((void)0)
+#endif // EM_FREE_TREE_AUGMENT
 
 /*
  * Rotate left
@@ -2647,6 +4170,9 @@ static inline Block *rotateLeft(Block *current_block) {
     set_color(x, get_color(current_block));
     set_color(current_block, EMRED);
 
+    EM_TREE_BOUND_UPDATE(current_block);
+    EM_TREE_BOUND_UPDATE(x);
+
     return x;
 }
 
@@ -2664,6 +4190,9 @@ static inline Block *rotateRight(Block *current_block) {
     set_color(x, get_color(current_block));
     set_color(current_block, EMRED);
 
+    EM_TREE_BOUND_UPDATE(current_block);
+    EM_TREE_BOUND_UPDATE(x);
+
     return x;
 }
 
@@ -2750,14 +4279,80 @@ static inline int compare_blocks(Block *a, Block *b) {
     return ((uintptr_t)a > (uintptr_t)b) ? -1 : 1;
 }
 
+/*
+ * Fold the first 'count' nodes of a right vine into left children (one DSW compression pass)
+ */
+static void compress_vine(Block *pseudo_root, size_t count, bool red_leaves) {
+    Block *scanner = pseudo_root;
+    for (size_t i = 0; i < count; i++) {
+        Block *child = get_right_tree(scanner);
+        set_right_tree(scanner, get_right_tree(child));
+        scanner = get_right_tree(scanner);
+        set_right_tree(child, get_left_tree(scanner));
+        set_left_tree(scanner, child);
+        if (red_leaves) set_color(child, EMRED);
+    }
+}
+
+/*
+ * Rebuild the free tree into a balanced red-black tree (Day-Stout-Warren)
+ * detach_block_fast trades balance for speed, so a long run of unlucky frees can grow the
+ * tree beyond EM_MAX_TREE_HEIGHT. insert_block calls this before its path stack would
+ * overflow: the tree is flattened into a sorted right vine and folded back into a complete
+ * tree, iteratively, in O(n) time and O(1) space. Every node is black except the partial
+ * bottom level, whose nodes are red leaves; the next inserts lean them left again.
+ */
+static Block *rebuild_tree(Block *root) {
+    Block pseudo_root;
+    set_left_tree(&pseudo_root, NULL);
+    set_right_tree(&pseudo_root, root);
+
+    // Tree to vine: rotate right until no node has a left child
+    Block *vine_tail = &pseudo_root;
+    Block *rest = root;
+    size_t count = 0;
+    while (rest != NULL) {
+        Block *left = get_left_tree(rest);
+        if (left == NULL) {
+            set_color(rest, EMBLACK);
+            vine_tail = rest;
+            rest = get_right_tree(rest);
+            count++;
+        } else {
+            set_left_tree(rest, get_right_tree(left));
+            set_right_tree(left, rest);
+            rest = left;
+            set_right_tree(vine_tail, left);
+        }
+    }
+
+    // Vine to tree: the first pass builds the partial bottom level, the others halve the spine
+    size_t full = 1;
+    while (full <= (count + 1) / 2) full <<= 1;
+    compress_vine(&pseudo_root, count + 1 - full, true);
+    for (size_t spine = full - 1; spine > 1;) {
+        spine /= 2;
+        compress_vine(&pseudo_root, spine, false);
+    }
+
+    #ifdef EM_FREE_TREE_AUGMENT
+    refresh_tree_bounds(get_right_tree(&pseudo_root));
+    #endif
+    return get_right_tree(&pseudo_root);
+}
+
 /*
  * Insert block into LLRB tree
  * Inserts a new free block iteratively based on size, alignment, and address
  */
-static Block *insert_block(Block *h, Block *new_block) {
+static Block *insert_block(Block *h, Block *new_block EM_PROFILE_PARAM) {
     EM_ASSERT((new_block != NULL) && "Internal Error: 'insert_block' called on NULL new_block");
 
+    EM_TREE_BOUND_UPDATE(new_block);
     if (h == NULL) {
+        #ifdef EM_PROFILE
+        em_profile_path(&profile->insert_calls, &profile->insert_depth_total, &profile->insert_depth_max, 0);
+        #endif
         set_color(new_block, EMBLACK);
         return new_block;
     }
@@ -2771,7 +4366,16 @@ static Block *insert_block(Block *h, Block *new_block) {
      * Descend the tree to find the insertion point, saving the path.
      */
     while (current != NULL) {
-        EM_ASSERT((depth < EM_MAX_TREE_HEIGHT) && "Internal Error: LLRB max depth exceeded");
+        if (depth == EM_MAX_TREE_HEIGHT) {
+            // The path stack is full: rebalance the whole tree and descend again
+            #ifdef EM_PROFILE
+            profile->tree_rebuilds++;
+            #endif
+            h = rebuild_tree(h);
+            current = h;
+            depth = 0;
+            continue;
+        }
         path[depth++] = current;
         
         if (compare_blocks(new_block, current) < 0) {
@@ -2787,6 +4391,10 @@ static Block *insert_block(Block *h, Block *new_block) {
      */
     set_color(new_block, EMRED);
     Block *parent = path[depth - 1];
+    #ifdef EM_PROFILE
+    em_profile_path(&profile->insert_calls, &profile->insert_depth_total, &profile->insert_depth_max, depth);
+    #endif
+    EM_COST_PROBE(EM_COST_INSERT_DEPTH, depth);
     
     if (compare_blocks(new_block, parent) < 0) {
         set_left_tree(parent, new_block);
@@ -2801,6 +4409,7 @@ static Block *insert_block(Block *h, Block *new_block) {
     for (size_t i = depth; i-- > 0;) {
         Block *node = path[i];
         Block *balanced = balance(node);
+        EM_TREE_BOUND_UPDATE(balanced);
 
         if (i > 0) {
             Block *upper_parent = path[i - 1];
@@ -2828,6 +4437,8 @@ static Block *insert_block(Block *h, Block *new_block) {
  * Strategy: 
  *   The tree is ordered primarily by size, and secondarily by "address quality" (CTZ).
  *   We aim to find the smallest block that satisfies: block_size >= requested_size + alignment_padding.
+ *   With EM_FREE_TREE_AUGMENT the walk stops as soon as the subtree bounds rule out a fit,
+ *   which never changes the block it returns.
  *   Performance: O(log n)
  */
 static Block *find_best_fit(Block *root, size_t size, size_t alignment, Block **out_parent) {
@@ -2843,8 +4454,21 @@ static Block *find_best_fit(Block *root, size_t size, size_t alignment, Block **
     Block *best_parent = NULL;
     Block *current = root;
     Block *current_parent = NULL;
+    #ifdef EM_HAS_COST_PROBE
+    size_t visited = 0;
+    #endif
+    #ifdef EM_FREE_TREE_AUGMENT
+    size_t upper = SIZE_MAX;  // Bound on the sizes below 'current': the last node we went left at
+    #endif
 
     while (current != NULL) {
+        #ifdef EM_FREE_TREE_AUGMENT
+        // Nothing below can hold the request: the walk would only end at a NULL link
+        if (!tree_may_fit(current, upper, size, alignment)) break;
+        #endif
+        #ifdef EM_HAS_COST_PROBE
+        visited++;
+        #endif
         size_t current_size = get_size(current);
         
         /* 
@@ -2879,6 +4503,9 @@ static Block *find_best_fit(Block *root, size_t size, size_t alignment, Block **
             // Look for a smaller block in the left sub-tree.
             current_parent = current;
             current = get_left_tree(current);
+            #ifdef EM_FREE_TREE_AUGMENT
+            upper = current_size;
+            #endif
         }
 
         /* 
@@ -2893,6 +4520,7 @@ static Block *find_best_fit(Block *root, size_t size, size_t alignment, Block **
         }
     }
 
+    EM_COST_PROBE(EM_COST_SEARCH_DEPTH, visited);
     if (out_parent) *out_parent = best_parent;
     return best;
 }
@@ -2924,8 +4552,10 @@ static void detach_block_fast(Block **tree_root, Block *target, Block *parent) {
         if (min_parent != target) {
             set_left_tree(min_parent, get_right_tree(min_node));
             set_right_tree(min_node, right_child);
+            EM_TREE_BOUND_UPDATE(min_parent);
         }
         set_left_tree(min_node, left_child);
+        EM_TREE_BOUND_UPDATE(min_node);
         replacement = min_node;
     }
 
@@ -2941,6 +4571,7 @@ static void detach_block_fast(Block **tree_root, Block *target, Block *parent) {
     set_left_tree(target, NULL);
     set_right_tree(target, NULL);
     set_color(target, EMRED);
+    EM_TREE_BOUND_CLEAR(target);
     
     if (*tree_root) *tree_root = balance(*tree_root);
 }
@@ -2973,7 +4604,7 @@ static Block *find_and_detach_block(Block **tree_root, size_t size, size_t align
  * Detach a specific block by its pointer
  * Finds the parent of the given block using Triple-Key logic and detaches it.
  */
-static void detach_block_by_ptr(Block **tree_root, Block *target) {
+static void detach_block_by_ptr(Block **tree_root, Block *target EM_PROFILE_PARAM) {
     EM_ASSERT((tree_root != NULL) && "Internal Error: 'detach_block_by_ptr' called on NULL tree_root");
     EM_ASSERT((target != NULL) && "Internal Error: 'detach_block_by_ptr' called on NULL target");
 
@@ -2983,7 +4614,14 @@ static void detach_block_by_ptr(Block **tree_root, Block *target) {
     size_t target_size = get_size(target);
     size_t target_quality = min_exponent_of((uintptr_t)block_data(target));
 
+    #if defined(EM_PROFILE) || defined(EM_HAS_COST_PROBE)
+    size_t path_length = 0;
+    #endif
+
     while (current != NULL && current != target) {
+        #if defined(EM_PROFILE) || defined(EM_HAS_COST_PROBE)
+        path_length++;
+        #endif
         parent = current;
         size_t current_size = get_size(current);
 
@@ -3006,38 +4644,691 @@ static void detach_block_by_ptr(Block **tree_root, Block *target) {
         }
     }
 
+    #ifdef EM_PROFILE
+    em_profile_path(&profile->detach_calls, &profile->detach_path_total, &profile->detach_path_max, path_length);
+    #endif
+    EM_COST_PROBE(EM_COST_DETACH_DEPTH, path_length);
+
     if (current == target) {
         detach_block_fast(tree_root, target, parent);
     }
 }
 
-static void em_free_block_full(EM *em, Block *block);
-/*
- * Split block
- * Splits a larger free block into two blocks if it is significantly larger than needed
- * The remainder block is added back to the free blocks tree
- */
-static inline void split_block(EM *em, Block *block, size_t needed_size) {
-    size_t full_size = get_size(block);
-    
-    if (full_size > needed_size && full_size - needed_size >= EMBLOCK_MIN_SIZE) {
-        set_size(block, needed_size);
-
-        Block *remainder = create_block(next_block_unsafe(block)); 
-        set_prev(remainder, block);
-        set_size(remainder, full_size - needed_size - sizeof(Block));
-        
-        Block *following = next_block(em, remainder);
-        if (following) {
-            set_prev(following, remainder);
-        }
+#ifdef EM_FREE_INDEX
+/*
+ * Free index node search (EM_FREE_INDEX)
+ * The rank of a size among the sizes of a node is the number of slots holding a smaller
+ * size. Slots are sorted and unused ones hold UINTPTR_MAX, so one SIMD compare over the
+ * whole line gives the position of the first key of at least that size.
+ */
+#if UINTPTR_MAX == UINT64_MAX && defined(__AVX2__)
+#   include <immintrin.h>
+#   define EM_INDEX_AVX2
+#elif UINTPTR_MAX == UINT64_MAX && defined(__SSE4_2__)
+#   include <nmmintrin.h>
+#   define EM_INDEX_SSE42
+#elif UINTPTR_MAX == UINT64_MAX && defined(__aarch64__) && defined(__ARM_NEON)
+#   include <arm_neon.h>
+#   define EM_INDEX_NEON
+#elif UINTPTR_MAX == UINT32_MAX && (defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#   include <emmintrin.h>
+#   define EM_INDEX_SSE2
+#endif
 
-        em_free_block_full(em, remainder);
+#define EM_INDEX_MIN  (EM_INDEX_FANOUT / 2)
+
+static inline size_t em_index_below(const uintptr_t *sizes, uintptr_t size) {
+    #if defined(EM_INDEX_AVX2)
+    const __m256i bias = _mm256_set1_epi64x(INT64_MIN);  // Unsigned order through signed compares
+    __m256i key = _mm256_xor_si256(_mm256_set1_epi64x((long long)size), bias);
+    __m256i low = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(const void *)sizes), bias);
+    __m256i high = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(const void *)(sizes + 4)), bias);
+    int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(key, low))) |
+               (_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(key, high))) << 4);
+    return min_exponent_of(~(size_t)(unsigned)mask);  // Sorted slots: the mask is a run of low bits
+    #elif defined(EM_INDEX_SSE42)
+    const __m128i bias = _mm_set1_epi64x(INT64_MIN);
+    __m128i key = _mm_xor_si128(_mm_set1_epi64x((long long)size), bias);
+    int mask = 0;
+    for (int i = 0; i < EM_INDEX_FANOUT / 2; i++) {
+        __m128i pair = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(const void *)(sizes + 2 * i)), bias);
+        mask |= _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(key, pair))) << (2 * i);
     }
+    return min_exponent_of(~(size_t)(unsigned)mask);
+    #elif defined(EM_INDEX_NEON)
+    uint64x2_t key = vdupq_n_u64((uint64_t)size);
+    const uint64_t *lanes = (const uint64_t *)(const void *)sizes;
+    int64x2_t sum = vdupq_n_s64(0);
+    for (int i = 0; i < EM_INDEX_FANOUT / 2; i++) {
+        sum = vaddq_s64(sum, vreinterpretq_s64_u64(vcltq_u64(vld1q_u64(lanes + 2 * i), key)));  // -1 per smaller slot
+    }
+    return (size_t)(-vaddvq_s64(sum));
+    #elif defined(EM_INDEX_SSE2)
+    const __m128i bias = _mm_set1_epi32(INT32_MIN);
+    __m128i key = _mm_xor_si128(_mm_set1_epi32((int)size), bias);
+    __m128i low = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(const void *)sizes), bias);
+    __m128i high = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(const void *)(sizes + 4)), bias);
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(key, low))) |
+               (_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(key, high))) << 4);
+    return min_exponent_of(~(size_t)(unsigned)mask);
+    #else
+    size_t below = 0;
+    for (size_t i = 0; i < EM_INDEX_FANOUT; i++) below += (size_t)(sizes[i] < size);
+    return below;
+    #endif
 }
 
 /*
- * Get the easy memory that owns this block
+ * Position of the first key not below (size, block), and of the first key above it
+ */
+static inline size_t em_index_lower(const EMIndexNode *node, uintptr_t size, uintptr_t block) {
+    size_t i = em_index_below(node->sizes, size);
+    while (i < node->count && node->sizes[i] == size && node->blocks[i] < block) i++;
+    return i;
+}
+
+static inline size_t em_index_upper(const EMIndexNode *node, uintptr_t size, uintptr_t block) {
+    size_t i = em_index_below(node->sizes, size);
+    while (i < node->count && node->sizes[i] == size && node->blocks[i] <= block) i++;
+    return i;
+}
+
+static EMIndexNode *em_index_node_new(EMFreeIndex *index) {
+    EMIndexNode *node = index->recycled;
+    if (node != NULL) index->recycled = node->next;
+    else node = index->unused++;
+    index->available--;
+
+    for (size_t i = 0; i < EM_INDEX_FANOUT; i++) {
+        node->sizes[i] = UINTPTR_MAX;
+        node->blocks[i] = 0;
+        node->children[i] = NULL;
+    }
+    node->next = NULL;
+    node->count = 0;
+    return node;
+}
+
+static inline void em_index_node_release(EMFreeIndex *index, EMIndexNode *node) {
+    node->next = index->recycled;
+    index->recycled = node;
+    index->available++;
+}
+
+/*
+ * Open slot 'at' (shifting the slots above it) and fill it
+ */
+static inline void em_index_put(EMIndexNode *node, size_t at, uintptr_t size, uintptr_t block, EMIndexNode *child) {
+    for (size_t i = node->count; i > at; i--) {
+        node->sizes[i] = node->sizes[i - 1];
+        node->blocks[i] = node->blocks[i - 1];
+        node->children[i] = node->children[i - 1];
+    }
+    node->sizes[at] = size;
+    node->blocks[at] = block;
+    node->children[at] = child;
+    node->count++;
+}
+
+/*
+ * Close slot 'at' (shifting the slots above it down)
+ */
+static inline void em_index_cut(EMIndexNode *node, size_t at) {
+    node->count--;
+    for (size_t i = at; i < node->count; i++) {
+        node->sizes[i] = node->sizes[i + 1];
+        node->blocks[i] = node->blocks[i + 1];
+        node->children[i] = node->children[i + 1];
+    }
+    node->sizes[node->count] = UINTPTR_MAX;
+    node->blocks[node->count] = 0;
+    node->children[node->count] = NULL;
+}
+
+/*
+ * Move the upper half of a full node into an empty one
+ */
+static inline void em_index_move_half(EMIndexNode *node, EMIndexNode *right) {
+    for (size_t i = EM_INDEX_MIN; i < EM_INDEX_FANOUT; i++) {
+        right->sizes[i - EM_INDEX_MIN] = node->sizes[i];
+        right->blocks[i - EM_INDEX_MIN] = node->blocks[i];
+        right->children[i - EM_INDEX_MIN] = node->children[i];
+        node->sizes[i] = UINTPTR_MAX;
+        node->blocks[i] = 0;
+        node->children[i] = NULL;
+    }
+    node->count = EM_INDEX_MIN;
+    right->count = EM_INDEX_FANOUT - EM_INDEX_MIN;
+}
+
+/*
+ * Insert a free block into the index
+ * Returns false, leaving the index untouched, when the splits it needs would exhaust the pool.
+ */
+static bool em_index_insert(EMFreeIndex *index, uintptr_t size, uintptr_t block) {
+    if (index->root == NULL) {
+        if (index->available == 0) return false;
+        index->root = em_index_node_new(index);
+        index->height = 1;
+    }
+
+    EMIndexNode *path[EM_INDEX_MAX_HEIGHT];
+    size_t slot[EM_INDEX_MAX_HEIGHT];
+    EMIndexNode *node = index->root;
+    for (size_t level = 0; level + 1 < index->height; level++) {
+        path[level] = node;
+        slot[level] = em_index_upper(node, size, block) - 1;
+        node = node->children[slot[level]];
+    }
+
+    if (node->count == EM_INDEX_FANOUT) {
+        // A split climbs through every full ancestor and may add a root
+        size_t needed = 1;
+        size_t level = index->height - 1;
+        while (level > 0 && path[level - 1]->count == EM_INDEX_FANOUT) {
+            needed++;
+            level--;
+        }
+        if (level == 0) needed++;
+        if (index->available < needed || (level == 0 && index->height == EM_INDEX_MAX_HEIGHT)) return false;
+    }
+
+    index->count++;
+    size_t at = em_index_lower(node, size, block);
+    if (node->count < EM_INDEX_FANOUT) {
+        em_index_put(node, at, size, block, NULL);
+        return true;
+    }
+
+    // Leaf split: the right half is linked after the left one and its first key goes up
+    EMIndexNode *right = em_index_node_new(index);
+    em_index_move_half(node, right);
+    right->next = node->next;
+    node->next = right;
+    if (at <= EM_INDEX_MIN) em_index_put(node, at, size, block, NULL);
+    else em_index_put(right, at - EM_INDEX_MIN, size, block, NULL);
+
+    uintptr_t separator_size = right->sizes[0];
+    uintptr_t separator_block = right->blocks[0];
+    EMIndexNode *separator_child = right;
+
+    for (size_t level = index->height - 1; level-- > 0;) {
+        EMIndexNode *parent = path[level];
+        at = slot[level] + 1;
+        if (parent->count < EM_INDEX_FANOUT) {
+            em_index_put(parent, at, separator_size, separator_block, separator_child);
+            return true;
+        }
+
+        // Internal split: the first separator of the right half goes up, its slot becomes the sentinel
+        right = em_index_node_new(index);
+        em_index_move_half(parent, right);
+        if (at <= EM_INDEX_MIN) em_index_put(parent, at, separator_size, separator_block, separator_child);
+        else em_index_put(right, at - EM_INDEX_MIN, separator_size, separator_block, separator_child);
+
+        separator_size = right->sizes[0];
+        separator_block = right->blocks[0];
+        separator_child = right;
+        right->sizes[0] = 0;
+        right->blocks[0] = 0;
+    }
+
+    EMIndexNode *root = em_index_node_new(index);
+    em_index_put(root, 0, 0, 0, index->root);
+    em_index_put(root, 1, separator_size, separator_block, separator_child);
+    index->root = root;
+    index->height++;
+    return true;
+}
+
+/*
+ * Refill an underfull node from a sibling, or merge it with one
+ * 'node' is child 'at' of 'parent'. Returns true when the parent lost a child.
+ */
+static bool em_index_rebalance(EMFreeIndex *index, EMIndexNode *parent, size_t at, bool leaves) {
+    EMIndexNode *node = parent->children[at];
+    EMIndexNode *left = (at > 0) ? parent->children[at - 1] : NULL;
+    EMIndexNode *right = (at + 1 < parent->count) ? parent->children[at + 1] : NULL;
+
+    if (left != NULL && left->count > EM_INDEX_MIN) {
+        size_t last = left->count - 1;
+        if (leaves) {
+            em_index_put(node, 0, left->sizes[last], left->blocks[last], NULL);
+        } else {
+            // The parent separator moves down over the sentinel, the left separator moves up
+            node->sizes[0] = parent->sizes[at];
+            node->blocks[0] = parent->blocks[at];
+            em_index_put(node, 0, 0, 0, left->children[last]);
+            parent->sizes[at] = left->sizes[last];
+            parent->blocks[at] = left->blocks[last];
+        }
+        em_index_cut(left, last);
+        if (leaves) {
+            parent->sizes[at] = node->sizes[0];
+            parent->blocks[at] = node->blocks[0];
+        }
+        return false;
+    }
+
+    if (right != NULL && right->count > EM_INDEX_MIN) {
+        if (leaves) {
+            em_index_put(node, node->count, right->sizes[0], right->blocks[0], NULL);
+            em_index_cut(right, 0);
+            parent->sizes[at + 1] = right->sizes[0];
+            parent->blocks[at + 1] = right->blocks[0];
+        } else {
+            em_index_put(node, node->count, parent->sizes[at + 1], parent->blocks[at + 1], right->children[0]);
+            parent->sizes[at + 1] = right->sizes[1];
+            parent->blocks[at + 1] = right->blocks[1];
+            em_index_cut(right, 0);
+            right->sizes[0] = 0;
+            right->blocks[0] = 0;
+        }
+        return false;
+    }
+
+    // Merge the right one of the pair into the left one
+    size_t right_at = (left != NULL) ? at : at + 1;
+    EMIndexNode *into = parent->children[right_at - 1];
+    EMIndexNode *from = parent->children[right_at];
+    if (leaves) {
+        into->next = from->next;
+    } else {
+        from->sizes[0] = parent->sizes[right_at];
+        from->blocks[0] = parent->blocks[right_at];
+    }
+    for (size_t i = 0; i < from->count; i++) {
+        em_index_put(into, into->count, from->sizes[i], from->blocks[i], from->children[i]);
+    }
+    em_index_cut(parent, right_at);
+    em_index_node_release(index, from);
+    return true;
+}
+
+/*
+ * Remove a free block from the index
+ * Returns false when the block is not indexed (it lives in the free tree).
+ */
+static bool em_index_remove(EMFreeIndex *index, uintptr_t size, uintptr_t block) {
+    if (index->root == NULL) return false;
+
+    EMIndexNode *path[EM_INDEX_MAX_HEIGHT];
+    size_t slot[EM_INDEX_MAX_HEIGHT];
+    EMIndexNode *node = index->root;
+    for (size_t level = 0; level + 1 < index->height; level++) {
+        path[level] = node;
+        slot[level] = em_index_upper(node, size, block) - 1;
+        node = node->children[slot[level]];
+    }
+
+    size_t at = em_index_lower(node, size, block);
+    if (at == node->count || node->sizes[at] != size || node->blocks[at] != block) return false;
+    em_index_cut(node, at);
+    index->count--;
+
+    // Walk up while nodes fall below half full
+    for (size_t level = index->height - 1; level > 0 && node->count < EM_INDEX_MIN; level--) {
+        EMIndexNode *parent = path[level - 1];
+        if (!em_index_rebalance(index, parent, slot[level - 1], level == index->height - 1)) break;
+        node = parent;
+    }
+
+    EMIndexNode *root = index->root;
+    if (index->height > 1 && root->count == 1) {
+        index->root = root->children[0];
+        index->height--;
+        em_index_node_release(index, root);
+    }
+    else if (index->height == 1 && root->count == 0) {
+        index->root = NULL;
+        index->height = 0;
+        em_index_node_release(index, root);
+    }
+    return true;
+}
+
+/*
+ * Best fit in the index: the smallest block that holds 'size' bytes after aligning its data
+ * Returns the block header (not dereferenced) or NULL.
+ */
+static Block *em_index_best_fit(const EMFreeIndex *index, size_t size, size_t alignment) {
+    const EMIndexNode *node = index->root;
+    if (node == NULL) return NULL;
+
+    for (size_t level = 1; level < index->height; level++) {
+        node = node->children[em_index_below(node->sizes, size) - 1];  // The sentinel always ranks below
+    }
+
+    // Sizes ascend along the leaf chain; blocks of size + alignment and up always fit
+    size_t at = em_index_below(node->sizes, size);
+    for (; node != NULL; node = node->next, at = 0) {
+        for (; at < node->count; at++) {
+            uintptr_t data = node->blocks[at] + sizeof(Block);
+            if (node->sizes[at] >= size + (align_up(data, alignment) - data)) return (Block *)node->blocks[at];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Leftmost leaf and largest key, for walks and statistics
+ */
+static inline const EMIndexNode *em_index_first_leaf(const EMFreeIndex *index) {
+    const EMIndexNode *node = index->root;
+    for (size_t level = 1; node != NULL && level < index->height; level++) node = node->children[0];
+    return node;
+}
+
+static inline size_t em_index_largest(const EMFreeIndex *index) {
+    const EMIndexNode *node = index->root;
+    if (node == NULL) return 0;
+    for (size_t level = 1; level < index->height; level++) node = node->children[node->count - 1];
+    return node->sizes[node->count - 1];
+}
+#endif // EM_FREE_INDEX
+
+#ifdef EM_FREE_TLSF
+/*
+ * TLSF class of a block size (EM_FREE_TLSF)
+ * Sizes are multiples of a word: below 1 << EM_TLSF_FL_SHIFT each word count has its own
+ * list in class 0.
+ */
+static inline void em_tlsf_mapping(size_t size, size_t *fl, size_t *sl) {
+    if (size < ((size_t)1 << EM_TLSF_FL_SHIFT)) {
+        *fl = 0;
+        *sl = size >> EM_TLSF_WORD_LOG2;
+        return;
+    }
+    size_t exponent = max_exponent_of(size);
+    *fl = exponent - EM_TLSF_FL_SHIFT + 1;
+    *sl = (size >> (exponent - EM_TLSF_SL_LOG2)) ^ EM_TLSF_SL_COUNT;
+}
+
+static inline void em_tlsf_insert(EMTlsf *tlsf, Block *block) {
+    size_t fl, sl;
+    em_tlsf_mapping(get_size(block), &fl, &sl);
+
+    Block *head = tlsf->heads[fl][sl];
+    set_left_tree(block, head);
+    set_right_tree(block, NULL);
+    if (head != NULL) set_right_tree(head, block);
+    tlsf->heads[fl][sl] = block;
+    tlsf->fl_bitmap |= (size_t)1 << fl;
+    tlsf->sl_bitmap[fl] = (uint8_t)(tlsf->sl_bitmap[fl] | (1u << sl));
+    if (get_size(block) > tlsf->largest) tlsf->largest = get_size(block);
+}
+
+/*
+ * Largest listed block: the longest of the top non-empty list
+ * Walked only when the cached largest block leaves the lists, as the free tree does under
+ * EM_FREE_TREE_AUGMENT.
+ */
+static inline void em_tlsf_refresh_largest(EMTlsf *tlsf) {
+    size_t largest = 0;
+    if (tlsf->fl_bitmap != 0) {
+        size_t fl = max_exponent_of(tlsf->fl_bitmap);
+        for (const Block *block = tlsf->heads[fl][max_exponent_of(tlsf->sl_bitmap[fl])]; block != NULL; block = get_left_tree(block)) {
+            if (get_size(block) > largest) largest = get_size(block);
+        }
+    }
+    tlsf->largest = largest;
+}
+
+static inline void em_tlsf_remove(EMTlsf *tlsf, Block *block) {
+    Block *next = get_left_tree(block);
+    Block *prev = get_right_tree(block);
+    if (next != NULL) set_right_tree(next, prev);
+
+    if (prev != NULL) {
+        set_left_tree(prev, next);
+    }
+    else {
+        size_t fl, sl;
+        em_tlsf_mapping(get_size(block), &fl, &sl);
+        tlsf->heads[fl][sl] = next;
+        if (next == NULL) {
+            tlsf->sl_bitmap[fl] = (uint8_t)(tlsf->sl_bitmap[fl] & ~(1u << sl));
+            if (tlsf->sl_bitmap[fl] == 0) tlsf->fl_bitmap &= ~((size_t)1 << fl);
+        }
+    }
+    set_left_tree(block, NULL);
+    set_right_tree(block, NULL);
+    if (get_size(block) == tlsf->largest) em_tlsf_refresh_largest(tlsf);
+}
+
+/*
+ * First block of the first non-empty class whose blocks all hold 'size' bytes
+ */
+static inline Block *em_tlsf_find(const EMTlsf *tlsf, size_t size) {
+    if (size >= ((size_t)1 << EM_TLSF_FL_SHIFT)) {
+        size += ((size_t)1 << (max_exponent_of(size) - EM_TLSF_SL_LOG2)) - 1;  // Round up to the next class
+    }
+    if (size > EM_TLSF_MAX_SIZE) return NULL;
+
+    size_t fl, sl;
+    em_tlsf_mapping(size, &fl, &sl);
+    size_t sl_map = tlsf->sl_bitmap[fl] & (~(size_t)0 << sl);
+    if (sl_map == 0) {
+        size_t fl_map = tlsf->fl_bitmap & (~(size_t)0 << (fl + 1));
+        if (fl_map == 0) return NULL;
+        fl = min_exponent_of(fl_map);
+        sl_map = tlsf->sl_bitmap[fl];
+    }
+    return tlsf->heads[fl][min_exponent_of(sl_map)];
+}
+
+/*
+ * Take a block that holds 'size' bytes at 'alignment'
+ * Block data is word aligned, so over-requesting alignment minus a word always fits; the
+ * plain request is tried first, its block often needs less padding or none.
+ */
+static inline Block *em_tlsf_take(EMTlsf *tlsf, size_t size, size_t alignment) {
+    size = align_up(size, sizeof(uintptr_t));
+    Block *block = em_tlsf_find(tlsf, size);
+    if (block != NULL && alignment > sizeof(uintptr_t)) {
+        uintptr_t data = (uintptr_t)block_data(block);
+        if (get_size(block) < size + (align_up(data, alignment) - data)) {
+            block = em_tlsf_find(tlsf, size + alignment - sizeof(uintptr_t));
+        }
+    }
+    if (block != NULL) em_tlsf_remove(tlsf, block);
+    return block;
+}
+#endif // EM_FREE_TLSF
+
+#if defined(EM_STATS) || defined(EM_FREE_TREE_AUGMENT)
+/*
+ * Largest free tree block (EM_STATS, EM_FREE_TREE_AUGMENT)
+ * Cached in the header extension, for em_get_stats and so that a request no free block can
+ * hold is turned away before the search touches the tree. The rightmost node is only walked
+ * to again when the cached block itself leaves the tree.
+ */
+static inline void free_tree_refresh_largest(EM *em) {
+    Block *node = em_get_free_blocks(em);
+    size_t largest = 0;
+    if (node != NULL) {
+        while (get_right_tree(node) != NULL) node = get_right_tree(node);
+        largest = get_size(node);
+    }
+    em_get_extension(em)->free_tree_largest = largest;
+}
+
+#   define EM_FREE_TREE_GROW(em, block) \
+        do { if (get_size(block) > em_get_extension(em)->free_tree_largest) em_get_extension(em)->free_tree_largest = get_size(block); } while (0)
+#   define EM_FREE_TREE_SHRINK(em, block) \
+        do { if (get_size(block) == em_get_extension(em)->free_tree_largest) free_tree_refresh_largest(em); } while (0)
+#   define EM_FREE_TREE_REFRESH(em)     free_tree_refresh_largest(em)
+#else
+#   define EM_FREE_TREE_GROW(em, block)   ((void)0)
+#   define EM_FREE_TREE_SHRINK(em, block) ((void)0)
+#   define EM_FREE_TREE_REFRESH(em)       ((void)0)
+#endif // EM_STATS || EM_FREE_TREE_AUGMENT
+
+#ifdef EM_FREE_TREE_AUGMENT
+static inline bool free_tree_may_fit(EM *em, const Block *root, size_t size, size_t alignment) {
+    return root != NULL && tree_may_fit(root, em_get_extension(em)->free_tree_largest, size, alignment);
+}
+
+#   define EM_FREE_TREE_MAY_FIT(em, root, size, alignment) free_tree_may_fit((em), (root), (size), (alignment))
+#else
+#   define EM_FREE_TREE_MAY_FIT(em, root, size, alignment) ((root) != NULL)
+#endif // EM_FREE_TREE_AUGMENT
+
+/*
+ * Free block bookkeeping
+ * The three operations the allocator performs on its free blocks. They go to the free tree,
+ * or with EM_FREE_INDEX to the side index first; the tree then only holds what the index
+ * buffer could not take. EM_FREE_TLSF replaces the tree with constant-time segregated lists
+ * in the root arenas that keep them.
+ */
+static inline void free_blocks_insert(EM *em, Block *block) {
+    #ifdef EM_FREE_TLSF
+    EMTlsf *tlsf = em_get_extension(em)->tlsf;
+    if (tlsf != NULL) {
+        EM_PROFILE_COUNT(em, insert_calls);
+        em_tlsf_insert(tlsf, block);
+        return;
+    }
+    #endif
+    #ifdef EM_FREE_INDEX
+    EMFreeIndex *index = em_get_extension(em)->free_index;
+    if (index != NULL && em_index_insert(index, get_size(block), (uintptr_t)block)) return;
+    #endif
+
+    Block *free_blocks_root = em_get_free_blocks(em);
+    free_blocks_root = insert_block(free_blocks_root, block EM_PROFILE_ARG(em));
+    em_set_free_blocks(em, free_blocks_root);
+    EM_FREE_TREE_GROW(em, block);
+}
+
+static inline void free_blocks_detach(EM *em, Block *block) {
+    #ifdef EM_FREE_TLSF
+    EMTlsf *tlsf = em_get_extension(em)->tlsf;
+    if (tlsf != NULL) {
+        EM_PROFILE_COUNT(em, detach_calls);
+        em_tlsf_remove(tlsf, block);
+        return;
+    }
+    #endif
+    #ifdef EM_FREE_INDEX
+    EMFreeIndex *index = em_get_extension(em)->free_index;
+    if (index != NULL && em_index_remove(index, get_size(block), (uintptr_t)block)) return;
+    #endif
+
+    Block *free_blocks_root = em_get_free_blocks(em);
+    detach_block_by_ptr(&free_blocks_root, block EM_PROFILE_ARG(em));
+    em_set_free_blocks(em, free_blocks_root);
+    EM_FREE_TREE_SHRINK(em, block);
+}
+
+static inline Block *free_blocks_take(EM *em, size_t size, size_t alignment) {
+    #ifdef EM_FREE_TLSF
+    EMTlsf *tlsf = em_get_extension(em)->tlsf;
+    if (tlsf != NULL) return em_tlsf_take(tlsf, size, alignment);
+    #endif
+    #ifdef EM_FREE_INDEX
+    EMFreeIndex *index = em_get_extension(em)->free_index;
+    if (index != NULL) {
+        Block *indexed = em_index_best_fit(index, size, alignment);
+        Block *root = em_get_free_blocks(em);
+        Block *parent = NULL;
+        Block *spilled = EM_FREE_TREE_MAY_FIT(em, root, size, alignment) ? find_best_fit(root, size, alignment, &parent) : NULL;
+
+        if (indexed != NULL && (spilled == NULL || get_size(indexed) <= get_size(spilled))) {
+            em_index_remove(index, get_size(indexed), (uintptr_t)indexed);
+            return indexed;
+        }
+        if (spilled != NULL) {
+            detach_block_fast(&root, spilled, parent);
+            em_set_free_blocks(em, root);
+            EM_FREE_TREE_SHRINK(em, spilled);
+        }
+        return spilled;
+    }
+    #endif
+
+    Block *root = em_get_free_blocks(em);
+    if (!EM_FREE_TREE_MAY_FIT(em, root, size, alignment)) return NULL;
+    Block *block = find_and_detach_block(&root, size, alignment);
+    em_set_free_blocks(em, root);
+    if (block != NULL) EM_FREE_TREE_SHRINK(em, block);
+    return block;
+}
+
+#ifdef EM_FREE_INDEX
+/*
+ * Empty the index on reset; a buffer carved from the arena itself is gone with the reset
+ */
+static void em_free_index_forget(EM *em) {
+    EMExtension *extension = em_get_extension(em);
+    EMFreeIndex *index = extension->free_index;
+    if (index == NULL) return;
+
+    if ((uintptr_t)index >= (uintptr_t)em && (uintptr_t)index < (uintptr_t)em + em_get_capacity(em)) {
+        extension->free_index = NULL;
+        return;
+    }
+    index->root = NULL;
+    index->recycled = NULL;
+    index->unused = index->end - index->nodes;
+    index->height = 0;
+    index->available = index->nodes;
+    index->count = 0;
+}
+
+#   define EM_FREE_INDEX_FORGET(em) em_free_index_forget(em)
+#else
+#   define EM_FREE_INDEX_FORGET(em) ((void)0)
+#endif // EM_FREE_INDEX
+
+#ifdef EM_FREE_TLSF
+/*
+ * Empty the class lists; the detector word after them stays in place
+ */
+static inline void em_tlsf_clear(EM *em) {
+    EMTlsf *tlsf = em_get_extension(em)->tlsf;
+    if (tlsf == NULL) return;
+    tlsf->fl_bitmap = 0;
+    memset(tlsf->sl_bitmap, 0, sizeof(tlsf->sl_bitmap));
+    memset(tlsf->heads, 0, sizeof(tlsf->heads));
+    tlsf->largest = 0;
+}
+
+#   define EM_FREE_TLSF_CLEAR(em) em_tlsf_clear(em)
+#else
+#   define EM_FREE_TLSF_CLEAR(em) ((void)0)
+#endif // EM_FREE_TLSF
+
+static void em_free_block_full(EM *em, Block *block);
+/*
+ * Split block
+ * Splits a larger free block into two blocks if it is significantly larger than needed
+ * The remainder block is added back to the free blocks tree
+ */
+static inline void split_block(EM *em, Block *block, size_t needed_size) {
+    size_t full_size = get_size(block);
+    
+    if (full_size > needed_size && full_size - needed_size >= EMBLOCK_MIN_SIZE) {
+        EM_PROFILE_COUNT(em, splits);
+        set_size(block, needed_size);
+
+        Block *remainder = create_block(next_block_unsafe(block)); 
+        set_prev(remainder, block);
+        set_size(remainder, full_size - needed_size - sizeof(Block));
+        
+        Block *following = next_block(em, remainder);
+        if (following) {
+            set_prev(following, remainder);
+        }
+
+        // The remainder goes through the regular free path, which releases it from the live counters
+        EM_STATS_OCCUPY(em, get_size(remainder));
+        em_free_block_full(em, remainder);
+    }
+}
+
+/*
+ * Get the easy memory that owns this block
  * Uses neighbor-borrowing or the LSB Padding Detector to find the header.
  */
 static inline EM *get_parent_em(Block *block) {
@@ -3048,6 +5339,9 @@ static inline EM *get_parent_em(Block *block) {
     }
 
     Block *prev = block;
+    #ifdef EM_HAS_COST_PROBE
+    size_t walked = 0;
+    #endif
     
     /*
      * Logic: Physical Neighbor Walkback
@@ -3056,6 +5350,9 @@ static inline EM *get_parent_em(Block *block) {
     */
     while (get_prev(prev) != NULL) {
         prev = get_prev(prev);
+        #ifdef EM_HAS_COST_PROBE
+        walked++;
+        #endif
 
         /* 
          * We found an occupied block. But wait!
@@ -3065,6 +5362,7 @@ static inline EM *get_parent_em(Block *block) {
          * treat a nested EM as a simple block.
         */
         if (!get_is_free(prev) && !em_get_is_nested((EM*)(void *)(prev))) {
+            EM_COST_PROBE(EM_COST_PARENT_WALK, walked);
             return get_em(prev);
         }
 
@@ -3078,6 +5376,7 @@ static inline EM *get_parent_em(Block *block) {
      * To get more understanding whats going on go to 'em_new_static_custom'
      * function. 
     */
+    EM_COST_PROBE(EM_COST_PARENT_WALK, walked);
     uintptr_t *detector_spot = (uintptr_t *)(void *)((char *)prev - sizeof(uintptr_t));
     uintptr_t val = *detector_spot;
     
@@ -3090,6 +5389,74 @@ static inline EM *get_parent_em(Block *block) {
 
 
 
+/*
+ * Poison the free tail (EM_ASAN)
+ * Marks everything between the tail header and the scratch area (or the end) as unaddressable.
+ */
+#ifdef EM_HAS_ASAN
+static inline void asan_poison_tail(const EM *em) {
+    EM_ASAN_POISON(block_data(em_get_tail(em)), free_size_in_tail(em));
+}
+#   define EM_ASAN_POISON_TAIL(em) asan_poison_tail(em)
+#else
+#   define EM_ASAN_POISON_TAIL(em) ((void)0)
+#endif
+
+#ifdef EM_LIFETIME
+/*
+ * Check if block belongs to the short-lived region
+ * The region is the only part of the arena between its floor and its top, so the address decides.
+ */
+static inline bool is_short_block(EM *em, const Block *block) {
+    const EMExtension *extension = em_get_extension(em);
+    return extension->short_floor != NULL && (uintptr_t)block >= (uintptr_t)extension->short_floor &&
+           (uintptr_t)block < extension->short_top;
+}
+
+/*
+ * Free a block of the short-lived region
+ * A block above the floor is only marked free. Freeing the floor lifts it over every free
+ * block above, in one step per block, and hands the space to the tail: freed in reverse
+ * allocation order, every free is O(1).
+ */
+static void em_free_short(EM *em, Block *block) {
+    EMExtension *extension = em_get_extension(em);
+
+    EM_STATS_RELEASE(em, get_size(block));
+    set_is_free(block, true);
+    if (block != extension->short_floor) {
+        EM_STATS_SHORT_HOLD(em, block);
+        EM_ASAN_POISON(block_data(block), get_size(block));
+        return;
+    }
+
+    // The floor lifts over the held blocks right above it
+    Block *floor = next_block_unsafe(block);
+    while ((uintptr_t)floor < extension->short_top && get_is_free(floor)) {
+        EM_STATS_SHORT_UNHOLD(em, floor);
+        floor = next_block_unsafe(floor);
+    }
+
+    // An occupied tail ends at the old floor, so the space handed back starts a new free tail there
+    Block *tail = em_get_tail(em);
+    if (!get_is_free(tail)) {
+        EM_ASSERT((next_block_unsafe(tail) == block) && "Internal Error: 'em_free_short' found an occupied tail that does not end at the floor");
+        Block *new_tail = create_block(block);
+        set_prev(new_tail, tail);
+        em_set_tail(em, new_tail);
+    }
+
+    if ((uintptr_t)floor >= extension->short_top) {
+        extension->short_floor = NULL;
+        extension->short_top = 0;
+    }
+    else {
+        extension->short_floor = floor;
+    }
+    EM_ASAN_POISON_TAIL(em);
+}
+#endif // EM_LIFETIME
+
 /*
  * Free scratch memory in easy memory
  * Marks the scratch memory as free
@@ -3101,6 +5468,11 @@ static void em_free_scratch(EM *em, Block *scratch_block) {
 
     Block *tail = em_get_tail(em);
 
+    #ifdef EM_LIFETIME
+    // The short-lived region lies between the tail and the scratch block: the space comes back once it drains
+    if (em_get_extension(em)->short_floor != NULL) return;
+    #endif
+
     if (get_size(tail) != 0) {
         set_color(scratch_block, EMRED);
         set_is_free(scratch_block, true);
@@ -3121,13 +5493,24 @@ static void em_free_block_full(EM *em, Block *block) {
     EM_ASSERT((block != NULL) && "Internal Error: 'em_free_block_full' called on NULL block");
 
     #ifdef EM_POISONING
+    EM_DIRTY_TOUCH(em, block_data(block), (uintptr_t)block_data(block) + get_size(block));
     memset(block_data(block), EM_POISON_BYTE, get_size(block));
     #endif
 
     if (get_is_in_scratch(block)) {
         em_free_scratch(em, block);
+        EM_ASAN_POISON_TAIL(em);
+        return;
+    }
+
+    #ifdef EM_LIFETIME
+    if (is_short_block(em, block)) {
+        em_free_short(em, block);
         return;
     }
+    #endif
+
+    EM_STATS_RELEASE(em, get_size(block));
 
     set_is_free(block, true);
     set_left_tree(block, NULL);
@@ -3141,6 +5524,7 @@ static void em_free_block_full(EM *em, Block *block) {
     
     // If block is tail, just set its size to 0
     if (block == tail) {
+        EM_PROFILE_COUNT(em, lifo_tail_frees);
         set_size(block, 0);
         result_to_tree = NULL;
     }
@@ -3149,15 +5533,18 @@ static void em_free_block_full(EM *em, Block *block) {
 
         // If next block is tail, just set its size to 0 and update tail pointer
         if (next == tail && get_is_free(tail)) {
+            EM_PROFILE_COUNT(em, lifo_next_tail_frees);
+            EM_VERIFY_FORGET(em, tail, block);
+            EM_COMPACT_FORGET(em, tail, block);
             set_size(block, 0);
             em_set_tail(em, block);
+            EM_DIRTY_DROP_HEADER(em, tail);
             result_to_tree = NULL; 
         } 
         // Merge with next block if it is free
         else if (next && get_is_free(next)) {
-            Block *free_blocks_root = em_get_free_blocks(em);
-            detach_block_by_ptr(&free_blocks_root, next);
-            em_set_free_blocks(em, free_blocks_root);
+            EM_STATS_TREE_REMOVE(em, next);
+            free_blocks_detach(em, next);
             merge_blocks_logic(em, block, next);
             result_to_tree = block;
         }
@@ -3165,14 +5552,16 @@ static void em_free_block_full(EM *em, Block *block) {
 
     // Merge with previous block if it is free
     if (prev && get_is_free(prev)) {
-        Block *free_blocks_root = em_get_free_blocks(em);
-        detach_block_by_ptr(&free_blocks_root, prev);
-        em_set_free_blocks(em, free_blocks_root);
+        EM_STATS_TREE_REMOVE(em, prev);
+        free_blocks_detach(em, prev);
 
         // If we merged with tail before, just update tail pointer
         if (result_to_tree == NULL) {
+            EM_VERIFY_FORGET(em, block, prev);
+            EM_COMPACT_FORGET(em, block, prev);
             set_size(prev, 0);
             em_set_tail(em, prev);
+            EM_DIRTY_DROP_HEADER(em, block);
         } 
         // Else, merge previous with current result
         else {
@@ -3183,31 +5572,25 @@ static void em_free_block_full(EM *em, Block *block) {
 
     // Insert the resulting free block back into the free blocks tree
     if (result_to_tree != NULL) {
-        Block *free_blocks_root = em_get_free_blocks(em);
-        free_blocks_root = insert_block(free_blocks_root, result_to_tree);
-        em_set_free_blocks(em, free_blocks_root);
+        EM_STATS_TREE_ADD(em, result_to_tree);
+        free_blocks_insert(em, result_to_tree);
+        EM_ASAN_POISON(block_data(result_to_tree), get_size(result_to_tree)); // Covers the headers merged into it
+    }
+    else {
+        EM_ASAN_POISON_TAIL(em);
     }
 }
 
 /*
- * Allocate memory in free blocks of easy memory ()full version)
- * Attempts to allocate a block of memory of given size and alignment from the free blocks tree of the easy memory
- * Returns pointer to allocated memory or NULL if allocation fails
+ * Allocate memory in a free block already taken out of the free blocks
+ * Marks the block occupied, splits off the space behind the request and writes the data header
+ * Returns pointer to allocated memory
  */
-static void *alloc_in_free_blocks(EM *em, size_t size, size_t alignment) {
-    EM_ASSERT((em != NULL)                         && "Internal Error: 'alloc_in_free_blocks' called on NULL easy memory");
-    EM_ASSERT((size > 0)                           && "Internal Error: 'alloc_in_free_blocks' called on too small size");
-    EM_ASSERT((size <= EMMAX_SIZE)                 && "Internal Error: 'alloc_in_free_blocks' called on too big size");
-    EM_ASSERT(((alignment & (alignment - 1)) == 0) && "Internal Error: 'alloc_in_free_blocks' called on invalid alignment");
-    EM_ASSERT((alignment >= EMMIN_ALIGNMENT)       && "Internal Error: 'alloc_in_free_blocks' called on too small alignment");
-    EM_ASSERT((alignment <= EMMAX_ALIGNMENT)       && "Internal Error: 'alloc_in_free_blocks' called on too big alignment");
+static void *alloc_in_taken_block(EM *em, Block *block, size_t size, size_t alignment) {
+    EM_ASSERT((block != NULL)      && "Internal Error: 'alloc_in_taken_block' called on NULL block");
+    EM_ASSERT((get_is_free(block)) && "Internal Error: 'alloc_in_taken_block' called on occupied block");
 
-    Block *root = em_get_free_blocks(em);
-    Block *block = find_and_detach_block(&root, size, alignment);
-    em_set_free_blocks(em, root);
-    
-    if (!block) return NULL;
-    
+    EM_STATS_TREE_REMOVE(em, block);
     set_is_free(block, false);
 
     uintptr_t data_ptr = (uintptr_t)block_data(block);
@@ -3219,18 +5602,42 @@ static void *alloc_in_free_blocks(EM *em, size_t size, size_t alignment) {
     
     split_block(em, block, aligned_needed);
 
+    // The gap in front of the data (but its last word) and the slack behind it stay poisoned
+    EM_ASAN_UNPOISON(aligned_ptr - sizeof(uintptr_t), size + sizeof(uintptr_t));
+
     if (padding > 0) {
         uintptr_t *spot_before = (uintptr_t *)(aligned_ptr - sizeof(uintptr_t));
         *spot_before = (uintptr_t)block ^ aligned_ptr;
+        EM_DIRTY_TOUCH(em, spot_before, aligned_ptr);
     }
 
     set_em(block, em);
     set_magic(block, (void *)aligned_ptr);
     set_color(block, EMRED);
 
+    EM_STATS_OCCUPY(em, get_size(block));
     return (void *)aligned_ptr;
 }
 
+/*
+ * Allocate memory in free blocks of easy memory ()full version)
+ * Attempts to allocate a block of memory of given size and alignment from the free blocks tree of the easy memory
+ * Returns pointer to allocated memory or NULL if allocation fails
+ */
+static void *alloc_in_free_blocks(EM *em, size_t size, size_t alignment) {
+    EM_ASSERT((em != NULL)                         && "Internal Error: 'alloc_in_free_blocks' called on NULL easy memory");
+    EM_ASSERT((size > 0)                           && "Internal Error: 'alloc_in_free_blocks' called on too small size");
+    EM_ASSERT((size <= EMMAX_SIZE)                 && "Internal Error: 'alloc_in_free_blocks' called on too big size");
+    EM_ASSERT(((alignment & (alignment - 1)) == 0) && "Internal Error: 'alloc_in_free_blocks' called on invalid alignment");
+    EM_ASSERT((alignment >= EMMIN_ALIGNMENT)       && "Internal Error: 'alloc_in_free_blocks' called on too small alignment");
+    EM_ASSERT((alignment <= EMMAX_ALIGNMENT)       && "Internal Error: 'alloc_in_free_blocks' called on too big alignment");
+
+    Block *block = free_blocks_take(em, size, alignment);
+    if (!block) return NULL;
+
+    return alloc_in_taken_block(em, block, size, alignment);
+}
+
 /*
  * Allocate memory in tail block of easy memory (full version)
  * Attempts to allocate a block of memory of given size and alignment in the tail block of the easy memory
@@ -3281,9 +5688,9 @@ static void *alloc_in_tail_full(EM *em, size_t size, size_t alignment) {
     if (alignment > em_get_alignment(em) && padding > 0) {
         if (padding >= EMBLOCK_MIN_SIZE) {
             set_size(tail, padding - sizeof(Block));
-            Block *free_blocks_root = em_get_free_blocks(em);
-            free_blocks_root = insert_block(free_blocks_root, tail);
-            em_set_free_blocks(em, free_blocks_root);
+            EM_STATS_TREE_ADD(em, tail);
+            EM_PROFILE_COUNT(em, gap_blocks_recycled);
+            free_blocks_insert(em, tail);
 
             Block *new_tail = create_next_block(em, tail);
             em_set_tail(em, new_tail);
@@ -3323,10 +5730,13 @@ static void *alloc_in_tail_full(EM *em, size_t size, size_t alignment) {
     * Therefore, any padding in 'padding' variable will be always 0 or powers of 2 with sizeof(uintptr_t) as minimum.
     */
    
+    EM_ASAN_UNPOISON(aligned_data_ptr - sizeof(uintptr_t), size + sizeof(uintptr_t));
+
     // Store pointer to block metadata before user data for deallocation if there is padding
     if (padding > 0) {
         uintptr_t *spot_before_user_data = (uintptr_t *)(aligned_data_ptr - sizeof(uintptr_t));
         *spot_before_user_data = (uintptr_t)tail ^ aligned_data_ptr;
+        EM_DIRTY_TOUCH(em, spot_before_user_data, aligned_data_ptr);
     }
 
     // Finalize tail block as occupied
@@ -3345,11 +5755,13 @@ static void *alloc_in_tail_full(EM *em, size_t size, size_t alignment) {
         // LCOV_EXCL_STOP
     }
 
+    EM_STATS_OCCUPY(em, get_size(tail));
     return (void *)aligned_data_ptr;
 }
 
 typedef void *(*AllocFunc)(EM *EM_RESTRICT, size_t);
 
+static EM *create_static_aligned_internal(void *EM_RESTRICT memory, size_t size, size_t alignment, bool root);
 /*
  * Internal memory context creation core
  * Orchestrates the allocation and initialization of a sub-em (nested or scratch).
@@ -3385,7 +5797,7 @@ static inline EM *create_nested_aligned_internal(EM *parent_em, size_t size, siz
     bool color_flag = get_color(block);
     size_t true_physical_capacity = get_size(block);
 
-    EM *em = em_create_static_aligned((void *)block, true_physical_capacity, alignment);
+    EM *em = create_static_aligned_internal((void *)block, true_physical_capacity, alignment, false);
     em_set_is_nested(em, true); 
     
     Block *em_block = &(em->as.block_representation);
@@ -3393,6 +5805,14 @@ static inline EM *create_nested_aligned_internal(EM *parent_em, size_t size, siz
     set_is_free(em_block, is_free_flag);
     set_color(em_block, color_flag);
 
+    #ifdef EM_DIRTY_TRACKING
+    // A child carved from the parent's clean window starts out clean itself
+    const EMExtension *parent_extension = em_get_extension(parent_em);
+    uintptr_t child_data = (uintptr_t)block_data(em_get_tail(em));
+    uintptr_t child_end = (uintptr_t)em + em_get_capacity(em);
+    if (child_data >= parent_extension->clean_start && child_end <= parent_extension->clean_end) em_mark_zeroed(em);
+    #endif
+
     return em;
 }
 
@@ -3426,8 +5846,10 @@ static inline Bump *bump_create_internal(EM *EM_RESTRICT parent_em, size_t size,
 
     Bump *bump = (Bump *)((void *)block);  // just cast allocated Block to Bump
 
+    set_reserved_bits(&(bump->as.block_representation), EMBUMP_TAG);
     bump_set_em(bump, parent_em);
     bump_set_offset(bump, sizeof(Bump));
+    EM_ASAN_POISON((char *)bump + sizeof(Bump), bump_get_capacity(bump));
 
     return bump;
 }
@@ -3479,8 +5901,12 @@ static inline Slab *slab_create_internal(EM *EM_RESTRICT parent_em, size_t slab_
     slab_set_chunk_size(slab, chunk_size);
     slab_set_index(slab, 1);
 
+    // Free chunks are poisoned except for their first word (the free-list link)
     uintptr_t *first_chunk = (uintptr_t *)(void *)((char *)slab + sizeof(Slab));
+    EM_ASAN_POISON(first_chunk, slab_get_capacity(slab));
+    EM_ASAN_UNPOISON(first_chunk, sizeof(uintptr_t));
     *first_chunk = 1;
+    EM_DIRTY_TOUCH(parent_em, first_chunk, first_chunk + 1);
 
     return slab;
 }
@@ -3517,8 +5943,10 @@ static inline Stack *em_stack_create_internal(EM *EM_RESTRICT parent_em, size_t
     stack_set_em(stack, parent_em);
     size_t capacity = stack_get_capacity(stack);
     size_t meta_type = stack_calculate_meta_type(capacity);
+    set_reserved_bits(&(stack->as.block_representation), EMSTACK_TAG);
     stack_set_meta_type(stack, meta_type);
     stack_set_meta_index(stack, 0);
+    EM_ASAN_POISON((char *)stack + sizeof(Stack), capacity);
 
     return stack;
 }
@@ -3526,6 +5954,175 @@ static inline Stack *em_stack_create_internal(EM *EM_RESTRICT parent_em, size_t
 
 
 
+/*
+ * Allocation sampler (EM_SAMPLE)
+ * Every sampled allocation path subtracts its size from a countdown; only when it drops below
+ * zero does the slow path run, capture a backtrace and store the sample in the caller's table.
+ * Sampled em_alloc blocks carry EMSAMPLED_TAG in their header, so em_free finds them without
+ * a lookup; Bump and Slab allocations and handle blocks are looked up (only while samples
+ * exist), and em_compact carries the samples of the blocks it moves. Resets and destroys drop
+ * every sample inside the released range.
+ * The state is process-wide by default; define EM_SAMPLE_TLS as a thread-local storage class
+ * to sample each thread independently (matching the one-arena-per-thread model).
+ */
+#ifdef EM_SAMPLE
+#ifndef EM_SAMPLE_TLS
+#   define EM_SAMPLE_TLS
+#endif
+
+#define EM_SAMPLE_IDLE ((intptr_t)(~(uintptr_t)0 >> 1))
+
+static EM_SAMPLE_TLS intptr_t em_sample_countdown = EM_SAMPLE_IDLE;
+static EM_SAMPLE_TLS EMSample *em_sample_slots = NULL;
+static EM_SAMPLE_TLS size_t em_sample_capacity = 0;
+static EM_SAMPLE_TLS size_t em_sample_live = 0;
+static EM_SAMPLE_TLS size_t em_sample_rate = 0;
+static EM_SAMPLE_TLS uintptr_t em_sample_seed = 0;
+static EM_SAMPLE_TLS EMBacktraceFunc em_sample_backtrace = NULL;
+
+/*
+ * Next distance in bytes, uniform in [rate/2, rate*3/2]: mean 'rate', no aliasing with periodic workloads
+ */
+static inline intptr_t sample_next_interval(void) {
+    em_sample_seed = em_sample_seed * (uintptr_t)1103515245u + (uintptr_t)12345u;
+    uintptr_t random = em_sample_seed ^ (em_sample_seed >> (sizeof(uintptr_t) * 4));
+    return (intptr_t)(em_sample_rate / 2 + random % (em_sample_rate + 1));
+}
+
+static inline size_t sample_home(const void *pointer) {
+    return (size_t)(((uintptr_t)pointer >> 4) * (uintptr_t)2654435761u) % em_sample_capacity;
+}
+
+/*
+ * Remove slot 'index' from the linear-probing table, shifting later entries of the cluster back
+ */
+static void sample_erase(size_t index) {
+    size_t hole = index;
+    size_t next = index;
+    for (;;) {
+        next = (next + 1 == em_sample_capacity) ? 0 : next + 1;
+        if (em_sample_slots[next].pointer == NULL) break;
+
+        size_t home = sample_home(em_sample_slots[next].pointer);
+        // Move the entry unless its home lies cyclically in (hole, next]
+        bool stays = (hole <= next) ? (hole < home && home <= next) : (hole < home || home <= next);
+        if (!stays) {
+            em_sample_slots[hole] = em_sample_slots[next];
+            hole = next;
+        }
+    }
+    em_sample_slots[hole].pointer = NULL;
+    em_sample_live--;
+}
+
+/*
+ * Slow path: re-arm the countdown and store a sample. Returns false if nothing was stored.
+ */
+static bool sample_record(const void *pointer, size_t size) {
+    if (em_sample_slots == NULL) {
+        em_sample_countdown = EM_SAMPLE_IDLE;
+        return false;
+    }
+    em_sample_countdown = sample_next_interval();
+
+    // Keep one slot empty so probes always terminate; a full table drops the sample
+    if (em_sample_live + 1 >= em_sample_capacity) return false;
+
+    size_t index = sample_home(pointer);
+    while (em_sample_slots[index].pointer != NULL) {
+        index = (index + 1 == em_sample_capacity) ? 0 : index + 1;
+    }
+
+    EMSample *sample = &em_sample_slots[index];
+    sample->pointer = pointer;
+    sample->size = size;
+    sample->depth = 0;
+    if (em_sample_backtrace != NULL) {
+        sample->depth = em_sample_backtrace(sample->frames, EM_SAMPLE_MAX_FRAMES);
+        if (sample->depth > EM_SAMPLE_MAX_FRAMES) sample->depth = EM_SAMPLE_MAX_FRAMES;
+    }
+    em_sample_live++;
+    return true;
+}
+
+static void sample_forget(const void *pointer) {
+    size_t index = sample_home(pointer);
+    while (em_sample_slots[index].pointer != NULL) {
+        if (em_sample_slots[index].pointer == pointer) {
+            sample_erase(index);
+            return;
+        }
+        index = (index + 1 == em_sample_capacity) ? 0 : index + 1;
+    }
+}
+
+/*
+ * Re-key the sample of a block em_compact moved from 'from' to 'to'
+ */
+static void sample_move(const void *from, const void *to) {
+    size_t index = sample_home(from);
+    while (em_sample_slots[index].pointer != NULL) {
+        if (em_sample_slots[index].pointer == from) {
+            EMSample sample = em_sample_slots[index];
+            sample_erase(index);
+
+            sample.pointer = to;
+            index = sample_home(to);
+            while (em_sample_slots[index].pointer != NULL) {
+                index = (index + 1 == em_sample_capacity) ? 0 : index + 1;
+            }
+            em_sample_slots[index] = sample;
+            em_sample_live++;
+            return;
+        }
+        index = (index + 1 == em_sample_capacity) ? 0 : index + 1;
+    }
+}
+
+/*
+ * Drop every sample in [begin, end). O(table capacity), runs only while samples exist.
+ */
+static void sample_forget_range(uintptr_t begin, uintptr_t end) {
+    if (em_sample_live == 0) return;
+
+    for (size_t i = 0; i < em_sample_capacity; i++) {
+        // An erase may shift the next entry into this slot, so re-check it
+        while (em_sample_slots[i].pointer != NULL &&
+               (uintptr_t)em_sample_slots[i].pointer >= begin && (uintptr_t)em_sample_slots[i].pointer < end) {
+            sample_erase(i);
+        }
+    }
+}
+
+/*
+ * Sample an em_alloc* result: stored samples tag their block header for em_free
+ */
+static void sample_block(void *data, size_t size) {
+    if (!sample_record(data, size)) return;
+
+    uintptr_t check = *(uintptr_t *)(void *)((char *)data - sizeof(uintptr_t)) ^ (uintptr_t)data;
+    Block *block = (check == (uintptr_t)EM_MAGIC) ? (Block *)(void *)((char *)data - sizeof(Block)) : (Block *)check;
+    set_reserved_bits(block, EMSAMPLED_TAG);
+}
+
+#   define EM_SAMPLE_BLOCK(data, size) \
+        do { if ((data) != NULL && (em_sample_countdown -= (intptr_t)(size)) < 0) sample_block((data), (size)); } while (0)
+#   define EM_SAMPLE_POINTER(data, size) \
+        do { if ((data) != NULL && (em_sample_countdown -= (intptr_t)(size)) < 0) (void)sample_record((data), (size)); } while (0)
+#   define EM_SAMPLE_FORGET(data) \
+        do { if (em_sample_live != 0) sample_forget(data); } while (0)
+#   define EM_SAMPLE_FORGET_RANGE(begin, end) \
+        sample_forget_range((uintptr_t)(begin), (uintptr_t)(end))
+#   define EM_SAMPLE_MOVE(from, to) \
+        do { if (em_sample_live != 0) sample_move((from), (to)); } while (0)
+#else
+#   define EM_SAMPLE_BLOCK(data, size)        ((void)0)
+#   define EM_SAMPLE_POINTER(data, size)      ((void)0)
+#   define EM_SAMPLE_FORGET(data)             ((void)0)
+#   define EM_SAMPLE_FORGET_RANGE(begin, end) ((void)0)
+#   define EM_SAMPLE_MOVE(from, to)           ((void)0)
+#endif // EM_SAMPLE
+
 /*
  * Deallocate a memory block
  *
@@ -3554,7 +6151,8 @@ static inline Stack *em_stack_create_internal(EM *EM_RESTRICT parent_em, size_t
  *       return without performing any operations, preventing a crash.
  *
  * Note: Once freed, the 'data' pointer becomes invalid and should not be accessed. 
- * If EM_POISONING is enabled, the memory area will be filled with EM_POISON_BYTE.
+ * If EM_POISONING is enabled, the memory area will be filled with EM_POISON_BYTE,
+ * under EM_ASAN it is poisoned in the AddressSanitizer shadow instead.
  */
 EMDEF void em_free(void *data) {
     EM_CHECK_V((data != NULL),                             "Internal Error: 'em_free' called on NULL pointer");
@@ -3582,6 +6180,11 @@ EMDEF void em_free(void *data) {
         block = (Block *)(void *)((char *)data - sizeof(Block));
     }
     else {
+        #ifdef EM_HANDLES
+        // A handle block keeps its odd slot word where the magic would be
+        EM_CHECK_V(((*spot_before_user_data & 1) == 0 || get_reserved_bits((Block *)(void *)((char *)data - sizeof(Block))) != EMHANDLE_TAG),
+                   "Internal Error: 'em_free' called on a handle block, use 'em_hfree'");
+        #endif
         EM_CHECK_V(((uintptr_t)check % sizeof(uintptr_t) == 0), "Internal Error: 'em_free' detected corrupted block metadata");
         block = (Block *)check;
     }
@@ -3601,10 +6204,88 @@ EMDEF void em_free(void *data) {
     #endif
         
     EM_CHECK_V((!get_is_free(block)), "Internal Error: 'em_free' called on already freed block");    
+    #ifdef EM_HANDLES
+    // Reached by handle blocks em_compact moved behind alignment padding
+    EM_CHECK_V((get_reserved_bits(block) != EMHANDLE_TAG), "Internal Error: 'em_free' called on a handle block, use 'em_hfree'");
+    #endif
+
+    EM_TRACE_EVENT(EM_TRACE_FREE, em, data, 0, 0);
+
+    #ifdef EM_SAMPLE
+    if (get_reserved_bits(block) == EMSAMPLED_TAG) {
+        set_reserved_bits(block, 0);
+        EM_SAMPLE_FORGET(data);
+    }
+    #endif
 
     em_free_block_full(em, block);
 }
 
+/*
+ * Internal placement (tree or tail, in the order set by EM_PLACEMENT_POLICY)
+ */
+static inline void *alloc_placed_internal(EM *EM_RESTRICT em, size_t size, size_t alignment) {
+#if EM_PLACEMENT_POLICY == EM_PLACEMENT_TAIL_FIRST
+    // Carving the tail first, holes are the fallback
+    void *result = NULL;
+    if (free_size_in_tail(em) != 0) {
+        result = alloc_in_tail_full(em, size, alignment);
+        if (result) {
+            EM_PROFILE_COUNT(em, tail_hits);
+            return result;
+        }
+    }
+
+    result = alloc_in_free_blocks(em, size, alignment);
+    if (result) EM_PROFILE_COUNT(em, tree_hits);
+    return result;
+#else
+    // Trying to allocate in free blocks first
+    void *result = alloc_in_free_blocks(em, size, alignment);
+    if (result) {
+        EM_PROFILE_COUNT(em, tree_hits);
+        return result;
+    }
+
+    if (free_size_in_tail(em) == 0) return NULL;
+    result = alloc_in_tail_full(em, size, alignment);
+    if (result) EM_PROFILE_COUNT(em, tail_hits);
+    return result;
+#endif
+}
+
+/*
+ * Internal allocation core
+ * Shared by the public entry points and by sub-allocator / nested arena creation, so that 
+ * with EM_TRACE only the outermost public call is recorded.
+ */
+static inline void *alloc_aligned_internal(EM *EM_RESTRICT em, size_t size, size_t alignment) {
+    EM_CHECK((em != NULL),                         NULL, "Internal Error: 'em_alloc_aligned' called on NULL easy memory");
+    EM_CHECK((size > 0),                           NULL, "Internal Error: 'em_alloc_aligned' called on too small size");
+    EM_CHECK((size <= em_get_capacity(em)),        NULL, "Internal Error: 'em_alloc_aligned' called on too big size");
+    EM_CHECK(((alignment & (alignment - 1)) == 0), NULL, "Internal Error: 'em_alloc_aligned' called on invalid alignment");
+    EM_CHECK((alignment >= EMMIN_ALIGNMENT),       NULL, "Internal Error: 'em_alloc_aligned' called on too small alignment");
+    EM_CHECK((alignment <= EMMAX_ALIGNMENT),       NULL, "Internal Error: 'em_alloc_aligned' called on too big alignment");
+
+#ifdef EM_HAS_ASAN
+    // Reserve the redzone with the block, so an overflow hits poison before the next header
+    void *result = alloc_placed_internal(em, size + EM_ASAN_REDZONE, alignment);
+    if (result) EM_ASAN_POISON((char *)result + size, EM_ASAN_REDZONE);
+    return result;
+#else
+    return alloc_placed_internal(em, size, alignment);
+#endif
+}
+
+/*
+ * Internal default-alignment allocation (AllocFunc for sub-allocator creation)
+ */
+static void *alloc_internal(EM *EM_RESTRICT em, size_t size) {
+    EM_CHECK((em != NULL), NULL, "Internal Error: 'em_alloc' called on NULL easy memory");
+
+    return alloc_aligned_internal(em, size, em_get_alignment(em));
+}
+
 /*
  * Allocate memory with custom alignment
  *
@@ -3640,19 +6321,11 @@ EMDEF void em_free(void *data) {
  *     integer overflow is detected during padding calculation.
  */
 EMDEF void *em_alloc_aligned(EM *EM_RESTRICT em, size_t size, size_t alignment) {
-    EM_CHECK((em != NULL),                         NULL, "Internal Error: 'em_alloc_aligned' called on NULL easy memory");
-    EM_CHECK((size > 0),                           NULL, "Internal Error: 'em_alloc_aligned' called on too small size");
-    EM_CHECK((size <= em_get_capacity(em)),        NULL, "Internal Error: 'em_alloc_aligned' called on too big size");
-    EM_CHECK(((alignment & (alignment - 1)) == 0), NULL, "Internal Error: 'em_alloc_aligned' called on invalid alignment");
-    EM_CHECK((alignment >= EMMIN_ALIGNMENT),       NULL, "Internal Error: 'em_alloc_aligned' called on too small alignment");
-    EM_CHECK((alignment <= EMMAX_ALIGNMENT),       NULL, "Internal Error: 'em_alloc_aligned' called on too big alignment");
-
-    // Trying to allocate in free blocks first
-    void *result = alloc_in_free_blocks(em, size, alignment);
-    if (result) return result;
-
-    if (free_size_in_tail(em) == 0) return NULL;
-    return alloc_in_tail_full(em, size, alignment);
+    void *result = alloc_aligned_internal(em, size, alignment);
+    if (result) EM_DIRTY_TOUCH(em, result, (uintptr_t)result + size);
+    EM_TRACE_EVENT(EM_TRACE_ALLOC, em, result, size, alignment);
+    EM_SAMPLE_BLOCK(result, size);
+    return result;
 }
 
 /*
@@ -3694,70 +6367,255 @@ EMDEF void *em_alloc(EM *EM_RESTRICT em, size_t size) {
 }
 
 /*
- * Allocate scratch memory at the physical end of the instance
+ * Block of a locality hint, or NULL when the hint is not a live allocation of 'em'
+ * The same lookup as em_free, but a rejected hint only costs the locality, never the allocation.
+ */
+static Block *near_origin(EM *em, const void *hint) {
+    if (hint == NULL || (uintptr_t)hint % sizeof(uintptr_t) != 0) return NULL;
+    // Inside the active part, so the word in front of the hint is arena memory
+    if ((uintptr_t)hint < (uintptr_t)em_get_first_block(em) + sizeof(Block)) return NULL;
+    if ((uintptr_t)hint > (uintptr_t)block_data(em_get_tail(em))) return NULL;
+
+    uintptr_t check = *(const uintptr_t *)((uintptr_t)hint - sizeof(uintptr_t)) ^ (uintptr_t)hint;
+    Block *block = (check == (uintptr_t)EM_MAGIC) ? (Block *)((uintptr_t)hint - sizeof(Block)) : (Block *)check;
+
+    if ((uintptr_t)block % sizeof(uintptr_t) != 0 || !is_block_in_active_part(em, block)) return NULL;
+    if (get_is_free(block) || !is_valid_magic(block, hint) || get_em(block) != em) return NULL;
+    return block;
+}
+
+/*
+ * Whether a free block, or the free space of the tail, holds 'size' bytes at 'alignment'
+ */
+static inline bool near_block_fits(EM *em, const Block *block, size_t size, size_t alignment) {
+    if (!get_is_free(block)) return false;
+
+    uintptr_t data_ptr = (uintptr_t)block_data(block);
+    size_t needed = align_up(data_ptr, alignment) - data_ptr + size;
+    size_t available = (block == em_get_tail(em)) ? free_size_in_tail(em) : get_size(block);
+    return available >= needed;
+}
+
+/*
+ * Find the free block closest to 'origin' that fits
+ * The physical block chain is the address-ordered view of the arena: up to EM_NEAR_SEARCH_BLOCKS
+ * neighbours on each side are checked, and of the first fit on each side the one whose data
+ * lands closer to 'origin' wins. The free tail counts as the last neighbour.
+ * Returns NULL when neither window holds a fit.
+ */
+static Block *find_near_fit(EM *em, Block *origin, size_t size, size_t alignment) {
+    Block *tail = em_get_tail(em);
+
+    Block *after = NULL;
+    Block *block = origin;
+    for (size_t i = 0; i < (size_t)EM_NEAR_SEARCH_BLOCKS && block != tail; i++) {
+        block = next_block_unsafe(block);
+        if (near_block_fits(em, block, size, alignment)) {
+            after = block;
+            break;
+        }
+    }
+
+    Block *before = NULL;
+    block = get_prev(origin);
+    for (size_t i = 0; i < (size_t)EM_NEAR_SEARCH_BLOCKS && block != NULL; i++) {
+        if (near_block_fits(em, block, size, alignment)) {
+            before = block;
+            break;
+        }
+        block = get_prev(block);
+    }
+
+    if (after == NULL) return before;
+    if (before == NULL) return after;
+    return ((uintptr_t)after - (uintptr_t)origin <= (uintptr_t)origin - (uintptr_t)before) ? after : before;
+}
+
+/*
+ * Internal locality placement: the block found around 'origin', split like a best fit
+ * Returns NULL when the window holds no fit, the caller then places normally.
+ */
+static inline void *alloc_near_internal(EM *em, Block *origin, size_t size, size_t alignment) {
+    Block *block = find_near_fit(em, origin, size, alignment);
+    if (block == NULL) return NULL;
+
+    if (block == em_get_tail(em)) {
+        void *result = alloc_in_tail_full(em, size, alignment);
+        if (result) EM_PROFILE_COUNT(em, tail_hits);
+        return result;
+    }
+
+    free_blocks_detach(em, block);
+    EM_PROFILE_COUNT(em, tree_hits);
+    return alloc_in_taken_block(em, block, size, alignment);
+}
+
+/*
+ * Allocate memory close to an existing allocation
  *
- * This function provides a specialized mechanism to dynamically "bite off" memory 
- * from the very end (highest addresses) of the memory pool.
+ * Places the new block as near as it can to 'hint', so that data walked together
+ * (a list node and its successor, a tree node and its children) shares cache lines
+ * and pages. Among the free blocks that fit around the hint it takes the closest one;
+ * when none is close, it falls back to the normal placement of em_alloc.
  *
- * Performance: 
- *   O(1) Constant Time. Since it simply calculates the address relative to the 
- *   total capacity and avoids tree searching, it is the fastest allocation method.
+ * Availability:
+ *   - Part of the core API, like em_alloc: compiled in every configuration, with no
+ *     feature macro. It adds nothing to the arena header and nothing to the other calls.
+ *
+ * Performance:
+ *   - O(EM_NEAR_SEARCH_BLOCKS): walks up to EM_NEAR_SEARCH_BLOCKS physical neighbours
+ *     on each side of the hint (default 16), reading one header per neighbour.
+ *   - The fallback costs the same as em_alloc.
  *
  * Alignment Requirements:
- *   - Must be a power of two.
- *   - Range: [4..512] bytes (32-bit systems) or [8..1024] bytes (64-bit systems).
+ *   - Uses the default alignment of the EM instance.
  *
- * Capacity Limits:
- *   - Minimum: 1 byte (internally padded to EM_MIN_BUFFER_SIZE, default 16).
- *   - Physical Max: 512 MiB (32-bit) or 2 EiB (64-bit), limited by bit-packing.
- *   - Usable Max: The current free space of the instance minus sizeof(Block) 
- *     for metadata. In any case, it cannot exceed the Physical Max
- * 
- * Rationale:
- *   Scratch allocation is designed to solve the "Short-lived vs. Long-lived" object 
- *   problem. By dynamically taking memory from the opposite end of the pool, 
- *   temporary buffers (e.g., workspaces, loaders) do not interfere with the 
- *   main heap topology, preserving large contiguous chunks for long-lived data.
+ * Parameters:
+ *   - em:   Pointer to the Easy Memory instance.
+ *   - size: Bytes to allocate (must not exceed instance capacity).
+ *   - hint: A live allocation of 'em' (from em_alloc, em_alloc_aligned, em_calloc or
+ *           em_alloc_near), or NULL for no preference.
  *
- * Mechanism:
- *   There is no pre-reserved "scratch slot". The function calculates a position 
- *   at the extreme tail of the instance's total capacity, effectively shrinking 
- *   the available space for standard allocations from the top down.
- * 
- * Deallocation (Crucial):
- *   It is STRONGLY RECOMMENDED to use the standard 'em_free()' function to 
- *   release this memory. The library is designed to automatically detect 
- *   scratch blocks and correctly update the instance state upon deallocation.
+ * Returns:
+ *   - Pointer to the aligned memory, or NULL on failure.
  *
- * Constraints:
- *   - Only ONE active scratchpad allocation is allowed at a time per any 
- *     Easy Memory instance.
- *   - The scratchpad must be released (em_free) to reclaim the memory 
- *     and allow a new scratch allocation.
+ * Safety & Behavior:
+ *   - A hint that is NULL, outside the arena or not an allocation of it is ignored,
+ *     under every policy: the request is then placed like em_alloc.
+ *   - Handle blocks, sub-allocator chunks and scratch allocations are not hints.
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT if 'em' is NULL or 'size' is 0 or out of range.
+ *   - EM_POLICY_DEFENSIVE: Returns NULL if 'em' is NULL, 'size' is 0, or if the arena is exhausted.
+ */
+EMDEF void *em_alloc_near(EM *EM_RESTRICT em, size_t size, const void *hint) {
+    EM_CHECK((em != NULL),                  NULL, "Internal Error: 'em_alloc_near' called on NULL easy memory");
+    EM_CHECK((size > 0),                    NULL, "Internal Error: 'em_alloc_near' called on too small size");
+    EM_CHECK((size <= em_get_capacity(em)), NULL, "Internal Error: 'em_alloc_near' called on too big size");
+
+    size_t alignment = em_get_alignment(em);
+    void *result = NULL;
+
+    Block *origin = near_origin(em, hint);
+    if (origin != NULL) {
+        result = alloc_near_internal(em, origin, size + EM_ASAN_REDZONE, alignment);
+        if (result) EM_ASAN_POISON((char *)result + size, EM_ASAN_REDZONE);
+    }
+    if (result == NULL) result = alloc_aligned_internal(em, size, alignment);
+
+    if (result) EM_DIRTY_TOUCH(em, result, (uintptr_t)result + size);
+    EM_TRACE_EVENT(EM_TRACE_ALLOC_NEAR, em, result, size, (hint != NULL) ? (uintptr_t)hint - (uintptr_t)em + 1 : 0);
+    EM_SAMPLE_BLOCK(result, size);
+    return result;
+}
+
+#ifdef EM_LIFETIME
+/*
+ * Internal short-lived placement
+ * Carves the block right below the floor of the short-lived region (the top of the free
+ * space when the region is empty). The block runs up to the old floor, so the region stays
+ * a gapless chain from its floor to its top.
+ * Returns NULL when the free space left above the tail is too small.
+ */
+static void *alloc_short_internal(EM *em, size_t size, size_t alignment) {
+    Block *tail = em_get_tail(em);
+    if (!get_is_free(tail)) return NULL;
+
+    EMExtension *extension = em_get_extension(em);
+    uintptr_t tail_data = (uintptr_t)block_data(tail);
+    uintptr_t limit = (extension->short_floor != NULL) ? (uintptr_t)extension->short_floor : align_down(tail_data + free_size_in_tail(em), EMMIN_ALIGNMENT);
+
+    if (limit < tail_data || size > limit - tail_data) return NULL;
+    uintptr_t data = align_down(limit - size, alignment);
+    if (data < tail_data + sizeof(Block)) return NULL;
+
+    uintptr_t header = data - sizeof(Block);
+    EM_DIRTY_CLIP(em, header);
+    Block *block = create_block((void *)header);
+    set_size(block, limit - data);
+    set_is_free(block, false);
+    set_magic(block, (void *)data);
+    set_em(block, em);
+    EM_ASAN_UNPOISON(data, size);
+
+    if (extension->short_floor == NULL) extension->short_top = limit;
+    extension->short_floor = block;
+    EM_ASAN_POISON_TAIL(em);
+
+    EM_STATS_OCCUPY(em, get_size(block));
+    return (void *)data;
+}
+
+/*
+ * Allocate memory with a lifetime hint
+ *
+ * Keeps short-lived and long-lived blocks apart. A short-lived block stuck at the tail
+ * blocks the O(1) tail reclaim of everything freed below it, and once freed it leaves a
+ * hole between long-lived blocks. With the hint, long-lived blocks take the normal
+ * placement (free blocks, then the tail growing up), while short-lived blocks are stacked
+ * down from the top of the free space, the way the scratchpad uses the end of the arena.
+ * Both regions grow toward each other and each gives memory back in O(1) when freed in
+ * reverse allocation order.
+ *
+ * Performance:
+ *   - EM_LIFETIME_SHORT: O(1) allocation. Freeing the lowest short-lived block is O(1)
+ *     per block handed back; any other short-lived block is only marked free.
+ *   - EM_LIFETIME_LONG: same as em_alloc_aligned.
+ *
+ * Alignment Requirements:
+ *   - Must be a power of two.
+ *   - Range: [4..512] bytes (32-bit systems) or [8..1024] bytes (64-bit systems).
  *
  * Parameters:
  *   - em:        Pointer to the Easy Memory instance.
- *   - size:      Size of the scratch buffer.
- *   - alignment: Alignment boundary (power of two).
+ *   - size:      Number of bytes to allocate (must be > 0 and not exceed instance capacity).
+ *   - alignment: Boundary (power of two, within supported range).
+ *   - lifetime:  EM_LIFETIME_SHORT or EM_LIFETIME_LONG.
  *
  * Returns:
- *   A pointer to the scratch buffer at the end of the pool, or NULL on failure.
+ *   A pointer to the aligned memory block, or NULL if the allocation fails.
  *
  * Safety & Behavior:
- *   - EM_POLICY_CONTRACT:
- *       Breaching the following triggers EM_ASSERT:
- *       - 'em' is NULL or a scratchpad is already active.
- *       - 'size' is 0 or too large.
- *       - 'alignment' is invalid.
- *
- *   - EM_POLICY_DEFENSIVE:
- *       Returns NULL if:
- *       - A scratchpad is already in use.
- *       - There is not enough free space between the standard tail and the 
- *         end of the pool to fit the requested size and metadata.
- *       - Any parameter is invalid.
+ *   - Every block is released with em_free.
+ *   - A short-lived block freed out of order keeps its space until every short-lived block
+ *     below it is freed too, as in a stack. Free them in reverse allocation order.
+ *   - When the free space above the tail is too small, a short-lived request falls back to
+ *     the normal placement.
+ *   - While the short-lived region holds blocks, the scratchpad cannot be allocated
+ *     (em_alloc_scratch and the *_scratch creators return NULL). A scratchpad allocated
+ *     before the region can still be freed, but its space lies behind the region and only
+ *     returns to the tail once every short-lived block is freed.
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT on NULL 'em', zero size, invalid alignment
+ *     or an unknown lifetime.
+ *   - EM_POLICY_DEFENSIVE: Returns NULL on any invalid input.
+ */
+EMDEF void *em_alloc_ex(EM *EM_RESTRICT em, size_t size, size_t alignment, EMLifetime lifetime) {
+    EM_CHECK((em != NULL),                                                       NULL, "Internal Error: 'em_alloc_ex' called on NULL easy memory");
+    EM_CHECK((size > 0),                                                         NULL, "Internal Error: 'em_alloc_ex' called on too small size");
+    EM_CHECK((size <= em_get_capacity(em)),                                      NULL, "Internal Error: 'em_alloc_ex' called on too big size");
+    EM_CHECK(((alignment & (alignment - 1)) == 0),                               NULL, "Internal Error: 'em_alloc_ex' called on invalid alignment");
+    EM_CHECK((alignment >= EMMIN_ALIGNMENT),                                     NULL, "Internal Error: 'em_alloc_ex' called on too small alignment");
+    EM_CHECK((alignment <= EMMAX_ALIGNMENT),                                     NULL, "Internal Error: 'em_alloc_ex' called on too big alignment");
+    EM_CHECK((lifetime == EM_LIFETIME_LONG || lifetime == EM_LIFETIME_SHORT),    NULL, "Internal Error: 'em_alloc_ex' called with unknown lifetime");
+
+    void *result = NULL;
+    if (lifetime == EM_LIFETIME_SHORT) {
+        result = alloc_short_internal(em, size + EM_ASAN_REDZONE, alignment);
+        if (result) EM_ASAN_POISON((char *)result + size, EM_ASAN_REDZONE);
+    }
+    if (result == NULL) result = alloc_aligned_internal(em, size, alignment);
+
+    if (result) EM_DIRTY_TOUCH(em, result, (uintptr_t)result + size);
+    // A long-lived request is an em_alloc_aligned call in every respect
+    if (lifetime == EM_LIFETIME_SHORT) EM_TRACE_EVENT(EM_TRACE_ALLOC_SHORT, em, result, size, alignment);
+    else EM_TRACE_EVENT(EM_TRACE_ALLOC, em, result, size, alignment);
+    EM_SAMPLE_BLOCK(result, size);
+    return result;
+}
+#endif // EM_LIFETIME
+
+/*
+ * Internal scratch allocation core (untraced, see alloc_aligned_internal)
  */
-EMDEF void *em_alloc_scratch_aligned(EM *EM_RESTRICT em, size_t size, size_t alignment) {
+static inline void *alloc_scratch_aligned_internal(EM *EM_RESTRICT em, size_t size, size_t alignment) {
     EM_CHECK((em != NULL)                        , NULL,"Internal Error: 'em_alloc_scratch_aligned' called on NULL easy memory");
     EM_CHECK((size > 0)                          , NULL,"Internal Error: 'em_alloc_scratch_aligned' called on too small size");
     EM_CHECK((!em_get_has_scratch(em))           , NULL,"Internal Error: 'em_alloc_scratch_aligned' called when scratch already allocated");
@@ -3766,6 +6624,9 @@ EMDEF void *em_alloc_scratch_aligned(EM *EM_RESTRICT em, size_t size, size_t ali
     EM_CHECK((alignment >= EMMIN_ALIGNMENT)      , NULL,"Internal Error: 'em_alloc_scratch_aligned' called on too small alignment");
     EM_CHECK((alignment <= EMMAX_ALIGNMENT)      , NULL,"Internal Error: 'em_alloc_scratch_aligned' called on too big alignment");
     EM_CHECK((size <= free_size_in_tail(em))     , NULL,"Internal Error: 'em_alloc_scratch_aligned' called on too big size for scratch");
+    #ifdef EM_LIFETIME
+    if (em_get_extension(em)->short_floor != NULL) return NULL;  // The short-lived region holds the end of the arena
+    #endif
 
     uintptr_t raw_end_of_em = (uintptr_t)em + em_get_capacity(em);
     uintptr_t end_of_em = raw_end_of_em;
@@ -3787,12 +6648,15 @@ EMDEF void *em_alloc_scratch_aligned(EM *EM_RESTRICT em, size_t size, size_t ali
 
     size_t scratch_size = scratch_size_spot - scratch_data_spot;
 
+    EM_DIRTY_CLIP(em, block_metadata_spot);
     Block *scratch_block = create_block((void *)block_metadata_spot);
     set_size(scratch_block, scratch_size);
     set_is_free(scratch_block, false);
     set_magic(scratch_block, (void *)scratch_data_spot);
     set_em(scratch_block, em);
     set_is_in_scratch(scratch_block, true);
+    EM_ASAN_UNPOISON(scratch_data_spot, size);
+    EM_ASAN_UNPOISON(scratch_size_spot, sizeof(uintptr_t));
     
     uintptr_t *size_spot = (uintptr_t *)scratch_size_spot;
     *size_spot = raw_end_of_em - block_metadata_spot;
@@ -3803,9 +6667,95 @@ EMDEF void *em_alloc_scratch_aligned(EM *EM_RESTRICT em, size_t size, size_t ali
 }
 
 /*
- * Allocate scratch memory with default alignment
- *
- * A convenience wrapper for em_alloc_scratch_aligned that uses the arena's 
+ * Internal default-alignment scratch allocation (AllocFunc for scratch sub-allocator creation)
+ */
+static void *alloc_scratch_internal(EM *EM_RESTRICT em, size_t size) {
+    EM_CHECK((em != NULL), NULL, "Internal Error: 'em_alloc_scratch' called on NULL easy memory");
+
+    return alloc_scratch_aligned_internal(em, size, em_get_alignment(em));
+}
+
+/*
+ * Allocate scratch memory at the physical end of the instance
+ *
+ * This function provides a specialized mechanism to dynamically "bite off" memory 
+ * from the very end (highest addresses) of the memory pool.
+ *
+ * Performance: 
+ *   O(1) Constant Time. Since it simply calculates the address relative to the 
+ *   total capacity and avoids tree searching, it is the fastest allocation method.
+ *
+ * Alignment Requirements:
+ *   - Must be a power of two.
+ *   - Range: [4..512] bytes (32-bit systems) or [8..1024] bytes (64-bit systems).
+ *
+ * Capacity Limits:
+ *   - Minimum: 1 byte (internally padded to EM_MIN_BUFFER_SIZE, default 16).
+ *   - Physical Max: 512 MiB (32-bit) or 2 EiB (64-bit), limited by bit-packing.
+ *   - Usable Max: The current free space of the instance minus sizeof(Block) 
+ *     for metadata. In any case, it cannot exceed the Physical Max
+ * 
+ * Rationale:
+ *   Scratch allocation is designed to solve the "Short-lived vs. Long-lived" object 
+ *   problem. By dynamically taking memory from the opposite end of the pool, 
+ *   temporary buffers (e.g., workspaces, loaders) do not interfere with the 
+ *   main heap topology, preserving large contiguous chunks for long-lived data.
+ *
+ * Mechanism:
+ *   There is no pre-reserved "scratch slot". The function calculates a position 
+ *   at the extreme tail of the instance's total capacity, effectively shrinking 
+ *   the available space for standard allocations from the top down.
+ * 
+ * Deallocation (Crucial):
+ *   It is STRONGLY RECOMMENDED to use the standard 'em_free()' function to 
+ *   release this memory. The library is designed to automatically detect 
+ *   scratch blocks and correctly update the instance state upon deallocation.
+ *
+ * Constraints:
+ *   - Only ONE active scratchpad allocation is allowed at a time per any 
+ *     Easy Memory instance.
+ *   - The scratchpad must be released (em_free) to reclaim the memory 
+ *     and allow a new scratch allocation.
+ *   - EM_LIFETIME: the scratchpad and the short-lived region both take the top of the
+ *     free space. No scratchpad is allocated while the region holds blocks, and one
+ *     freed while the region holds blocks gives its space back only when the region
+ *     drains (see em_alloc_ex).
+ *
+ * Parameters:
+ *   - em:        Pointer to the Easy Memory instance.
+ *   - size:      Size of the scratch buffer.
+ *   - alignment: Alignment boundary (power of two).
+ *
+ * Returns:
+ *   A pointer to the scratch buffer at the end of the pool, or NULL on failure.
+ *
+ * Safety & Behavior:
+ *   - EM_POLICY_CONTRACT:
+ *       Breaching the following triggers EM_ASSERT:
+ *       - 'em' is NULL or a scratchpad is already active.
+ *       - 'size' is 0 or too large.
+ *       - 'alignment' is invalid.
+ *
+ *   - EM_POLICY_DEFENSIVE:
+ *       Returns NULL if:
+ *       - A scratchpad is already in use.
+ *       - There is not enough free space between the standard tail and the 
+ *         end of the pool to fit the requested size and metadata.
+ *       - Any parameter is invalid.
+ *
+ *   - EM_LIFETIME: Returns NULL in every policy while the short-lived region holds blocks.
+ */
+EMDEF void *em_alloc_scratch_aligned(EM *EM_RESTRICT em, size_t size, size_t alignment) {
+    void *result = alloc_scratch_aligned_internal(em, size, alignment);
+    EM_TRACE_EVENT(EM_TRACE_ALLOC_SCRATCH, em, result, size, alignment);
+    EM_SAMPLE_BLOCK(result, size);
+    return result;
+}
+
+/*
+ * Allocate scratch memory with default alignment
+ *
+ * A convenience wrapper for em_alloc_scratch_aligned that uses the arena's 
  * baseline alignment (configured during instance creation). 
  *
  * Performance:
@@ -3825,6 +6775,8 @@ EMDEF void *em_alloc_scratch_aligned(EM *EM_RESTRICT em, size_t size, size_t ali
  * Constraints:
  *   - Only ONE active scratchpad allocation per any Easy Memory instance.
  *   - You must free (em_free) the current scratchpad before allocating a new one.
+ *   - EM_LIFETIME: none while the short-lived region holds blocks (see
+ *     em_alloc_scratch_aligned).
  *
  * Parameters:
  *   - em:   Pointer to the Easy Memory instance.
@@ -3895,70 +6847,45 @@ EMDEF void *em_calloc(EM *EM_RESTRICT em, size_t nmemb, size_t size) {
 
     (void)success;
 
-    void *ptr = em_alloc(em, total_size);
+    void *ptr = alloc_internal(em, total_size);
     if (ptr) {
+        #ifdef EM_DIRTY_TRACKING
+        em_dirty_zero(em, (uintptr_t)ptr, total_size, false); // Memory never written since the last zeroing is skipped
+        EM_DIRTY_TOUCH(em, ptr, (uintptr_t)ptr + total_size);
+        #else
         memset(ptr, 0, total_size); // Zero-initialize the allocated memory
+        #endif
     }
+    EM_TRACE_EVENT(EM_TRACE_CALLOC, em, ptr, nmemb, size);
+    EM_SAMPLE_BLOCK(ptr, total_size);
     return ptr;
 }
 
 /*
- * Initialize an Easy Memory instance over a static buffer
- *
- * Transforms a raw pre-allocated block of memory into a fully functional arena.
- * This is the primary initialization function for bare-metal, stack-allocated, 
- * or shared memory environments.
- *
- * Flexible Input Handling:
- *   The function is designed to handle "crooked" or unaligned input pointers. 
- *   It will automatically shift its internal starting position to the nearest 
- *   required machine-word boundary. 
- *   Note: This internal alignment shift slightly reduces the usable capacity 
- *   from the provided total 'size'.
- *
- * Alignment Requirements:
- *   - Must be a power of two.
- *   - Range: [4..512] bytes (32-bit systems) or [8..1024] bytes (64-bit systems).
- *
- * Capacity Limits:
- *   - Minimum: ~48 bytes (32-bit) or ~80 bytes (64-bit). 
- *     Calculated as: sizeof(EM) + sizeof(Block) + EM_MIN_BUFFER_SIZE.
- *   - Physical Max: 512 MiB (32-bit) or 2 EiB (64-bit), limited by bit-packing.
- *   - Usable Max: Total 'size' minus internal alignment padding, sizeof(EM) 
- *     header, and the first block's metadata (sizeof(Block)).
- *
- * Parameters:
- *   - memory:    Pointer to the start of the buffer (alignment is handled internally).
- *   - size:      Total size of the buffer in bytes.
- *   - alignment: Baseline alignment for all future allocations in this instance.
- *
- * Returns:
- *   A pointer to the initialized EM header within the provided buffer, 
- *   or NULL if the usable area (after self-alignment) is below the minimum threshold.
- *
- * Safety & Behavior:
- *   - EM_POLICY_CONTRACT:
- *       Triggers EM_ASSERT on NULL memory or if size is outside [Min..Max] range.
- *
- *   - EM_POLICY_DEFENSIVE:
- *       Gracefully returns NULL if input parameters are invalid or if the 
- *       buffer cannot satisfy the initialization overhead.
+ * Internal static instance construction core
+ * Shared by every creation path (static, dynamic, nested, scratch); untraced.
+ * Only 'root' arenas (static and dynamic ones) may keep the TLSF class lists.
  */
-EMDEF EM *em_create_static_aligned(void *EM_RESTRICT memory, size_t size, size_t alignment) {
+static EM *create_static_aligned_internal(void *EM_RESTRICT memory, size_t size, size_t alignment, bool root) {
     EM_CHECK((memory != NULL)                    , NULL, "Internal Error: 'em_create_static_aligned' called with NULL memory");
     EM_CHECK((size >= EMMIN_SIZE)                , NULL, "Internal Error: 'em_create_static_aligned' called with too small size");
     EM_CHECK((size <= EMMAX_SIZE)                , NULL, "Internal Error: 'em_create_static_aligned' called with too big size");
     EM_CHECK(((alignment & (alignment - 1)) == 0), NULL, "Internal Error: 'em_create_static_aligned' called with invalid alignment");
     EM_CHECK((alignment >= EMMIN_ALIGNMENT)      , NULL, "Internal Error: 'em_create_static_aligned' called with too small alignment");
     EM_CHECK((alignment <= EMMAX_ALIGNMENT)      , NULL, "Internal Error: 'em_create_static_aligned' called with too big alignment");
+    #ifdef EM_FREE_TLSF
+    EM_CHECK((size <= EM_TLSF_MAX_SIZE)          , NULL, "Internal Error: 'em_create_static_aligned' called with a size beyond the TLSF classes (raise EM_TLSF_FL_MAX)");
+    #endif
 
     uintptr_t raw_addr = (uintptr_t)memory;
     uintptr_t aligned_addr = align_up(raw_addr, EMMIN_ALIGNMENT);
     size_t em_padding = aligned_addr - raw_addr; 
+    size_t lists_size = root ? EM_TLSF_LISTS_SIZE(size - em_padding) : 0; // TLSF class lists after the header
 
-    if (size < em_padding + sizeof(EM) + EMBLOCK_MIN_SIZE) return NULL;
+    if (size < em_padding + EM_HEADER_SIZE + lists_size + EMBLOCK_MIN_SIZE) return NULL;
     
     EM *em = (EM *)aligned_addr;
+    EM_ASAN_UNPOISON(memory, size); // The buffer may still carry the shadow of an abandoned arena
 
     // Initialize all fields to zero/NULL
     em->as.self.capacity_and_alignment = 0;
@@ -4014,7 +6941,7 @@ EMDEF EM *em_create_static_aligned(void *EM_RESTRICT memory, size_t size, size_t
      * ---------------------------------------------------------------------------------
     */
 
-    uintptr_t aligned_block_start = align_up(aligned_addr + sizeof(Block) + sizeof(EM), alignment) - sizeof(Block);
+    uintptr_t aligned_block_start = align_up(aligned_addr + sizeof(Block) + EM_HEADER_SIZE + lists_size, alignment) - sizeof(Block);
     Block *block = create_block((void *)(aligned_block_start));
 
     if (aligned_block_start > (aligned_addr + sizeof(EM))) {
@@ -4024,7 +6951,7 @@ EMDEF EM *em_create_static_aligned(void *EM_RESTRICT memory, size_t size, size_t
     }
 
     em_set_alignment(em, alignment);
-    em_set_capacity(em, size - em_padding);
+    em_set_capacity(em, align_down(size - em_padding, EMMIN_ALIGNMENT)); // Bytes past the last word hold no block
     
     em_set_free_blocks(em, NULL);
     em_set_has_scratch(em, false);
@@ -4034,6 +6961,95 @@ EMDEF EM *em_create_static_aligned(void *EM_RESTRICT memory, size_t size, size_t
     em_set_is_dynamic(em, false);
     em_set_is_nested(em, false);
 
+    #ifdef EM_STATS
+    EMExtension *extension = em_get_extension(em);
+    extension->used_bytes = 0;
+    extension->peak_used_bytes = 0;
+    extension->live_blocks = 0;
+    extension->free_tree_bytes = 0;
+    extension->free_tree_blocks = 0;
+    #endif
+
+    #ifdef EM_PROFILE
+    memset(&em_get_extension(em)->profile, 0, sizeof(EMProfile));
+    #endif
+
+    #ifdef EM_DIRTY_TRACKING
+    // Nothing is known about the buffer yet: empty clean window (see em_mark_zeroed)
+    em_get_extension(em)->clean_start = (uintptr_t)em + em_get_capacity(em);
+    em_get_extension(em)->clean_end = (uintptr_t)em + em_get_capacity(em);
+    #endif
+
+    #ifdef EM_FREE_INDEX
+    em_get_extension(em)->free_index = NULL;
+    #endif
+
+    #ifdef EM_HANDLES
+    em_get_extension(em)->handles = NULL;
+    #endif
+
+    #ifdef EM_LIFETIME
+    em_get_extension(em)->short_floor = NULL;
+    em_get_extension(em)->short_top = 0;
+    EM_STATS_SHORT_CLEAR(em);
+    #endif
+
+    #ifdef EM_FREE_TLSF
+    em_get_extension(em)->tlsf = (lists_size != 0) ? (EMTlsf *)(void *)(aligned_addr + EM_HEADER_SIZE) : NULL;
+    #endif
+    EM_FREE_TLSF_CLEAR(em);
+    EM_FREE_TREE_REFRESH(em);
+    EM_VERIFY_RESTART(em);
+    EM_ASAN_POISON_TAIL(em);
+
+    return em;
+}
+
+/*
+ * Initialize an Easy Memory instance over a static buffer
+ *
+ * Transforms a raw pre-allocated block of memory into a fully functional arena.
+ * This is the primary initialization function for bare-metal, stack-allocated, 
+ * or shared memory environments.
+ *
+ * Flexible Input Handling:
+ *   The function is designed to handle "crooked" or unaligned input pointers. 
+ *   It will automatically shift its internal starting position to the nearest 
+ *   required machine-word boundary. 
+ *   Note: This internal alignment shift slightly reduces the usable capacity 
+ *   from the provided total 'size'.
+ *
+ * Alignment Requirements:
+ *   - Must be a power of two.
+ *   - Range: [4..512] bytes (32-bit systems) or [8..1024] bytes (64-bit systems).
+ *
+ * Capacity Limits:
+ *   - Minimum: ~48 bytes (32-bit) or ~80 bytes (64-bit). 
+ *     Calculated as: sizeof(EM) + sizeof(Block) + EM_MIN_BUFFER_SIZE.
+ *   - Physical Max: 512 MiB (32-bit) or 2 EiB (64-bit), limited by bit-packing.
+ *   - Usable Max: Total 'size' minus internal alignment padding, sizeof(EM) 
+ *     header, and the first block's metadata (sizeof(Block)).
+ *
+ * Parameters:
+ *   - memory:    Pointer to the start of the buffer (alignment is handled internally).
+ *   - size:      Total size of the buffer in bytes.
+ *   - alignment: Baseline alignment for all future allocations in this instance.
+ *
+ * Returns:
+ *   A pointer to the initialized EM header within the provided buffer, 
+ *   or NULL if the usable area (after self-alignment) is below the minimum threshold.
+ *
+ * Safety & Behavior:
+ *   - EM_POLICY_CONTRACT:
+ *       Triggers EM_ASSERT on NULL memory or if size is outside [Min..Max] range.
+ *
+ *   - EM_POLICY_DEFENSIVE:
+ *       Gracefully returns NULL if input parameters are invalid or if the 
+ *       buffer cannot satisfy the initialization overhead.
+ */
+EMDEF EM *em_create_static_aligned(void *EM_RESTRICT memory, size_t size, size_t alignment) {
+    EM *em = create_static_aligned_internal(memory, size, alignment, true);
+    EM_TRACE_EVENT(EM_TRACE_CREATE_STATIC, NULL, em, size, alignment);
     return em;
 }
 
@@ -4109,7 +7125,8 @@ EMDEF EM *em_create_static(void *EM_RESTRICT memory, size_t size) {
  *       request is mathematically impossible to satisfy.
  */
 EMDEF EM *em_create_aligned(size_t size, size_t alignment) {
-    size_t overhead = sizeof(EM) + alignment;
+    size_t header_size = EM_HEADER_SIZE + EM_TLSF_LISTS_SIZE(size + EM_HEADER_SIZE);
+    size_t overhead = header_size + alignment;
     EM_CHECK((size <= SIZE_MAX - overhead)       , NULL, "Internal Error: 'em_create_aligned' size overflow");
     EM_CHECK((size >= EMBLOCK_MIN_SIZE)          , NULL, "Internal Error: 'em_create_aligned' called with too small size");
     EM_CHECK((size <= EMMAX_SIZE)                , NULL, "Internal Error: 'em_create_aligned' called with too big size");
@@ -4117,10 +7134,14 @@ EMDEF EM *em_create_aligned(size_t size, size_t alignment) {
     EM_CHECK((alignment >= EMMIN_ALIGNMENT)      , NULL, "Internal Error: 'em_create_aligned' called with too small alignment");
     EM_CHECK((alignment <= EMMAX_ALIGNMENT)      , NULL, "Internal Error: 'em_create_aligned' called with too big alignment");
 
+    #ifdef EM_DIRTY_TRACKING
+    void *data = calloc(1, size + overhead); // Large requests come straight from zeroed pages
+    #else
     void *data = malloc(size + overhead);
+    #endif
     if (!data) return NULL;
     
-    EM *em = em_create_static_aligned(data, size + sizeof(EM), alignment);
+    EM *em = create_static_aligned_internal(data, size + header_size, alignment, true);
 
     if (!em) {
         // LCOV_EXCL_START
@@ -4130,7 +7151,11 @@ EMDEF EM *em_create_aligned(size_t size, size_t alignment) {
     }
 
     em_set_is_dynamic(em, true);
+    #ifdef EM_DIRTY_TRACKING
+    em_mark_zeroed(em);
+    #endif
 
+    EM_TRACE_EVENT(EM_TRACE_CREATE, NULL, em, size, alignment);
     return em;
 }
 
@@ -4200,12 +7225,25 @@ EMDEF EM *em_create(size_t size) {
 EMDEF void em_destroy(EM *em) {
     EM_CHECK_V((em != NULL), "Internal Error: 'em_destroy' called on NULL easy memory");
 
+    EM_TRACE_EVENT(EM_TRACE_DESTROY, em, NULL, 0, 0);
+    EM_SAMPLE_FORGET_RANGE(em, (uintptr_t)em + em_get_capacity(em));
+
     if (em_get_is_nested(em)) {
         EM *parent = get_parent_em((Block *)em);
+        #ifdef EM_DIRTY_TRACKING
+        // Hand the child's dirty range (its live headers end at its tail) back to the parent
+        EMExtension *extension = em_get_extension(em);
+        uintptr_t dirty_end = (uintptr_t)em_get_tail(em) + sizeof(Block);
+        if (extension->clean_start > dirty_end) dirty_end = extension->clean_start;
+        if (extension->clean_end < (uintptr_t)em + em_get_capacity(em)) dirty_end = (uintptr_t)em + em_get_capacity(em);
+        EM_DIRTY_TOUCH(parent, em, dirty_end);
+        #endif
         em_free_block_full(parent, (Block *)em); 
         return;
     }
 
+    EM_ASAN_UNPOISON(em, em_get_capacity(em)); // Hand the buffer back fully addressable
+
     #ifndef EM_NO_MALLOC
     if (em_get_is_dynamic(em)) {
         free(em);
@@ -4213,6 +7251,58 @@ EMDEF void em_destroy(EM *em) {
     #endif // EM_NO_MALLOC
 }
 
+/*
+ * Internal reset core (untraced, shared with em_reset_zero)
+ */
+static inline void reset_internal(EM *EM_RESTRICT em) {
+    EM_CHECK_V((em != NULL), "Internal Error: 'em_reset' called on NULL easy memory");
+
+    EM_SAMPLE_FORGET_RANGE(em, (uintptr_t)em + em_get_capacity(em));
+
+    Block *first_block = em_get_first_block(em);
+
+    // Every header up to the tail dissolves into the free tail
+    EM_DIRTY_TOUCH(em, first_block, (uintptr_t)em_get_tail(em) + sizeof(Block));
+
+    // Reset first block (a sub-allocator may have left its header tag there)
+    set_reserved_bits(first_block, 0);
+    set_size(first_block, 0);
+    set_prev(first_block, NULL);
+    set_is_free(first_block, true);
+    set_color(first_block, EMRED);
+    set_left_tree(first_block, NULL);
+    set_right_tree(first_block, NULL);
+
+    // Reset easy memory metadata
+    em_set_free_blocks(em, NULL);
+    EM_FREE_INDEX_FORGET(em);
+    EM_FREE_TLSF_CLEAR(em);
+    EM_FREE_TREE_REFRESH(em);
+    em_set_tail(em, first_block);
+    em_set_has_scratch(em, false);
+
+    #ifdef EM_STATS
+    EMExtension *extension = em_get_extension(em);
+    extension->used_bytes = 0;
+    extension->live_blocks = 0;
+    extension->free_tree_bytes = 0;
+    extension->free_tree_blocks = 0;
+    #endif
+
+    #ifdef EM_HANDLES
+    em_get_extension(em)->handles = NULL;  // The table was a block of the arena
+    #endif
+
+    #ifdef EM_LIFETIME
+    em_get_extension(em)->short_floor = NULL;
+    em_get_extension(em)->short_top = 0;
+    EM_STATS_SHORT_CLEAR(em);
+    #endif
+
+    EM_VERIFY_RESTART(em);
+    EM_ASAN_POISON_TAIL(em);
+}
+
 /*
  * Reset the Easy Memory instance
  *
@@ -4237,22 +7327,8 @@ EMDEF void em_destroy(EM *em) {
  * (unless using em_reset_zero).
  */
 EMDEF void em_reset(EM *EM_RESTRICT em) {
-    EM_CHECK_V((em != NULL), "Internal Error: 'em_reset' called on NULL easy memory");
-
-    Block *first_block = em_get_first_block(em);
-
-    // Reset first block
-    set_size(first_block, 0);
-    set_prev(first_block, NULL);
-    set_is_free(first_block, true);
-    set_color(first_block, EMRED);
-    set_left_tree(first_block, NULL);
-    set_right_tree(first_block, NULL);
-
-    // Reset easy memory metadata
-    em_set_free_blocks(em, NULL);
-    em_set_tail(em, first_block);
-    em_set_has_scratch(em, false);
+    reset_internal(em);
+    EM_TRACE_EVENT(EM_TRACE_RESET, em, NULL, 0, 0);
 }
 
 /*
@@ -4273,39 +7349,663 @@ EMDEF void em_reset(EM *EM_RESTRICT em) {
 EMDEF void em_reset_zero(EM *EM_RESTRICT em) {
     EM_CHECK_V((em != NULL), "Internal Error: 'em_reset_zero' called on NULL easy memory");
 
-    em_reset(em); // Reset easy memory
-    memset(block_data(em_get_tail(em)), 0, free_size_in_tail(em)); // Set tail to zero
+    reset_internal(em); // Reset easy memory
+
+    void *tail_data = block_data(em_get_tail(em));
+    size_t tail_size = free_size_in_tail(em);
+    EM_ASAN_UNPOISON(tail_data, tail_size);
+    EM_RESET_ZERO(em, tail_data, tail_size); // Set tail to zero (with EM_DIRTY_TRACKING: only what was written)
+    EM_ASAN_POISON(tail_data, tail_size);
+
+    EM_TRACE_EVENT(EM_TRACE_RESET_ZERO, em, NULL, 0, 0);
 }
 
+#ifdef EM_DIRTY_TRACKING
 /*
- * Create a nested Easy Memory instance with custom alignment
+ * Declare the free tail of the instance as zero-filled
  *
- * Carves out a block from a parent arena and initializes it as an 
- * independent child arena.
- *
- * Zero-Overhead Header (ABI Compatibility):
- *   The EM and Block structures are strictly ABI compatible. The nested 
- *   instance hijacks the parent's existing block header to store its own 
- *   EM metadata. This ensures that 100% of the allocated payload is 
- *   directly usable for child allocations, with zero additional overhead 
- *   for the arena header itself.
+ * Tells the arena that the memory after its tail holds only zero bytes, as with a freshly
+ * mapped region, calloc'd storage or a static buffer in .bss. From then on the arena keeps
+ * a clean window of never-written memory: em_calloc skips zeroing allocations carved from
+ * it, and em_reset_zero, em_slab_reset_zero and em_stack_reset_zero only clear what has
+ * been written since. Dynamic arenas (em_create) and nested arenas carved from clean memory
+ * are marked automatically.
  *
  * Performance:
- *   - Allocation from parent: O(1) (tail) or O(log n) (tree).
- *   - Initialization: O(1) Constant Time.
- *
- * Zero-Cost Parent Tracking:
- *   - No explicit parent pointers are stored. The child arena identifies 
- *     its parent using the "Physical Neighbor Walkback" strategy, 
- *     traversing preceding blocks to find the owner. This saves 
- *     8-16 bytes of metadata per instance.
+ *   - O(1) Constant Time.
  *
- * Alignment Requirements:
- *   - Must be a power of two.
- *   - Range: [4..512] bytes (32-bit systems) or [8..1024] bytes (64-bit systems).
+ * Parameters:
+ *   - em: Pointer to the Easy Memory instance.
  *
- * Capacity Limits:
- *   - Usable Max: Exactly the 'size' requested from the parent. 
+ * Safety & Behavior:
+ *   - The caller vouches for the contents: declaring dirty memory as zeroed makes em_calloc
+ *     return stale bytes. When unsure, call em_reset_zero instead, which zeroes once and
+ *     establishes the same window.
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT if 'em' is NULL.
+ *   - EM_POLICY_DEFENSIVE: Safely returns if 'em' is NULL.
+ */
+EMDEF void em_mark_zeroed(EM *EM_RESTRICT em) {
+    EM_CHECK_V((em != NULL), "Internal Error: 'em_mark_zeroed' called on NULL easy memory");
+
+    EMExtension *extension = em_get_extension(em);
+    uintptr_t tail_data = (uintptr_t)block_data(em_get_tail(em));
+    extension->clean_start = tail_data;
+    extension->clean_end = tail_data + free_size_in_tail(em);
+}
+#endif // EM_DIRTY_TRACKING
+
+#ifdef EM_BULK_ZERO
+/*
+ * Zero a range, bypassing the cache when it is large
+ *
+ * Ranges of at least EM_BULK_ZERO_THRESHOLD bytes are written with non-temporal streaming
+ * stores in whole cache lines (AVX2 when the CPU has it, SSE2 otherwise), so clearing them
+ * does not flush the working set out of the caches. Smaller ranges, and targets without
+ * these stores, use memset. This is the engine behind em_reset_zero, em_slab_reset_zero and
+ * em_stack_reset_zero under EM_BULK_ZERO.
+ *
+ * Performance:
+ *   - O(N) Linear Time, bound by memory bandwidth instead of cache capacity.
+ *
+ * Parameters:
+ *   - data: Start of the range; any alignment.
+ *   - size: Bytes to zero.
+ *
+ * Safety & Behavior:
+ *   - Issues a store fence before returning: the zeroes are ordered before any later store,
+ *     so a worker can hand its part back to another thread with an ordinary release.
+ *   - Does not call the workers installed with em_bulk_zero_set_workers, so workers may use it.
+ */
+EMDEF void em_bulk_zero(void *data, size_t size) {
+    if (size < EM_BULK_ZERO_THRESHOLD || size < 2 * EM_BULK_ZERO_LINE) {
+        memset(data, 0, size);
+        return;
+    }
+
+    #ifdef EM_BULK_ZERO_SSE2
+    char *start = (char *)data;
+    size_t head = (size_t)((uintptr_t)0 - (uintptr_t)start) & (EM_BULK_ZERO_LINE - 1);
+    size_t lines = (size - head) / EM_BULK_ZERO_LINE;
+    char *body = start + head;
+
+    memset(start, 0, head);
+    #   ifdef EM_BULK_ZERO_AVX2
+    if (__builtin_cpu_supports("avx2")) em_stream_zero_avx2(body, lines);
+    else em_stream_zero_sse2(body, lines);
+    #   else
+    em_stream_zero_sse2(body, lines);
+    #   endif
+    _mm_sfence(); // Streaming stores are weakly ordered
+    memset(body + lines * EM_BULK_ZERO_LINE, 0, size - head - lines * EM_BULK_ZERO_LINE);
+    #else
+    memset(data, 0, size);
+    #endif
+}
+
+/*
+ * Install a hook that spreads large reset_zero ranges across worker threads
+ *
+ * From then on every range of at least 'min_size' bytes that em_reset_zero,
+ * em_slab_reset_zero or em_stack_reset_zero has to clear is handed to 'workers', which must
+ * return only once all of it is zero. A typical hook cuts the range into one part per thread
+ * of an existing pool, runs em_bulk_zero on each and waits for them. Smaller ranges are
+ * zeroed on the calling thread.
+ *
+ * Parameters:
+ *   - workers:  The hook, or NULL to zero everything on the calling thread again.
+ *   - min_size: Smallest range handed to the hook.
+ *   - context:  Opaque pointer passed back to every hook call.
+ *
+ * Note: The hook is process-wide. Install it before arenas are used from several threads.
+ */
+EMDEF void em_bulk_zero_set_workers(EMZeroWorkers workers, size_t min_size, void *context) {
+    em_zero_workers = workers;
+    em_zero_min_size = min_size;
+    em_zero_context = context;
+}
+#endif // EM_BULK_ZERO
+
+#ifdef EM_FREE_INDEX
+/*
+ * Attach a side index over the free blocks of an instance
+ *
+ * Lays out an EMFreeIndex and its node pool in 'memory' and moves the blocks of the free
+ * tree into it. From then on frees insert into the index and allocations that miss the
+ * tail search it: a best fit costs one cache line of sizes per level plus a short scan of
+ * the leaf chain, and only the chosen block header is read. When the pool cannot take a
+ * block, it falls back to the free tree, which stays part of every search;
+ * EM_PLAN_FREE_INDEX_SIZE gives the size that never spills.
+ *
+ * Performance:
+ *   - O(n log n) for the move of n free blocks; O(log n) per operation afterwards.
+ *
+ * Parameters:
+ *   - em:     Pointer to the Easy Memory instance.
+ *   - memory: Buffer for the index, e.g. static storage or an em_alloc from the same arena.
+ *   - size:   Size of the buffer in bytes.
+ *
+ * Returns:
+ *   - true on success, false if the buffer cannot hold a single node.
+ *
+ * Safety & Behavior:
+ *   - An index already attached is detached first.
+ *   - The buffer must outlive the attachment: call em_free_index_detach before releasing it.
+ *     A buffer allocated from the arena itself is dropped by em_reset (re-attach afterwards);
+ *     any other buffer is emptied and kept.
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT if 'em' or 'memory' is NULL.
+ *   - EM_POLICY_DEFENSIVE: Safely returns false if 'em' or 'memory' is NULL.
+ */
+EMDEF bool em_free_index_attach(EM *EM_RESTRICT em, void *memory, size_t size) {
+    EM_CHECK((em != NULL),     false, "Internal Error: 'em_free_index_attach' called on NULL easy memory");
+    EM_CHECK((memory != NULL), false, "Internal Error: 'em_free_index_attach' called with NULL memory");
+
+    uintptr_t start = align_up((uintptr_t)memory, sizeof(uintptr_t));
+    uintptr_t end = (uintptr_t)memory + size;
+    uintptr_t nodes_start = align_up(start + sizeof(EMFreeIndex), 64);  // Size lines start on a cache line
+    if (end < nodes_start || end - nodes_start < sizeof(EMIndexNode)) return false;
+
+    em_free_index_detach(em);
+
+    EMFreeIndex *index = (EMFreeIndex *)start;
+    index->root = NULL;
+    index->recycled = NULL;
+    index->unused = (EMIndexNode *)nodes_start;
+    index->nodes = (end - nodes_start) / sizeof(EMIndexNode);
+    index->end = index->unused + index->nodes;
+    index->height = 0;
+    index->available = index->nodes;
+    index->count = 0;
+    em_get_extension(em)->free_index = index;
+
+    // Drain the free tree from the root down until the pool is full
+    Block *root = em_get_free_blocks(em);
+    while (root != NULL) {
+        Block *block = root;
+        detach_block_fast(&root, block, NULL);
+        if (!em_index_insert(index, get_size(block), (uintptr_t)block)) {
+            root = insert_block(root, block EM_PROFILE_ARG(em));
+            break;
+        }
+    }
+    em_set_free_blocks(em, root);
+    EM_FREE_TREE_REFRESH(em);
+    return true;
+}
+
+/*
+ * Detach the side index of an instance
+ *
+ * Moves every indexed block back into the free tree, after which the buffer given to
+ * em_free_index_attach is no longer referenced and can be released.
+ *
+ * Performance:
+ *   - O(n log n) for n indexed blocks.
+ *
+ * Parameters:
+ *   - em: Pointer to the Easy Memory instance.
+ *
+ * Safety & Behavior:
+ *   - Does nothing when no index is attached.
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT if 'em' is NULL.
+ *   - EM_POLICY_DEFENSIVE: Safely returns if 'em' is NULL.
+ */
+EMDEF void em_free_index_detach(EM *EM_RESTRICT em) {
+    EM_CHECK_V((em != NULL), "Internal Error: 'em_free_index_detach' called on NULL easy memory");
+
+    EMExtension *extension = em_get_extension(em);
+    EMFreeIndex *index = extension->free_index;
+    if (index == NULL) return;
+    extension->free_index = NULL;
+
+    Block *root = em_get_free_blocks(em);
+    for (const EMIndexNode *leaf = em_index_first_leaf(index); leaf != NULL; leaf = leaf->next) {
+        for (size_t i = 0; i < leaf->count; i++) {
+            Block *block = (Block *)leaf->blocks[i];
+            set_left_tree(block, NULL);
+            set_right_tree(block, NULL);
+            root = insert_block(root, block EM_PROFILE_ARG(em));
+        }
+    }
+    em_set_free_blocks(em, root);
+    EM_FREE_TREE_REFRESH(em);
+}
+#endif // EM_FREE_INDEX
+
+#ifdef EM_HANDLES
+/*
+ * Handle table helpers
+ * The slots follow the table header. A block is found from its data pointer through the word
+ * before it: for a handle block the odd slot word of its own header or the even alignment
+ * back-link, for a plain block the XOR magic or the back-link, as in em_free.
+ */
+static inline uintptr_t *handle_slots(EMHandleTable *table) {
+    return (uintptr_t *)(void *)(table + 1);
+}
+
+static inline Block *handle_block(uintptr_t data) {
+    uintptr_t link = *(const uintptr_t *)(data - sizeof(uintptr_t));
+    if (link & 1) return (Block *)(data - sizeof(Block));
+    return (Block *)(link ^ data);
+}
+
+static inline Block *plain_block(uintptr_t data) {
+    uintptr_t check = *(const uintptr_t *)(data - sizeof(uintptr_t)) ^ data;
+    return (check == (uintptr_t)EM_MAGIC) ? (Block *)(data - sizeof(Block)) : (Block *)check;
+}
+
+static inline bool is_handle_block(const EM *em, const Block *block) {
+    uintptr_t word2 = (uintptr_t)block->as.occupied.em;
+    if (get_is_free(block) || (word2 & (EMIS_NESTED_FLAG | EMSLAB_EM_TAG)) != 0) return false;
+    return get_reserved_bits(block) == EMHANDLE_TAG && word2 == (uintptr_t)em;
+}
+
+/*
+ * Slide a handle block down into the free block right before it
+ * The block takes over the place of the hole, its data aligned to the arena alignment, and
+ * the hole reappears behind it, where it merges with the next free block or the tail as a
+ * freed block would. Returns the hole, or NULL (nothing changed) when the alignment padding
+ * would not leave the hole a word of its own.
+ */
+static Block *compact_slide(EM *em, EMHandleTable *table, Block *hole, Block *block, size_t *moved) {
+    size_t slot = (size_t)(get_magic(block) >> 1);
+    uintptr_t from = handle_slots(table)[slot];
+    uintptr_t to = align_up((uintptr_t)block_data(hole), em_get_alignment(em));
+    uintptr_t end = (uintptr_t)block_data(block) + get_size(block);
+    size_t payload = (size_t)(end - from);
+    size_t padding = (size_t)(to - (uintptr_t)block_data(hole));   // Taken in front of the data
+    size_t shed = (size_t)(from - (uintptr_t)block_data(block));    // Left behind for the hole
+    size_t hole_size = get_size(hole);
+    if (hole_size + shed < padding + sizeof(uintptr_t)) return NULL;
+
+    bool was_tail = (block == em_get_tail(em));
+    Block *next = was_tail ? NULL : next_block_unsafe(block);
+    Block *prev = get_prev(hole);
+    Block header = *block;
+
+    EM_STATS_TREE_REMOVE(em, hole);
+    free_blocks_detach(em, hole);
+
+    #ifdef EM_HAS_ASAN
+    // The redzone and slack behind the data stay poisoned at the new place
+    const void *poisoned = __asan_region_is_poisoned((void *)from, payload);
+    size_t live = poisoned ? (size_t)((uintptr_t)poisoned - from) : payload;
+    #endif
+    EM_ASAN_UNPOISON(block_data(hole), end - (uintptr_t)block_data(hole));
+    EM_DIRTY_TOUCH(em, block_data(hole), end);
+
+    if (table->relocate) table->relocate((void *)to, (void *)from, payload, table->context);
+    else memmove((void *)to, (void *)from, payload);
+
+    #ifdef EM_HAS_ASAN
+    EM_ASAN_POISON(to + live, payload - live);
+    if (padding > sizeof(uintptr_t)) EM_ASAN_POISON(block_data(hole), padding - sizeof(uintptr_t));
+    #endif
+
+    // The header moves down into the hole and keeps the hole's physical link
+    *hole = header;
+    set_prev(hole, prev);
+    set_size(hole, padding + payload);
+    if (padding > 0) *(uintptr_t *)(to - sizeof(uintptr_t)) = (uintptr_t)hole ^ to;
+    handle_slots(table)[slot] = to;
+    EM_SAMPLE_MOVE((const void *)from, (const void *)to);
+    EM_VERIFY_FORGET(em, block, hole);
+    *moved += payload;
+
+    #ifdef EM_STATS
+    EMExtension *extension = em_get_extension(em);
+    extension->used_bytes = extension->used_bytes - shed + padding;
+    if (extension->used_bytes > extension->peak_used_bytes) extension->peak_used_bytes = extension->used_bytes;
+    #endif
+
+    Block *gap = create_block((void *)(to + payload));
+    set_size(gap, hole_size + shed - padding);
+    set_prev(gap, hole);
+    #ifdef EM_POISONING
+    memset(block_data(gap), EM_POISON_BYTE, get_size(gap));
+    #endif
+
+    if (was_tail || (next == em_get_tail(em) && get_is_free(next))) {
+        if (!was_tail) {
+            EM_VERIFY_FORGET(em, next, gap);
+            EM_DIRTY_DROP_HEADER(em, next);
+        }
+        set_size(gap, 0);
+        em_set_tail(em, gap);
+        EM_ASAN_POISON_TAIL(em);
+        return gap;
+    }
+
+    set_prev(next, gap);
+    if (get_is_free(next)) {
+        EM_STATS_TREE_REMOVE(em, next);
+        free_blocks_detach(em, next);
+        merge_blocks_logic(em, gap, next);
+    }
+    EM_STATS_TREE_ADD(em, gap);
+    free_blocks_insert(em, gap);
+    EM_ASAN_POISON(block_data(gap), get_size(gap));
+    return gap;
+}
+
+/*
+ * Create the handle table of an instance
+ *
+ * Allocates a table of 'capacity' slots as an ordinary block of the arena, after which
+ * em_halloc hands out relocatable blocks and em_compact may move them. Create the table
+ * before other allocations: like every em_alloc block it is a pin that compaction slides
+ * handle blocks up against, never past.
+ *
+ * Performance:
+ *   - O(capacity) to thread the free slots.
+ *
+ * Parameters:
+ *   - em:       Pointer to the Easy Memory instance.
+ *   - capacity: Maximum number of live handles.
+ *   - relocate: Moves a block during em_compact (e.g. C++ move construction), or NULL for memmove.
+ *   - context:  Passed to 'relocate'.
+ *
+ * Returns:
+ *   - true on success, false if the instance already has a table or the arena cannot hold it.
+ *
+ * Safety & Behavior:
+ *   - The table must not be passed to em_free; em_handles_destroy releases it.
+ *   - em_reset drops the table with everything else; create it again afterwards.
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT if 'em' is NULL or 'capacity' is 0.
+ *   - EM_POLICY_DEFENSIVE: Safely returns false if 'em' is NULL or 'capacity' is 0.
+ */
+EMDEF bool em_handles_create(EM *EM_RESTRICT em, size_t capacity, EMRelocateFunc relocate, void *context) {
+    EM_CHECK((em != NULL),  false, "Internal Error: 'em_handles_create' called on NULL easy memory");
+    EM_CHECK((capacity > 0), false, "Internal Error: 'em_handles_create' called with zero capacity");
+
+    EM_TRACE_EVENT(EM_TRACE_HANDLES_CREATE, em, NULL, capacity, 0);
+
+    EMExtension *extension = em_get_extension(em);
+    if (extension->handles != NULL) return false;
+    if (capacity > (EMMAX_SIZE - sizeof(EMHandleTable)) / sizeof(uintptr_t)) return false;
+
+    size_t size = sizeof(EMHandleTable) + capacity * sizeof(uintptr_t);
+    EMHandleTable *table = (EMHandleTable *)alloc_internal(em, size);
+    if (!table) return false;
+    EM_DIRTY_TOUCH(em, table, (uintptr_t)table + size);
+
+    table->capacity = capacity;
+    table->live = 0;
+    table->free_head = 1;
+    table->cursor = NULL;
+    table->relocate = relocate;
+    table->context = context;
+
+    uintptr_t *slots = handle_slots(table);
+    for (size_t i = 0; i < capacity; i++) {
+        slots[i] = (uintptr_t)((i + 1 < capacity) ? i + 2 : 0) << 1 | 1;
+    }
+
+    extension->handles = table;
+    return true;
+}
+
+/*
+ * Destroy the handle table of an instance
+ *
+ * Frees every block still named by a handle, then the table itself.
+ *
+ * Performance:
+ *   - O(capacity) plus one em_free per live handle.
+ *
+ * Parameters:
+ *   - em: Pointer to the Easy Memory instance.
+ *
+ * Safety & Behavior:
+ *   - Does nothing when the instance has no table.
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT if 'em' is NULL.
+ *   - EM_POLICY_DEFENSIVE: Safely returns if 'em' is NULL.
+ */
+EMDEF void em_handles_destroy(EM *EM_RESTRICT em) {
+    EM_CHECK_V((em != NULL), "Internal Error: 'em_handles_destroy' called on NULL easy memory");
+
+    EM_TRACE_EVENT(EM_TRACE_HANDLES_DESTROY, em, NULL, 0, 0);
+
+    EMExtension *extension = em_get_extension(em);
+    EMHandleTable *table = extension->handles;
+    if (table == NULL) return;
+    extension->handles = NULL;
+
+    uintptr_t *slots = handle_slots(table);
+    for (size_t i = 0; i < table->capacity; i++) {
+        if (slots[i] & 1) continue;
+        EM_SAMPLE_FORGET((const void *)slots[i]);
+        Block *block = handle_block(slots[i]);
+        set_reserved_bits(block, 0);
+        em_free_block_full(em, block);
+    }
+
+    em_free_block_full(em, plain_block((uintptr_t)table));
+}
+
+/*
+ * Allocate a relocatable block
+ *
+ * Allocates 'size' bytes at the default alignment, like em_alloc, and names the block by a
+ * handle instead of its address, so em_compact may move it. Resolve the handle with em_hget
+ * after every em_compact.
+ *
+ * Performance:
+ *   - Same as em_alloc, plus O(1) to take a slot.
+ *
+ * Parameters:
+ *   - em:   Pointer to the Easy Memory instance (with a table from em_handles_create).
+ *   - size: Number of bytes to allocate.
+ *
+ * Returns:
+ *   - A non-zero handle, or 0 if the arena or the table is full.
+ *
+ * Safety & Behavior:
+ *   - The block must be released with em_hfree; em_free refuses it.
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT on NULL 'em', a missing table or invalid size.
+ *   - EM_POLICY_DEFENSIVE: Returns 0 on invalid input.
+ */
+EMDEF EMHandle em_halloc(EM *EM_RESTRICT em, size_t size) {
+    EM_CHECK((em != NULL), 0, "Internal Error: 'em_halloc' called on NULL easy memory");
+
+    EMHandleTable *table = em_get_extension(em)->handles;
+    EM_CHECK((table != NULL), 0, "Internal Error: 'em_halloc' called before 'em_handles_create'");
+    if (table->free_head == 0) {
+        EM_TRACE_EVENT(EM_TRACE_HALLOC, em, NULL, size, 0);
+        return 0;
+    }
+
+    void *result = alloc_aligned_internal(em, size, em_get_alignment(em));
+    if (!result) {
+        EM_TRACE_EVENT(EM_TRACE_HALLOC, em, NULL, size, 0);
+        return 0;
+    }
+    EM_DIRTY_TOUCH(em, result, (uintptr_t)result + size);
+
+    Block *block = plain_block((uintptr_t)result);
+
+    size_t slot = table->free_head - 1;
+    uintptr_t *slots = handle_slots(table);
+    table->free_head = (size_t)(slots[slot] >> 1);
+    slots[slot] = (uintptr_t)result;
+    table->live++;
+
+    set_reserved_bits(block, EMHANDLE_TAG);
+    block->as.occupied.magic = (uintptr_t)slot << 1 | 1;
+
+    EM_TRACE_EVENT(EM_TRACE_HALLOC, em, result, size, slot + 1);
+    EM_SAMPLE_POINTER(result, size);
+    return (EMHandle)(slot + 1);
+}
+
+/*
+ * Resolve a handle
+ *
+ * Returns the current address of the block named by 'handle'. The address stays valid
+ * until the next em_compact or em_hfree.
+ *
+ * Performance:
+ *   - O(1): one load from the handle table.
+ *
+ * Parameters:
+ *   - em:     Pointer to the Easy Memory instance.
+ *   - handle: Handle returned by em_halloc.
+ *
+ * Returns:
+ *   - The data pointer of the block, or NULL for a handle that names no block.
+ *
+ * Safety & Behavior:
+ *   - A released handle resolves to NULL until em_halloc reuses its slot.
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT on NULL 'em' or an invalid handle.
+ *   - EM_POLICY_DEFENSIVE: Returns NULL on invalid input.
+ */
+EMDEF void *em_hget(EM *EM_RESTRICT em, EMHandle handle) {
+    EM_CHECK((em != NULL), NULL, "Internal Error: 'em_hget' called on NULL easy memory");
+
+    EMHandleTable *table = em_get_extension(em)->handles;
+    EM_CHECK((table != NULL && handle - 1 < table->capacity), NULL, "Internal Error: 'em_hget' called with an invalid handle");
+
+    uintptr_t value = handle_slots(table)[handle - 1];
+    EM_CHECK(((value & 1) == 0), NULL, "Internal Error: 'em_hget' called with a released handle");
+    return (void *)value;
+}
+
+/*
+ * Free a relocatable block
+ *
+ * Returns the block named by 'handle' to the arena, exactly like em_free does for em_alloc
+ * blocks, and releases the handle.
+ *
+ * Performance:
+ *   - Same as em_free.
+ *
+ * Parameters:
+ *   - em:     Pointer to the Easy Memory instance.
+ *   - handle: Handle returned by em_halloc.
+ *
+ * Safety & Behavior:
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT on NULL 'em', an invalid or a released handle.
+ *   - EM_POLICY_DEFENSIVE: Safely returns on invalid input.
+ */
+EMDEF void em_hfree(EM *EM_RESTRICT em, EMHandle handle) {
+    EM_CHECK_V((em != NULL), "Internal Error: 'em_hfree' called on NULL easy memory");
+
+    EMHandleTable *table = em_get_extension(em)->handles;
+    EM_CHECK_V((table != NULL && handle - 1 < table->capacity), "Internal Error: 'em_hfree' called with an invalid handle");
+
+    uintptr_t *slots = handle_slots(table);
+    size_t slot = handle - 1;
+    EM_CHECK_V(((slots[slot] & 1) == 0), "Internal Error: 'em_hfree' called with a released handle");
+
+    EM_TRACE_EVENT(EM_TRACE_HFREE, em, slots[slot], 0, handle);
+    EM_SAMPLE_FORGET((const void *)slots[slot]);
+
+    Block *block = handle_block(slots[slot]);
+    set_reserved_bits(block, 0);
+    em_free_block_full(em, block);
+
+    slots[slot] = (uintptr_t)table->free_head << 1 | 1;
+    table->free_head = slot + 1;
+    table->live--;
+}
+
+/*
+ * Compact the arena incrementally
+ *
+ * Walks the blocks from where the previous call stopped and slides every handle block that
+ * follows a free block down into it. The free block reappears behind the moved one, where it
+ * merges with the next free block, so the holes in front of handle blocks travel up the arena
+ * and coalesce into the tail. Blocks from em_alloc and the sub-allocators are pins: holes
+ * stop in front of them. Handle tables are updated as blocks move; resolve handles again
+ * with em_hget afterwards.
+ *
+ * Performance:
+ *   - O(blocks walked + bytes moved). A call stops once 'budget' bytes were moved, so a
+ *     long-lived arena can be compacted a slice at a time between requests.
+ *
+ * Parameters:
+ *   - em:     Pointer to the Easy Memory instance.
+ *   - budget: Bytes to move before returning (at least one block is moved when possible);
+ *             SIZE_MAX compacts everything in one call.
+ *
+ * Returns:
+ *   - Bytes moved. 0 means a whole pass found nothing left to move.
+ *
+ * Safety & Behavior:
+ *   - Every pointer obtained from em_hget before the call may be stale after it.
+ *   - Moved data keeps the arena alignment. A hole too small to take the alignment padding
+ *     stays in front of its block.
+ *   - A budget of 0 moves nothing.
+ *   - The relocation hook given to em_handles_create performs the moves; it must not call
+ *     back into the arena.
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT if 'em' is NULL.
+ *   - EM_POLICY_DEFENSIVE: Safely returns 0 if 'em' is NULL.
+ */
+EMDEF size_t em_compact(EM *EM_RESTRICT em, size_t budget) {
+    EM_CHECK((em != NULL), 0, "Internal Error: 'em_compact' called on NULL easy memory");
+
+    EMHandleTable *table = em_get_extension(em)->handles;
+    if (table == NULL || table->live == 0) {
+        EM_TRACE_EVENT(EM_TRACE_COMPACT, em, NULL, budget, 0);
+        return 0;
+    }
+
+    size_t moved = 0;
+    bool from_start = (table->cursor == NULL);
+    Block *block = from_start ? em_get_first_block(em) : table->cursor;
+
+    while (moved < budget) {
+        if (block == em_get_tail(em)) {
+            // A pass resumed mid-arena wraps around once, to cover the blocks it skipped
+            if (from_start) {
+                block = NULL;
+                break;
+            }
+            from_start = true;
+            block = em_get_first_block(em);
+            continue;
+        }
+
+        Block *next = next_block_unsafe(block);
+        Block *hole = NULL;
+        if (get_is_free(block) && is_handle_block(em, next)) hole = compact_slide(em, table, block, next, &moved);
+        block = (hole != NULL) ? hole : next;
+    }
+
+    table->cursor = block;
+    EM_TRACE_EVENT(EM_TRACE_COMPACT, em, NULL, budget, moved);
+    return moved;
+}
+#endif // EM_HANDLES
+
+/*
+ * Create a nested Easy Memory instance with custom alignment
+ *
+ * Carves out a block from a parent arena and initializes it as an 
+ * independent child arena.
+ *
+ * Zero-Overhead Header (ABI Compatibility):
+ *   The EM and Block structures are strictly ABI compatible. The nested 
+ *   instance hijacks the parent's existing block header to store its own 
+ *   EM metadata. This ensures that 100% of the allocated payload is 
+ *   directly usable for child allocations, with zero additional overhead 
+ *   for the arena header itself.
+ *
+ * Performance:
+ *   - Allocation from parent: O(1) (tail) or O(log n) (tree).
+ *   - Initialization: O(1) Constant Time.
+ *
+ * Zero-Cost Parent Tracking:
+ *   - No explicit parent pointers are stored. The child arena identifies 
+ *     its parent using the "Physical Neighbor Walkback" strategy, 
+ *     traversing preceding blocks to find the owner. This saves 
+ *     8-16 bytes of metadata per instance.
+ *
+ * Alignment Requirements:
+ *   - Must be a power of two.
+ *   - Range: [4..512] bytes (32-bit systems) or [8..1024] bytes (64-bit systems).
+ *
+ * Capacity Limits:
+ *   - Usable Max: Exactly the 'size' requested from the parent. 
  *     The child gains full access to the parent's allocated payload area.
  *   - Physical Max: 512 MiB (32-bit) or 2 EiB (64-bit).
  *
@@ -4324,7 +8024,9 @@ EMDEF void em_reset_zero(EM *EM_RESTRICT em) {
 EMDEF EM *em_create_nested_aligned(EM *EM_RESTRICT parent_em, size_t size, size_t alignment) {
     EM_CHECK((parent_em != NULL)                 , NULL, "Internal Error: 'em_create_nested_aligned' called with NULL parent easy memory");
 
-    return create_nested_aligned_internal(parent_em, size, alignment, em_alloc);
+    EM *em = create_nested_aligned_internal(parent_em, size, alignment, alloc_internal);
+    EM_TRACE_EVENT(EM_TRACE_CREATE_NESTED, parent_em, em, size, alignment);
+    return em;
 }
 
 /*
@@ -4425,12 +8127,16 @@ EMDEF EM *em_create_scratch_aligned(EM *EM_RESTRICT parent_em, size_t size, size
     EM_CHECK((parent_em != NULL)                 , NULL, "Internal Error: 'em_create_scratch_aligned' called with NULL parent easy memory");
     EM_CHECK((!em_get_has_scratch(parent_em))    , NULL, "Internal Error: 'em_create_scratch_aligned' called when scratch already allocated in parent");
     
-    EM *em = create_nested_aligned_internal(parent_em, size, alignment, em_alloc_scratch);  // Allocate memory from the parent easy memory scratch
-    if (!em) return NULL;
+    EM *em = create_nested_aligned_internal(parent_em, size, alignment, alloc_scratch_internal);  // Allocate memory from the parent easy memory scratch
+    if (!em) {
+        EM_TRACE_EVENT(EM_TRACE_CREATE_SCRATCH, parent_em, NULL, size, alignment);
+        return NULL;
+    }
 
     set_color(&(em->as.block_representation), EMBLACK);  // Scratch block is always black to highlight its special status
     set_prev(&(em->as.block_representation), parent_em); // Scratch block has no previous block so we use prev pointer to store parent EM pointer
 
+    EM_TRACE_EVENT(EM_TRACE_CREATE_SCRATCH, parent_em, em, size, alignment);
     return em;
 }
 
@@ -4527,7 +8233,9 @@ EMDEF EM *em_create_scratch(EM *EM_RESTRICT parent_em, size_t size) {
  *   - Pointer to the Bump allocator instance, or NULL on failure.
  */
 EMDEF Bump *em_bump_create(EM *EM_RESTRICT parent_em, size_t size) {
-    return bump_create_internal(parent_em, size, em_alloc);
+    Bump *bump = bump_create_internal(parent_em, size, alloc_internal);
+    EM_TRACE_EVENT(EM_TRACE_BUMP_CREATE, parent_em, bump, size, 0);
+    return bump;
 }
 
 /*
@@ -4573,7 +8281,9 @@ EMDEF Bump *em_bump_create(EM *EM_RESTRICT parent_em, size_t size) {
  *   - Pointer to the Bump allocator instance, or NULL on failure.
  */
 EMDEF Bump *em_bump_create_scratch(EM *EM_RESTRICT parent_em, size_t size) {
-    return bump_create_internal(parent_em, size, em_alloc_scratch);
+    Bump *bump = bump_create_internal(parent_em, size, alloc_scratch_internal);
+    EM_TRACE_EVENT(EM_TRACE_BUMP_CREATE_SCRATCH, parent_em, bump, size, 0);
+    return bump;
 }
 
 /*
@@ -4611,10 +8321,18 @@ EMDEF void *em_bump_alloc(Bump *EM_RESTRICT bump, size_t size) {
     EM_CHECK((size > 0),     NULL, "Internal Error: 'em_bump_alloc' called with zero size");
 
     size_t offset = bump_get_offset(bump);
-    if (size >= (bump_get_capacity(bump) - offset + sizeof(Bump))) return NULL;
+    if (size >= (bump_get_capacity(bump) - offset + sizeof(Bump))) {
+        EM_TRACE_EVENT(EM_TRACE_BUMP_ALLOC, bump, NULL, size, 0);
+        return NULL;
+    }
 
     void *memory = (char *)bump + offset;
     bump_set_offset(bump, offset + size);
+    EM_ASAN_UNPOISON(memory, size);
+    EM_DIRTY_TOUCH(bump_get_em(bump), memory, (uintptr_t)memory + size);
+
+    EM_TRACE_EVENT(EM_TRACE_BUMP_ALLOC, bump, memory, size, 0);
+    EM_SAMPLE_POINTER(memory, size);
 
     return memory;
 }
@@ -4670,10 +8388,17 @@ EMDEF void *em_bump_alloc_aligned(Bump *EM_RESTRICT bump, size_t size, size_t al
     size_t total_size = padding + size;
 
     size_t offset = bump_get_offset(bump);
-    if ((size_t)total_size >= (bump_get_capacity(bump) - offset + sizeof(Bump))) return NULL;
+    if ((size_t)total_size >= (bump_get_capacity(bump) - offset + sizeof(Bump))) {
+        EM_TRACE_EVENT(EM_TRACE_BUMP_ALLOC, bump, NULL, size, alignment);
+        return NULL;
+    }
 
     bump_set_offset(bump, offset + total_size);
+    EM_ASAN_UNPOISON(aligned_ptr, size);
+    EM_DIRTY_TOUCH(bump_get_em(bump), aligned_ptr, aligned_ptr + size);
 
+    EM_TRACE_EVENT(EM_TRACE_BUMP_ALLOC, bump, aligned_ptr, size, alignment);
+    EM_SAMPLE_POINTER((void *)aligned_ptr, size);
     return (void *)aligned_ptr;
 }
 
@@ -4700,6 +8425,8 @@ EMDEF void *em_bump_alloc_aligned(Bump *EM_RESTRICT bump, size_t size, size_t al
 EMDEF void em_bump_trim(Bump *EM_RESTRICT bump) {
     EM_CHECK_V((bump != NULL), "Internal Error: 'em_bump_trim' called on NULL bump allocator");
 
+    EM_TRACE_EVENT(EM_TRACE_BUMP_TRIM, bump, NULL, 0, 0);
+
     if (get_is_in_scratch(&(bump->as.block_representation))) {
         return; 
     }
@@ -4719,8 +8446,15 @@ EMDEF void em_bump_trim(Bump *EM_RESTRICT bump) {
         new_payload_size = EM_MIN_BUFFER_SIZE;
     }
 
-    if (bump_get_capacity(bump) > new_payload_size) 
+    if (bump_get_capacity(bump) > new_payload_size) {
+        #ifdef EM_STATS
+        size_t old_size = get_size((Block *)bump);
+        split_block(parent, (Block*)bump, new_payload_size);
+        EM_STATS_SHRINK(parent, old_size - get_size((Block *)bump));
+        #else
         split_block(parent, (Block*)bump, new_payload_size);
+        #endif
+    }
 }
 
 /*
@@ -4752,8 +8486,12 @@ EMDEF void em_bump_trim(Bump *EM_RESTRICT bump) {
  */
 EMDEF void em_bump_reset(Bump *EM_RESTRICT bump) {
     EM_CHECK_V((bump != NULL), "Internal Error: 'em_bump_reset' called on NULL bump allocator");
+
+    EM_TRACE_EVENT(EM_TRACE_BUMP_RESET, bump, NULL, 0, 0);
+    EM_SAMPLE_FORGET_RANGE(bump, (uintptr_t)bump + bump_get_offset(bump));
     
     bump_set_offset(bump, sizeof(Bump));
+    EM_ASAN_POISON((char *)bump + sizeof(Bump), bump_get_capacity(bump));
 }
 
 /*
@@ -4788,6 +8526,12 @@ EMDEF void em_bump_reset(Bump *EM_RESTRICT bump) {
 EMDEF void em_bump_destroy(Bump *bump) {
     EM_CHECK_V((bump != NULL), "Internal Error: 'em_bump_destroy' called on NULL bump allocator");
 
+    EM_TRACE_EVENT(EM_TRACE_BUMP_DESTROY, bump, NULL, 0, 0);
+    EM_SAMPLE_FORGET_RANGE(bump, (uintptr_t)bump + bump_get_offset(bump));
+
+    // Clear the header tag so the parent reclaims a plain block
+    set_reserved_bits(&(bump->as.block_representation), 0);
+
     em_free_block_full(bump_get_em(bump), (Block *)(void *)bump);
 }
 
@@ -4833,7 +8577,9 @@ EMDEF void em_bump_destroy(Bump *bump) {
  *     detected integer overflows, or memory exhaustion.
  */
 EMDEF Slab *em_slab_create(EM *EM_RESTRICT parent_em, size_t slab_size, size_t chunk_size) {
-    return slab_create_internal(parent_em, slab_size, chunk_size, em_alloc);
+    Slab *slab = slab_create_internal(parent_em, slab_size, chunk_size, alloc_internal);
+    EM_TRACE_EVENT(EM_TRACE_SLAB_CREATE, parent_em, slab, slab_size, chunk_size);
+    return slab;
 }
 
 /*
@@ -4865,7 +8611,9 @@ EMDEF Slab *em_slab_create(EM *EM_RESTRICT parent_em, size_t slab_size, size_t c
  *     detected integer overflows, or memory exhaustion.
  */
 EMDEF Slab *em_slab_create_scratch(EM *EM_RESTRICT parent_em, size_t slab_size, size_t chunk_size) {
-    return slab_create_internal(parent_em, slab_size, chunk_size, em_alloc_scratch);
+    Slab *slab = slab_create_internal(parent_em, slab_size, chunk_size, alloc_scratch_internal);
+    EM_TRACE_EVENT(EM_TRACE_SLAB_CREATE_SCRATCH, parent_em, slab, slab_size, chunk_size);
+    return slab;
 }
 
 /*
@@ -4900,7 +8648,10 @@ EMDEF void *em_slab_alloc(Slab *EM_RESTRICT slab) {
     EM_CHECK((slab != NULL), NULL, "Internal Error: 'em_slab_alloc' called on NULL slab");
 
     size_t index = slab_get_index(slab);
-    if (index == 0) return NULL; 
+    if (index == 0) {
+        EM_TRACE_EVENT(EM_TRACE_SLAB_ALLOC, slab, NULL, 0, 0);
+        return NULL;
+    }
 
     size_t chunk_size = slab_get_chunk_size(slab);
     size_t capacity = slab_get_capacity(slab);
@@ -4924,7 +8675,9 @@ EMDEF void *em_slab_alloc(Slab *EM_RESTRICT slab) {
         size_t next_offset = offset + chunk_size;
         
         if (next_offset + chunk_size <= capacity) {
+            EM_ASAN_UNPOISON(data_start + next_offset, sizeof(uintptr_t));
             *(uintptr_t *)(data_start + next_offset) = next_idx;
+            EM_DIRTY_TOUCH(slab_get_em(slab), data_start + next_offset, data_start + next_offset + sizeof(uintptr_t));
             new_index = next_idx;
         } else {
             new_index = 0; 
@@ -4932,7 +8685,11 @@ EMDEF void *em_slab_alloc(Slab *EM_RESTRICT slab) {
     }
 
     slab_set_index(slab, new_index);
+    EM_ASAN_UNPOISON(cur_chunk, chunk_size);
+    EM_DIRTY_TOUCH(slab_get_em(slab), cur_chunk, (uintptr_t)cur_chunk + chunk_size);
 
+    EM_TRACE_EVENT(EM_TRACE_SLAB_ALLOC, slab, cur_chunk, 0, 0);
+    EM_SAMPLE_POINTER((void *)cur_chunk, chunk_size);
     return (void *)cur_chunk;
 }
 
@@ -5024,8 +8781,26 @@ EMDEF void em_slab_free(Slab *EM_RESTRICT slab, void *pointer) {
     
     EM_CHECK_V((freed_index != old_head_idx), "Internal Error: 'em_slab_free' double free detected");
 
+    EM_TRACE_EVENT(EM_TRACE_SLAB_FREE, slab, pointer, 0, 0);
+    EM_SAMPLE_FORGET(pointer);
+
     *(uintptr_t *)pointer = old_head_idx;
     slab_set_index(slab, freed_index);
+    EM_ASAN_POISON((uintptr_t *)pointer + 1, slab_get_chunk_size(slab) - sizeof(uintptr_t));
+}
+
+/*
+ * Internal slab reset core (shared by em_slab_reset and em_slab_reset_zero)
+ */
+static inline void slab_reset_internal(Slab *EM_RESTRICT slab) {
+    EM_SAMPLE_FORGET_RANGE(slab, (uintptr_t)slab + sizeof(Slab) + slab_get_capacity(slab));
+    slab_set_index(slab, 1);
+    
+    uintptr_t *first_chunk = (uintptr_t *)(void *)((char *)slab + sizeof(Slab));
+    EM_ASAN_POISON(first_chunk, slab_get_capacity(slab));
+    EM_ASAN_UNPOISON(first_chunk, sizeof(uintptr_t));
+    *first_chunk = 1;
+    EM_DIRTY_TOUCH(slab_get_em(slab), first_chunk, first_chunk + 1);
 }
 
 /*
@@ -5051,10 +8826,8 @@ EMDEF void em_slab_free(Slab *EM_RESTRICT slab, void *pointer) {
 EMDEF void em_slab_reset(Slab *EM_RESTRICT slab) {
     EM_CHECK_V((slab != NULL), "Internal Error: 'em_slab_reset' called on NULL slab");
 
-    slab_set_index(slab, 1);
-    
-    uintptr_t *first_chunk = (uintptr_t *)(void *)((char *)slab + sizeof(Slab));
-    *first_chunk = 1;
+    EM_TRACE_EVENT(EM_TRACE_SLAB_RESET, slab, NULL, 0, 0);
+    slab_reset_internal(slab);
 }
 
 /*
@@ -5076,9 +8849,11 @@ EMDEF void em_slab_reset_zero(Slab *EM_RESTRICT slab) {
     EM_CHECK_V((slab != NULL), "Internal Error: 'em_slab_reset_zero' called on NULL slab");
 
     void *data_start = (void *)((char *)slab + sizeof(Slab));
-    memset(data_start, 0, slab_get_capacity(slab));
+    EM_ASAN_UNPOISON(data_start, slab_get_capacity(slab));
+    EM_RESET_ZERO(slab_get_em(slab), data_start, slab_get_capacity(slab));
     
-    em_slab_reset(slab);
+    slab_reset_internal(slab);
+    EM_TRACE_EVENT(EM_TRACE_SLAB_RESET_ZERO, slab, NULL, 0, 0);
 }
 
 /*
@@ -5106,6 +8881,9 @@ EMDEF void em_slab_reset_zero(Slab *EM_RESTRICT slab) {
 EMDEF void em_slab_destroy(Slab *slab) {
     EM_CHECK_V((slab != NULL), "Internal Error: 'em_slab_destroy' called on NULL slab");
 
+    EM_TRACE_EVENT(EM_TRACE_SLAB_DESTROY, slab, NULL, 0, 0);
+    EM_SAMPLE_FORGET_RANGE(slab, (uintptr_t)slab + sizeof(Slab) + slab_get_capacity(slab));
+
     set_reserved_bits(&(slab->as.block_representation), 0);
 
     em_free_block_full(slab_get_em(slab), (Block *)slab);
@@ -5160,7 +8938,9 @@ EMDEF void em_slab_destroy(Slab *slab) {
  *     detected integer overflows, or memory exhaustion.
  */
 EMDEF Stack *em_stack_create(EM *EM_RESTRICT parent_em, size_t stack_size) {
-    return em_stack_create_internal(parent_em, stack_size, em_alloc);
+    Stack *stack = em_stack_create_internal(parent_em, stack_size, alloc_internal);
+    EM_TRACE_EVENT(EM_TRACE_STACK_CREATE, parent_em, stack, stack_size, 0);
+    return stack;
 }
 
 /*
@@ -5196,7 +8976,9 @@ EMDEF Stack *em_stack_create(EM *EM_RESTRICT parent_em, size_t stack_size) {
  *     already active scratchpad, or memory exhaustion.
  */
 EMDEF Stack *em_stack_create_scratch(EM *EM_RESTRICT parent_em, size_t stack_size) {
-    return em_stack_create_internal(parent_em, stack_size, em_alloc_scratch);
+    Stack *stack = em_stack_create_internal(parent_em, stack_size, alloc_scratch_internal);
+    EM_TRACE_EVENT(EM_TRACE_STACK_CREATE_SCRATCH, parent_em, stack, stack_size, 0);
+    return stack;
 }
 
 /*
@@ -5284,12 +9066,19 @@ EMDEF void *em_stack_alloc_aligned(Stack *EM_RESTRICT stack, size_t size, size_t
     uintptr_t raw_ptr = (uintptr_t)stack + capacity - right_offset - size;
     uintptr_t aligned_ptr = align_down(raw_ptr, alignment);
     uintptr_t meta_end = (uintptr_t)stack + sizeof(Stack) + ((cur_index + 1) << meta_type);
-    if (aligned_ptr < meta_end) return NULL; 
+    if (aligned_ptr < meta_end) {
+        EM_TRACE_EVENT(EM_TRACE_STACK_ALLOC, stack, NULL, size, alignment);
+        return NULL;
+    }
 
     size_t new_right_offset = (uintptr_t)stack + capacity - aligned_ptr;
+    EM_ASAN_UNPOISON(meta_end - ((size_t)1 << meta_type), (size_t)1 << meta_type);
+    EM_ASAN_UNPOISON(aligned_ptr, size);
+    EM_DIRTY_TOUCH(stack_get_em(stack), aligned_ptr, aligned_ptr + size);  // Frames are above the meta slots
     stack_write_meta(stack, meta_type, cur_index, new_right_offset);
     stack_set_meta_index(stack, cur_index + 1);
 
+    EM_TRACE_EVENT(EM_TRACE_STACK_ALLOC, stack, aligned_ptr, size, alignment);
     return (void *)aligned_ptr;
 }
 
@@ -5361,226 +9150,1451 @@ EMDEF void em_stack_free(Stack *EM_RESTRICT stack, void *pointer) {
     size_t right_offset = stack_read_meta(stack, meta_type, cur_index - 1);
     uintptr_t head_ptr = (uintptr_t)stack + capacity - right_offset;
 
-    EM_CHECK_V(((uintptr_t)pointer == head_ptr), 
-               "Internal Error: 'em_stack_free' LIFO violation: pointer is not the head of the stack");
+    EM_CHECK_V(((uintptr_t)pointer == head_ptr), 
+               "Internal Error: 'em_stack_free' LIFO violation: pointer is not the head of the stack");
+
+    EM_TRACE_EVENT(EM_TRACE_STACK_FREE, stack, pointer, 0, 0);
+
+    #if defined(EM_POISONING) || defined(EM_HAS_ASAN)
+    size_t prev_offset = (cur_index - 1 == 0) ? 0 : stack_read_meta(stack, meta_type, cur_index - 2);
+    size_t poison_size = right_offset - prev_offset;
+    
+    #ifdef EM_HAS_ASAN
+    EM_ASAN_POISON(pointer, poison_size);
+    #else
+    memset(pointer, EM_POISON_BYTE, poison_size);
+    #endif
+    #endif
+
+    stack_set_meta_index(stack, cur_index - 1);
+}
+
+/*
+ * Get Stack Marker
+ *
+ * Returns a secure, XOR-hardened snapshot (marker) representing the current 
+ * allocation state of the stack.
+ *
+ * Security / XOR-Hardening:
+ *   Both the index and the verification signature are dynamically XOR-encrypted 
+ *   using the stack's base memory address. This protects against cross-allocator 
+ *   marker pollution (passing Stack A's marker to Stack B) and prevents 
+ *   forged marker rollbacks with zero performance overhead.
+ *
+ * Performance:
+ *   - O(1) Constant Time.
+ *   - Returns a lightweight 16-byte structure by value, which is optimized 
+ *     by modern compilers to pass entirely within CPU registers.
+ *
+ * Parameters:
+ *   - stack: Pointer to the active Stack allocator.
+ *
+ * Returns:
+ *   - A secured StackMarker structure. On failure (e.g. NULL stack), returns 
+ *     an empty, invalid marker.
+ *
+ * Safety & Behavior:
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT on NULL stack.
+ *   - EM_POLICY_DEFENSIVE: Safely returns an empty marker structure on NULL stack.
+ */
+EMDEF StackMarker em_stack_get_marker(const Stack *stack) {
+    StackMarker marker = {0, 0};
+    EM_CHECK((stack != NULL), marker, "Internal Error: 'em_stack_get_marker' called on NULL stack");
+
+    size_t cur_index = stack_get_meta_index(stack);
+    uintptr_t stack_addr = (uintptr_t)stack;
+    uintptr_t parent_em = (uintptr_t)stack_get_em(stack);
+
+    marker.index = cur_index ^ stack_addr;
+    marker.magic = parent_em ^ stack_addr;
+
+    return marker;
+}
+
+/*
+ * Free Stack to Marker (Rollback)
+ *
+ * Decrypts and validates a secured StackMarker, then rolls back the stack state, 
+ * releasing all allocations made after the marker's snapshot.
+ *
+ * Performance:
+ *   - O(1) Constant Time. Restores the stack pointer instantly by resetting the index.
+ *
+ * Memory Poisoning (Batch Mode):
+ *   - If EM_POISONING is enabled, calculates the entire boundary of the rolled-back 
+ *     region and poisons it with EM_POISON_BYTE in a single, highly efficient 
+ *     memset call rather than freeing blocks sequentially.
+ *
+ * Parameters:
+ *   - stack:  Pointer to the active Stack allocator.
+ *   - marker: The secure StackMarker to roll back to.
+ *
+ * Returns:
+ *   - None (void).
+ *
+ * Safety & Behavior:
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT on NULL stack, if the decrypted 
+ *     signature fails verification (alien or corrupted marker), or if the 
+ *     marker's index is out of range.
+ *   - EM_POLICY_DEFENSIVE: Performs robust validation. Safely aborts the 
+ *     operation and returns without modifying state if the pointer is NULL, 
+ *     the marker signature fails verification, or if the index is out of range.
+ */
+EMDEF void em_stack_free_to_marker(Stack *EM_RESTRICT stack, StackMarker marker) {
+    EM_CHECK_V((stack != NULL), "Internal Error: 'em_stack_free_to_marker' called on NULL stack");
+
+    uintptr_t stack_addr = (uintptr_t)stack;
+
+    /* 
+     * WHY DOING THIS? (XOR-Hardened Stack Markers)
+     *
+     * 1. THE VULNERABILITY OF RAW MARKERS:
+     * Standard stack allocators return raw offsets or pointers as rollback markers. 
+     * This is highly unsafe in complex applications, as a user could easily pass a marker 
+     * belonging to Stack A into Stack B, causing horrific out-of-bounds memory rollback 
+     * or metadata corruption.
+     *
+     * 2. THE MATHEMATICS OF XOR ENCRYPTION:
+     * To prevent cross-allocator marker pollution with zero runtime overhead, we encode 
+     * both the index and a validation signature by XORing them with the stack's base address:
+     *   encoded_magic = EM_MAGIC ^ stack_address
+     * If the marker is passed to a different stack, decoding it yields:
+     *   decoded_magic = encoded_magic ^ alien_stack_address = EM_MAGIC ^ stack_address ^ alien_stack_address
+     * Since stack_address != alien_stack_address, the decoded signature never equals EM_MAGIC,
+     * immediately triggering a safe assertion or OOM path. This is a 100% mathematically 
+     * secure protection mechanism compiled into simple 1-cycle bitwise XOR instructions.
+    */
+    uintptr_t parent_em = (uintptr_t)stack_get_em(stack);
+
+    uintptr_t decoded_magic = marker.magic ^ stack_addr;
+    EM_CHECK_V((decoded_magic == parent_em), 
+               "Internal Error: 'em_stack_free_to_marker' detected invalid, corrupted or alien stack marker");
+
+    size_t decoded_index = marker.index ^ stack_addr;
+    size_t cur_index = stack_get_meta_index(stack);
+    EM_CHECK_V((decoded_index <= cur_index), 
+               "Internal Error: 'em_stack_free_to_marker' marker index is out of range");
+
+    EM_TRACE_EVENT(EM_TRACE_STACK_FREE_TO_MARKER, stack, NULL, decoded_index, 0);
+
+    if (decoded_index == cur_index) return;
+
+    #if defined(EM_POISONING) || defined(EM_HAS_ASAN)
+    size_t meta_type = stack_get_meta_type(stack);
+    size_t capacity = stack_get_capacity(stack);
+
+    size_t right_offset_start = stack_read_meta(stack, meta_type, cur_index - 1);
+    size_t right_offset_end = (decoded_index == 0) ? 0 : stack_read_meta(stack, meta_type, decoded_index - 1);
+
+    uintptr_t poison_start = (uintptr_t)stack + capacity - right_offset_start;
+    size_t poison_size = right_offset_start - right_offset_end;
+
+    #ifdef EM_HAS_ASAN
+    EM_ASAN_POISON(poison_start, poison_size);
+    #else
+    memset((void *)poison_start, EM_POISON_BYTE, poison_size);
+    #endif
+    #endif
+
+    stack_set_meta_index(stack, decoded_index);
+}
+
+/*
+ * Reset Stack
+ *
+ * Instantly invalidates all active allocations in the stack, resetting its 
+ * internal cursor back to the beginning.
+ *
+ * Performance:
+ *   - O(1) Constant Time. Only the primary metadata index is updated (single 
+ *     register write).
+ *
+ * Parameters:
+ *   - stack: Pointer to the Stack allocator to be reset.
+ *
+ * Returns:
+ *   - None (void).
+ *
+ * Safety & Behavior:
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT if stack is NULL.
+ *   - EM_POLICY_DEFENSIVE: Safely returns if stack is NULL.
+ */
+EMDEF void em_stack_reset(Stack *EM_RESTRICT stack) {
+    EM_CHECK_V((stack != NULL), "Internal Error: 'em_stack_reset' called on NULL stack");
+
+    EM_TRACE_EVENT(EM_TRACE_STACK_RESET, stack, NULL, 0, 0);
+
+    stack_set_meta_index(stack, 0);
+    EM_ASAN_POISON((char *)stack + sizeof(Stack), stack_get_capacity(stack));
+}
+
+/*
+ * Reset Stack and zero-initialize memory
+ *
+ * Resets the stack's index to 0 and zero-initializes the entire payload capacity.
+ *
+ * Performance:
+ *   - O(N) Linear Time, where N is the total capacity of the stack.
+ *
+ * Parameters:
+ *   - stack: Pointer to the Stack allocator to be reset.
+ *
+ * Returns:
+ *   - None (void).
+ *
+ * Safety & Behavior:
+ *   - Subject to the same Safety Policies and limits as em_stack_reset.
+ */
+EMDEF void em_stack_reset_zero(Stack *EM_RESTRICT stack) {
+    EM_CHECK_V((stack != NULL), "Internal Error: 'em_stack_reset_zero' called on NULL stack");
+
+    EM_TRACE_EVENT(EM_TRACE_STACK_RESET_ZERO, stack, NULL, 0, 0);
+
+    size_t capacity = stack_get_capacity(stack);
+    void *data_start = (void *)((char *)stack + sizeof(Stack));
+
+    EM_ASAN_UNPOISON(data_start, capacity);
+    EM_RESET_ZERO(stack_get_em(stack), data_start, capacity);
+    EM_ASAN_POISON(data_start, capacity);
+
+    stack_set_meta_index(stack, 0);
+}
+
+/*
+ * Destroy Stack Allocator
+ *
+ * Cleans up internal metadata and returns the entire allocated block back to the 
+ * parent Easy Memory EM instance.
+ *
+ * Performance:
+ *   - O(1) or O(log n). Leverages parent EM integration; may involve free-tree 
+ *     (LLRB) insertion and physical coalescing in the parent.
+ *
+ * Parameters:
+ *   - stack: Pointer to the Stack allocator to be destroyed.
+ *
+ * Returns:
+ *   - None (void).
+ *
+ * Safety & Behavior:
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT if stack is NULL.
+ *   - EM_POLICY_DEFENSIVE: Safely returns if stack is NULL.
+ */
+EMDEF void em_stack_destroy(Stack *stack) {
+    EM_CHECK_V((stack != NULL), "Internal Error: 'em_stack_destroy' called on NULL stack");
+
+    EM_TRACE_EVENT(EM_TRACE_STACK_DESTROY, stack, NULL, 0, 0);
+
+    // Clear reserved bits in size_and_reserved field so parent can reclaim block cleanly
+    set_reserved_bits(&(stack->as.block_representation), 0);
+
+    // Return the block back to the parent arena
+    em_free_block_full(stack_get_em(stack), (Block *)stack);
+}
+
+#ifdef EM_WALK
+/*
+ * Heap walk helpers
+ * The walk is iterative (Zero-Recursion Policy): descending into a nested arena switches the
+ * current arena, and the way back up is recovered from the nested header itself through
+ * get_parent_em, so no explicit stack of parents is needed.
+ */
+static inline Block *walk_scratch_block(const EM *em) {
+    if (!em_get_has_scratch(em)) return NULL;
+
+    uintptr_t raw_end = (uintptr_t)em + em_get_capacity(em);
+    uintptr_t size_spot = align_down(raw_end, EMMIN_ALIGNMENT) - sizeof(uintptr_t);
+
+    return (Block *)(raw_end - *(const uintptr_t *)size_spot);
+}
+
+static inline EMWalkKind walk_classify(const Block *block, bool is_scratch) {
+    uintptr_t word2 = (uintptr_t)block->as.occupied.em;
+
+    if (word2 & EMIS_NESTED_FLAG) return EM_WALK_NESTED;
+    if (word2 & EMSLAB_EM_TAG)    return EM_WALK_SLAB;
+
+    switch (get_reserved_bits(block) & EMSUBALLOC_TAG_MASK) {
+        case EMBUMP_TAG:  return EM_WALK_BUMP;
+        case EMSTACK_TAG: return EM_WALK_STACK;
+        default:          return is_scratch ? EM_WALK_SCRATCH : EM_WALK_USED;
+    }
+}
+
+static inline bool walk_emit(EMWalkCallback callback, void *context, EMWalkKind kind,
+                             const void *address, const EM *owner, size_t size, unsigned depth) {
+    EMWalkEntry entry;
+    entry.address = address;
+    entry.owner = owner;
+    entry.size = size;
+    entry.depth = depth;
+    entry.kind = kind;
+
+    return callback(&entry, context);
+}
+
+/*
+ * Report the inside of a Bump, Slab or Stack allocator one level below its header
+ */
+static bool walk_sub_allocator(EMWalkKind kind, const Block *block, const EM *owner, unsigned depth,
+                               EMWalkCallback callback, void *context) {
+    uintptr_t data = (uintptr_t)block_data(block);
+    size_t capacity = get_size(block);
+
+    if (kind == EM_WALK_BUMP) {
+        size_t used = bump_get_offset((const Bump *)(const void *)block) - sizeof(Bump);
+
+        if (used > 0 && !walk_emit(callback, context, EM_WALK_SUB_USED, (const void *)data, owner, used, depth)) return false;
+        if (capacity > used && !walk_emit(callback, context, EM_WALK_SUB_FREE, (const void *)(data + used), owner, capacity - used, depth)) return false;
+        return true;
+    }
+
+    if (kind == EM_WALK_SLAB) {
+        const Slab *slab = (const Slab *)(const void *)block;
+        size_t chunk_size = slab_get_chunk_size(slab);
+        size_t total = capacity / chunk_size;
+        size_t free_chunks = 0;
+
+        // Follow the free list up to the virgin frontier (a chunk holding its own index)
+        size_t index = slab_get_index(slab);
+        for (size_t steps = 0; index != 0 && index <= total && steps < total; steps++) {
+            size_t value = (size_t)*(const uintptr_t *)(data + (index - 1) * chunk_size);
+            if (value == index) {
+                free_chunks += total - index + 1;
+                break;
+            }
+            free_chunks++;
+            index = value;
+        }
+
+        size_t used = (total - free_chunks) * chunk_size;
+        if (used > 0 && !walk_emit(callback, context, EM_WALK_SUB_USED, (const void *)data, owner, used, depth)) return false;
+        if (capacity > used && !walk_emit(callback, context, EM_WALK_SUB_FREE, (const void *)data, owner, capacity - used, depth)) return false;
+        return true;
+    }
+
+    // Stack: frames grow down from the end, the offset array grows up from the header
+    const Stack *stack = (const Stack *)(const void *)block;
+    size_t meta_type = stack_get_meta_type(stack);
+    size_t count = stack_get_meta_index(stack);
+    uintptr_t end = (uintptr_t)stack + capacity;
+    size_t previous = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        size_t offset = stack_read_meta(stack, meta_type, i);
+        if (!walk_emit(callback, context, EM_WALK_SUB_USED, (const void *)(end - offset), owner, offset - previous, depth)) return false;
+        previous = offset;
+    }
+
+    uintptr_t meta_end = (uintptr_t)stack + sizeof(Stack) + (count << meta_type);
+    uintptr_t frames_start = end - previous;
+    if (frames_start > meta_end && !walk_emit(callback, context, EM_WALK_SUB_FREE, (const void *)meta_end, owner, frames_start - meta_end, depth)) return false;
+    return true;
+}
+
+/*
+ * Step to the block after 'block' in 'em': the physical chain up to the tail, then the
+ * short-lived region (EM_LIFETIME), then the scratch block. Reports the untouched space
+ * after the tail on the way.
+ * Returns NULL (and sets *ok) once the arena is exhausted.
+ */
+static Block *walk_advance(EM *em, Block *block, unsigned depth, EMWalkCallback callback, void *context, bool *ok) {
+    Block *scratch = walk_scratch_block(em);
+    if (block == scratch) return NULL;
+
+    Block *tail = em_get_tail(em);
+    #ifdef EM_LIFETIME
+    const EMExtension *extension = em_get_extension(em);
+    if (extension->short_floor != NULL && (uintptr_t)block >= (uintptr_t)extension->short_floor) {
+        Block *next = next_block_unsafe(block);
+        return ((uintptr_t)next < extension->short_top) ? next : scratch;
+    }
+    #endif
+    if (block != tail) return next_block(em, block);
+
+    // A free tail is reported by its header like any free block, the leftover after an occupied tail by its start
+    size_t tail_space = free_size_in_tail(em);
+    if (get_is_free(tail) || tail_space > 0) {
+        const void *address = get_is_free(tail) ? (const void *)tail : (const void *)((uintptr_t)block_data(tail) + get_size(tail));
+        *ok = walk_emit(callback, context, EM_WALK_TAIL, address, em, tail_space, depth);
+    }
+
+    #ifdef EM_LIFETIME
+    if (*ok && extension->short_floor != NULL) return extension->short_floor;
+    #endif
+    return *ok ? scratch : NULL;
+}
+
+/*
+ * Walk all physical blocks of an arena
+ *
+ * Visits every block of 'em' in address order (the scratch block last), descending into
+ * nested arenas and reporting the contents of Bump, Slab and Stack allocators. Each region
+ * is handed to 'callback' as an EMWalkEntry; returning false from the callback stops the walk.
+ *
+ * Performance:
+ *   - O(n) in the number of blocks. Iterative, no allocations, no recursion.
+ *     Slab contents cost O(free chunks), Stack contents O(frames).
+ *
+ * Parameters:
+ *   - em:       Pointer to the Easy Memory instance to walk.
+ *   - callback: Function invoked for every entry.
+ *   - context:  Opaque pointer passed back to every callback.
+ *
+ * Returns:
+ *   - true if the walk completed, false if the callback stopped it (or on invalid arguments).
+ *
+ * Safety & Behavior:
+ *   - The arena must not be modified from inside the callback.
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT if em or callback is NULL.
+ */
+EMDEF bool em_walk(EM *em, EMWalkCallback callback, void *context) {
+    EM_CHECK((em != NULL),       false, "Internal Error: 'em_walk' called on NULL easy memory");
+    EM_CHECK((callback != NULL), false, "Internal Error: 'em_walk' called with NULL callback");
+
+    EM *current = em;
+    Block *block = em_get_first_block(current);
+    unsigned depth = 0;
+    bool ok = true;
+
+    for (;;) {
+        if (block != NULL) {
+            Block *scratch = walk_scratch_block(current);
+
+            if (get_is_free(block)) {
+                // The free tail block is empty by construction, its space is reported as TAIL
+                if (block != em_get_tail(current)) {
+                    ok = walk_emit(callback, context, EM_WALK_FREE, block, current, get_size(block), depth);
+                }
+            }
+            else {
+                EMWalkKind kind = walk_classify(block, block == scratch);
+                ok = walk_emit(callback, context, kind, block, current, get_size(block), depth);
+
+                if (ok && kind == EM_WALK_NESTED) {
+                    current = (EM *)(void *)block;
+                    block = em_get_first_block(current);
+                    depth++;
+                    continue;
+                }
+                if (ok && kind >= EM_WALK_BUMP && kind <= EM_WALK_STACK) {
+                    ok = walk_sub_allocator(kind, block, current, depth + 1, callback, context);
+                }
+            }
+
+            if (!ok) return false;
+            block = walk_advance(current, block, depth, callback, context, &ok);
+            if (!ok) return false;
+            continue;
+        }
+
+        // Current arena exhausted: resume in the parent right after the nested header
+        if (current == em) return true;
+
+        Block *header = &(current->as.block_representation);
+        current = get_parent_em(header);
+        depth--;
+        block = walk_advance(current, header, depth, callback, context, &ok);
+        if (!ok) return false;
+    }
+}
+
+/*
+ * Heap dump state: a small staging buffer so the writer sees large chunks, not entries
+ */
+#define EM_DUMP_BUFFER_SIZE 512
+
+typedef struct {
+    EMDumpWriter writer;
+    void *context;
+    uintptr_t last_address;
+    size_t length;
+    uint8_t buffer[EM_DUMP_BUFFER_SIZE];
+} EMDumpState;
+
+static bool dump_entry(const EMWalkEntry *entry, void *context) {
+    EMDumpState *state = (EMDumpState *)context;
+
+    if (state->length + 3 * EM_VARINT_MAX > EM_DUMP_BUFFER_SIZE) {
+        state->writer(state->buffer, state->length, state->context);
+        state->length = 0;
+    }
+
+    uint8_t *out = state->buffer + state->length;
+    size_t length = em_put_varint(out, (uintptr_t)entry->kind | ((uintptr_t)entry->depth << 4));
+    length += em_put_address(out + length, entry->address, &state->last_address);
+    length += em_put_varint(out + length, (uintptr_t)entry->size);
+    state->length += length;
+
+    return true;
+}
+
+/*
+ * Dump an arena in the binary heap dump format
+ *
+ * Encodes the em_walk sequence of 'em' (see HEAP DUMP FORMAT) and hands it to 'writer'
+ * in chunks of at most EM_DUMP_BUFFER_SIZE bytes. Decode and analyze the result offline
+ * with tools/em_heapdump.
+ *
+ * Performance:
+ *   - O(n) in the number of blocks, a few bytes per block, no formatting and no allocations.
+ *
+ * Parameters:
+ *   - em:      Pointer to the Easy Memory instance to dump.
+ *   - writer:  Sink for the encoded bytes.
+ *   - context: Opaque pointer passed back to every writer call.
+ *
+ * Returns:
+ *   - true on success, false on invalid arguments.
+ *
+ * Safety & Behavior:
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT if em or writer is NULL.
+ */
+EMDEF bool em_dump(EM *em, EMDumpWriter writer, void *context) {
+    EM_CHECK((em != NULL),     false, "Internal Error: 'em_dump' called on NULL easy memory");
+    EM_CHECK((writer != NULL), false, "Internal Error: 'em_dump' called with NULL writer");
+
+    EMDumpState state;
+    state.writer = writer;
+    state.context = context;
+    state.last_address = (uintptr_t)em;
+    state.length = 0;
+
+    uint8_t *out = state.buffer;
+    out[0] = 'E'; out[1] = 'M'; out[2] = 'H'; out[3] = 'D';
+    out[4] = EM_DUMP_VERSION;
+    out[5] = (uint8_t)sizeof(uintptr_t);
+    state.length = 6;
+    state.length += em_put_varint(out + state.length, (uintptr_t)em);
+    state.length += em_put_varint(out + state.length, (uintptr_t)em_get_capacity(em));
+
+    em_walk(em, dump_entry, &state);
+
+    if (state.length > 0) writer(state.buffer, state.length, context);
+    return true;
+}
+#endif // EM_WALK
+
+#ifdef EM_STATS
+/*
+ * Get arena statistics
+ *
+ * Returns a snapshot of the occupancy counters maintained by the allocation,
+ * free, split and merge paths, completed with values derived from the header.
+ *
+ * Performance:
+ *   - O(1). The largest free tree block is cached on insert and detach, as
+ *     EM_FREE_TREE_AUGMENT does; with EM_FREE_INDEX the index adds a walk down its
+ *     right edge (a handful of nodes).
+ *
+ * Parameters:
+ *   - em: Pointer to the Easy Memory instance to inspect.
+ *
+ * Returns:
+ *   - EMStats filled with the current values (all zero for NULL in defensive mode).
+ *
+ * Safety & Behavior:
+ *   - Counts only this arena: a nested EM, bump, slab or stack is one live block
+ *     of its parent. Scratch memory is reported in 'scratch_bytes' only.
+ *   - Byte counts are block payload sizes, so alignment padding inside a block is
+ *     counted as used while block headers are not counted at all.
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT if em is NULL.
+ */
+EMDEF EMStats em_get_stats(const EM *em) {
+    EMStats stats;
+    memset(&stats, 0, sizeof(stats));
+
+    EM_CHECK((em != NULL), stats, "Internal Error: 'em_get_stats' called on NULL easy memory");
+
+    const EMExtension *extension = (const EMExtension *)(const void *)((const char *)em + sizeof(EM));
+
+    stats.capacity         = em_get_capacity(em);
+    stats.used_bytes       = extension->used_bytes;
+    stats.peak_used_bytes  = extension->peak_used_bytes;
+    stats.live_blocks      = extension->live_blocks;
+    stats.free_tree_bytes  = extension->free_tree_bytes;
+    stats.free_tree_blocks = extension->free_tree_blocks;
+    stats.free_tail_bytes  = free_size_in_tail(em);
+
+    if (em_get_has_scratch(em)) {
+        uintptr_t end_of_em = align_down((uintptr_t)em + stats.capacity, EMMIN_ALIGNMENT);
+        stats.scratch_bytes = (size_t)*(const uintptr_t *)(end_of_em - sizeof(uintptr_t));
+    }
+
+    #ifdef EM_LIFETIME
+    if (extension->short_floor != NULL) {
+        stats.short_region_bytes = (size_t)(extension->short_top - (uintptr_t)extension->short_floor);
+        stats.short_region_top = (size_t)(extension->short_top - (uintptr_t)em);
+    }
+    stats.short_held_bytes  = extension->short_held_bytes;
+    stats.short_held_blocks = extension->short_held_blocks;
+    #endif
+
+    stats.largest_free_block = stats.free_tail_bytes;
+    if (extension->free_tree_largest > stats.largest_free_block) stats.largest_free_block = extension->free_tree_largest;
+
+    #ifdef EM_FREE_INDEX
+    const EMFreeIndex *index = extension->free_index;
+    if (index != NULL && em_index_largest(index) > stats.largest_free_block) stats.largest_free_block = em_index_largest(index);
+    #endif
+
+    #ifdef EM_FREE_TLSF
+    if (extension->tlsf != NULL && extension->tlsf->largest > stats.largest_free_block) stats.largest_free_block = extension->tlsf->largest;
+    #endif
+
+    return stats;
+}
+#endif // EM_STATS
+
+#ifdef EM_VERIFY
+/*
+ * Heap verification helpers
+ * Every pointer read from a header is bounds-checked before it is followed, so a damaged
+ * arena yields a report instead of a crash. The block chain runs from the first block to
+ * the tail and ends at the scratch header (or the arena end), or with EM_LIFETIME at the
+ * floor of the short-lived region.
+ */
+typedef struct {
+    uintptr_t first;  // First block header
+    uintptr_t tail;   // Tail block header
+    uintptr_t top;    // Scratch block header (or the arena end)
+    uintptr_t end;    // End of the block chain
+} VerifyBounds;
+
+static inline bool verify_in_chain(const Block *block, const VerifyBounds *bounds) {
+    uintptr_t address = (uintptr_t)block;
+    return (address % sizeof(uintptr_t)) == 0 && address >= bounds->first && address <= bounds->tail;
+}
+
+static const char *verify_bounds(const EM *em, VerifyBounds *bounds) {
+    uintptr_t raw_end = (uintptr_t)em + em_get_capacity(em);
+
+    bounds->first = (uintptr_t)em_get_first_block(em);
+    bounds->tail = (uintptr_t)em_get_tail(em);
+    bounds->end = raw_end;
+
+    if (em_get_has_scratch(em)) {
+        uintptr_t size_spot = align_down(raw_end, EMMIN_ALIGNMENT) - sizeof(uintptr_t);
+        uintptr_t scratch_size = *(const uintptr_t *)size_spot;
+        if (scratch_size < sizeof(Block) || scratch_size > raw_end - bounds->first) return "scratch size is out of range";
+        bounds->end = raw_end - scratch_size;
+    }
+    bounds->top = bounds->end;
+
+    #ifdef EM_LIFETIME
+    const EMExtension *extension = (const EMExtension *)(const void *)((const char *)em + sizeof(EM));
+    if (extension->short_floor != NULL) {
+        uintptr_t floor = (uintptr_t)extension->short_floor;
+        if (floor % sizeof(uintptr_t) != 0 || floor < bounds->first || floor >= extension->short_top ||
+            extension->short_top > bounds->top) return "short-lived region is outside the arena";
+        bounds->end = floor;
+    }
+    #endif
+
+    if (bounds->tail % sizeof(uintptr_t) != 0 || bounds->tail < bounds->first || 
+        bounds->tail + sizeof(Block) > bounds->end) return "tail is outside the arena";
+    return NULL;
+}
+
+#ifdef EM_FREE_TLSF
+/*
+ * Both neighbours in the list of 'block' link back to it, and a block without a previous
+ * one is the head of its class (the links em_tlsf_remove relies on)
+ */
+static bool verify_tlsf_linked(const EMTlsf *tlsf, Block *block, const VerifyBounds *bounds) {
+    if (get_size(block) > EM_TLSF_MAX_SIZE) return false;
+
+    size_t fl, sl;
+    em_tlsf_mapping(get_size(block), &fl, &sl);
+    Block *next = get_left_tree(block);
+    Block *prev = get_right_tree(block);
+    if (next != NULL && (!verify_in_chain(next, bounds) || get_right_tree(next) != block)) return false;
+    if (prev != NULL) return verify_in_chain(prev, bounds) && get_left_tree(prev) == block;
+    return tlsf->heads[fl][sl] == block && ((tlsf->sl_bitmap[fl] >> sl) & 1u) != 0 && ((tlsf->fl_bitmap >> fl) & 1u) != 0;
+}
+#endif // EM_FREE_TLSF
+
+/*
+ * Follow the search path of 'block' from the root (the path detach_block_by_ptr takes)
+ */
+static bool verify_tree_contains(const EM *em, Block *block, const VerifyBounds *bounds) {
+    Block *current = em_get_free_blocks(em);
+    for (size_t depth = 0; current != NULL && depth <= 2 * EM_MAX_TREE_HEIGHT; depth++) {
+        if (current == block) return true;
+        if (!verify_in_chain(current, bounds)) return false;
+        current = (compare_blocks(block, current) < 0) ? get_left_tree(current) : get_right_tree(current);
+    }
+    return false;
+}
+
+#ifdef EM_FREE_INDEX
+/*
+ * Index nodes must come from the node pool of the index and hold a sane count
+ */
+static inline bool verify_index_node(const EMFreeIndex *index, const EMIndexNode *node) {
+    uintptr_t base = (uintptr_t)(index->end - index->nodes);
+    uintptr_t address = (uintptr_t)node;
+    return address >= base && address < (uintptr_t)index->end && (address - base) % sizeof(EMIndexNode) == 0 &&
+           node->count > 0 && node->count <= EM_INDEX_FANOUT;
+}
+
+/*
+ * Follow the search path of 'block' through the free index (the path em_index_remove takes)
+ */
+static bool verify_index_contains(const EM *em, Block *block) {
+    const EMExtension *extension = (const EMExtension *)(const void *)((const char *)em + sizeof(EM));
+    const EMFreeIndex *index = extension->free_index;
+    if (index == NULL || index->root == NULL || index->height > EM_INDEX_MAX_HEIGHT) return false;
+
+    uintptr_t size = get_size(block);
+    const EMIndexNode *node = index->root;
+    for (size_t level = 1; level < index->height; level++) {
+        if (!verify_index_node(index, node)) return false;
+        size_t upper = em_index_upper(node, size, (uintptr_t)block);
+        if (upper == 0) return false;  // Slot 0 is the sentinel, every key ranks above it
+        node = node->children[upper - 1];
+    }
+    if (!verify_index_node(index, node)) return false;
+
+    size_t at = em_index_lower(node, size, (uintptr_t)block);
+    return at < node->count && node->blocks[at] == (uintptr_t)block;
+}
+#endif // EM_FREE_INDEX
+
+#ifdef EM_HANDLES
+/*
+ * Handle block: its slot must be live and name a data pointer inside the block
+ */
+static const char *verify_handle(const EM *em, const Block *block) {
+    const EMHandleTable *table = ((const EMExtension *)(const void *)((const char *)em + sizeof(EM)))->handles;
+    if (table == NULL) return "handle block without a handle table";
+
+    uintptr_t magic = get_magic(block);
+    if ((magic & 1) == 0 || (magic >> 1) >= table->capacity) return "handle block names no slot of the table";
+
+    uintptr_t data = (uintptr_t)block_data(block);
+    uintptr_t user_ptr = ((const uintptr_t *)(const void *)(table + 1))[magic >> 1];
+    if ((user_ptr & 1) != 0 || user_ptr < data || user_ptr > data + get_size(block)) return "handle slot does not point into its block";
+    if (user_ptr != data && (*(const uintptr_t *)(user_ptr - sizeof(uintptr_t)) ^ user_ptr) != (uintptr_t)block) return "alignment back-link does not point to the block";
+    return NULL;
+}
+#endif // EM_HANDLES
+
+/*
+ * Occupied block: owner, and for plain allocations the XOR magic and alignment back-link.
+ * Nested arenas overlay their own header, sub-allocators reuse the magic word.
+ */
+static const char *verify_occupied(const EM *em, Block *block) {
+    uintptr_t word2 = (uintptr_t)block->as.occupied.em;
+    uintptr_t data = (uintptr_t)block_data(block);
+
+    if (word2 & EMIS_NESTED_FLAG) {
+        uintptr_t nested_tail = (uintptr_t)em_get_tail((const EM *)(const void *)block);
+        if (nested_tail < data || nested_tail >= data + get_size(block)) return "nested arena tail is outside its block";
+        return NULL;
+    }
+    if (get_em(block) != em) return "occupied block belongs to another arena";
+    if ((word2 & EMSLAB_EM_TAG) || (get_reserved_bits(block) & EMSUBALLOC_TAG_MASK) == EMBUMP_TAG ||
+        (get_reserved_bits(block) & EMSUBALLOC_TAG_MASK) == EMSTACK_TAG) return NULL;
+    #ifdef EM_HANDLES
+    if (get_reserved_bits(block) == EMHANDLE_TAG) return verify_handle(em, block);
+    #endif
+
+    uintptr_t user_ptr = get_magic(block) ^ (uintptr_t)EM_MAGIC;
+    if (user_ptr % sizeof(uintptr_t) != 0 || user_ptr < data || user_ptr > data + get_size(block)) return "magic does not match a data pointer inside the block";
+    if (user_ptr != data && (*(const uintptr_t *)(user_ptr - sizeof(uintptr_t)) ^ user_ptr) != (uintptr_t)block) return "alignment back-link does not point to the block";
+    return NULL;
+}
+
+/*
+ * Check one block of the chain
+ * Returns NULL or the failed check. Linkage is checked against the previous block only,
+ * which is what lets em_verify_step resume from any block.
+ */
+static const char *verify_block(const EM *em, Block *block, const VerifyBounds *bounds) {
+    if (!verify_in_chain(block, bounds)) return "block header is outside the block chain";
+
+    uintptr_t address = (uintptr_t)block;
+    uintptr_t data = (uintptr_t)block_data(block);
+    if (data > bounds->end || get_size(block) > bounds->end - data) return "block size runs past the end of the arena";
+    if (address != bounds->tail && (uintptr_t)next_block_unsafe(block) > bounds->tail) return "block runs past the tail";
+
+    Block *prev = get_prev(block);
+    if (address == bounds->first) {
+        if (prev != NULL) return "first block has a previous block";
+    }
+    else if (prev == NULL || (uintptr_t)prev >= address || !verify_in_chain(prev, bounds) || next_block_unsafe(prev) != block) {
+        return "previous block does not end at this block";
+    }
+
+    if (!get_is_free(block)) {
+        if (get_is_in_scratch(block)) return "block in the chain is marked as scratch";
+        return verify_occupied(em, block);
+    }
+
+    #ifdef EM_FREE_TLSF
+    const EMTlsf *tlsf = ((const EMExtension *)(const void *)((const char *)em + sizeof(EM)))->tlsf;
+    #endif
+
+    if (address == bounds->tail) {
+        if (get_size(block) != 0) return "free tail has a size";
+        #ifdef EM_FREE_TLSF
+        if (tlsf != NULL && verify_tlsf_linked(tlsf, block, bounds)) return "free tail is linked into the free lists";
+        #endif
+        if (verify_tree_contains(em, block, bounds)) return "free tail is linked into the free tree";
+        #ifdef EM_FREE_INDEX
+        if (verify_index_contains(em, block)) return "free tail is linked into the free index";
+        #endif
+        return NULL;
+    }
+
+    if (prev != NULL && get_is_free(prev)) return "adjacent free blocks were not merged";
+    #ifdef EM_FREE_TLSF
+    if (tlsf != NULL) return verify_tlsf_linked(tlsf, block, bounds) ? NULL : "free block is not linked into its free list";
+    #endif
+    #ifdef EM_FREE_INDEX
+    // Indexed blocks carry no tree links; the index itself is walked by em_verify
+    bool in_tree = verify_tree_contains(em, block, bounds);
+    if (verify_index_contains(em, block)) return in_tree ? "free block is both in the free tree and in the free index" : NULL;
+    if (!in_tree) return "free block is missing from the free tree";
+    #else
+    if (!verify_tree_contains(em, block, bounds)) return "free block is missing from the free tree";
+    #endif
+
+    Block *left = get_left_tree(block);
+    Block *right = get_right_tree(block);
+    if (left != NULL && (!verify_in_chain(left, bounds) || compare_blocks(left, block) > 0)) return "left free tree child is out of order";
+    if (right != NULL && (!verify_in_chain(right, bounds) || compare_blocks(right, block) < 0)) return "right free tree child is out of order";
+    #ifdef EM_FREE_TREE_AUGMENT
+    size_t bound = get_tree_bound(block);
+    if (bound > EMTREE_QUALITY_MAX || bound < tree_quality_of(block) || bound < get_tree_bound(left) || bound < get_tree_bound(right)) {
+        return "free tree node bound is below the qualities of its subtree";
+    }
+    #endif
+    return NULL;
+}
+
+#ifdef EM_LIFETIME
+/*
+ * Walk the short-lived region from its floor to its top
+ * Its blocks are unlinked (prev is NULL), so each one is checked against the region bounds
+ * only. Returns NULL or the failed check, with the offending header in *offender.
+ */
+static const char *verify_short_region(const EM *em, const VerifyBounds *bounds, Block **offender) {
+    const EMExtension *extension = (const EMExtension *)(const void *)((const char *)em + sizeof(EM));
+    Block *block = extension->short_floor;
+    if (block == NULL) return NULL;
+
+    *offender = block;
+    if (get_is_free(block)) return "short-lived region floor is free";
+    #ifdef EM_STATS
+    size_t held_bytes = 0, held_blocks = 0;
+    #endif
+    while ((uintptr_t)block < extension->short_top) {
+        *offender = block;
+        uintptr_t address = (uintptr_t)block;
+        if (address % sizeof(uintptr_t) != 0 || address < bounds->end || extension->short_top - address < sizeof(Block)) {
+            return "short-lived block is outside its region";
+        }
+        uintptr_t data = (uintptr_t)block_data(block);
+        if (get_size(block) > extension->short_top - data) return "short-lived block runs past the region top";
+        if (!get_is_free(block)) {
+            if (get_is_in_scratch(block)) return "short-lived block is marked as scratch";
+            const char *reason = verify_occupied(em, block);
+            if (reason != NULL) return reason;
+        }
+        #ifdef EM_STATS
+        else {
+            held_bytes += get_size(block);
+            held_blocks++;
+        }
+        #endif
+        block = next_block_unsafe(block);
+    }
+    if ((uintptr_t)block != extension->short_top) return "short-lived region does not end at its top";
+    #ifdef EM_STATS
+    *offender = extension->short_floor;
+    if (held_bytes != extension->short_held_bytes || held_blocks != extension->short_held_blocks) {
+        return "short-lived held statistics do not match the region";
+    }
+    #endif
+    return NULL;
+}
+#endif // EM_LIFETIME
+
+/*
+ * Check up to 'budget' blocks starting at 'block' (NULL: the first block)
+ * Returns the block to resume from: NULL after the tail (pass completed), the offending
+ * block on failure.
+ */
+static Block *verify_run(const EM *em, Block *block, size_t budget, EMVerifyReport *report, size_t *free_blocks) {
+    VerifyBounds bounds;
+    const char *reason = verify_bounds(em, &bounds);
+    if (reason != NULL) {
+        report->block = em;
+        report->reason = reason;
+        return NULL;
+    }
+
+    if (block == NULL) block = (Block *)bounds.first;
+
+    while (report->checked < budget) {
+        reason = verify_block(em, block, &bounds);
+        report->checked++;
+        if (reason != NULL) {
+            report->block = block;
+            report->reason = reason;
+            return block;
+        }
+        if (get_is_free(block) && (uintptr_t)block != bounds.tail) (*free_blocks)++;
+
+        if ((uintptr_t)block == bounds.tail) {
+            #ifdef EM_LIFETIME
+            Block *offender = NULL;
+            reason = verify_short_region(em, &bounds, &offender);
+            if (reason != NULL) {
+                report->block = offender;
+                report->reason = reason;
+                return block;
+            }
+            #endif
+            if (em_get_has_scratch(em)) {
+                Block *scratch = (Block *)bounds.top;
+                reason = get_is_in_scratch(scratch) ? verify_occupied(em, scratch) : "scratch block lost its flags";
+                if (reason != NULL) {
+                    report->block = scratch;
+                    report->reason = reason;
+                    return block;
+                }
+            }
+            report->passes++;
+            return NULL;
+        }
+        block = next_block_unsafe(block);
+    }
+    return block;
+}
+
+/*
+ * Verify the whole arena
+ *
+ * Walks every block of the arena and checks the physical chain (prev/next linkage, sizes
+ * within bounds, the tail, the short-lived region and the scratch block), occupied blocks (owner, XOR magic and
+ * alignment back-link) and free blocks (merged with their neighbours, reachable in the free
+ * tree, ordered against their children). The free tree is then traversed on its own to
+ * find nodes that are not free blocks of the chain, as is the leaf chain of an attached
+ * free index (or every list and bitmap bit of EM_FREE_TLSF), and with EM_STATS the
+ * counters are compared against both.
+ *
+ * Performance:
+ *   - O(n log n) in the number of blocks, no allocations. Meant for tests and debugging;
+ *     em_verify_step spreads the same per-block checks over many calls.
+ *
+ * Parameters:
+ *   - em: Pointer to the Easy Memory instance to verify.
+ *
+ * Returns:
+ *   - EMVerifyReport: 'block' and 'reason' are NULL if the arena is intact, otherwise
+ *     they name the first offending header and the failed check.
+ *
+ * Safety & Behavior:
+ *   - Nested arenas are checked as blocks of their parent; verify their contents by
+ *     passing the nested handle. Bump, Slab and Stack contents are not inspected.
+ *   - Never modifies the arena and never follows an unchecked pointer.
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT if em is NULL.
+ */
+EMDEF EMVerifyReport em_verify(EM *em) {
+    EMVerifyReport report;
+    memset(&report, 0, sizeof(report));
+
+    EM_CHECK((em != NULL), report, "Internal Error: 'em_verify' called on NULL easy memory");
+
+    size_t free_blocks = 0;
+    verify_run(em, NULL, SIZE_MAX, &report, &free_blocks);
+    if (report.reason != NULL) return report;
+
+    VerifyBounds bounds;
+    verify_bounds(em, &bounds);
+    size_t nodes = 0;
+
+    #ifdef EM_FREE_TLSF
+    // Every list: bitmap bits set exactly for the non-empty ones, every node a free block of its class
+    const EMTlsf *tlsf = em_get_extension(em)->tlsf;
+    size_t largest = 0;
+    for (size_t fl = 0; tlsf != NULL && fl < EM_TLSF_FL_COUNT; fl++) {
+        report.block = em;
+        if ((((tlsf->fl_bitmap >> fl) & 1u) != 0) != (tlsf->sl_bitmap[fl] != 0)) {
+            report.reason = "free list first-level bitmap disagrees with the second level";
+            return report;
+        }
+        for (size_t sl = 0; sl < EM_TLSF_SL_COUNT; sl++) {
+            if ((((tlsf->sl_bitmap[fl] >> sl) & 1u) != 0) != (tlsf->heads[fl][sl] != NULL)) {
+                report.block = em;
+                report.reason = "free list second-level bitmap disagrees with the list heads";
+                return report;
+            }
+            Block *prev = NULL;
+            for (Block *node = tlsf->heads[fl][sl]; node != NULL; node = get_left_tree(node)) {
+                report.block = node;
+                if (!verify_in_chain(node, &bounds) || !get_is_free(node) || (uintptr_t)node == bounds.tail) {
+                    report.reason = "free list links a block that is not a free block of the chain";
+                    return report;
+                }
+                if (++nodes > free_blocks) {
+                    report.reason = "free lists hold more nodes than there are free blocks";
+                    return report;
+                }
+                size_t node_fl, node_sl;
+                em_tlsf_mapping(get_size(node), &node_fl, &node_sl);
+                if (node_fl != fl || node_sl != sl || get_right_tree(node) != prev) {
+                    report.reason = "free list holds a block of another class or a broken back link";
+                    return report;
+                }
+                if (get_size(node) > largest) largest = get_size(node);
+                prev = node;
+            }
+        }
+    }
+    if (tlsf != NULL && tlsf->largest != largest) {
+        report.block = em;
+        report.reason = "cached largest free list block disagrees with the free lists";
+        return report;
+    }
+    #endif
+
+    // Iterative preorder traversal: the pending stack never holds more than one node per level
+    Block *pending[EM_MAX_TREE_HEIGHT + 2];
+    size_t depth = 0;
+    Block *root = em_get_free_blocks(em);
+    if (root != NULL) pending[depth++] = root;
+
+    while (depth > 0) {
+        Block *node = pending[--depth];
+        report.block = node;
+        if (!verify_in_chain(node, &bounds) || !get_is_free(node) || (uintptr_t)node == bounds.tail) {
+            report.reason = "free tree links a block that is not a free block of the chain";
+            return report;
+        }
+        if (++nodes > free_blocks) {
+            report.reason = "free tree holds more nodes than there are free blocks";
+            return report;
+        }
+
+        Block *left = get_left_tree(node);
+        Block *right = get_right_tree(node);
+        if (depth + 2 > sizeof(pending) / sizeof(pending[0])) {
+            report.reason = "free tree is deeper than EM_MAX_TREE_HEIGHT";
+            return report;
+        }
+        if (right != NULL) pending[depth++] = right;
+        if (left != NULL) pending[depth++] = left;
+    }
+
+    #if defined(EM_STATS) || defined(EM_FREE_TREE_AUGMENT)
+    // The traversal found no cycle, so the right spine ends
+    Block *rightmost = root;
+    while (rightmost != NULL && get_right_tree(rightmost) != NULL) rightmost = get_right_tree(rightmost);
+    if (em_get_extension(em)->free_tree_largest != (rightmost != NULL ? get_size(rightmost) : 0)) {
+        report.block = em;
+        report.reason = "cached largest free tree block disagrees with the free tree";
+        return report;
+    }
+    #endif
+    report.block = NULL;
+
+    #ifdef EM_FREE_INDEX
+    // Leaf chain of the free index: every key names a free block of its size, in ascending order
+    const EMFreeIndex *index = em_get_extension(em)->free_index;
+    if (index != NULL) {
+        size_t indexed = 0;
+        size_t leaves = 0;
+        uintptr_t last_size = 0;
+        uintptr_t last_block = 0;
+        const EMIndexNode *leaf = index->root;
+        for (size_t level = 1; leaf != NULL && level < index->height && level < EM_INDEX_MAX_HEIGHT; level++) {
+            leaf = verify_index_node(index, leaf) ? leaf->children[0] : NULL;
+        }
+
+        for (; leaf != NULL; leaf = leaf->next) {
+            report.block = index;
+            if (!verify_index_node(index, leaf) || ++leaves > index->nodes) {
+                report.reason = "free index links a node outside its pool";
+                return report;
+            }
+            for (size_t i = 0; i < leaf->count; i++) {
+                Block *block = (Block *)leaf->blocks[i];
+                report.block = block;
+                if (!verify_in_chain(block, &bounds) || !get_is_free(block) || (uintptr_t)block == bounds.tail || get_size(block) != leaf->sizes[i]) {
+                    report.reason = "free index holds a key that is not a free block of the chain";
+                    return report;
+                }
+                if (leaf->sizes[i] < last_size || (leaf->sizes[i] == last_size && leaf->blocks[i] <= last_block)) {
+                    report.reason = "free index keys are out of order";
+                    return report;
+                }
+                last_size = leaf->sizes[i];
+                last_block = leaf->blocks[i];
+                indexed++;
+            }
+        }
+        report.block = index;
+        if (indexed != index->count || nodes + indexed > free_blocks) {
+            report.reason = "free index count disagrees with the free blocks";
+            return report;
+        }
+        report.block = NULL;
+        nodes += indexed;
+    }
+    #endif
 
-    #ifdef EM_POISONING
-    size_t prev_offset = (cur_index - 1 == 0) ? 0 : stack_read_meta(stack, meta_type, cur_index - 2);
-    size_t poison_size = right_offset - prev_offset;
-    
-    memset(pointer, EM_POISON_BYTE, poison_size);
+    #ifdef EM_STATS
+    if (em_get_extension(em)->free_tree_blocks != nodes) {
+        report.block = em;
+        report.reason = "statistics disagree with the free tree";
+    }
     #endif
 
-    stack_set_meta_index(stack, cur_index - 1);
+    return report;
 }
 
 /*
- * Get Stack Marker
- *
- * Returns a secure, XOR-hardened snapshot (marker) representing the current 
- * allocation state of the stack.
+ * Verify the arena incrementally
  *
- * Security / XOR-Hardening:
- *   Both the index and the verification signature are dynamically XOR-encrypted 
- *   using the stack's base memory address. This protects against cross-allocator 
- *   marker pollution (passing Stack A's marker to Stack B) and prevents 
- *   forged marker rollbacks with zero performance overhead.
+ * Runs the per-block checks of em_verify on at most 'budget' blocks, starting where the
+ * previous call stopped. The cursor lives in the arena header and follows blocks through
+ * merges, so allocations and frees may happen between calls; em_reset starts a new pass.
+ * Calling this with a small budget from a periodic task gives production builds bounded,
+ * amortized integrity checking without a stop-the-world walk.
  *
  * Performance:
- *   - O(1) Constant Time.
- *   - Returns a lightweight 16-byte structure by value, which is optimized 
- *     by modern compilers to pass entirely within CPU registers.
+ *   - O(budget * log n) per call, no allocations.
  *
  * Parameters:
- *   - stack: Pointer to the active Stack allocator.
+ *   - em:     Pointer to the Easy Memory instance to verify.
+ *   - budget: Maximum number of blocks to check in this call.
  *
  * Returns:
- *   - A secured StackMarker structure. On failure (e.g. NULL stack), returns 
- *     an empty, invalid marker.
+ *   - EMVerifyReport: 'checked' blocks were examined and 'passes' is 1 when the call
+ *     reached the tail (the next call starts over from the first block). On corruption
+ *     'block' and 'reason' name the offending header; the cursor stays on it, so later
+ *     calls keep reporting it.
  *
  * Safety & Behavior:
- *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT on NULL stack.
- *   - EM_POLICY_DEFENSIVE: Safely returns an empty marker structure on NULL stack.
+ *   - Only the whole-tree traversal of em_verify is left out: a free tree node that is not
+ *     a free block of the chain is only found by em_verify.
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT if em is NULL.
  */
-EMDEF StackMarker em_stack_get_marker(const Stack *stack) {
-    StackMarker marker = {0, 0};
-    EM_CHECK((stack != NULL), marker, "Internal Error: 'em_stack_get_marker' called on NULL stack");
-
-    size_t cur_index = stack_get_meta_index(stack);
-    uintptr_t stack_addr = (uintptr_t)stack;
-    uintptr_t parent_em = (uintptr_t)stack_get_em(stack);
+EMDEF EMVerifyReport em_verify_step(EM *em, size_t budget) {
+    EMVerifyReport report;
+    memset(&report, 0, sizeof(report));
 
-    marker.index = cur_index ^ stack_addr;
-    marker.magic = parent_em ^ stack_addr;
+    EM_CHECK((em != NULL), report, "Internal Error: 'em_verify_step' called on NULL easy memory");
 
-    return marker;
+    size_t free_blocks = 0;
+    EMExtension *extension = em_get_extension(em);
+    extension->verify_cursor = verify_run(em, extension->verify_cursor, budget, &report, &free_blocks);
+    return report;
 }
+#endif // EM_VERIFY
 
+#ifdef EM_PROFILE
 /*
- * Free Stack to Marker (Rollback)
+ * Get allocation path profile
  *
- * Decrypts and validates a secured StackMarker, then rolls back the stack state, 
- * releasing all allocations made after the marker's snapshot.
+ * Returns a copy of the path counters of this arena, so a workload can be
+ * classified as running on the O(1) paths (tail hits, LIFO frees) or on the
+ * O(log n) free-tree paths (tree hits, detaches, inserts).
  *
  * Performance:
- *   - O(1) Constant Time. Restores the stack pointer instantly by resetting the index.
- *
- * Memory Poisoning (Batch Mode):
- *   - If EM_POISONING is enabled, calculates the entire boundary of the rolled-back 
- *     region and poisons it with EM_POISON_BYTE in a single, highly efficient 
- *     memset call rather than freeing blocks sequentially.
+ *   - O(1).
  *
  * Parameters:
- *   - stack:  Pointer to the active Stack allocator.
- *   - marker: The secure StackMarker to roll back to.
+ *   - em: Pointer to the Easy Memory instance to inspect.
  *
  * Returns:
- *   - None (void).
+ *   - EMProfile snapshot (all zero for NULL in defensive mode).
  *
  * Safety & Behavior:
- *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT on NULL stack, if the decrypted 
- *     signature fails verification (alien or corrupted marker), or if the 
- *     marker's index is out of range.
- *   - EM_POLICY_DEFENSIVE: Performs robust validation. Safely aborts the 
- *     operation and returns without modifying state if the pointer is NULL, 
- *     the marker signature fails verification, or if the index is out of range.
+ *   - Counters are per arena; nested arenas keep their own profile.
+ *   - Counters survive em_reset; use em_profile_reset to start a new measurement.
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT if em is NULL.
  */
-EMDEF void em_stack_free_to_marker(Stack *EM_RESTRICT stack, StackMarker marker) {
-    EM_CHECK_V((stack != NULL), "Internal Error: 'em_stack_free_to_marker' called on NULL stack");
-
-    uintptr_t stack_addr = (uintptr_t)stack;
-
-    /* 
-     * WHY DOING THIS? (XOR-Hardened Stack Markers)
-     *
-     * 1. THE VULNERABILITY OF RAW MARKERS:
-     * Standard stack allocators return raw offsets or pointers as rollback markers. 
-     * This is highly unsafe in complex applications, as a user could easily pass a marker 
-     * belonging to Stack A into Stack B, causing horrific out-of-bounds memory rollback 
-     * or metadata corruption.
-     *
-     * 2. THE MATHEMATICS OF XOR ENCRYPTION:
-     * To prevent cross-allocator marker pollution with zero runtime overhead, we encode 
-     * both the index and a validation signature by XORing them with the stack's base address:
-     *   encoded_magic = EM_MAGIC ^ stack_address
-     * If the marker is passed to a different stack, decoding it yields:
-     *   decoded_magic = encoded_magic ^ alien_stack_address = EM_MAGIC ^ stack_address ^ alien_stack_address
-     * Since stack_address != alien_stack_address, the decoded signature never equals EM_MAGIC,
-     * immediately triggering a safe assertion or OOM path. This is a 100% mathematically 
-     * secure protection mechanism compiled into simple 1-cycle bitwise XOR instructions.
-    */
-    uintptr_t parent_em = (uintptr_t)stack_get_em(stack);
-
-    uintptr_t decoded_magic = marker.magic ^ stack_addr;
-    EM_CHECK_V((decoded_magic == parent_em), 
-               "Internal Error: 'em_stack_free_to_marker' detected invalid, corrupted or alien stack marker");
-
-    size_t decoded_index = marker.index ^ stack_addr;
-    size_t cur_index = stack_get_meta_index(stack);
-    EM_CHECK_V((decoded_index <= cur_index), 
-               "Internal Error: 'em_stack_free_to_marker' marker index is out of range");
-
-    if (decoded_index == cur_index) return;
-
-    #ifdef EM_POISONING
-    size_t meta_type = stack_get_meta_type(stack);
-    size_t capacity = stack_get_capacity(stack);
+EMDEF EMProfile em_get_profile(const EM *em) {
+    EMProfile profile;
+    memset(&profile, 0, sizeof(profile));
 
-    size_t right_offset_start = stack_read_meta(stack, meta_type, cur_index - 1);
-    size_t right_offset_end = (decoded_index == 0) ? 0 : stack_read_meta(stack, meta_type, decoded_index - 1);
+    EM_CHECK((em != NULL), profile, "Internal Error: 'em_get_profile' called on NULL easy memory");
 
-    uintptr_t poison_start = (uintptr_t)stack + capacity - right_offset_start;
-    size_t poison_size = right_offset_start - right_offset_end;
+    const EMExtension *extension = (const EMExtension *)(const void *)((const char *)em + sizeof(EM));
+    return extension->profile;
+}
 
-    memset((void *)poison_start, EM_POISON_BYTE, poison_size);
-    #endif
+/*
+ * Reset allocation path profile
+ *
+ * Zeroes all path counters of the arena. Allocator state is not touched.
+ *
+ * Parameters:
+ *   - em: Pointer to the Easy Memory instance.
+ *
+ * Safety & Behavior:
+ *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT if em is NULL.
+ *   - EM_POLICY_DEFENSIVE: Safely returns if em is NULL.
+ */
+EMDEF void em_profile_reset(EM *em) {
+    EM_CHECK_V((em != NULL), "Internal Error: 'em_profile_reset' called on NULL easy memory");
 
-    stack_set_meta_index(stack, decoded_index);
+    memset(&em_get_extension(em)->profile, 0, sizeof(EMProfile));
 }
 
 /*
- * Reset Stack
- *
- * Instantly invalidates all active allocations in the stack, resetting its 
- * internal cursor back to the beginning.
+ * Print allocation path profile
  *
- * Performance:
- *   - O(1) Constant Time. Only the primary metadata index is updated (single 
- *     register write).
+ * Dumps the path counters to stdout as a single JSON object, with the average
+ * free-tree path lengths and the share of O(1) operations precomputed.
  *
  * Parameters:
- *   - stack: Pointer to the Stack allocator to be reset.
- *
- * Returns:
- *   - None (void).
+ *   - em: Pointer to the Easy Memory instance.
  *
  * Safety & Behavior:
- *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT if stack is NULL.
- *   - EM_POLICY_DEFENSIVE: Safely returns if stack is NULL.
+ *   - Requires <stdio.h>; intended for host-side profiling builds.
+ *   - EM_POLICY_DEFENSIVE: Safely returns if em is NULL.
  */
-EMDEF void em_stack_reset(Stack *EM_RESTRICT stack) {
-    EM_CHECK_V((stack != NULL), "Internal Error: 'em_stack_reset' called on NULL stack");
+EMDEF void em_print_profile(const EM *em) {
+    EM_CHECK_V((em != NULL), "Internal Error: 'em_print_profile' called on NULL easy memory");
 
-    stack_set_meta_index(stack, 0);
+    EMProfile p = em_get_profile(em);
+    size_t allocs = p.tail_hits + p.tree_hits;
+
+    printf("{\"em\":\"%p\",\"tail_hits\":%zu,\"tree_hits\":%zu,\"tail_hit_ratio\":%.3f,"
+           "\"gap_blocks_recycled\":%zu,\"splits\":%zu,\"merges\":%zu,"
+           "\"lifo_tail_frees\":%zu,\"lifo_next_tail_frees\":%zu,"
+           "\"detach_calls\":%zu,\"detach_path_avg\":%.2f,\"detach_path_max\":%zu,"
+           "\"insert_calls\":%zu,\"insert_depth_avg\":%.2f,\"insert_depth_max\":%zu,\"tree_rebuilds\":%zu}\n",
+           (const void *)em, p.tail_hits, p.tree_hits,
+           allocs ? (double)p.tail_hits / (double)allocs : 0.0,
+           p.gap_blocks_recycled, p.splits, p.merges,
+           p.lifo_tail_frees, p.lifo_next_tail_frees,
+           p.detach_calls, p.detach_calls ? (double)p.detach_path_total / (double)p.detach_calls : 0.0, p.detach_path_max,
+           p.insert_calls, p.insert_calls ? (double)p.insert_depth_total / (double)p.insert_calls : 0.0, p.insert_depth_max,
+           p.tree_rebuilds);
 }
+#endif // EM_PROFILE
 
+#ifdef EM_TRACE
 /*
- * Reset Stack and zero-initialize memory
+ * Install the trace writer for the calling thread
  *
- * Resets the stack's index to 0 and zero-initializes the entire payload capacity.
+ * Every subsequent call into the allocator API is encoded as one event and
+ * handed to 'writer' (see ALLOCATION TRACE FORMAT). Installing a writer starts
+ * a new stream: the delta-encoding registers are cleared and the stream header
+ * is emitted immediately, so each installation yields a self-contained trace.
  *
- * Performance:
- *   - O(N) Linear Time, where N is the total capacity of the stack.
+ * Parameters:
+ *   - writer:  Sink for encoded bytes, or NULL to stop recording.
+ *   - context: Opaque pointer passed back to every writer call.
+ *
+ * Note: With EM_TRACE_TLS set to a thread-local keyword each thread records
+ * into its own writer; otherwise the writer is process-wide and the caller
+ * must not record from several threads at once.
+ */
+EMDEF void em_trace_set_writer(EMTraceWriter writer, void *context) {
+    em_trace_writer = writer;
+    em_trace_context = context;
+    em_trace_last_handle = 0;
+    em_trace_last_pointer = 0;
+
+    if (writer != NULL) {
+        const uint8_t header[6] = { 'E', 'M', 'T', 'R', EM_TRACE_VERSION, (uint8_t)sizeof(uintptr_t) };
+        writer(header, sizeof(header), context);
+    }
+}
+#endif // EM_TRACE
+
+
+#ifdef EM_SAMPLE
+/*
+ * Start sampling allocations for the calling thread
+ *
+ * On average one allocation per 'sample_rate' allocated bytes (em_alloc*, em_calloc,
+ * em_bump_alloc*, em_slab_alloc) is recorded with its size and a backtrace, and stays
+ * recorded until it is freed or its arena, bump or slab is reset or destroyed. The fast
+ * path is a single counter decrement; the distance to the next sample is randomized in
+ * [rate/2, rate*3/2] so periodic allocation patterns do not alias with it.
  *
  * Parameters:
- *   - stack: Pointer to the Stack allocator to be reset.
+ *   - storage:     Table for live samples, owned by the caller (no hidden allocations).
+ *   - capacity:    Number of EMSample slots. One slot always stays empty; when the rest
+ *                  are taken new samples are dropped until older ones are freed.
+ *   - sample_rate: Mean number of bytes between samples; 0 samples every allocation.
+ *   - backtrace:   Frame capture callback, or NULL to record sizes only.
  *
  * Returns:
- *   - None (void).
+ *   false if 'storage' is NULL or 'capacity' is below 2.
  *
- * Safety & Behavior:
- *   - Subject to the same Safety Policies and limits as em_stack_reset.
+ * Note: Stack allocations are not sampled; frames live only until the next pop.
  */
-EMDEF void em_stack_reset_zero(Stack *EM_RESTRICT stack) {
-    EM_CHECK_V((stack != NULL), "Internal Error: 'em_stack_reset_zero' called on NULL stack");
+EMDEF bool em_sample_start(EMSample *storage, size_t capacity, size_t sample_rate, EMBacktraceFunc backtrace) {
+    EM_CHECK((storage != NULL), false, "Internal Error: 'em_sample_start' called on NULL storage");
+    EM_CHECK((capacity >= 2),   false, "Internal Error: 'em_sample_start' called with capacity below 2");
 
-    size_t capacity = stack_get_capacity(stack);
-    void *data_start = (void *)((char *)stack + sizeof(Stack));
-
-    memset(data_start, 0, capacity);
+    for (size_t i = 0; i < capacity; i++) {
+        storage[i].pointer = NULL;
+    }
 
-    stack_set_meta_index(stack, 0);
+    em_sample_slots = storage;
+    em_sample_capacity = capacity;
+    em_sample_live = 0;
+    em_sample_rate = sample_rate;
+    em_sample_seed = (uintptr_t)storage ^ (uintptr_t)sample_rate;
+    em_sample_backtrace = backtrace;
+    em_sample_countdown = sample_next_interval();
+    return true;
 }
 
 /*
- * Destroy Stack Allocator
- *
- * Cleans up internal metadata and returns the entire allocated block back to the 
- * parent Easy Memory EM instance.
+ * Stop sampling and detach the sample table
  *
- * Performance:
- *   - O(1) or O(log n). Leverages parent EM integration; may involve free-tree 
- *     (LLRB) insertion and physical coalescing in the parent.
+ * The storage passed to em_sample_start may be reused afterwards. Blocks sampled
+ * before the stop are released normally.
+ */
+EMDEF void em_sample_stop(void) {
+    em_sample_countdown = EM_SAMPLE_IDLE;
+    em_sample_slots = NULL;
+    em_sample_capacity = 0;
+    em_sample_live = 0;
+    em_sample_backtrace = NULL;
+}
+
+/*
+ * Number of sampled allocations that are still live
+ */
+EMDEF size_t em_sample_count(void) {
+    return em_sample_live;
+}
+
+#define EM_SAMPLE_LINE_MAX   (128 + EM_SAMPLE_MAX_FRAMES * (4 + 2 * sizeof(void *)))
+#define EM_SAMPLE_BUFFER_SIZE (2 * EM_SAMPLE_LINE_MAX)
+
+typedef struct {
+    EMSampleWriter writer;
+    void *context;
+    size_t length;
+    char buffer[EM_SAMPLE_BUFFER_SIZE];
+} EMSampleOutput;
+
+static void sample_put_text(EMSampleOutput *out, const char *text) {
+    while (*text != '\0') out->buffer[out->length++] = *text++;
+}
+
+static void sample_put_decimal(EMSampleOutput *out, uintptr_t value) {
+    char digits[3 * sizeof(uintptr_t)];
+    size_t count = 0;
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (count > 0) out->buffer[out->length++] = digits[--count];
+}
+
+static void sample_put_hex(EMSampleOutput *out, uintptr_t value) {
+    char digits[2 * sizeof(uintptr_t)];
+    size_t count = 0;
+    do {
+        digits[count++] = "0123456789abcdef"[value & 0xF];
+        value >>= 4;
+    } while (value != 0);
+    out->buffer[out->length++] = '0';
+    out->buffer[out->length++] = 'x';
+    while (count > 0) out->buffer[out->length++] = digits[--count];
+}
+
+/*
+ * Make room for one more line, handing buffered text to the writer
+ */
+static void sample_reserve_line(EMSampleOutput *out) {
+    if (out->length + EM_SAMPLE_LINE_MAX > EM_SAMPLE_BUFFER_SIZE) {
+        out->writer(out->buffer, out->length, out->context);
+        out->length = 0;
+    }
+}
+
+/*
+ * Write the live samples as a heap profile
  *
- * Parameters:
- *   - stack: Pointer to the Stack allocator to be destroyed.
+ * Emits one line per live sample in the requested EMSampleFormat and hands the text to
+ * 'writer' in chunks. The folded format weights every sample by the bytes it stands for
+ * (max(size, sample_rate), the expected allocation volume between two samples); the pprof
+ * format leaves unsampling to pprof through the heap_v2/<rate> header.
  *
  * Returns:
- *   - None (void).
- *
- * Safety & Behavior:
- *   - EM_POLICY_CONTRACT: Triggers EM_ASSERT if stack is NULL.
- *   - EM_POLICY_DEFENSIVE: Safely returns if stack is NULL.
+ *   The number of samples written.
  */
-EMDEF void em_stack_destroy(Stack *stack) {
-    EM_CHECK_V((stack != NULL), "Internal Error: 'em_stack_destroy' called on NULL stack");
+EMDEF size_t em_sample_write(EMSampleFormat format, EMSampleWriter writer, void *context) {
+    EM_CHECK((writer != NULL), 0, "Internal Error: 'em_sample_write' called on NULL writer");
 
-    // Clear reserved bits in size_and_reserved field so parent can reclaim block cleanly
-    set_reserved_bits(&(stack->as.block_representation), 0);
+    EMSampleOutput out;
+    out.writer = writer;
+    out.context = context;
+    out.length = 0;
 
-    // Return the block back to the parent arena
-    em_free_block_full(stack_get_em(stack), (Block *)stack);
+    if (format == EM_SAMPLE_PPROF) {
+        size_t total = 0;
+        for (size_t i = 0; i < em_sample_capacity; i++) {
+            if (em_sample_slots[i].pointer != NULL) total += em_sample_slots[i].size;
+        }
+
+        // heap profile: <live count>: <live bytes> [<alloc count>: <alloc bytes>] @ heap_v2/<rate>
+        sample_put_text(&out, "heap profile: ");
+        sample_put_decimal(&out, (uintptr_t)em_sample_live);
+        sample_put_text(&out, ": ");
+        sample_put_decimal(&out, (uintptr_t)total);
+        sample_put_text(&out, " [");
+        sample_put_decimal(&out, (uintptr_t)em_sample_live);
+        sample_put_text(&out, ": ");
+        sample_put_decimal(&out, (uintptr_t)total);
+        sample_put_text(&out, "] @ heap_v2/");
+        sample_put_decimal(&out, (uintptr_t)(em_sample_rate != 0 ? em_sample_rate : 1));
+        sample_put_text(&out, "\n");
+    }
+
+    size_t written = 0;
+    for (size_t i = 0; i < em_sample_capacity; i++) {
+        const EMSample *sample = &em_sample_slots[i];
+        if (sample->pointer == NULL) continue;
+
+        sample_reserve_line(&out);
+
+        if (format == EM_SAMPLE_PPROF) {
+            // 1: <size> [1: <size>] @ <leaf> ... <root>
+            sample_put_text(&out, "1: ");
+            sample_put_decimal(&out, (uintptr_t)sample->size);
+            sample_put_text(&out, " [1: ");
+            sample_put_decimal(&out, (uintptr_t)sample->size);
+            sample_put_text(&out, "] @");
+            for (size_t f = 0; f < sample->depth; f++) {
+                sample_put_text(&out, " ");
+                sample_put_hex(&out, (uintptr_t)sample->frames[f]);
+            }
+        }
+        else {
+            // <root>;...;<leaf> <weight>
+            if (sample->depth == 0) sample_put_text(&out, "[unknown]");
+            for (size_t f = sample->depth; f > 0; f--) {
+                sample_put_hex(&out, (uintptr_t)sample->frames[f - 1]);
+                if (f > 1) sample_put_text(&out, ";");
+            }
+            sample_put_text(&out, " ");
+            sample_put_decimal(&out, (uintptr_t)(sample->size > em_sample_rate ? sample->size : em_sample_rate));
+        }
+        sample_put_text(&out, "\n");
+        written++;
+    }
+
+    if (out.length > 0) writer(out.buffer, out.length, context);
+    return written;
 }
+#endif // EM_SAMPLE
 
 
 
@@ -5626,9 +10640,9 @@ EMDEF void print_em(EM *em) {
     if (!em) return;
     PRINTF(T("Easy Memory: %p\n"), em);
     PRINTF(T("EM Full Size: %zu\n"), em_get_capacity(em));
-    PRINTF(T("EM Data Size: %zu\n"), em_get_capacity(em) - sizeof(EM));
+    PRINTF(T("EM Data Size: %zu\n"), em_get_capacity(em) - em_get_header_size(em));
     PRINTF(T("EM Alignment: %zu\n"), em_get_alignment(em));
-    PRINTF(T("Data: %p\n"), (void *)((char *)em + sizeof(EM)));
+    PRINTF(T("Data: %p\n"), (void *)((char *)em + em_get_header_size(em)));
     PRINTF(T("Tail: %p\n"), em_get_tail(em));
     PRINTF(T("Free Blocks: %p\n"), em_get_free_blocks(em));
     PRINTF(T("Free Size in Tail: %zu\n"), free_size_in_tail(em));
@@ -5683,16 +10697,35 @@ EMDEF void print_em(EM *em) {
 
     PRINTF(T("Easy Memory Free Blocks\n"));
 
-    Block *free_block = em_get_free_blocks(em);
-    if (free_block == NULL) PRINTF(T("  None\n"));
-    else {
-        print_llrb_tree(free_block, 0);
+    #ifdef EM_FREE_TLSF
+    const EMTlsf *tlsf = em_get_extension(em)->tlsf;
+    if (tlsf != NULL && tlsf->fl_bitmap == 0) PRINTF(T("  None\n"));
+    for (size_t fl = 0; tlsf != NULL && fl < EM_TLSF_FL_COUNT; fl++) {
+        for (size_t sl = 0; sl < EM_TLSF_SL_COUNT; sl++) {
+            if (tlsf->heads[fl][sl] == NULL) continue;
+            PRINTF(T("  Class %zu.%zu:"), fl, sl);
+            for (Block *node = tlsf->heads[fl][sl]; node != NULL; node = get_left_tree(node)) PRINTF(T(" %p (%zu)"), node, get_size(node));
+            PRINTF(T("\n"));
+        }
+    }
+    if (tlsf == NULL)
+    #endif
+    {
+        Block *free_block = em_get_free_blocks(em);
+        if (free_block == NULL) PRINTF(T("  None\n"));
+        else {
+            print_llrb_tree(free_block, 0);
+        }
     }
+    #ifdef EM_FREE_INDEX
+    const EMFreeIndex *index = em_get_extension(em)->free_index;
+    if (index != NULL) PRINTF(T("  Indexed: %zu blocks in %zu of %zu nodes\n"), index->count, index->nodes - index->available, index->nodes);
+    #endif
     PRINTF(T("\n"));
 
     PRINTF(T("EM occupied data size: %zu\n"), occupied_data);
-    PRINTF(T("EM occupied meta size: %zu + %zu\n"), occupied_meta, sizeof(EM));
-    PRINTF(T("EM occupied full size: %zu + %zu\n"), occupied_data + occupied_meta, sizeof(EM));
+    PRINTF(T("EM occupied meta size: %zu + %zu\n"), occupied_meta, em_get_header_size(em));
+    PRINTF(T("EM occupied full size: %zu + %zu\n"), occupied_data + occupied_meta, em_get_header_size(em));
     PRINTF(T("EM block count: %zu\n"), len);
 }
 
@@ -5738,6 +10771,7 @@ EMDEF void print_fancy(EM *em, size_t bar_size) {
     // Calculate offset to detect initial alignment padding
     Block *first_block = em_get_first_block(em);
     size_t first_block_offset = (uintptr_t)first_block - (uintptr_t)em;
+    size_t header_size = em_get_header_size(em);
 
     // --- 2. RENDERING ---
 
@@ -5764,9 +10798,9 @@ EMDEF void print_fancy(EM *em, size_t bar_size) {
         size_t max_overlap = 0;
         
         // 1. EM Header (Yellow)
-        // From 0 to sizeof(EM)
-        if (segment_start < sizeof(EM)) {
-             size_t overlap = (segment_end < sizeof(EM) ? segment_end : sizeof(EM)) - segment_start;
+        // From 0 to header_size (header plus optional extension and class lists)
+        if (segment_start < header_size) {
+             size_t overlap = (segment_end < header_size ? segment_end : header_size) - segment_start;
              if (overlap > max_overlap) {
                  max_overlap = overlap;
                  segment_type = '@';
@@ -5775,9 +10809,9 @@ EMDEF void print_fancy(EM *em, size_t bar_size) {
 
         // 2. Alignment Padding (Red/Occupied)
         // From end of EM Header to Start of First Block.
-        // If first_block_offset > sizeof(EM), there is a gap used for alignment.
-        if (first_block_offset > sizeof(EM)) {
-            size_t pad_start = sizeof(EM);
+        // If first_block_offset > header_size, there is a gap used for alignment.
+        if (first_block_offset > header_size) {
+            size_t pad_start = header_size;
             size_t pad_end = first_block_offset;
             
             if (segment_start < pad_end && segment_end > pad_start) {
@@ -5863,4 +10897,110 @@ EMDEF void print_fancy(EM *em, size_t bar_size) {
 } // extern "C"
 #endif
 
+/*
+ * C++ Layout Planner
+ * Type-level counterpart of the EM_PLAN_* macros. A plan is a list of entries evaluated 
+ * against the arena baseline alignment, so nested arenas compose naturally:
+ *
+ *   using Plan = em_plan::Arena<16,
+ *       em_plan::Alloc<48, 16, 100>,
+ *       em_plan::Slab<32, 64>,
+ *       em_plan::Nested<64, em_plan::Alloc<256, 64, 4>>>;
+ *
+ *   alignas(16) static unsigned char memory[Plan::size];
+ *   static_assert(Plan::fits(sizeof(memory)), "arena too small");
+ *
+ * Templates can not have C linkage, hence this block lives outside of the extern "C" wrapper.
+*/
+#if defined(__cplusplus) && (__cplusplus >= 201103L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201103L))
+namespace em_plan {
+
+// 'count' allocations of 'size' bytes; Alignment 0 means "arena baseline alignment"
+template <size_t Size, size_t Alignment = 0, size_t Count = 1>
+struct Alloc {
+    static constexpr size_t footprint(size_t arena_alignment) {
+        return EM_PLAN_ALLOCS(Size, Alignment ? Alignment : arena_alignment, Count, arena_alignment);
+    }
+};
+
+// One scratchpad allocation (only one may be active at a time)
+template <size_t Size, size_t Alignment = 0>
+struct Scratch {
+    static constexpr size_t footprint(size_t arena_alignment) {
+        return EM_PLAN_SCRATCH(Size, Alignment ? Alignment : arena_alignment);
+    }
+};
+
+// Bump allocator able to serve 'count' allocations of (size, alignment)
+template <size_t Size, size_t Alignment = EMMIN_ALIGNMENT, size_t Count = 1>
+struct Bump {
+    static constexpr size_t create_size(size_t arena_alignment) {
+        return EM_PLAN_BUMP_SIZE(Size, Alignment, Count, arena_alignment);
+    }
+    static constexpr size_t footprint(size_t arena_alignment) {
+        return EM_PLAN_ALLOC(create_size(arena_alignment), arena_alignment, arena_alignment);
+    }
+};
+
+// Slab allocator holding 'count' chunks of 'chunk_size'
+template <size_t ChunkSize, size_t Count>
+struct Slab {
+    static constexpr size_t create_size = EM_PLAN_SLAB_SIZE(ChunkSize, Count);
+    static constexpr size_t footprint(size_t arena_alignment) {
+        return EM_PLAN_ALLOC(create_size, arena_alignment, arena_alignment);
+    }
+};
+
+// Stack capacity, declared ahead of em_plan::Stack: inside the template 'Stack' names the template, not the header
+constexpr size_t stack_create_size(size_t frame_bytes, size_t frame_count) {
+    return EM_PLAN_STACK_SIZE(frame_bytes, frame_count);
+}
+
+// Stack allocator holding 'count' frames of (size, alignment)
+template <size_t Size, size_t Alignment = EMMIN_ALIGNMENT, size_t Count = 1>
+struct Stack {
+    static constexpr size_t create_size = stack_create_size(EM_PLAN_STACK_FRAMES(Size, Alignment, Count), Count);
+    static constexpr size_t footprint(size_t arena_alignment) {
+        return EM_PLAN_ALLOC(create_size, arena_alignment, arena_alignment);
+    }
+};
+
+template <size_t ArenaAlignment, typename... Entries>
+struct Sum;
+
+template <size_t ArenaAlignment>
+struct Sum<ArenaAlignment> {
+    static constexpr size_t value = 0;
+};
+
+template <size_t ArenaAlignment, typename Head, typename... Tail>
+struct Sum<ArenaAlignment, Head, Tail...> {
+    static constexpr size_t value = Head::footprint(ArenaAlignment) + Sum<ArenaAlignment, Tail...>::value;
+};
+
+// Complete arena: 'size' is the buffer size for em_create_static_aligned (or em_create_nested_aligned)
+template <size_t ArenaAlignment, typename... Entries>
+struct Arena {
+    static_assert((ArenaAlignment & (ArenaAlignment - 1)) == 0, "Arena alignment must be a power of two");
+    static_assert(ArenaAlignment >= EMMIN_ALIGNMENT && ArenaAlignment <= EMMAX_ALIGNMENT, "Arena alignment out of range");
+
+    static constexpr size_t alignment = ArenaAlignment;
+    static constexpr size_t footprint = Sum<ArenaAlignment, Entries...>::value;
+    static constexpr size_t size = EM_PLAN_STATIC_SIZE(ArenaAlignment, footprint);
+
+    static constexpr bool fits(size_t buffer_size) { return buffer_size >= size; }
+};
+
+// Nested arena (em_create_nested_aligned) described by its own entries
+template <size_t NestedAlignment, typename... Entries>
+struct Nested {
+    static constexpr size_t create_size = Arena<NestedAlignment, Entries...>::size;
+    static constexpr size_t footprint(size_t arena_alignment) {
+        return EM_PLAN_ALLOC(create_size, arena_alignment, arena_alignment);
+    }
+};
+
+} // namespace em_plan
+#endif // __cplusplus >= 201103L
+
 #endif // EASY_MEMORY_H
@@ -0,0 +1,222 @@
+/*
+ * Adversarial complexity fuzzer.
+ *
+ * The other fuzzers hunt crashes; this one hunts slow inputs. The library reports the
+ * length of every free-tree walk and parent lookup through EM_COST_PROBE, and each
+ * operation is timed in cycles. Every (site, length) pair and every log2 cycle bucket
+ * reached is a libFuzzer extra counter, so inputs that walk deeper or run longer than
+ * anything in the corpus count as new coverage and the corpus ratchets towards the
+ * worst case.
+ *
+ * The worst input seen for each metric is written to <EM_COST_PREFIX>max-<metric>
+ * (default prefix "cost-"), and the maxima are printed when the run ends. Replaying a
+ * corpus with -runs=0 (make cost_regress) turns it into a performance regression set.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+static void cost_probe(unsigned site, size_t value);
+#define EM_COST_PROBE(site, value) cost_probe((unsigned)(site), (size_t)(value))
+
+#include "fuzz_utils.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_PTRS     2048
+#define MAX_NESTED   8
+#define DEPTH_SLOTS  128
+#define CYCLE_SLOTS  64
+#define METRIC_COUNT (EM_COST_SITE_COUNT + 1)   // Probe sites plus cycles per operation
+
+#if defined(__linux__)
+#   define COST_COUNTERS_SECTION __attribute__((used, section("__libfuzzer_extra_counters")))
+#else
+#   define COST_COUNTERS_SECTION
+#endif
+
+static uint8_t cost_counters[METRIC_COUNT * DEPTH_SLOTS] COST_COUNTERS_SECTION;
+
+static const char *const metric_names[METRIC_COUNT] = {
+    "insert_depth", "search_depth", "detach_depth", "parent_walk", "cycles_per_op"
+};
+
+static size_t input_max[METRIC_COUNT];   // Worst value of the current input
+static size_t global_max[METRIC_COUNT];  // Worst value of the whole run
+static bool cost_saving = false;         // Only a libFuzzer run writes artifacts
+
+int LLVMFuzzerInitialize(int *argc, char ***argv);
+
+static void cost_probe(unsigned site, size_t value) {
+    if (site >= EM_COST_SITE_COUNT) return;
+    cost_counters[site * DEPTH_SLOTS + (value < DEPTH_SLOTS ? value : DEPTH_SLOTS - 1)] = 1;
+    if (value > input_max[site]) input_max[site] = value;
+}
+
+/*
+ * Cycle counter: rdtsc on x86, the virtual counter on AArch64, nanoseconds elsewhere
+ */
+static inline uint64_t cost_ticks(void) {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_ia32_rdtsc();
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+    uint64_t ticks;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+#endif
+}
+
+static inline void cost_record_op(uint64_t start) {
+    uint64_t cycles = cost_ticks() - start;
+    size_t bucket = 0;
+    while (bucket + 1 < CYCLE_SLOTS && (cycles >> (bucket + 1)) != 0) bucket++;
+    cost_counters[EM_COST_SITE_COUNT * DEPTH_SLOTS + bucket] = 1;
+    if ((size_t)cycles > input_max[EM_COST_SITE_COUNT]) input_max[EM_COST_SITE_COUNT] = (size_t)cycles;
+}
+
+#define TIMED(call) do { uint64_t cost_start_ = cost_ticks(); call; cost_record_op(cost_start_); } while (0)
+
+static void cost_save(const char *metric, const uint8_t *data, size_t size) {
+    const char *prefix = getenv("EM_COST_PREFIX");
+    char path[512];
+    snprintf(path, sizeof(path), "%smax-%s", prefix ? prefix : "cost-", metric);
+
+    FILE *file = fopen(path, "wb");
+    if (!file) return;
+    fwrite(data, 1, size, file);
+    fclose(file);
+}
+
+static void cost_report(void) {
+    fprintf(stderr, "cost_fuzzer: {");
+    for (size_t m = 0; m < METRIC_COUNT; m++) {
+        fprintf(stderr, "%s\"%s\":%zu", m ? "," : "", metric_names[m], global_max[m]);
+    }
+    fprintf(stderr, "}\n");
+}
+
+int LLVMFuzzerInitialize(int *argc, char ***argv) {
+    (void)argc;
+    (void)argv;
+    cost_saving = true;
+    atexit(cost_report);
+    return 0;
+}
+
+typedef struct {
+    void *p;
+    int owner;  // -1 for the root arena, otherwise an index into 'nested'
+    int32_t padding;
+} CostPtr;
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size < 16) return 0;
+
+    EM *root = em_create(4 * 1024 * 1024);
+    if (!root) return 0;
+
+    static CostPtr ptrs[MAX_PTRS];
+    EM *nested[MAX_NESTED] = {0};
+    size_t ptr_count = 0;
+    memset(input_max, 0, sizeof(input_max));
+
+    size_t i = 0;
+    int step = 0;
+
+    FUZZ_LOG("\n--- STARTING COST REPLAY ---\n");
+
+    while (i < size) {
+        uint8_t op = fuzz_read_byte(data, &i, size) % 7;
+        step++;
+        (void)step;
+
+        switch (op) {
+            case 0: { // ALLOC
+                if (ptr_count >= MAX_PTRS) break;
+                size_t alloc_size = (fuzz_read_size(data, &i, size) % 8192) + 1;
+                void *p = NULL;
+                TIMED(p = em_alloc(root, alloc_size));
+                FUZZ_LOG("[%d] ALLOC %zu -> %p\n", step, alloc_size, p);
+                if (p) ptrs[ptr_count++] = (CostPtr){p, -1, 0};
+                break;
+            }
+            case 1: { // ALLOC_ALIGNED
+                if (ptr_count >= MAX_PTRS) break;
+                size_t alloc_size = (fuzz_read_size(data, &i, size) % 4096) + 1;
+                size_t alignment = fuzz_read_align(data, &i, size);
+                void *p = NULL;
+                TIMED(p = em_alloc_aligned(root, alloc_size, alignment));
+                FUZZ_LOG("[%d] ALLOC_ALIGNED %zu/%zu -> %p\n", step, alloc_size, alignment, p);
+                if (p) ptrs[ptr_count++] = (CostPtr){p, -1, 0};
+                break;
+            }
+            case 2: { // FREE ONE
+                if (ptr_count == 0) break;
+                size_t idx = fuzz_read_size(data, &i, size) % ptr_count;
+                FUZZ_LOG("[%d] FREE %zu\n", step, idx);
+                TIMED(em_free(ptrs[idx].p));
+                ptrs[idx] = ptrs[--ptr_count];
+                break;
+            }
+            case 3: { // FREE STRIDE: punch many holes at once to grow the free tree
+                if (ptr_count == 0) break;
+                size_t stride = (fuzz_read_byte(data, &i, size) % 7) + 2;
+                size_t phase = fuzz_read_byte(data, &i, size) % stride;
+                FUZZ_LOG("[%d] FREE STRIDE %zu/%zu\n", step, stride, phase);
+                for (size_t k = ptr_count; k-- > 0;) {
+                    if (k % stride != phase || ptrs[k].owner != -1) continue;
+                    TIMED(em_free(ptrs[k].p));
+                    ptrs[k] = ptrs[--ptr_count];
+                }
+                break;
+            }
+            case 4: { // CREATE NESTED
+                size_t slot = fuzz_read_byte(data, &i, size) % MAX_NESTED;
+                if (nested[slot] != NULL) break;
+                size_t capacity = (fuzz_read_size(data, &i, size) % 32768) + 1024;
+                TIMED(nested[slot] = em_create_nested(root, capacity));
+                FUZZ_LOG("[%d] CREATE NESTED %zu (%zu) -> %p\n", step, slot, capacity, (void *)nested[slot]);
+                break;
+            }
+            case 5: { // ALLOC IN NESTED
+                size_t slot = fuzz_read_byte(data, &i, size) % MAX_NESTED;
+                if (nested[slot] == NULL || ptr_count >= MAX_PTRS) break;
+                size_t alloc_size = (fuzz_read_size(data, &i, size) % 1024) + 1;
+                void *p = NULL;
+                TIMED(p = em_alloc(nested[slot], alloc_size));
+                if (p) ptrs[ptr_count++] = (CostPtr){p, (int)slot, 0};
+                break;
+            }
+            case 6: { // DESTROY NESTED: walks back to the parent arena
+                size_t slot = fuzz_read_byte(data, &i, size) % MAX_NESTED;
+                if (nested[slot] == NULL) break;
+                FUZZ_LOG("[%d] DESTROY NESTED %zu\n", step, slot);
+                TIMED(em_destroy(nested[slot]));
+                nested[slot] = NULL;
+                for (size_t k = 0; k < ptr_count;) {
+                    if (ptrs[k].owner == (int)slot) ptrs[k] = ptrs[--ptr_count];
+                    else k++;
+                }
+                break;
+            }
+        }
+    }
+
+    for (size_t slot = 0; slot < MAX_NESTED; slot++) {
+        if (nested[slot] != NULL) em_destroy(nested[slot]);
+    }
+    em_destroy(root);
+
+    for (size_t m = 0; m < METRIC_COUNT; m++) {
+        if (input_max[m] > global_max[m]) {
+            global_max[m] = input_max[m];
+            if (cost_saving) cost_save(metric_names[m], data, size);
+        }
+    }
+    return 0;
+}
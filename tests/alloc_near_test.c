@@ -0,0 +1,149 @@
+#define EM_VERIFY
+#define EM_PROFILE
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE  (1 << 17)
+#define ROW         (64)
+#define MAX_LIVE    (512)
+#define ITERATIONS  (20000)
+#define LIST_LENGTH (400)
+
+static uint8_t arena_memory[ARENA_SIZE];
+
+static size_t distance(const void *a, const void *b) {
+    return ((uintptr_t)a > (uintptr_t)b) ? (size_t)((uintptr_t)a - (uintptr_t)b) : (size_t)((uintptr_t)b - (uintptr_t)a);
+}
+
+static void test_nearest_hole(void) {
+    TEST_CASE("The hole next to the hint is taken over the best fit");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *row[ROW];
+    for (size_t i = 0; i < ROW; i++) row[i] = em_alloc(em, 64);
+    void *low = row[10];
+    void *high = row[40];
+    em_free(low);
+    em_free(high);
+
+    size_t tree_hits = em_get_profile(em).tree_hits;
+    void *after = em_alloc_near(em, 48, row[39]);
+    ASSERT(after == high, "A hint in front of a hole takes the hole behind it");
+    void *before = em_alloc_near(em, 48, row[11]);
+    ASSERT(before == low, "A hint behind a hole takes the hole in front of it");
+    ASSERT(em_get_profile(em).tree_hits == tree_hits + 2 && em_verify(em).reason == NULL, "Both came out of the free blocks");
+
+    em_free(after);
+    em_free(before);
+    void *split = em_alloc_near(em, 16, row[41]);
+    ASSERT(split == high, "A larger hole is split at its start");
+    ASSERT(em_verify(em).reason == NULL, "The split leaves a verified arena");
+
+    void *tail = em_alloc_near(em, 64, row[ROW - 1]);
+    ASSERT(tail != NULL && (uintptr_t)tail > (uintptr_t)row[ROW - 1] && distance(tail, row[ROW - 1]) <= 64 + sizeof(Block) + em_get_alignment(em), "The last block's neighbour comes from the tail");
+    em_destroy(em);
+}
+
+static void test_fallback(void) {
+    TEST_CASE("Hints without a fit nearby fall back to the normal placement");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *row[ROW];
+    for (size_t i = 0; i < ROW; i++) row[i] = em_alloc(em, 64);
+    em_free(row[0]);
+    void *wall = em_alloc(em, (size_t)ARENA_SIZE / 2);   // Keeps the tail out of the window
+    ASSERT(wall != NULL, "The tail is pushed away");
+
+    void *placed = em_alloc(em, 48);
+    em_free(placed);
+
+    void *far = em_alloc_near(em, 48, row[EM_NEAR_SEARCH_BLOCKS + 8]);
+    ASSERT(far == placed, "Beyond the window the request lands where em_alloc puts it");
+    em_free(far);
+
+    int local = 0;
+    void *outside = em_alloc_near(em, 48, &local);
+    ASSERT(outside == placed, "A pointer outside the arena is ignored");
+    em_free(outside);
+
+    void *interior = em_alloc_near(em, 48, (char *)row[20] + 16);
+    ASSERT(interior == placed, "An interior pointer is ignored");
+    em_free(interior);
+
+    ASSERT(em_alloc_near(em, 48, NULL) != NULL, "A NULL hint places like em_alloc");
+    ASSERT(em_verify(em).reason == NULL, "The arena verifies");
+    em_destroy(em);
+}
+
+static void test_list_locality(void) {
+    TEST_CASE("Hinted list nodes stay closer together");
+
+    size_t spread[2] = { 0, 0 };
+    for (size_t variant = 0; variant < 2; variant++) {
+        EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+        void *filler[MAX_LIVE];
+        for (size_t i = 0; i < MAX_LIVE; i++) filler[i] = em_alloc(em, 16 + test_random() % 160);
+        for (size_t i = 0; i < MAX_LIVE; i += 2) em_free(filler[i]);
+
+        void *previous = NULL;
+        for (size_t i = 0; i < LIST_LENGTH; i++) {
+            void *node = (variant == 0) ? em_alloc(em, 32) : em_alloc_near(em, 32, previous);
+            if (previous != NULL) spread[variant] += distance(node, previous);
+            previous = node;
+        }
+        ASSERT(em_verify(em).reason == NULL, "The arena verifies after building the list");
+        em_destroy(em);
+    }
+#if EM_PLACEMENT_POLICY == EM_PLACEMENT_BEST_FIT
+    ASSERT(spread[1] < spread[0] / 4, "Consecutive nodes lie much closer with hints");
+#else
+    ASSERT(spread[1] <= spread[0], "Carving the tail already keeps consecutive nodes together");
+#endif
+}
+
+static void test_randomized(void) {
+    TEST_CASE("Random hinted workload keeps the arena consistent");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *live[MAX_LIVE] = { 0 };
+    size_t sizes[MAX_LIVE] = { 0 };
+    size_t failures = 0;
+
+    for (size_t i = 0; i < ITERATIONS; i++) {
+        size_t slot = test_random() % MAX_LIVE;
+        if (live[slot] != NULL) {
+            if (!verify_memory_pattern(live[slot], sizes[slot], (int)(slot & 0xFF))) failures++;
+            em_free(live[slot]);
+            live[slot] = NULL;
+        }
+
+        uint32_t op = test_random() % 8;
+        sizes[slot] = 1 + test_random() % 300;
+        if (op < 5) live[slot] = em_alloc_near(em, sizes[slot], live[test_random() % MAX_LIVE]);
+        else if (op < 7) live[slot] = em_alloc(em, sizes[slot]);
+        if (live[slot] != NULL) fill_memory_pattern(live[slot], sizes[slot], (int)(slot & 0xFF));
+
+        if (i % 97 == 0 && em_verify(em).reason != NULL) failures++;
+    }
+    ASSERT(failures == 0, "The arena verified clean and the contents held throughout");
+
+    for (size_t i = 0; i < MAX_LIVE; i++) {
+        if (live[i] != NULL) em_free(live[i]);
+    }
+    ASSERT(em_get_free_blocks(em) == NULL && em_verify(em).reason == NULL, "Everything merged back into the tail");
+    em_destroy(em);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_nearest_hole();
+    test_fallback();
+    test_list_locality();
+    test_randomized();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,191 @@
+#define EM_ASAN
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (1 << 16)
+
+static uint8_t arena_memory[ARENA_SIZE];
+
+#ifdef EM_HAS_ASAN
+int __asan_address_is_poisoned(void const volatile *addr);
+
+static bool poisoned(const void *address) {
+    return __asan_address_is_poisoned(address) != 0;
+}
+
+static bool range_poisoned(const void *address, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        if (!poisoned((const char *)address + i)) return false;
+    }
+    return true;
+}
+
+static bool range_addressable(const void *address, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        if (poisoned((const char *)address + i)) return false;
+    }
+    return true;
+}
+
+static void test_core_blocks(void) {
+    TEST_CASE("Core blocks are poisoned in the shadow, headers stay addressable");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    ASSERT(em != NULL, "Arena is created");
+    ASSERT(range_poisoned(block_data(em_get_tail(em)), 256), "The untouched tail is poisoned");
+
+    uint8_t *a = (uint8_t *)em_alloc(em, 40);
+    uint8_t *b = (uint8_t *)em_alloc(em, 24);
+    ASSERT(a && b, "Allocations succeed");
+    ASSERT(range_addressable(a, 40), "The requested bytes are addressable");
+    ASSERT(range_poisoned(a + 40, EM_ASAN_REDZONE), "A redzone follows the allocation");
+    ASSERT(range_addressable(a - sizeof(Block), sizeof(Block)), "The block header is addressable");
+    ASSERT(range_poisoned(b + 24, EM_ASAN_REDZONE), "Every allocation gets its redzone");
+
+    em_free(a);
+    ASSERT(range_poisoned(a, 40), "A freed block is poisoned");
+    ASSERT(range_addressable(a - sizeof(Block), sizeof(Block)), "Its header (a free tree node) is not");
+
+    uint8_t *c = (uint8_t *)em_alloc(em, 16);
+    ASSERT(c == a && range_addressable(c, 16), "Reusing the hole unpoisons only the new request");
+    ASSERT(poisoned(c + 16), "The rest of the reused hole stays poisoned");
+
+    uint8_t *d = (uint8_t *)em_alloc_aligned(em, 32, 256);
+    ASSERT(d != NULL && ((uintptr_t)d % 256) == 0, "Over-aligned allocation succeeds");
+    ASSERT(range_addressable(d - sizeof(uintptr_t), 32 + sizeof(uintptr_t)), "Data and the back-link word are addressable");
+
+    em_free(b);
+    em_free(c);
+    em_free(d);
+    ASSERT(range_poisoned(a, 64), "Merged blocks are poisoned, including the headers absorbed by the merge");
+
+    void *s = em_alloc_scratch(em, 100);
+    ASSERT(s != NULL && range_addressable(s, 100), "Scratch memory is addressable");
+    em_free(s);
+    ASSERT(range_poisoned(s, 100), "Freed scratch memory is poisoned");
+
+    em_reset(em);
+    ASSERT(range_poisoned(block_data(em_get_tail(em)), 1024), "Reset poisons the whole arena");
+
+    em_reset_zero(em);
+    ASSERT(range_poisoned(block_data(em_get_tail(em)), 1024), "Zeroing reset unpoisons for the fill and poisons again");
+
+    em_destroy(em);
+    ASSERT(range_addressable(arena_memory, sizeof(arena_memory)), "A destroyed static arena hands its buffer back addressable");
+}
+
+static void test_nested(void) {
+    TEST_CASE("Nested arenas poison their tail and are poisoned when destroyed");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    EM *nested = em_create_nested(em, 4096);
+    ASSERT(nested != NULL, "Nested arena is created");
+    ASSERT(range_poisoned(block_data(em_get_tail(nested)), 1024), "The nested tail is poisoned");
+
+    uint8_t *p = (uint8_t *)em_alloc(nested, 64);
+    ASSERT(p != NULL && range_addressable(p, 64), "Nested allocations are addressable");
+
+    em_destroy(nested);
+    ASSERT(range_poisoned(p, 64), "The parent poisons the block of a destroyed nested arena");
+    em_destroy(em);
+}
+
+static void test_bump(void) {
+    TEST_CASE("Bump space past the offset is poisoned");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    Bump *bump = em_bump_create(em, 512);
+    ASSERT(bump != NULL, "Bump is created");
+
+    uint8_t *a = (uint8_t *)em_bump_alloc(bump, 20);
+    ASSERT(a != NULL && range_addressable(a, 20), "Bump allocation is addressable");
+    ASSERT(range_poisoned(a + 20, 100), "Space past the offset is poisoned");
+
+    uint8_t *b = (uint8_t *)em_bump_alloc_aligned(bump, 16, 64);
+    ASSERT(b != NULL && range_addressable(b, 16), "Aligned bump allocation is addressable");
+    ASSERT(range_poisoned(a + 20, (size_t)(b - (a + 20))), "The alignment gap is poisoned");
+
+    em_bump_reset(bump);
+    ASSERT(range_poisoned(a, 36), "Reset poisons the handed out space");
+    em_bump_destroy(bump);
+    em_destroy(em);
+}
+
+static void test_slab(void) {
+    TEST_CASE("Free Slab chunks are poisoned except for their free-list link");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    Slab *slab = em_slab_create(em, 512, 64);
+    ASSERT(slab != NULL, "Slab is created");
+
+    uint8_t *a = (uint8_t *)em_slab_alloc(slab);
+    uint8_t *b = (uint8_t *)em_slab_alloc(slab);
+    ASSERT(a && b && range_addressable(a, 64) && range_addressable(b, 64), "Allocated chunks are addressable");
+    ASSERT(range_poisoned(b + 64 + sizeof(uintptr_t), 64 - sizeof(uintptr_t)), "The virgin frontier is poisoned past its link");
+
+    em_slab_free(slab, a);
+    ASSERT(range_addressable(a, sizeof(uintptr_t)), "The link of a freed chunk stays addressable");
+    ASSERT(range_poisoned(a + sizeof(uintptr_t), 64 - sizeof(uintptr_t)), "The rest of a freed chunk is poisoned");
+    ASSERT(em_slab_alloc(slab) == a && range_addressable(a, 64), "Reallocation unpoisons the chunk");
+
+    em_slab_reset_zero(slab);
+    ASSERT(range_poisoned(b, 64), "Zeroing reset leaves the chunks poisoned");
+    ASSERT(em_slab_alloc(slab) == a, "Slab restarts from the first chunk");
+    em_slab_destroy(slab);
+    em_destroy(em);
+}
+
+static void test_stack(void) {
+    TEST_CASE("Popped Stack frames are poisoned");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    Stack *stack = em_stack_create(em, 1024);
+    ASSERT(stack != NULL, "Stack is created");
+
+    uint8_t *a = (uint8_t *)em_stack_alloc(stack, 40);
+    StackMarker marker = em_stack_get_marker(stack);
+    uint8_t *b = (uint8_t *)em_stack_alloc(stack, 24);
+    uint8_t *c = (uint8_t *)em_stack_alloc(stack, 8);
+    ASSERT(a && b && c && range_addressable(a, 40) && range_addressable(b, 24), "Frames are addressable");
+    ASSERT(range_poisoned(c - 64, 64), "Space below the top frame is poisoned");
+
+    em_stack_free(stack, c);
+    ASSERT(range_poisoned(c, 8), "A popped frame is poisoned");
+    em_stack_free_to_marker(stack, marker);
+    ASSERT(range_poisoned(b, 24) && range_addressable(a, 40), "Rolling back to a marker poisons exactly the frames above it");
+
+    em_stack_reset(stack);
+    ASSERT(range_poisoned(a, 40), "Reset poisons every frame");
+    void *d = em_stack_alloc(stack, 40);
+    ASSERT(d == a && range_addressable(d, 40), "The stack is reusable");
+
+    em_stack_reset_zero(stack);
+    ASSERT(range_poisoned(a, 40), "Zeroing reset leaves the frames poisoned");
+    em_stack_destroy(stack);
+    em_destroy(em);
+}
+#endif
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+#ifdef EM_HAS_ASAN
+    test_core_blocks();
+    test_nested();
+    test_bump();
+    test_slab();
+    test_stack();
+#else
+    TEST_CASE("Shadow poisoning without AddressSanitizer");
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *a = em_alloc(em, 40);
+    ASSERT(a != NULL && EM_ASAN_REDZONE == 0, "EM_ASAN compiles to nothing without -fsanitize=address");
+    em_free(a);
+    em_destroy(em);
+#endif
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,122 @@
+#define EM_BULK_ZERO
+#define EM_BULK_ZERO_THRESHOLD ((size_t)1 << 16)  // Low enough for both paths to run on small buffers
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "test_utils.h"
+
+#define LARGE_SIZE  ((size_t)4 << 20)
+#define GUARD       (64)
+
+static uint8_t large_memory[LARGE_SIZE + 2 * GUARD];
+
+static size_t worker_calls;
+static size_t worker_bytes;
+
+static bool all_equal(const uint8_t *bytes, size_t size, uint8_t value) {
+    for (size_t i = 0; i < size; i++) {
+        if (bytes[i] != value) return false;
+    }
+    return true;
+}
+
+/*
+ * Stand-in for a thread pool: cuts the range into four parts, as workers would
+*/
+static void split_workers(void *data, size_t size, void *context) {
+    size_t parts = *(size_t *)context;
+    size_t part = size / parts;
+    worker_calls++;
+    worker_bytes += size;
+    for (size_t i = 0; i < parts; i++) {
+        size_t length = (i == parts - 1) ? size - i * part : part;
+        em_bulk_zero((char *)data + i * part, length);
+    }
+}
+
+static void test_bulk_zero_ranges(void) {
+    TEST_CASE("em_bulk_zero clears exactly the requested range");
+
+    const size_t offsets[] = { 0, 1, 7, 33, 63 };
+    const size_t sizes[] = { 0, 1, 100, 4096, EM_BULK_ZERO_THRESHOLD - 1, EM_BULK_ZERO_THRESHOLD, LARGE_SIZE - 63 };
+    bool exact = true;
+
+    for (size_t o = 0; o < sizeof(offsets) / sizeof(offsets[0]); o++) {
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            uint8_t *start = large_memory + GUARD + offsets[o];
+            memset(large_memory, 0xFF, sizeof(large_memory));
+            em_bulk_zero(start, sizes[s]);
+            if (!all_equal(start, sizes[s], 0)) exact = false;
+            if (!all_equal(large_memory, (size_t)(start - large_memory), 0xFF)) exact = false;
+            if (!all_equal(start + sizes[s], sizeof(large_memory) - (size_t)(start - large_memory) - sizes[s], 0xFF)) exact = false;
+        }
+    }
+    ASSERT(exact, "Every size and misalignment is zeroed without touching its neighbours");
+}
+
+static void test_reset_zero_paths(void) {
+    TEST_CASE("reset_zero paths go through the bulk engine");
+
+    EM *em = em_create_static(large_memory, sizeof(large_memory));
+    ASSERT(em != NULL, "Arena is created");
+
+    uint8_t *a = (uint8_t *)em_alloc(em, LARGE_SIZE / 2);
+    ASSERT(a != NULL, "Large allocation succeeds");
+    memset(a, 0xAA, LARGE_SIZE / 2);
+    em_reset_zero(em);
+    ASSERT(all_equal(block_data(em_get_tail(em)), free_size_in_tail(em), 0), "The whole tail is zeroed");
+
+    Slab *slab = em_slab_create(em, LARGE_SIZE / 4, 256);
+    uint8_t *chunk = (uint8_t *)em_slab_alloc(slab);
+    memset(chunk, 0xBB, 256);
+    em_slab_reset_zero(slab);
+    ASSERT(all_equal(chunk + sizeof(uintptr_t), LARGE_SIZE / 4 - sizeof(uintptr_t), 0), "Slab storage is zeroed");
+    em_slab_destroy(slab);
+
+    Stack *stack = em_stack_create(em, LARGE_SIZE / 4);
+    uint8_t *frame = (uint8_t *)em_stack_alloc(stack, 1000);
+    memset(frame, 0xCC, 1000);
+    em_stack_reset_zero(stack);
+    ASSERT(all_equal(frame, 1000, 0), "Stack frames are zeroed");
+    em_stack_destroy(stack);
+
+    em_destroy(em);
+}
+
+static void test_workers(void) {
+    TEST_CASE("Large ranges are handed to the installed workers");
+
+    size_t parts = 4;
+    em_bulk_zero_set_workers(split_workers, (size_t)1 << 20, &parts);
+    worker_calls = 0;
+    worker_bytes = 0;
+
+    EM *em = em_create_static(large_memory, sizeof(large_memory));
+    uint8_t *a = (uint8_t *)em_alloc(em, LARGE_SIZE / 2);
+    memset(a, 0xDD, LARGE_SIZE / 2);
+    em_reset_zero(em);
+    ASSERT(worker_calls == 1 && worker_bytes == free_size_in_tail(em), "The tail is zeroed by the workers in one call");
+    ASSERT(all_equal(block_data(em_get_tail(em)), free_size_in_tail(em), 0), "The workers cleared all of it");
+
+    Slab *slab = em_slab_create(em, 4096, 64);
+    em_slab_reset_zero(slab);
+    ASSERT(worker_calls == 1, "Ranges below the minimum stay on the calling thread");
+    em_slab_destroy(slab);
+
+    em_bulk_zero_set_workers(NULL, 0, NULL);
+    em_reset_zero(em);
+    ASSERT(worker_calls == 1, "Removing the hook zeroes on the calling thread again");
+
+    em_destroy(em);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_bulk_zero_ranges();
+    test_reset_zero_paths();
+    test_workers();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,240 @@
+#define EM_DIRTY_TRACKING
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE  (1 << 16)
+#define MAX_LIVE    (48)
+#define ITERATIONS  (6000)
+
+static uint8_t arena_memory[ARENA_SIZE];
+
+static bool is_zero(const void *memory, size_t size) {
+    const uint8_t *bytes = (const uint8_t *)memory;
+    for (size_t i = 0; i < size; i++) {
+        if (bytes[i] != 0) return false;
+    }
+    return true;
+}
+
+/*
+ * A byte planted behind the arena's back marks memory the arena believes untouched:
+ * it survives exactly when zeroing is skipped.
+*/
+static void test_untouched_memory_is_skipped(void) {
+    TEST_CASE("Never-written memory is not zeroed again");
+
+    memset(arena_memory, 0, sizeof(arena_memory));
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    em_mark_zeroed(em);
+
+    uint8_t *first = (uint8_t *)em_calloc(em, 1, 256);
+    ASSERT(first != NULL && is_zero(first, 256), "calloc from the clean tail is zero");
+
+    uint8_t *planted = first + 4096;
+    *planted = 0xAB;
+    uint8_t *second = (uint8_t *)em_calloc(em, 1, 8192);
+    ASSERT(second != NULL && planted > second && planted < second + 8192, "The next calloc covers the planted byte");
+    ASSERT(*planted == 0xAB, "calloc skipped memory that was never handed out");
+
+    memset(first, 0x5A, 256);
+    em_free(first);
+    uint8_t *reused = (uint8_t *)em_calloc(em, 1, 200);
+    ASSERT(reused == first && is_zero(reused, 200), "A reused dirty block is zeroed");
+
+    em_reset_zero(em);
+    ASSERT(*planted == 0 && is_zero(first, 256), "reset_zero clears everything handed out since the last zeroing");
+
+    planted = (uint8_t *)block_data(em_get_tail(em)) + 20000;
+    *planted = 0xCD;
+    em_reset_zero(em);
+    ASSERT(*planted == 0xCD, "A second reset_zero without allocations writes nothing");
+    *planted = 0;
+
+    em_destroy(em);
+}
+
+static void test_sub_allocators(void) {
+    TEST_CASE("Slab and Stack zeroing only clear what they wrote");
+
+    memset(arena_memory, 0, sizeof(arena_memory));
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    em_mark_zeroed(em);
+
+    Slab *slab = em_slab_create(em, 4096, 64);
+    ASSERT(slab != NULL, "Slab is created");
+    uint8_t *a = (uint8_t *)em_slab_alloc(slab);
+    uint8_t *b = (uint8_t *)em_slab_alloc(slab);
+    memset(a, 0x11, 64);
+    memset(b, 0x22, 64);
+    uint8_t *planted = a + 2048;
+    *planted = 0xEE;
+
+    em_slab_reset_zero(slab);
+    ASSERT(is_zero(b, 64), "Written chunks are zeroed");
+    ASSERT(*planted == 0xEE, "Chunks past the frontier are skipped");
+    *planted = 0;
+
+    uint8_t *c = (uint8_t *)em_slab_alloc(slab);
+    ASSERT(c == a && is_zero(c + sizeof(uintptr_t), 64 - sizeof(uintptr_t)), "The slab restarts from zeroed chunks");
+    em_slab_destroy(slab);
+
+    Stack *stack = em_stack_create(em, 2048);
+    ASSERT(stack != NULL, "Stack is created");
+    uint8_t *frame = (uint8_t *)em_stack_alloc(stack, 128);
+    memset(frame, 0x33, 128);
+    em_stack_reset_zero(stack);
+    ASSERT(is_zero(frame, 128), "Stack frames are zeroed");
+    em_stack_destroy(stack);
+
+    Bump *bump = em_bump_create(em, 1024);
+    uint8_t *bumped = (uint8_t *)em_bump_alloc(bump, 100);
+    memset(bumped, 0x44, 100);
+    em_bump_destroy(bump);
+    uint8_t *zeroed = (uint8_t *)em_calloc(em, 1, 1024);
+    ASSERT(zeroed != NULL && is_zero(zeroed, 1024), "calloc over a destroyed Bump clears what the Bump handed out");
+
+    em_destroy(em);
+}
+
+static void test_unknown_memory_is_dirty(void) {
+    TEST_CASE("Arenas over unknown memory zero everything");
+
+    memset(arena_memory, 0x77, sizeof(arena_memory));
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    uint8_t *p = (uint8_t *)em_calloc(em, 1, 1000);
+    ASSERT(p != NULL && is_zero(p, 1000), "Without em_mark_zeroed calloc zeroes in full");
+
+    em_reset_zero(em);
+    uint8_t *tail_data = (uint8_t *)block_data(em_get_tail(em));
+    ASSERT(is_zero(tail_data, 4096), "reset_zero zeroes the whole tail once");
+
+    EM *nested = em_create_nested(em, 4096);
+    uint8_t *q = (uint8_t *)em_calloc(nested, 1, 512);
+    ASSERT(q != NULL && is_zero(q, 512), "A nested arena carved from zeroed memory hands out zeroes");
+    memset(q, 0x66, 512);
+    em_destroy(nested);
+    uint8_t *r = (uint8_t *)em_calloc(em, 1, 4096);
+    ASSERT(r != NULL && is_zero(r, 4096), "Memory written by a destroyed child is zeroed by the parent");
+
+    em_destroy(em);
+
+#ifndef EM_NO_MALLOC
+    EM *dynamic = em_create(1 << 20);
+    uint8_t *big = (uint8_t *)em_calloc(dynamic, 1, 1 << 19);
+    ASSERT(big != NULL && is_zero(big, 1 << 19), "Dynamic arenas start from zeroed pages");
+    em_destroy(dynamic);
+#endif
+}
+
+/*
+ * Random operations, dirtying every byte handed out; each calloc and every zeroing reset
+ * must still produce zeroes.
+*/
+static void test_randomized_zeroing(void) {
+    TEST_CASE("Zeroing stays exact under random operations");
+
+    memset(arena_memory, 0, sizeof(arena_memory));
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    em_mark_zeroed(em);
+
+    void *live[MAX_LIVE] = { 0 };
+    size_t sizes[MAX_LIVE] = { 0 };
+    void *scratch = NULL;
+    Slab *slab = NULL;
+    Stack *stack = NULL;
+    EM *nested = NULL;
+    size_t failures = 0;
+
+    for (size_t i = 0; i < ITERATIONS; i++) {
+        size_t slot = test_random() % MAX_LIVE;
+        uint32_t op = test_random() % 16;
+
+        if (op < 7) {
+            if (live[slot] != NULL) em_free(live[slot]);
+            sizes[slot] = 1 + test_random() % 900;
+            live[slot] = (op < 4) ? em_calloc(em, 1, sizes[slot]) : em_alloc_aligned(em, sizes[slot], (size_t)16 << (test_random() % 4));
+            if (live[slot] != NULL && op < 4 && !is_zero(live[slot], sizes[slot])) failures++;
+            if (live[slot] != NULL) memset(live[slot], 0xA5, sizes[slot]);
+        }
+        else if (op < 10) {
+            if (live[slot] != NULL) em_free(live[slot]);
+            live[slot] = NULL;
+        }
+        else if (op == 10) {
+            if (scratch != NULL) {
+                em_free(scratch);
+                scratch = NULL;
+            }
+            else if ((scratch = em_alloc_scratch(em, 256)) != NULL) {
+                memset(scratch, 0xB6, 256);
+            }
+        }
+        else if (op == 11) {
+            if (slab == NULL) slab = em_slab_create(em, 2048, 48);
+            uint8_t *chunk = slab ? (uint8_t *)em_slab_alloc(slab) : NULL;
+            if (chunk) memset(chunk, 0xC7, 48);
+            if (slab && test_random() % 4 == 0) {
+                em_slab_reset_zero(slab);
+                if (!is_zero((uint8_t *)slab + sizeof(Slab) + sizeof(uintptr_t), 2048 - sizeof(uintptr_t))) failures++;
+            }
+        }
+        else if (op == 12) {
+            if (stack == NULL) stack = em_stack_create(em, 1024);
+            uint8_t *frame = stack ? (uint8_t *)em_stack_alloc(stack, 1 + test_random() % 100) : NULL;
+            if (frame) memset(frame, 0xD8, 1);
+            if (stack && test_random() % 4 == 0) {
+                em_stack_reset_zero(stack);
+                if (!is_zero((uint8_t *)stack + sizeof(Stack), 1024)) failures++;
+            }
+        }
+        else if (op == 13) {
+            if (nested != NULL) {
+                em_destroy(nested);
+                nested = NULL;
+            }
+            else if ((nested = em_create_nested(em, 3000)) != NULL) {
+                uint8_t *inner = (uint8_t *)em_calloc(nested, 1, 700);
+                if (inner && !is_zero(inner, 700)) failures++;
+                if (inner) memset(inner, 0xE9, 700);
+            }
+        }
+        else if (op == 14) {
+            if (slab) em_slab_destroy(slab);
+            if (stack) em_stack_destroy(stack);
+            slab = NULL;
+            stack = NULL;
+        }
+        else if (test_random() % 32 == 0) {
+            for (size_t j = 0; j < MAX_LIVE; j++) live[j] = NULL;
+            scratch = NULL;
+            slab = NULL;
+            stack = NULL;
+            nested = NULL;
+            if (test_random() % 2) {
+                em_reset_zero(em);
+                if (!is_zero(block_data(em_get_tail(em)), free_size_in_tail(em))) failures++;
+            }
+            else {
+                em_reset(em);
+            }
+        }
+    }
+
+    ASSERT(failures == 0, "Every zeroing produced zeroes");
+    em_destroy(em);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+    seed_test_random(0x9E3779B9u);
+
+    test_untouched_memory_is_skipped();
+    test_sub_allocators();
+    test_unknown_memory_is_dirty();
+    test_randomized_zeroing();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
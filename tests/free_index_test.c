@@ -0,0 +1,189 @@
+#ifndef EM_FREE_TLSF  // The index works on top of the free tree, which EM_FREE_TLSF replaces
+#define EM_FREE_INDEX
+#endif
+#define EM_VERIFY
+#define EM_STATS
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "test_utils.h"
+
+#ifdef EM_FREE_INDEX
+
+#define ARENA_SIZE  (1 << 17)
+#define MAX_LIVE    (256)
+#define ITERATIONS  (20000)
+
+static uint8_t arena_memory[ARENA_SIZE];
+static uint8_t index_memory[EM_PLAN_FREE_INDEX_SIZE(1024)];
+
+/*
+ * Brute force over the block chain: size of the smallest free block holding 'size' bytes
+ * (0 if none), and the size each free block had before the allocation
+*/
+static size_t oracle_best_fit(EM *em, size_t size, Block **blocks, size_t *sizes, size_t *count) {
+    size_t best = 0;
+    *count = 0;
+    for (Block *block = em_get_first_block(em); block != em_get_tail(em); block = next_block_unsafe(block)) {
+        if (!get_is_free(block)) continue;
+        if (*count < MAX_LIVE * 2) {
+            blocks[*count] = block;
+            sizes[(*count)++] = get_size(block);
+        }
+        if (get_size(block) >= size && (best == 0 || get_size(block) < best)) best = get_size(block);
+    }
+    return best;
+}
+
+static size_t indexed_blocks(EM *em) {
+    EMFreeIndex *index = em_get_extension(em)->free_index;
+    return index ? index->count : 0;
+}
+
+/*
+ * Random allocations and frees; every default-aligned allocation must land in the smallest
+ * fitting free block, and the arena must verify against the index throughout.
+*/
+static void run_randomized(EM *em, size_t iterations, size_t *misplaced, size_t *failures) {
+    void *live[MAX_LIVE] = { 0 };
+
+    for (size_t i = 0; i < iterations; i++) {
+        size_t slot = test_random() % MAX_LIVE;
+        uint32_t op = test_random() % 8;
+
+        if (live[slot] != NULL) {
+            em_free(live[slot]);
+            live[slot] = NULL;
+        }
+
+        if (op < 4) {
+            // Word alignment needs no padding, so best fit is exact in the tree and in the index
+            static Block *blocks[MAX_LIVE * 2];
+            static size_t sizes[MAX_LIVE * 2];
+            size_t count = 0;
+            size_t size = 1 + test_random() % 400;
+            size_t best = oracle_best_fit(em, align_up(size + EM_ASAN_REDZONE, sizeof(uintptr_t)), blocks, sizes, &count);
+            live[slot] = em_alloc_aligned(em, size, sizeof(uintptr_t));
+            if (live[slot] != NULL) {
+                size_t used = 0;
+                for (size_t j = 0; j < count; j++) {
+                    if (blocks[j] == block_from_data(live[slot])) used = sizes[j];
+                }
+                if (used != best) (*misplaced)++;
+            }
+        }
+        else if (op < 6) {
+            live[slot] = em_alloc_aligned(em, 1 + test_random() % 300, (size_t)16 << (test_random() % 5));
+            if (live[slot] != NULL && ((uintptr_t)live[slot] & 15) != 0) (*failures)++;
+        }
+
+        if (i % 97 == 0 && em_verify(em).reason != NULL) (*failures)++;
+    }
+
+    for (size_t i = 0; i < MAX_LIVE; i++) {
+        if (live[i] != NULL) em_free(live[i]);
+    }
+}
+
+static void test_best_fit(void) {
+    TEST_CASE("Allocations from the index take the smallest fitting block");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    ASSERT(em_free_index_attach(em, index_memory, sizeof(index_memory)), "Index is attached");
+
+    size_t misplaced = 0;
+    size_t failures = 0;
+    void *live[MAX_LIVE] = { 0 };
+    for (size_t i = 0; i < MAX_LIVE; i++) live[i] = em_alloc(em, 16 + (i * 37) % 500);
+    for (size_t i = 0; i < MAX_LIVE; i += 2) em_free(live[i]);
+    ASSERT(indexed_blocks(em) == MAX_LIVE / 2 && em_get_free_blocks(em) == NULL, "Every hole goes to the index, none to the tree");
+
+    run_randomized(em, ITERATIONS, &misplaced, &failures);
+    ASSERT(misplaced == 0, "Every allocation matched the brute-force best fit");
+    ASSERT(failures == 0, "The arena verified clean throughout");
+
+    for (size_t i = 1; i < MAX_LIVE; i += 2) em_free(live[i]);
+    ASSERT(indexed_blocks(em) == 0 && em_verify(em).reason == NULL, "Everything merged back into the tail");
+    em_destroy(em);
+}
+
+static void test_spill_into_tree(void) {
+    TEST_CASE("A small index spills into the free tree");
+
+    static uint8_t small_index[sizeof(EMFreeIndex) + 64 + 3 * sizeof(EMIndexNode)];
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    ASSERT(!em_free_index_attach(em, small_index, sizeof(EMFreeIndex)), "A buffer without room for a node is refused");
+    ASSERT(em_free_index_attach(em, small_index, sizeof(small_index)), "Index is attached");
+
+    void *live[64];
+    for (size_t i = 0; i < 64; i++) live[i] = em_alloc(em, 24 + i * 8);
+    for (size_t i = 0; i < 64; i += 2) em_free(live[i]);
+    ASSERT(indexed_blocks(em) > 0 && em_get_free_blocks(em) != NULL, "Holes are split between the index and the tree");
+    ASSERT(em_get_stats(em).free_tree_blocks == 32, "Statistics count both");
+    ASSERT(em_verify(em).reason == NULL, "The split state verifies");
+
+    void *p = em_alloc_aligned(em, 24 + 62 * 8, sizeof(uintptr_t));
+    ASSERT(p == live[62], "The best fit is found wherever it lives");
+    em_free(p);
+
+    size_t misplaced = 0;
+    size_t failures = 0;
+    run_randomized(em, ITERATIONS / 2, &misplaced, &failures);
+    ASSERT(misplaced == 0 && failures == 0, "Best fit and verification hold across both structures");
+
+    for (size_t i = 1; i < 64; i += 2) em_free(live[i]);
+    ASSERT(em_verify(em).reason == NULL && em_get_free_blocks(em) == NULL, "Everything merged back into the tail");
+    em_destroy(em);
+}
+
+static void test_attach_detach_reset(void) {
+    TEST_CASE("Attach, detach and reset move the free blocks");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *live[100];
+    for (size_t i = 0; i < 100; i++) live[i] = em_alloc(em, 40 + i);
+    for (size_t i = 0; i < 100; i += 2) em_free(live[i]);
+    size_t largest = em_get_stats(em).largest_free_block;
+
+    ASSERT(em_free_index_attach(em, index_memory, sizeof(index_memory)), "Index is attached to a fragmented arena");
+    ASSERT(indexed_blocks(em) == 50 && em_get_free_blocks(em) == NULL, "The free tree moved into the index");
+    ASSERT(em_verify(em).reason == NULL, "The arena verifies after the move");
+    ASSERT(em_get_stats(em).largest_free_block == largest, "The largest free block is still reported");
+
+    em_free_index_detach(em);
+    ASSERT(em_get_extension(em)->free_index == NULL, "Index is detached");
+    ASSERT(em_get_stats(em).free_tree_blocks == 50 && em_verify(em).reason == NULL, "The blocks moved back into the tree");
+    em_free_index_detach(em);
+
+    ASSERT(em_free_index_attach(em, index_memory, sizeof(index_memory)), "Index is attached again");
+    em_reset(em);
+    ASSERT(em_get_extension(em)->free_index != NULL && indexed_blocks(em) == 0, "A reset empties an outside buffer and keeps it");
+    for (size_t i = 0; i < 10; i++) live[i] = em_alloc(em, 64);
+    em_free(live[3]);
+    ASSERT(indexed_blocks(em) == 1 && em_verify(em).reason == NULL, "The emptied index is used again");
+
+    void *inside = em_alloc(em, EM_PLAN_FREE_INDEX_SIZE(64));
+    ASSERT(em_free_index_attach(em, inside, EM_PLAN_FREE_INDEX_SIZE(64)), "A buffer from the arena itself is attached");
+    ASSERT(indexed_blocks(em) == 1 && em_verify(em).reason == NULL, "The previous index was detached first");
+    em_reset(em);
+    ASSERT(em_get_extension(em)->free_index == NULL, "A reset drops a buffer carved from the arena");
+    ASSERT(em_alloc(em, 100) != NULL && em_verify(em).reason == NULL, "The arena works without it");
+    em_destroy(em);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+    seed_test_random(0x7F4A7C15u);
+
+    test_best_fit();
+    test_spill_into_tree();
+    test_attach_detach_reset();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
+#else
+int main(void) {
+    return 0;
+}
+#endif // EM_FREE_INDEX
@@ -0,0 +1,258 @@
+#define EM_HANDLES
+#define EM_VERIFY
+#define EM_STATS
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE  (1 << 16)
+#define MAX_LIVE    (256)
+#define ITERATIONS  (20000)
+
+static uint8_t arena_memory[ARENA_SIZE];
+
+typedef struct {
+    size_t calls;
+    size_t bytes;
+} RelocateLog;
+
+static void logged_relocate(void *to, void *from, size_t size, void *context) {
+    RelocateLog *log = (RelocateLog *)context;
+    log->calls++;
+    log->bytes += size;
+    memmove(to, from, size);
+}
+
+/*
+ * Every live handle still holds the pattern written at allocation
+*/
+static bool contents_intact(EM *em, const EMHandle *handles, const size_t *sizes, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (handles[i] == 0) continue;
+        if (!verify_memory_pattern(em_hget(em, handles[i]), sizes[i], (int)(i & 0xFF))) return false;
+    }
+    return true;
+}
+
+/*
+ * A free block directly followed by a handle block is what a finished compaction leaves none of
+*/
+static bool nothing_movable(EM *em) {
+    for (Block *block = em_get_first_block(em); block != em_get_tail(em); block = next_block_unsafe(block)) {
+        if (get_is_free(block) && get_reserved_bits(next_block_unsafe(block)) == EMHANDLE_TAG) return false;
+    }
+    return true;
+}
+
+static void test_compaction_unblocks(void) {
+    TEST_CASE("Compaction coalesces holes into the tail");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    ASSERT(em_handles_create(em, MAX_LIVE, NULL, NULL), "Handle table is created");
+
+    EMHandle handles[MAX_LIVE] = { 0 };
+    size_t sizes[MAX_LIVE] = { 0 };
+    size_t count = 0;
+    while (count < MAX_LIVE) {
+        sizes[count] = 64 + test_random() % 320;
+        handles[count] = em_halloc(em, sizes[count]);
+        if (handles[count] == 0) break;
+        fill_memory_pattern(em_hget(em, handles[count]), sizes[count], (int)(count & 0xFF));
+        count++;
+    }
+    for (size_t i = 0; i < count; i += 2) {
+        em_hfree(em, handles[i]);
+        handles[i] = 0;
+    }
+
+    EMStats before = em_get_stats(em);
+    size_t wanted = before.free_tree_bytes / 2;
+    ASSERT(before.largest_free_block < wanted, "The free space is too fragmented for a large request");
+    ASSERT(em_alloc(em, wanted) == NULL, "The large request fails before compaction");
+
+    size_t moved = em_compact(em, SIZE_MAX);
+    ASSERT(moved > 0 && em_verify(em).reason == NULL, "Compaction moves blocks and the arena verifies");
+    ASSERT(em_get_stats(em).free_tree_blocks == 0 && em_get_free_blocks(em) == NULL, "Every hole merged into the tail");
+    ASSERT(contents_intact(em, handles, sizes, count), "Every handle resolves to its original contents");
+    ASSERT(em_compact(em, SIZE_MAX) == 0, "A second pass finds nothing to move");
+
+    void *large = em_alloc(em, wanted);
+    ASSERT(large != NULL, "The large request succeeds after compaction");
+    em_free(large);
+    em_destroy(em);
+}
+
+static void test_pins(void) {
+    TEST_CASE("Plain allocations stay in place as pins");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    ASSERT(em_handles_create(em, MAX_LIVE, NULL, NULL), "Handle table is created");
+
+    EMHandle handles[64] = { 0 };
+    size_t sizes[64] = { 0 };
+    void *pins[8];
+    for (size_t i = 0; i < 64; i++) {
+        if (i % 8 == 7) {
+            pins[i / 8] = em_alloc(em, 100);
+            fill_memory_pattern(pins[i / 8], 100, 0xA5);
+        }
+        sizes[i] = 40 + i * 4;
+        handles[i] = em_halloc(em, sizes[i]);
+        fill_memory_pattern(em_hget(em, handles[i]), sizes[i], (int)i);
+    }
+    for (size_t i = 0; i < 64; i += 3) {
+        em_hfree(em, handles[i]);
+        handles[i] = 0;
+    }
+
+    em_compact(em, SIZE_MAX);
+    bool pinned = true;
+    for (size_t i = 0; i < 8; i++) {
+        if (!verify_memory_pattern(pins[i], 100, 0xA5)) pinned = false;
+    }
+    ASSERT(pinned, "Pins keep their address and contents");
+    ASSERT(contents_intact(em, handles, sizes, 64), "Handle blocks moved intact");
+    ASSERT(nothing_movable(em) && em_verify(em).reason == NULL, "Holes are left only in front of pins");
+
+#if EM_SAFETY_POLICY == EM_POLICY_DEFENSIVE
+    em_free(em_hget(em, handles[1]));
+    ASSERT(em_hget(em, handles[1]) != NULL && em_verify(em).reason == NULL, "em_free refuses a handle block");
+#endif
+    for (size_t i = 0; i < 8; i++) em_free(pins[i]);
+    em_compact(em, SIZE_MAX);
+    ASSERT(em_get_free_blocks(em) == NULL && em_verify(em).reason == NULL, "Without pins everything compacts");
+    em_destroy(em);
+}
+
+static void test_budget_and_hook(void) {
+    TEST_CASE("Budgets move a slice at a time through the hook");
+
+    RelocateLog log = { 0, 0 };
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    ASSERT(em_handles_create(em, MAX_LIVE, logged_relocate, &log), "Handle table is created with a hook");
+
+    EMHandle handles[128] = { 0 };
+    size_t sizes[128] = { 0 };
+    for (size_t i = 0; i < 128; i++) {
+        sizes[i] = 16 + test_random() % 200;
+        handles[i] = em_halloc(em, sizes[i]);
+        fill_memory_pattern(em_hget(em, handles[i]), sizes[i], (int)i);
+    }
+    for (size_t i = 0; i < 128; i += 2) {
+        em_hfree(em, handles[i]);
+        handles[i] = 0;
+    }
+
+    size_t total = 0;
+    size_t calls = 0;
+    bool single = true;
+    bool clean = true;
+    for (size_t moved = em_compact(em, 1); moved > 0; moved = em_compact(em, 1)) {
+        total += moved;
+        calls++;
+        if (log.calls != calls) single = false;
+        if (em_verify(em).reason != NULL || !contents_intact(em, handles, sizes, 128)) clean = false;
+    }
+    ASSERT(calls == 64 && single, "A one-byte budget moves one block per call");
+    ASSERT(log.bytes == total, "Every moved byte went through the hook");
+    ASSERT(clean, "The arena verifies and the contents hold between slices");
+    ASSERT(em_get_free_blocks(em) == NULL, "The slices add up to a full compaction");
+    em_destroy(em);
+}
+
+static void test_table_lifecycle(void) {
+    TEST_CASE("Handle table limits, destruction and reset");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+#if EM_SAFETY_POLICY == EM_POLICY_DEFENSIVE
+    ASSERT(em_halloc(em, 16) == 0, "Handles need a table");
+#endif
+    ASSERT(em_handles_create(em, 4, NULL, NULL), "A small table is created");
+    ASSERT(!em_handles_create(em, 4, NULL, NULL), "A second table is refused");
+
+    EMHandle handles[4];
+    for (size_t i = 0; i < 4; i++) handles[i] = em_halloc(em, 32);
+    ASSERT(handles[3] != 0 && em_halloc(em, 32) == 0, "A full table refuses more handles");
+
+    em_hfree(em, handles[1]);
+#if EM_SAFETY_POLICY == EM_POLICY_DEFENSIVE
+    ASSERT(em_hget(em, handles[1]) == NULL, "A released handle resolves to NULL");
+    ASSERT(em_hget(em, 0) == NULL && em_hget(em, 5) == NULL, "Handles outside the table resolve to NULL");
+#endif
+    ASSERT(em_halloc(em, 32) == handles[1], "The released slot is reused");
+    ASSERT(em_get_stats(em).live_blocks == 5 && em_verify(em).reason == NULL, "Handle blocks and the table are live blocks");
+
+    em_handles_destroy(em);
+    ASSERT(em_get_extension(em)->handles == NULL && em_get_stats(em).live_blocks == 0, "Destroy frees the blocks and the table");
+    ASSERT(em_get_free_blocks(em) == NULL && em_get_tail(em) == em_get_first_block(em), "The arena is empty again");
+
+    ASSERT(em_handles_create(em, 8, NULL, NULL) && em_halloc(em, 64) != 0, "A new table is created");
+    em_reset(em);
+    ASSERT(em_get_extension(em)->handles == NULL, "A reset drops the table");
+    ASSERT(em_compact(em, SIZE_MAX) == 0, "Compaction without a table does nothing");
+    em_destroy(em);
+}
+
+static void test_randomized(void) {
+    TEST_CASE("Random workload with interleaved compaction");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    ASSERT(em_handles_create(em, MAX_LIVE, NULL, NULL), "Handle table is created");
+
+    EMHandle handles[MAX_LIVE] = { 0 };
+    size_t sizes[MAX_LIVE] = { 0 };
+    void *pins[MAX_LIVE / 8] = { 0 };
+    size_t failures = 0;
+
+    for (size_t i = 0; i < ITERATIONS; i++) {
+        size_t slot = test_random() % MAX_LIVE;
+        uint32_t op = test_random() % 16;
+
+        if (op < 8) {
+            if (handles[slot] != 0) em_hfree(em, handles[slot]);
+            sizes[slot] = 1 + test_random() % 400;
+            handles[slot] = em_halloc(em, sizes[slot]);
+            if (handles[slot] != 0) fill_memory_pattern(em_hget(em, handles[slot]), sizes[slot], (int)(slot & 0xFF));
+        }
+        else if (op < 12) {
+            if (handles[slot] != 0) em_hfree(em, handles[slot]);
+            handles[slot] = 0;
+        }
+        else if (op < 14) {
+            size_t pin = slot % (MAX_LIVE / 8);
+            if (pins[pin] != NULL) em_free(pins[pin]);
+            pins[pin] = (op == 12) ? em_alloc(em, 1 + test_random() % 200) : NULL;
+        }
+        else {
+            em_compact(em, 1 + test_random() % 2048);
+            if (!contents_intact(em, handles, sizes, MAX_LIVE)) failures++;
+        }
+
+        if (i % 97 == 0 && em_verify(em).reason != NULL) failures++;
+    }
+    ASSERT(failures == 0, "The arena verified clean and the contents held throughout");
+
+    for (size_t i = 0; i < MAX_LIVE / 8; i++) {
+        if (pins[i] != NULL) em_free(pins[i]);
+    }
+    em_compact(em, SIZE_MAX);
+    ASSERT(em_compact(em, SIZE_MAX) == 0 && contents_intact(em, handles, sizes, MAX_LIVE), "A final compaction leaves nothing to move");
+    em_handles_destroy(em);
+    ASSERT(em_get_stats(em).live_blocks == 0 && em_verify(em).reason == NULL, "Everything is released");
+    em_destroy(em);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+    seed_test_random(0x3C6EF372u);
+
+    test_compaction_unblocks();
+    test_pins();
+    test_budget_and_hook();
+    test_table_lifecycle();
+    test_randomized();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,141 @@
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "test_utils.h"
+
+/*
+ * Plans under test: the C++ counterparts of the plans in layout_plan_test.c.
+ * Every value is a constant expression, so the templates are checked against
+ * the EM_PLAN_* macros at compile time and size the buffers below.
+*/
+using MixedPlan = em_plan::Arena<16,
+    em_plan::Alloc<24, 0, 40>,
+    em_plan::Alloc<300, 0, 6>>;
+
+using OveralignedPlan = em_plan::Arena<EMMIN_ALIGNMENT,
+    em_plan::Alloc<40, 64, 5>,
+    em_plan::Alloc<100, 256, 3>,
+    em_plan::Alloc<8, 0, 7>>;
+
+using BumpPlan   = em_plan::Bump<36, 16, 20>;
+using SlabPlan   = em_plan::Slab<20, 32>;
+using StackPlan  = em_plan::Stack<50, 32, 12>;
+using NestedPlan = em_plan::Nested<64, em_plan::Alloc<70, 64, 10>>;
+
+using SubPlan = em_plan::Arena<EM_DEFAULT_ALIGNMENT,
+    BumpPlan, SlabPlan, StackPlan, NestedPlan,
+    em_plan::Scratch<200, 128>>;
+
+static_assert(MixedPlan::footprint == EM_PLAN_ALLOCS(24, 16, 40, 16) + EM_PLAN_ALLOCS(300, 16, 6, 16),
+    "Alloc entries match EM_PLAN_ALLOCS");
+static_assert(MixedPlan::size == EM_PLAN_STATIC_SIZE(16, MixedPlan::footprint),
+    "Arena size matches EM_PLAN_STATIC_SIZE");
+static_assert(BumpPlan::create_size(EM_DEFAULT_ALIGNMENT) == EM_PLAN_BUMP_SIZE(36, 16, 20, EM_DEFAULT_ALIGNMENT),
+    "Bump size matches EM_PLAN_BUMP_SIZE");
+static_assert(SlabPlan::create_size == EM_PLAN_SLAB_SIZE(20, 32), "Slab size matches EM_PLAN_SLAB_SIZE");
+static_assert(StackPlan::create_size == EM_PLAN_STACK_SIZE(EM_PLAN_STACK_FRAMES(50, 32, 12), 12),
+    "Stack size matches EM_PLAN_STACK_SIZE");
+static_assert(NestedPlan::create_size == EM_PLAN_STATIC_SIZE(64, EM_PLAN_ALLOCS(70, 64, 10, 64)),
+    "Nested size matches EM_PLAN_STATIC_SIZE");
+static_assert(SubPlan::fits(SubPlan::size) && !SubPlan::fits(SubPlan::size - 1), "fits() compares against the plan size");
+
+static uint8_t plan_memory[SubPlan::size + MixedPlan::size + OveralignedPlan::size + EMMIN_ALIGNMENT];
+
+static bool fill_mixed(EM *em, bool reversed) {
+    for (int i = 0; i < 46; i++) {
+        int index = reversed ? (45 - i) : i;
+        size_t size = (index < 40) ? 24 : 300;
+        void *ptr = em_alloc_aligned(em, size, MixedPlan::alignment);
+        if (!ptr) return false;
+        memset(ptr, 0xAB, size);
+    }
+    return true;
+}
+
+static bool fill_overaligned(EM *em) {
+    for (int i = 0; i < 5; i++) {
+        void *ptr = em_alloc_aligned(em, 40, 64);
+        if (!ptr || ((uintptr_t)ptr & 63) != 0) return false;
+    }
+    for (int i = 0; i < 3; i++) {
+        void *ptr = em_alloc_aligned(em, 100, 256);
+        if (!ptr || ((uintptr_t)ptr & 255) != 0) return false;
+    }
+    for (int i = 0; i < 7; i++) {
+        if (!em_alloc_aligned(em, 8, OveralignedPlan::alignment)) return false;
+    }
+    return true;
+}
+
+static void test_alloc_plans(void) {
+    TEST_CASE("Template plans for plain allocations fit at every buffer offset");
+
+    bool mixed_ok = true;
+    bool overaligned_ok = true;
+    for (size_t offset = 0; offset < EMMIN_ALIGNMENT; offset++) {
+        for (int order = 0; order < 2; order++) {
+            EM *em = em_create_static_aligned(plan_memory + offset, MixedPlan::size, MixedPlan::alignment);
+            if (!em || !fill_mixed(em, order == 1)) mixed_ok = false;
+        }
+        EM *em = em_create_static_aligned(plan_memory + offset, OveralignedPlan::size, OveralignedPlan::alignment);
+        if (!em || !fill_overaligned(em)) overaligned_ok = false;
+    }
+    ASSERT(mixed_ok, "Every planned allocation succeeds in both orders and at every offset");
+    ASSERT(overaligned_ok, "Over-aligned allocations fit into the planned buffer");
+}
+
+static void test_sub_allocator_plan(void) {
+    TEST_CASE("Template plan for sub-allocators, nested arena and scratch");
+
+    for (size_t offset = 0; offset < EMMIN_ALIGNMENT; offset++) {
+        EM *em = em_create_static(plan_memory + offset, SubPlan::size);
+        ASSERT_QUIET(em != NULL, "Arena creation should succeed");
+        if (!em) continue;
+
+        Bump *bump = em_bump_create(em, BumpPlan::create_size(SubPlan::alignment));
+        ASSERT_QUIET(bump != NULL, "Planned Bump should be created");
+        bool bump_ok = bump != NULL;
+        for (int i = 0; bump && i < 20; i++) {
+            if (!em_bump_alloc_aligned(bump, 36, 16)) bump_ok = false;
+        }
+        ASSERT_QUIET(bump_ok, "All planned Bump allocations should succeed");
+
+        Slab *slab = em_slab_create(em, SlabPlan::create_size, 20);
+        ASSERT_QUIET(slab != NULL, "Planned Slab should be created");
+        bool slab_ok = slab != NULL;
+        for (int i = 0; slab && i < 32; i++) {
+            if (!em_slab_alloc(slab)) slab_ok = false;
+        }
+        ASSERT_QUIET(slab_ok, "All planned Slab chunks should be available");
+
+        Stack *stack = em_stack_create(em, StackPlan::create_size);
+        ASSERT_QUIET(stack != NULL, "Planned Stack should be created");
+        bool stack_ok = stack != NULL;
+        for (int i = 0; stack && i < 12; i++) {
+            if (!em_stack_alloc_aligned(stack, 50, 32)) stack_ok = false;
+        }
+        ASSERT_QUIET(stack_ok, "All planned Stack frames should succeed");
+
+        EM *nested = em_create_nested_aligned(em, NestedPlan::create_size, 64);
+        ASSERT_QUIET(nested != NULL, "Planned nested arena should be created");
+        bool nested_ok = nested != NULL;
+        for (int i = 0; nested && i < 10; i++) {
+            if (!em_alloc(nested, 70)) nested_ok = false;
+        }
+        ASSERT_QUIET(nested_ok, "All planned nested allocations should succeed");
+
+        void *scratch = em_alloc_scratch_aligned(em, 200, 128);
+        ASSERT_QUIET(scratch != NULL, "Planned scratch allocation should succeed");
+    }
+    ASSERT(tests_failed == 0, "Sub-allocator plan holds at every buffer offset");
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_alloc_plans();
+    test_sub_allocator_plan();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,202 @@
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "test_utils.h"
+
+/*
+ * Plans under test. Every plan is a plain integer constant expression,
+ * so it can size static arrays and feed EM_PLAN_ASSERT_FITS.
+*/
+#define SMALL_COUNT   (40)
+#define SMALL_SIZE    (24)
+#define MEDIUM_COUNT  (6)
+#define MEDIUM_SIZE   (300)
+
+#define MIXED_PLAN(align) \
+    (EM_PLAN_ALLOCS(SMALL_SIZE, align, SMALL_COUNT, align) + EM_PLAN_ALLOCS(MEDIUM_SIZE, align, MEDIUM_COUNT, align))
+
+#define OVERALIGNED_PLAN(align) \
+    (EM_PLAN_ALLOCS(40, 64, 5, align) + EM_PLAN_ALLOCS(100, 256, 3, align) + EM_PLAN_ALLOCS(8, align, 7, align))
+
+#define BUMP_ITEMS    (20)
+#define SLAB_CHUNKS   (32)
+#define SLAB_CHUNK    (20)
+#define STACK_FRAMES  (12)
+#define NESTED_COUNT  (10)
+
+#define BUMP_CREATE_SIZE   EM_PLAN_BUMP_SIZE(36, 16, BUMP_ITEMS, EM_DEFAULT_ALIGNMENT)
+#define SLAB_CREATE_SIZE   EM_PLAN_SLAB_SIZE(SLAB_CHUNK, SLAB_CHUNKS)
+#define STACK_CREATE_SIZE  EM_PLAN_STACK_SIZE(EM_PLAN_STACK_FRAMES(50, 32, STACK_FRAMES), STACK_FRAMES)
+#define NESTED_CREATE_SIZE EM_PLAN_STATIC_SIZE(64, EM_PLAN_ALLOCS(70, 64, NESTED_COUNT, 64))
+
+#define SUB_PLAN \
+    (EM_PLAN_ALLOC(BUMP_CREATE_SIZE,   EM_DEFAULT_ALIGNMENT, EM_DEFAULT_ALIGNMENT) + \
+     EM_PLAN_ALLOC(SLAB_CREATE_SIZE,   EM_DEFAULT_ALIGNMENT, EM_DEFAULT_ALIGNMENT) + \
+     EM_PLAN_ALLOC(STACK_CREATE_SIZE,  EM_DEFAULT_ALIGNMENT, EM_DEFAULT_ALIGNMENT) + \
+     EM_PLAN_ALLOC(NESTED_CREATE_SIZE, EM_DEFAULT_ALIGNMENT, EM_DEFAULT_ALIGNMENT) + \
+     EM_PLAN_SCRATCH(200, 128))
+
+#define SUB_ARENA_SIZE EM_PLAN_STATIC_SIZE(EM_DEFAULT_ALIGNMENT, SUB_PLAN)
+
+static uint8_t sub_arena_memory[SUB_ARENA_SIZE + EMMIN_ALIGNMENT];
+EM_PLAN_ASSERT_FITS(sizeof(sub_arena_memory), SUB_ARENA_SIZE);
+
+static uint8_t scratch_memory[1 << 16];
+
+/*
+ * Allocation helpers: fill the arena with the mixed plan in a given order.
+*/
+static bool fill_mixed(EM *em, size_t align, bool reversed) {
+    for (int i = 0; i < SMALL_COUNT + MEDIUM_COUNT; i++) {
+        int index = reversed ? (SMALL_COUNT + MEDIUM_COUNT - 1 - i) : i;
+        size_t size = (index < SMALL_COUNT) ? SMALL_SIZE : MEDIUM_SIZE;
+        void *ptr = em_alloc_aligned(em, size, align);
+        if (!ptr) return false;
+        memset(ptr, 0xAB, size);
+    }
+    return true;
+}
+
+static bool fill_overaligned(EM *em, size_t align) {
+    for (int i = 0; i < 5; i++) {
+        void *ptr = em_alloc_aligned(em, 40, 64);
+        if (!ptr || ((uintptr_t)ptr & 63) != 0) return false;
+    }
+    for (int i = 0; i < 3; i++) {
+        void *ptr = em_alloc_aligned(em, 100, 256);
+        if (!ptr || ((uintptr_t)ptr & 255) != 0) return false;
+    }
+    for (int i = 0; i < 7; i++) {
+        if (!em_alloc_aligned(em, 8, align)) return false;
+    }
+    return true;
+}
+
+static void test_plain_plan(void) {
+    TEST_CASE("Plan for plain allocations fits at every buffer offset");
+
+    const size_t aligns[] = { EMMIN_ALIGNMENT, 16, 32, 64 };
+    for (size_t a = 0; a < sizeof(aligns) / sizeof(aligns[0]); a++) {
+        size_t align = aligns[a];
+        size_t plan = EM_PLAN_STATIC_SIZE(align, MIXED_PLAN(align));
+        ASSERT_QUIET(plan + EMMIN_ALIGNMENT <= sizeof(scratch_memory), "Scratch buffer must hold the plan");
+
+        bool all_ok = true;
+        for (size_t offset = 0; offset < EMMIN_ALIGNMENT; offset++) {
+            for (int order = 0; order < 2; order++) {
+                EM *em = em_create_static_aligned(scratch_memory + offset, plan, align);
+                if (!em || !fill_mixed(em, align, order == 1)) all_ok = false;
+            }
+        }
+        ASSERT(all_ok, "Every planned allocation succeeds in both orders and at every offset");
+    }
+}
+
+static void test_overaligned_plan(void) {
+    TEST_CASE("Plan accounts for over-aligned allocations");
+
+    const size_t aligns[] = { EMMIN_ALIGNMENT, 16 };
+    for (size_t a = 0; a < sizeof(aligns) / sizeof(aligns[0]); a++) {
+        size_t align = aligns[a];
+        size_t plan = EM_PLAN_STATIC_SIZE(align, OVERALIGNED_PLAN(align));
+
+        bool all_ok = true;
+        for (size_t offset = 0; offset < EMMIN_ALIGNMENT; offset++) {
+            EM *em = em_create_static_aligned(scratch_memory + offset, plan, align);
+            if (!em || !fill_overaligned(em, align)) all_ok = false;
+        }
+        ASSERT(all_ok, "Over-aligned allocations fit into the planned buffer");
+    }
+}
+
+static void test_sub_allocator_plan(void) {
+    TEST_CASE("Plan for sub-allocators, nested arena and scratch");
+
+    for (size_t offset = 0; offset < EMMIN_ALIGNMENT; offset++) {
+        EM *em = em_create_static(sub_arena_memory + offset, SUB_ARENA_SIZE);
+        ASSERT_QUIET(em != NULL, "Arena creation should succeed");
+        if (!em) continue;
+
+        Bump *bump = em_bump_create(em, BUMP_CREATE_SIZE);
+        ASSERT_QUIET(bump != NULL, "Planned Bump should be created");
+        bool bump_ok = bump != NULL;
+        for (int i = 0; bump && i < BUMP_ITEMS; i++) {
+            if (!em_bump_alloc_aligned(bump, 36, 16)) bump_ok = false;
+        }
+        ASSERT_QUIET(bump_ok, "All planned Bump allocations should succeed");
+
+        Slab *slab = em_slab_create(em, SLAB_CREATE_SIZE, SLAB_CHUNK);
+        ASSERT_QUIET(slab != NULL, "Planned Slab should be created");
+        bool slab_ok = slab != NULL;
+        for (int i = 0; slab && i < SLAB_CHUNKS; i++) {
+            if (!em_slab_alloc(slab)) slab_ok = false;
+        }
+        ASSERT_QUIET(slab_ok, "All planned Slab chunks should be available");
+
+        Stack *stack = em_stack_create(em, STACK_CREATE_SIZE);
+        ASSERT_QUIET(stack != NULL, "Planned Stack should be created");
+        bool stack_ok = stack != NULL;
+        for (int i = 0; stack && i < STACK_FRAMES; i++) {
+            if (!em_stack_alloc_aligned(stack, 50, 32)) stack_ok = false;
+        }
+        ASSERT_QUIET(stack_ok, "All planned Stack frames should succeed");
+
+        EM *nested = em_create_nested_aligned(em, NESTED_CREATE_SIZE, 64);
+        ASSERT_QUIET(nested != NULL, "Planned nested arena should be created");
+        bool nested_ok = nested != NULL;
+        for (int i = 0; nested && i < NESTED_COUNT; i++) {
+            if (!em_alloc(nested, 70)) nested_ok = false;
+        }
+        ASSERT_QUIET(nested_ok, "All planned nested allocations should succeed");
+
+        void *scratch = em_alloc_scratch_aligned(em, 200, 128);
+        ASSERT_QUIET(scratch != NULL, "Planned scratch allocation should succeed");
+    }
+    ASSERT(tests_failed == 0, "Sub-allocator plan holds at every buffer offset");
+}
+
+static void test_plan_tightness(void) {
+    TEST_CASE("Plan is tight");
+
+    // Find the smallest buffer that still holds the plan and compare it with the prediction.
+    // The only slack allowed is the worst-case self-alignment shift, first-block gap and
+    // the end padding of the last block, none of which exist for this aligned buffer.
+    size_t align = 16;
+    size_t plan = EM_PLAN_STATIC_SIZE(align, MIXED_PLAN(align));
+    uint8_t *aligned = (uint8_t *)align_up((uintptr_t)scratch_memory, EMMAX_ALIGNMENT);
+
+    size_t smallest = plan;
+    while (smallest > EMMIN_SIZE) {
+        EM *em = em_create_static_aligned(aligned, smallest - 1, align);
+        if (!em || !fill_mixed(em, align, false)) break;
+        smallest--;
+    }
+
+    ASSERT(smallest <= plan, "Plan is never smaller than the real requirement");
+    ASSERT(plan - smallest <= (EMMIN_ALIGNMENT - 1) + (align - EMMIN_ALIGNMENT) + align_up(MEDIUM_SIZE + sizeof(Block), align) - MEDIUM_SIZE,
+           "Plan overestimates by no more than the worst-case placement slack");
+}
+
+static void test_plan_helpers(void) {
+    TEST_CASE("Planner helper values");
+
+    ASSERT(EM_PLAN_ALLOC(1, EM_DEFAULT_ALIGNMENT, EM_DEFAULT_ALIGNMENT) == align_up(1 + sizeof(Block), EM_DEFAULT_ALIGNMENT),
+           "Single allocation costs its header plus aligned payload");
+    ASSERT(EM_PLAN_ALLOC(16, 256, 16) == EM_PLAN_ALLOC(16, 16, 16) + 240, "Over-alignment adds the worst-case gap");
+    ASSERT(EM_PLAN_SLAB_SIZE(1, 1) == EM_MIN_BUFFER_SIZE, "Slab size never drops below EM_MIN_BUFFER_SIZE");
+    ASSERT(EM_PLAN_STACK_META_WIDTH(200) == 1 && EM_PLAN_STACK_META_WIDTH(300) == 2, "Stack metadata width follows capacity");
+    ASSERT(EM_PLAN_STATIC_SIZE(16, 0) >= EMMIN_SIZE, "Empty plan still satisfies the minimal arena size");
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_plan_helpers();
+    test_plain_plan();
+    test_overaligned_plan();
+    test_sub_allocator_plan();
+    test_plan_tightness();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
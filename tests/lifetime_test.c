@@ -0,0 +1,253 @@
+#define EM_LIFETIME
+#define EM_VERIFY
+#define EM_STATS
+#define EM_WALK
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE  (1 << 16)
+#define MAX_LIVE    (256)
+#define ITERATIONS  (20000)
+
+static uint8_t arena_memory[ARENA_SIZE];
+
+static void test_placement(void) {
+    TEST_CASE("Short-lived blocks grow down from the top and come back in LIFO order");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    size_t alignment = em_get_alignment(em);
+    size_t empty_tail = free_size_in_tail(em);
+
+    void *lower = em_alloc_ex(em, 64, alignment, EM_LIFETIME_LONG);
+    void *a = em_alloc_ex(em, 100, alignment, EM_LIFETIME_SHORT);
+    void *b = em_alloc_ex(em, 40, alignment, EM_LIFETIME_SHORT);
+    void *upper = em_alloc_ex(em, 64, alignment, EM_LIFETIME_LONG);
+    ASSERT(lower != NULL && a != NULL && b != NULL && upper != NULL, "All four allocations succeed");
+    ASSERT((uintptr_t)upper > (uintptr_t)lower && (uintptr_t)upper < (uintptr_t)b, "Long-lived blocks are carved from the tail");
+    ASSERT((uintptr_t)b < (uintptr_t)a && (uintptr_t)a + 100 <= (uintptr_t)arena_memory + ARENA_SIZE, "Short-lived blocks grow down");
+    ASSERT((uintptr_t)a % alignment == 0 && (uintptr_t)b % alignment == 0, "Short-lived blocks are aligned");
+
+    EMStats stats = em_get_stats(em);
+    ASSERT(stats.live_blocks == 4 && stats.short_region_bytes >= 140 + 2 * sizeof(Block), "Statistics count the region");
+    ASSERT(em_verify(em).reason == NULL, "The arena verifies with a live region");
+
+    size_t tail_before = free_size_in_tail(em);
+    em_free(b);
+    ASSERT(free_size_in_tail(em) > tail_before && em_get_free_blocks(em) == NULL, "Freeing the floor hands its space to the tail");
+    em_free(a);
+    ASSERT(em_get_stats(em).short_region_bytes == 0 && em_verify(em).reason == NULL, "The drained region disappears");
+
+    em_free(upper);
+    em_free(lower);
+    ASSERT(free_size_in_tail(em) == empty_tail && em_get_free_blocks(em) == NULL, "Both ends reclaimed without holes");
+    em_destroy(em);
+}
+
+static void test_out_of_order(void) {
+    TEST_CASE("Short-lived blocks freed out of order are held until the floor passes them");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    size_t alignment = em_get_alignment(em);
+    void *blocks[8];
+    for (size_t i = 0; i < 8; i++) {
+        blocks[i] = em_alloc_ex(em, 48 + i * 8, alignment, EM_LIFETIME_SHORT);
+        fill_memory_pattern(blocks[i], 48 + i * 8, (int)i);
+    }
+
+    size_t region = em_get_stats(em).short_region_bytes;
+    for (size_t i = 0; i < 7; i += 2) em_free(blocks[i]);
+    ASSERT(em_get_stats(em).short_region_bytes == region && em_verify(em).reason == NULL, "Frees above the floor keep the region in place");
+    ASSERT(em_get_stats(em).live_blocks == 4 && em_get_free_blocks(em) == NULL, "Held blocks stay out of the free tree");
+    EMStats held = em_get_stats(em);
+    ASSERT(held.short_held_blocks == 4 && held.short_held_bytes >= 48 + 64 + 80 + 96, "Held blocks are counted apart from the free tree");
+    uintptr_t top = (uintptr_t)em + held.short_region_top;
+    ASSERT(top > (uintptr_t)blocks[0] && top <= (uintptr_t)arena_memory + ARENA_SIZE, "The region top is reported as an arena offset");
+
+    bool intact = true;
+    for (size_t i = 1; i < 8; i += 2) {
+        if (!verify_memory_pattern(blocks[i], 48 + i * 8, (int)i)) intact = false;
+    }
+    ASSERT(intact, "Live neighbours keep their contents");
+
+    em_free(blocks[7]);
+    ASSERT(em_get_stats(em).short_region_bytes < region && em_verify(em).reason == NULL, "Freeing the floor lifts it over the held block above");
+    held = em_get_stats(em);
+    ASSERT(held.short_held_blocks == 3 && held.short_held_bytes < region, "The lifted floor releases the block it passed");
+    em_free(blocks[1]);
+    em_free(blocks[5]);
+    em_free(blocks[3]);
+    ASSERT(em_get_stats(em).short_region_bytes == 0 && em_get_tail(em) == em_get_first_block(em), "The last free drains the whole region");
+    held = em_get_stats(em);
+    ASSERT(held.short_held_blocks == 0 && held.short_held_bytes == 0 && held.short_region_top == 0, "Nothing is held once the region drains");
+    em_destroy(em);
+}
+
+static void test_tail_meets_region(void) {
+    TEST_CASE("The tail and the region share the free space");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    size_t alignment = em_get_alignment(em);
+    void *top = em_alloc_ex(em, 256, alignment, EM_LIFETIME_SHORT);
+    ASSERT(top != NULL, "A short-lived block is placed");
+
+    void *rest = em_alloc(em, free_size_in_tail(em) - EM_ASAN_REDZONE);
+    ASSERT(rest != NULL && !get_is_free(em_get_tail(em)) && free_size_in_tail(em) == 0, "The tail is used up to the region");
+    ASSERT(em_verify(em).reason == NULL, "An occupied tail ending at the floor verifies");
+    ASSERT(em_alloc_ex(em, 16, alignment, EM_LIFETIME_SHORT) == NULL, "With no space left a short-lived request fails");
+
+    em_free(top);
+    ASSERT(get_is_free(em_get_tail(em)) && free_size_in_tail(em) >= 256 && em_verify(em).reason == NULL, "The drained region becomes a free tail");
+    void *after = em_alloc_ex(em, 128, alignment, EM_LIFETIME_SHORT);
+    ASSERT(after != NULL && em_verify(em).reason == NULL, "A new region starts above the occupied block");
+    em_free(after);
+    em_free(rest);
+    ASSERT(em_get_free_blocks(em) == NULL && em_get_tail(em) == em_get_first_block(em), "Everything is reclaimed");
+    em_destroy(em);
+}
+
+static void test_scratch_below_region(void) {
+    TEST_CASE("A scratchpad freed under the region comes back when the region drains");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    size_t alignment = em_get_alignment(em);
+    size_t empty_tail = free_size_in_tail(em);
+    void *scratch = em_alloc_scratch(em, 1024);
+    ASSERT(scratch != NULL, "A scratchpad is placed");
+
+    void *below = em_alloc_ex(em, 64, alignment, EM_LIFETIME_SHORT);
+    void *second = em_alloc_ex(em, 64, alignment, EM_LIFETIME_SHORT);
+    ASSERT(below != NULL && (uintptr_t)below < (uintptr_t)scratch && em_verify(em).reason == NULL, "The region starts below the scratchpad");
+    ASSERT(second != NULL && (uintptr_t)second < (uintptr_t)below, "The region grows down");
+    size_t tail_with_region = free_size_in_tail(em);
+
+    em_free(scratch);
+    EMStats stats = em_get_stats(em);
+    ASSERT(stats.scratch_bytes == 0 && stats.short_region_bytes > 0 && em_verify(em).reason == NULL, "Freeing the scratchpad keeps the region");
+    ASSERT(free_size_in_tail(em) == tail_with_region, "The scratchpad space stays behind the region");
+    ASSERT(em_alloc_scratch(em, 1024) == NULL, "No scratchpad while the region holds blocks");
+
+    em_free(below);
+    ASSERT(em_get_stats(em).short_region_bytes > 0 && free_size_in_tail(em) == tail_with_region, "A block above the floor is held");
+    em_free(second);
+    ASSERT(em_get_stats(em).short_region_bytes == 0 && free_size_in_tail(em) == empty_tail, "The scratchpad space returns with the region");
+    ASSERT(em_verify(em).reason == NULL, "The drained arena verifies");
+
+    scratch = em_alloc_scratch(em, 1024);
+    ASSERT(scratch != NULL, "The scratchpad is available again");
+    em_free(scratch);
+    em_destroy(em);
+}
+
+static void test_fallback(void) {
+    TEST_CASE("Short-lived requests fall back to the normal placement");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    size_t alignment = em_get_alignment(em);
+    void *filler = em_alloc(em, 256);
+    void *big = em_alloc_ex(em, free_size_in_tail(em) - 128, alignment, EM_LIFETIME_LONG);
+    em_free(filler);
+    void *hole = em_alloc_ex(em, 200, alignment, EM_LIFETIME_SHORT);
+    ASSERT(big != NULL && hole == filler && em_get_stats(em).short_region_bytes == 0, "A request too large for the top takes the normal placement");
+    ASSERT(em_verify(em).reason == NULL, "The fallback verifies");
+    em_free(hole);
+    em_free(big);
+
+    void *short_block = em_alloc_ex(em, 64, alignment, EM_LIFETIME_SHORT);
+    em_reset(em);
+    ASSERT(em_get_stats(em).short_region_bytes == 0 && em_verify(em).reason == NULL, "A reset drops the region");
+    (void)short_block;
+    em_destroy(em);
+}
+
+typedef struct {
+    EMWalkKind kinds[8];
+    const void *addresses[8];
+    size_t count;
+} WalkLog;
+
+static bool log_entry(const EMWalkEntry *entry, void *context) {
+    WalkLog *log = (WalkLog *)context;
+    if (log->count < 8) {
+        log->kinds[log->count] = entry->kind;
+        log->addresses[log->count] = entry->address;
+    }
+    log->count++;
+    return true;
+}
+
+static void test_walk(void) {
+    TEST_CASE("The walk visits the region after the tail");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    size_t alignment = em_get_alignment(em);
+    void *long_block = em_alloc_ex(em, 64, alignment, EM_LIFETIME_LONG);
+    void *a = em_alloc_ex(em, 64, alignment, EM_LIFETIME_SHORT);
+    void *b = em_alloc_ex(em, 64, alignment, EM_LIFETIME_SHORT);
+    em_free(a);
+
+    WalkLog log;
+    memset(&log, 0, sizeof(log));
+    ASSERT(em_walk(em, log_entry, &log) && log.count == 4, "Block, tail and both region blocks are reported");
+    ASSERT(log.kinds[0] == EM_WALK_USED && log.kinds[1] == EM_WALK_TAIL, "The chain comes first");
+    ASSERT(log.kinds[2] == EM_WALK_USED && log.addresses[2] == (const void *)((uintptr_t)b - sizeof(Block)), "Then the floor of the region");
+    ASSERT(log.kinds[3] == EM_WALK_FREE && log.addresses[3] == (const void *)((uintptr_t)a - sizeof(Block)), "Then the held block above it");
+
+    em_free(b);
+    em_free(long_block);
+    em_destroy(em);
+}
+
+static void test_randomized(void) {
+    TEST_CASE("Random mixed-lifetime workload keeps the arena consistent");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    size_t alignment = em_get_alignment(em);
+    void *live[MAX_LIVE] = { 0 };
+    size_t sizes[MAX_LIVE] = { 0 };
+    size_t failures = 0;
+
+    for (size_t i = 0; i < ITERATIONS; i++) {
+        size_t slot = test_random() % MAX_LIVE;
+        if (live[slot] != NULL) {
+            if (!verify_memory_pattern(live[slot], sizes[slot], (int)(slot & 0xFF))) failures++;
+            em_free(live[slot]);
+            live[slot] = NULL;
+        }
+
+        uint32_t op = test_random() % 8;
+        sizes[slot] = 1 + test_random() % 400;
+        size_t align = alignment << (test_random() % 3);
+        if (op < 4) live[slot] = em_alloc_ex(em, sizes[slot], align, EM_LIFETIME_SHORT);
+        else if (op < 7) live[slot] = em_alloc_ex(em, sizes[slot], align, EM_LIFETIME_LONG);
+        if (live[slot] != NULL) fill_memory_pattern(live[slot], sizes[slot], (int)(slot & 0xFF));
+
+        if (i % 97 == 0 && em_verify(em).reason != NULL) failures++;
+    }
+    ASSERT(failures == 0, "The arena verified clean and the contents held throughout");
+
+    for (size_t i = 0; i < MAX_LIVE; i++) {
+        if (live[i] != NULL) em_free(live[i]);
+    }
+    EMStats stats = em_get_stats(em);
+    ASSERT(stats.live_blocks == 0 && stats.short_region_bytes == 0, "Everything is released");
+    ASSERT(em_get_free_blocks(em) == NULL && em_verify(em).reason == NULL, "Everything merged back into the tail");
+    em_destroy(em);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+    seed_test_random(0x6A09E667u);
+
+    test_placement();
+    test_out_of_order();
+    test_tail_meets_region();
+    test_scratch_below_region();
+    test_fallback();
+    test_walk();
+    test_randomized();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,173 @@
+#define EM_PROFILE
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE   (1 << 16)
+#define MAX_POINTERS (128)
+#define ITERATIONS   (3000)
+
+static uint8_t arena_memory[ARENA_SIZE];
+
+static void test_lifo_paths(void) {
+    TEST_CASE("LIFO usage stays on the O(1) paths");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *a = em_alloc(em, 100);
+    void *b = em_alloc(em, 200);
+
+    EMProfile profile = em_get_profile(em);
+    ASSERT(profile.tail_hits == 2 && profile.tree_hits == 0, "Fresh allocations come from the tail");
+
+    em_free(b);
+    em_free(a);
+    profile = em_get_profile(em);
+    ASSERT(profile.lifo_next_tail_frees == 2, "Frees in reverse order fold into the tail");
+    ASSERT(profile.insert_calls == 0 && profile.detach_calls == 0, "The free tree is never touched");
+
+    void *all = em_alloc(em, free_size_in_tail(em));
+    ASSERT(all != NULL && !get_is_free(em_get_tail(em)), "Allocation of the whole tail occupies the tail block");
+    em_free(all);
+    ASSERT(em_get_profile(em).lifo_tail_frees == 1, "Freeing the occupied tail is counted");
+}
+
+static void test_tree_paths(void) {
+    TEST_CASE("Out-of-order frees go through the free tree");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *a = em_alloc(em, 512);
+    void *b = em_alloc(em, 64);
+    void *c = em_alloc(em, 64);
+    ASSERT(a && b && c, "Setup allocations succeed");
+
+    em_free(a);
+    EMProfile profile = em_get_profile(em);
+    ASSERT(profile.insert_calls == 1 && profile.insert_depth_max == 0, "A hole becomes the tree root");
+
+    void *d = em_alloc(em, 32);
+    profile = em_get_profile(em);
+    ASSERT(d != NULL && profile.tree_hits == 1, "The hole is reused");
+    ASSERT(profile.splits == 1, "The reused hole is split");
+
+    em_free(b);
+    profile = em_get_profile(em);
+    ASSERT(profile.merges == 1 && profile.detach_calls == 1, "Freeing next to the remainder merges with it");
+
+    em_free(d);
+    profile = em_get_profile(em);
+    ASSERT(profile.merges == 2, "The last gap closes with another merge");
+    ASSERT(profile.detach_path_max <= EM_MAX_TREE_HEIGHT, "Paths are bounded by the tree height");
+
+    em_profile_reset(em);
+    profile = em_get_profile(em);
+    ASSERT(profile.tail_hits == 0 && profile.merges == 0 && profile.insert_calls == 0, "Profile reset zeroes the counters");
+    ASSERT(em_alloc(em, 16) != NULL, "Arena is still usable after a profile reset");
+}
+
+static void test_alignment_gap(void) {
+    TEST_CASE("Alignment gaps in the tail are recycled");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    // End the first block half way to a 512 byte boundary, whatever the header length
+    size_t phase = (size_t)(((uintptr_t)em_get_tail(em) + sizeof(Block)) & 511);
+    void *small = em_alloc(em, ((256 + 512 - phase) & 511) + 8);
+    void *aligned = em_alloc_aligned(em, 64, 512);
+
+    EMProfile profile = em_get_profile(em);
+    ASSERT(small && aligned, "Allocations succeed");
+    ASSERT(profile.gap_blocks_recycled == 1, "The padding before the aligned block becomes a free block");
+    ASSERT(profile.insert_calls == 1, "The recycled gap is inserted into the tree");
+
+    em_reset(em);
+    ASSERT(em_get_profile(em).gap_blocks_recycled == 1, "Counters survive em_reset");
+}
+
+#define VINE_LENGTH (EM_MAX_TREE_HEIGHT + 40)
+
+static Block vine[VINE_LENGTH + 1];
+
+static void test_tree_rebuild(void) {
+    TEST_CASE("A free tree deeper than EM_MAX_TREE_HEIGHT is rebuilt on insert");
+
+    // Sorted right vine: what a long run of fast detaches can degrade the tree into
+    for (size_t i = 0; i <= VINE_LENGTH; i++) {
+        set_size(&vine[i], (i + 1) * 16);
+        set_left_tree(&vine[i], NULL);
+        set_right_tree(&vine[i], (i + 1 < VINE_LENGTH) ? &vine[i + 1] : NULL);
+        set_color(&vine[i], EMBLACK);
+    }
+
+    EMProfile profile;
+    memset(&profile, 0, sizeof(profile));
+    Block *root = insert_block(&vine[0], &vine[VINE_LENGTH], &profile);
+    ASSERT(profile.tree_rebuilds == 1, "The overflowing insert triggers one rebuild");
+
+    // In-order walk: every block present, in order, red nodes never have red children
+    Block *stack[EM_MAX_TREE_HEIGHT];
+    size_t depth = 0, visited = 0, max_depth = 0;
+    Block *previous = NULL;
+    Block *current = root;
+    bool ordered = true, no_red_red = true;
+    while (current != NULL || depth > 0) {
+        while (current != NULL) {
+            stack[depth++] = current;
+            if (depth > max_depth) max_depth = depth;
+            current = get_left_tree(current);
+        }
+        current = stack[--depth];
+        if (previous != NULL && compare_blocks(previous, current) > 0) ordered = false;
+        if (is_red(current) && (is_red(get_left_tree(current)) || is_red(get_right_tree(current)))) no_red_red = false;
+        previous = current;
+        visited++;
+        current = get_right_tree(current);
+    }
+    ASSERT(visited == VINE_LENGTH + 1 && ordered, "The rebuilt tree keeps every block in order");
+    ASSERT(no_red_red && !is_red(root), "The rebuilt tree is a valid red-black tree");
+    ASSERT(max_depth <= 9, "The rebuilt tree is balanced");
+}
+
+static void test_random_workload(void) {
+    TEST_CASE("Counters stay consistent under a random workload");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *pointers[MAX_POINTERS] = { NULL };
+    size_t successes = 0;
+    unsigned seed = 777;
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        seed = seed * 1103515245u + 12345u;
+        size_t slot = (seed >> 8) % MAX_POINTERS;
+        if (pointers[slot] != NULL) {
+            em_free(pointers[slot]);
+            pointers[slot] = NULL;
+        } else {
+            pointers[slot] = em_alloc(em, 1 + (seed >> 4) % 900);
+            if (pointers[slot] != NULL) successes++;
+        }
+    }
+
+    EMProfile profile = em_get_profile(em);
+    ASSERT(profile.tail_hits + profile.tree_hits == successes, "Every successful allocation is a tail or a tree hit");
+    ASSERT(profile.tree_hits > 0 && profile.merges > 0, "Random order exercises the tree paths");
+    ASSERT(profile.insert_depth_max <= EM_MAX_TREE_HEIGHT && profile.detach_path_max <= EM_MAX_TREE_HEIGHT,
+           "Observed paths never exceed the tree height limit");
+
+    em_print_profile(em);
+
+    EM *nested = em_create_nested(em, 2048);
+    ASSERT(nested != NULL && em_get_profile(nested).tail_hits == 0, "A nested arena starts with its own empty profile");
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_lifo_paths();
+    test_tree_paths();
+    test_alignment_gap();
+    test_tree_rebuild();
+    test_random_workload();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,198 @@
+#define EM_SAMPLE
+#define EM_HANDLES
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE   (1 << 16)
+#define SAMPLE_SLOTS (128)
+#define TEXT_SIZE    (8192)
+
+static uint8_t arena_memory[ARENA_SIZE];
+static EMSample samples[SAMPLE_SLOTS];
+
+typedef struct {
+    char text[TEXT_SIZE];
+    size_t length;
+    size_t chunks;
+} TextSink;
+
+static void text_writer(const void *data, size_t size, void *context) {
+    TextSink *sink = (TextSink *)context;
+    if (sink->length + size < TEXT_SIZE) {
+        memcpy(sink->text + sink->length, data, size);
+        sink->length += size;
+        sink->text[sink->length] = '\0';
+    }
+    sink->chunks++;
+}
+
+// Deterministic "backtrace": leaf 0x30, caller 0x20, root 0x10
+static size_t fake_backtrace(void **frames, size_t max_frames) {
+    static const uintptr_t stack[3] = { 0x30, 0x20, 0x10 };
+    size_t depth = max_frames < 3 ? max_frames : 3;
+    for (size_t i = 0; i < depth; i++) frames[i] = (void *)stack[i];
+    return depth;
+}
+
+static void test_every_allocation(void) {
+    TEST_CASE("Rate 0 samples every allocation until it is freed");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    ASSERT(em_sample_start(samples, SAMPLE_SLOTS, 0, fake_backtrace), "Sampler starts");
+
+    void *a = em_alloc(em, 100);
+    void *b = em_alloc_aligned(em, 64, 256);
+    void *c = em_calloc(em, 4, 10);
+    void *s = em_alloc_scratch(em, 32);
+    ASSERT(a && b && c && s, "Allocations succeed");
+    ASSERT(em_sample_count() == 4, "Each allocation is sampled");
+
+    em_free(b);
+    ASSERT(em_sample_count() == 3, "Freeing an aligned block releases its sample");
+    em_free(s);
+    em_free(a);
+    ASSERT(em_sample_count() == 1, "Freeing plain and scratch blocks releases their samples");
+
+    void *d = em_alloc(em, 100);
+    ASSERT(d != NULL && em_sample_count() == 2, "A reused block is sampled again");
+
+    em_reset(em);
+    ASSERT(em_sample_count() == 0, "em_reset drops every sample in the arena");
+
+    void *e = em_alloc(em, 48);
+    em_sample_stop();
+    ASSERT(em_sample_count() == 0, "Stopping detaches the table");
+    em_free(e);
+    ASSERT(em_alloc(em, 48) != NULL, "Blocks sampled before the stop are freed normally");
+}
+
+static void test_sub_allocators(void) {
+    TEST_CASE("Bump and slab allocations are sampled by address");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    Bump *bump = em_bump_create(em, 1024);
+    Slab *slab = em_slab_create(em, 1024, 32);
+    ASSERT(bump && slab, "Sub-allocators are created without being sampled");
+
+    em_sample_start(samples, SAMPLE_SLOTS, 0, NULL);
+    void *x = em_bump_alloc(bump, 40);
+    void *y = em_bump_alloc_aligned(bump, 40, 64);
+    void *p = em_slab_alloc(slab);
+    void *q = em_slab_alloc(slab);
+    ASSERT(x && y && p && q && em_sample_count() == 4, "Bump and slab allocations are sampled");
+
+    em_slab_free(slab, p);
+    ASSERT(em_sample_count() == 3, "em_slab_free releases the sample");
+
+    em_bump_reset(bump);
+    ASSERT(em_sample_count() == 1, "em_bump_reset drops the bump samples");
+
+    em_slab_destroy(slab);
+    ASSERT(em_sample_count() == 0, "em_slab_destroy drops the slab samples");
+
+    em_bump_destroy(bump);
+    em_sample_stop();
+}
+
+static bool sample_at(const void *pointer) {
+    for (size_t i = 0; i < SAMPLE_SLOTS; i++) {
+        if (samples[i].pointer == pointer) return true;
+    }
+    return false;
+}
+
+static void test_handles(void) {
+    TEST_CASE("Handle blocks are sampled and their samples follow compaction");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    ASSERT(em_handles_create(em, 8, NULL, NULL), "Handle table is created without being sampled");
+
+    em_sample_start(samples, SAMPLE_SLOTS, 0, NULL);
+    EMHandle a = em_halloc(em, 64);
+    EMHandle b = em_halloc(em, 64);
+    EMHandle c = em_halloc(em, 64);
+    ASSERT(a && b && c && em_sample_count() == 3, "em_halloc is sampled");
+
+    em_hfree(em, a);
+    ASSERT(em_sample_count() == 2 && sample_at(em_hget(em, b)), "em_hfree releases the sample");
+
+    void *before = em_hget(em, b);
+    ASSERT(em_compact(em, SIZE_MAX) > 0 && em_hget(em, b) != before, "Compaction moves the surviving blocks");
+    ASSERT(em_sample_count() == 2 && sample_at(em_hget(em, b)) && sample_at(em_hget(em, c)),
+           "The samples are re-keyed to the new addresses");
+
+    em_handles_destroy(em);
+    ASSERT(em_sample_count() == 0, "em_handles_destroy drops the samples of its blocks");
+    em_sample_stop();
+}
+
+static void test_rate_and_capacity(void) {
+    TEST_CASE("A rate thins out samples and a full table drops them");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    em_sample_start(samples, SAMPLE_SLOTS, 4096, NULL);
+
+    size_t allocated = 0;
+    for (int i = 0; i < 400; i++) {
+        if (em_alloc(em, 64) != NULL) allocated += 64;
+    }
+    size_t count = em_sample_count();
+    ASSERT(count > 0, "Some allocations are sampled");
+    ASSERT(count <= allocated / (4096 / 2) + 1, "No more than one sample per half interval");
+
+    em_reset(em);
+    em_sample_start(samples, 4, 0, NULL);
+    for (int i = 0; i < 8; i++) {
+        ASSERT_QUIET(em_alloc(em, 16) != NULL, "Allocation succeeds with a full table");
+    }
+    ASSERT(em_sample_count() == 3, "One slot stays empty, further samples are dropped");
+    em_sample_stop();
+}
+
+static void test_export(void) {
+    TEST_CASE("Live samples export as folded stacks and a pprof heap profile");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    em_sample_start(samples, SAMPLE_SLOTS, 0, fake_backtrace);
+    void *a = em_alloc(em, 100);
+    void *b = em_alloc(em, 28);
+    ASSERT(a && b, "Allocations succeed");
+
+    TextSink folded;
+    memset(&folded, 0, sizeof(folded));
+    ASSERT(em_sample_write(EM_SAMPLE_FOLDED, text_writer, &folded) == 2, "Two samples are written");
+    ASSERT(strstr(folded.text, "0x10;0x20;0x30 100\n") != NULL, "Folded stacks run root to leaf with the size");
+    ASSERT(strstr(folded.text, "0x10;0x20;0x30 28\n") != NULL, "Every live sample gets a line");
+
+    TextSink pprof;
+    memset(&pprof, 0, sizeof(pprof));
+    em_sample_write(EM_SAMPLE_PPROF, text_writer, &pprof);
+    ASSERT(strncmp(pprof.text, "heap profile: 2: 128 [2: 128] @ heap_v2/1\n", 42) == 0, "pprof header carries totals and rate");
+    ASSERT(strstr(pprof.text, "1: 100 [1: 100] @ 0x30 0x20 0x10\n") != NULL, "pprof lines list the leaf first");
+
+    em_sample_start(samples, SAMPLE_SLOTS, 0, NULL);
+    for (int i = 0; i < 80; i++) {
+        ASSERT_QUIET(em_alloc(em, 200) != NULL, "Allocation succeeds");
+    }
+    TextSink unknown;
+    memset(&unknown, 0, sizeof(unknown));
+    ASSERT(em_sample_write(EM_SAMPLE_FOLDED, text_writer, &unknown) == 80, "All samples are written");
+    ASSERT(unknown.chunks > 1, "Long profiles are flushed in several chunks");
+    ASSERT(strncmp(unknown.text, "[unknown] 200\n", 14) == 0, "Samples without frames fold into [unknown]");
+    em_sample_stop();
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_every_allocation();
+    test_sub_allocators();
+    test_handles();
+    test_rate_and_capacity();
+    test_export();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
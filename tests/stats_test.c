@@ -0,0 +1,215 @@
+#define EM_STATS
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE   (1 << 16)
+#define MAX_POINTERS (256)
+#define ITERATIONS   (4000)
+
+static uint8_t arena_memory[ARENA_SIZE];
+
+/*
+ * Reference values recomputed by walking the physical block chain.
+*/
+typedef struct {
+    size_t used_bytes;
+    size_t live_blocks;
+    size_t free_tree_bytes;
+    size_t free_tree_blocks;
+    size_t largest_free_block;
+} WalkStats;
+
+static WalkStats walk_arena(EM *em) {
+    WalkStats walk;
+    memset(&walk, 0, sizeof(walk));
+
+    Block *tail = em_get_tail(em);
+    Block *block = em_get_first_block(em);
+    while (block != NULL) {
+        if (!get_is_free(block)) {
+            walk.used_bytes += get_size(block);
+            walk.live_blocks++;
+        }
+        else if (block != tail) {
+            walk.free_tree_bytes += get_size(block);
+            walk.free_tree_blocks++;
+            if (get_size(block) > walk.largest_free_block) walk.largest_free_block = get_size(block);
+        }
+        if (block == tail) break;
+        block = next_block(em, block);
+    }
+
+    if (free_size_in_tail(em) > walk.largest_free_block) walk.largest_free_block = free_size_in_tail(em);
+    return walk;
+}
+
+static bool stats_match_walk(EM *em) {
+    EMStats stats = em_get_stats(em);
+    WalkStats walk = walk_arena(em);
+    return stats.used_bytes == walk.used_bytes &&
+           stats.live_blocks == walk.live_blocks &&
+           stats.free_tree_bytes == walk.free_tree_bytes &&
+           stats.free_tree_blocks == walk.free_tree_blocks &&
+           stats.largest_free_block == walk.largest_free_block &&
+           stats.free_tail_bytes == free_size_in_tail(em) &&
+           stats.peak_used_bytes >= stats.used_bytes;
+}
+
+static void test_fresh_arena(void) {
+    TEST_CASE("Counters of a fresh arena");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    ASSERT(em != NULL, "Arena creation should succeed");
+
+    EMStats stats = em_get_stats(em);
+    ASSERT(stats.capacity == em_get_capacity(em), "Capacity is reported");
+    ASSERT(stats.used_bytes == 0 && stats.live_blocks == 0 && stats.peak_used_bytes == 0, "Nothing is in use");
+    ASSERT(stats.free_tree_bytes == 0 && stats.free_tree_blocks == 0, "Free tree is empty");
+    ASSERT(stats.free_tail_bytes == free_size_in_tail(em), "Tail space is reported");
+    ASSERT(stats.largest_free_block == stats.free_tail_bytes, "Largest free region is the tail");
+    ASSERT(stats.scratch_bytes == 0, "No scratch");
+}
+
+static void test_alloc_free_merge(void) {
+    TEST_CASE("Allocation, free and coalescing");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *a = em_alloc(em, 100);
+    void *b = em_alloc(em, 200);
+    void *c = em_alloc(em, 300);
+    void *d = em_alloc(em, 40);
+
+    EMStats stats = em_get_stats(em);
+    ASSERT(stats.live_blocks == 4, "Four live blocks");
+    ASSERT(stats.used_bytes >= 640, "Used bytes cover the requests");
+    ASSERT(stats_match_walk(em), "Counters match the physical walk after allocation");
+
+    size_t peak = stats.used_bytes;
+    em_free(b);
+    stats = em_get_stats(em);
+    ASSERT(stats.free_tree_blocks == 1 && stats.live_blocks == 3, "Freed block enters the tree");
+    ASSERT(stats.peak_used_bytes == peak, "Peak is kept after free");
+
+    em_free(c);
+    stats = em_get_stats(em);
+    ASSERT(stats.free_tree_blocks == 1, "Adjacent free blocks are merged into one");
+    ASSERT(stats.largest_free_block >= 500, "Largest free region covers the merged block");
+    ASSERT(stats_match_walk(em), "Counters match the physical walk after merge");
+
+    void *e = em_alloc(em, 64);
+    ASSERT(e != NULL && stats_match_walk(em), "Split of a reused block is accounted for");
+
+    em_free(d);
+    ASSERT(stats_match_walk(em), "Freeing the block before the tail shrinks it back");
+
+    em_free(a);
+    em_free(e);
+    stats = em_get_stats(em);
+    ASSERT(stats.used_bytes == 0 && stats.live_blocks == 0, "Everything is released");
+    ASSERT(stats.free_tree_blocks == 0, "All space returned to the tail");
+    ASSERT(stats.peak_used_bytes == peak, "Peak survives full release");
+
+    em_reset(em);
+    stats = em_get_stats(em);
+    ASSERT(stats.used_bytes == 0 && stats.peak_used_bytes == peak, "Reset clears usage but keeps the peak");
+}
+
+static void test_scratch_and_sub_allocators(void) {
+    TEST_CASE("Scratch, nested arenas and sub-allocators");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *scratch = em_alloc_scratch(em, 500);
+    EMStats stats = em_get_stats(em);
+    ASSERT(scratch != NULL && stats.live_blocks == 0, "Scratch is not a live block");
+    ASSERT(stats.scratch_bytes >= 500 + sizeof(Block), "Scratch footprint is reported");
+    ASSERT(stats.free_tail_bytes + stats.scratch_bytes <= stats.capacity, "Scratch is taken from the tail");
+
+    em_free(scratch);
+    ASSERT(em_get_stats(em).scratch_bytes == 0, "Freed scratch is no longer reported");
+
+    EM *nested = em_create_nested(em, 4096);
+    void *inner = em_alloc(nested, 128);
+    stats = em_get_stats(em);
+    ASSERT(stats.live_blocks == 1, "A nested arena is one block of its parent");
+    ASSERT(em_get_stats(nested).live_blocks == 1, "Nested arena keeps its own counters");
+    ASSERT(inner != NULL && stats_match_walk(nested), "Nested counters match its walk");
+
+    Bump *bump = em_bump_create(em, 2048);
+    void *item = em_bump_alloc(bump, 100);
+    size_t before = em_get_stats(em).used_bytes;
+    em_bump_trim(bump);
+    stats = em_get_stats(em);
+    ASSERT(item != NULL && stats.used_bytes < before, "Trimming a bump returns bytes to the parent");
+    ASSERT(stats_match_walk(em), "Counters match the walk after trim");
+
+    Slab *slab = em_slab_create(em, 1024, 32);
+    Stack *stack = em_stack_create(em, 1024);
+    ASSERT(em_get_stats(em).live_blocks == 4, "Each sub-allocator is one live block");
+
+    em_stack_destroy(stack);
+    em_slab_destroy(slab);
+    em_bump_destroy(bump);
+    em_destroy(nested);
+    stats = em_get_stats(em);
+    ASSERT(stats.live_blocks == 0 && stats.used_bytes == 0, "Destroying children releases them");
+    ASSERT(stats_match_walk(em), "Counters match the walk after destruction");
+}
+
+static void test_random_workload(void) {
+    TEST_CASE("Random workload against the physical walk");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *pointers[MAX_POINTERS] = { NULL };
+    size_t alignments[] = { 16, 32, 64, 128, 256 };
+    unsigned seed = 12345;
+    bool consistent = true;
+    bool scratch_live = false;
+    void *scratch = NULL;
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        seed = seed * 1103515245u + 12345u;
+        size_t slot = (seed >> 8) % MAX_POINTERS;
+        size_t size = 1 + (seed >> 4) % 700;
+
+        if (pointers[slot] != NULL) {
+            em_free(pointers[slot]);
+            pointers[slot] = NULL;
+        }
+        else if ((seed & 7) == 0) {
+            pointers[slot] = em_alloc_aligned(em, size, alignments[(seed >> 20) % 5]);
+        }
+        else {
+            pointers[slot] = em_alloc(em, size);
+        }
+
+        if ((seed & 0x3F0) == 0x100) {
+            if (scratch_live) em_free(scratch);
+            else scratch = em_alloc_scratch(em, 256);
+            scratch_live = !scratch_live && scratch != NULL;
+        }
+
+        if (!stats_match_walk(em)) consistent = false;
+    }
+
+    ASSERT(consistent, "Counters match the walk after every operation");
+    EMStats stats = em_get_stats(em);
+    ASSERT(stats.largest_free_block >= stats.free_tail_bytes, "Largest free region is at least the tail");
+
+    em_reset_zero(em);
+    stats = em_get_stats(em);
+    ASSERT(stats.used_bytes == 0 && stats.free_tree_blocks == 0 && stats.scratch_bytes == 0, "Reset clears all counters");
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_fresh_arena();
+    test_alloc_free_merge();
+    test_scratch_and_sub_allocators();
+    test_random_workload();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
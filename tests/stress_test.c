@@ -6,6 +6,18 @@
 #define MAX_OBJECTS 300
 #define EM_SIZE (10 * 1024)
 
+/*
+ * Root of the free tree; with EM_FREE_TLSF, the first listed block of an arena that keeps
+ * the segregated lists in place of the tree
+ */
+static Block *first_free_block(EM *em) {
+    #ifdef EM_FREE_TLSF
+    EMTlsf *tlsf = em_get_extension(em)->tlsf;
+    if (tlsf != NULL) return em_tlsf_find(tlsf, 0);
+    #endif
+    return em_get_free_blocks(em);
+}
+
 /*
  * Test complex allocation pattern
  * Imitates a real scenario of dynamic object graph management
@@ -332,8 +344,8 @@ static void test_block_merging(void) {
     #endif // DEBUG
 
     // Verify that a new free block was created
-    ASSERT(em_get_free_blocks(em) != NULL, "Should have a free block from remaining space");
-    ASSERT(get_size(em_get_free_blocks(em)) == EM_MIN_BUFFER_SIZE, "Free block should have exactly MIN_BUFFER_SIZE");
+    ASSERT(first_free_block(em) != NULL, "Should have a free block from remaining space");
+    ASSERT(get_size(first_free_block(em)) == EM_MIN_BUFFER_SIZE, "Free block should have exactly MIN_BUFFER_SIZE");
 
     // Free the smaller block
     em_free(smaller_block);
@@ -348,7 +360,7 @@ static void test_block_merging(void) {
     print_fancy(em, 100);
     #endif // DEBUG
 
-    ASSERT(em_get_free_blocks(em) == NULL, "Should not have any free blocks after allocation");
+    ASSERT(first_free_block(em) == NULL, "Should not have any free blocks after allocation");
     
     em_reset(em);
     
@@ -392,7 +404,7 @@ static void test_block_merging(void) {
     
     ASSERT(get_size(first_block_) > size_before_merge, "First block size should increase after two-sided merge");
     ASSERT(get_size(first_block_) == (3 * size_before_merge + 2 * sizeof(Block)), "First block size should equal combined size of three blocks plus metadata");
-    ASSERT(get_size(em_get_free_blocks(em)) == get_size(first_block_), "Free blocks should point to the merged block");
+    ASSERT(get_size(first_free_block(em)) == get_size(first_block_), "Free blocks should point to the merged block");
 
     em_destroy(em);
 }
@@ -426,8 +438,8 @@ static void test_llrb_detach_scenarios(void) {
     #ifdef DEBUG
     print_fancy(em_root, 100);
     #endif // DEBUG
-    ASSERT(em_get_free_blocks(em_root) != NULL, "[Detach Root] Free list should contain block A");
-    ASSERT(get_size(em_get_free_blocks(em_root)) == 112, "[Detach Root] Root of free list should be block A");
+    ASSERT(first_free_block(em_root) != NULL, "[Detach Root] Free list should contain block A");
+    ASSERT(get_size(first_free_block(em_root)) == 112, "[Detach Root] Root of free list should be block A");
 
     // Allocate the same size again (100). This should find block A and detach it.
     void *ptr_c_root = em_alloc(em_root, 100);
@@ -438,7 +450,7 @@ static void test_llrb_detach_scenarios(void) {
     ASSERT(ptr_c_root == ptr_a_root, "[Detach Root] Reused block should be the same memory as A");
 
     // The free tree should now be empty
-    ASSERT(em_get_free_blocks(em_root) == NULL, "[Detach Root] Free list should be empty after detaching root");
+    ASSERT(first_free_block(em_root) == NULL, "[Detach Root] Free list should be empty after detaching root");
 
     em_destroy(em_root);
 
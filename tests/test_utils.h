@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 
 /* 
@@ -13,6 +14,11 @@ static int tests_total = 0;
 static int tests_passed = 0;
 static int tests_failed = 0;
 
+/*
+ * State of the random generator of randomized tests (see test_random)
+*/
+static uint32_t test_rng_state = 0x2545F491u;
+
 /* 
  * Colors for output
 */
@@ -30,6 +36,13 @@ bool pointers_overlap(void *p1, size_t size1, void *p2, size_t size2);
 void check_pointers_integrity(void **pointers, size_t *sizes, int count);
 void fill_memory_pattern(void *ptr, size_t size, int pattern);
 bool verify_memory_pattern(void *ptr, size_t size, int pattern);
+void seed_test_random(uint32_t seed);
+uint32_t test_random(void);
+
+/*
+ * Block header of an allocation made without alignment padding
+*/
+#define block_from_data(data) ((Block *)(void *)((uintptr_t)(data) - sizeof(Block)))
 
 /* 
  * Macro for checking a condition (full output)
@@ -162,4 +175,21 @@ bool verify_memory_pattern(void *ptr, size_t size, int pattern) {
     return true;
 }
 
+/*
+ * Restarting the random sequence; each randomized test file picks its own seed
+*/
+void seed_test_random(uint32_t seed) {
+    test_rng_state = seed;
+}
+
+/*
+ * Xorshift32: a fixed, platform-independent sequence, so a failing run replays exactly
+*/
+uint32_t test_random(void) {
+    test_rng_state ^= test_rng_state << 13;
+    test_rng_state ^= test_rng_state >> 17;
+    test_rng_state ^= test_rng_state << 5;
+    return test_rng_state;
+}
+
 #endif // TEST_UTILS_H 
\ No newline at end of file
@@ -0,0 +1,176 @@
+#ifndef EM_FREE_TLSF  // `make tests_tlsf` passes it on the command line
+#define EM_FREE_TLSF
+#endif
+#define EM_VERIFY
+#define EM_STATS
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE  (1 << 17)
+#define MAX_LIVE    (256)
+#define ITERATIONS  (20000)
+
+static uint8_t arena_memory[ARENA_SIZE];
+
+static EMTlsf *lists_of(EM *em) {
+    return em_get_extension(em)->tlsf;
+}
+
+static void test_class_mapping(void) {
+    TEST_CASE("Classes are ordered and a found class always fits");
+
+    bool ordered = true;
+    bool fits = true;
+    size_t last_fl = 0, last_sl = 0;
+    for (size_t size = sizeof(uintptr_t); size < ((size_t)1 << 20); size += sizeof(uintptr_t)) {
+        size_t fl, sl;
+        em_tlsf_mapping(size, &fl, &sl);
+        if (fl < last_fl || (fl == last_fl && sl < last_sl)) ordered = false;
+        last_fl = fl;
+        last_sl = sl;
+
+        // Smallest size that em_tlsf_find sends to this class: every block of the class holds it
+        size_t lower = (fl == 0) ? sl << EM_TLSF_WORD_LOG2
+                                 : ((size_t)(EM_TLSF_SL_COUNT + sl) << (fl + EM_TLSF_FL_SHIFT - 1 - EM_TLSF_SL_LOG2));
+        if (lower > size) fits = false;
+    }
+    ASSERT(ordered, "Class indices grow with the size");
+    ASSERT(fits, "Every size is at least the lower bound of its class");
+}
+
+static void test_good_fit(void) {
+    TEST_CASE("Allocations take a block from the first class that fits");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *live[MAX_LIVE];
+    for (size_t i = 0; i < MAX_LIVE; i++) live[i] = em_alloc(em, 16 + (i * 37) % 900);
+    for (size_t i = 0; i < MAX_LIVE; i += 2) em_free(live[i]);
+    ASSERT(em_get_stats(em).free_tree_blocks == MAX_LIVE / 2 && em_get_free_blocks(em) == NULL, "Every hole is in the lists, none in a tree");
+    ASSERT(em_verify(em).reason == NULL, "The lists verify");
+
+    bool fitting = true;
+    bool from_holes = true;
+    for (size_t i = 0; i < 64; i++) {
+        size_t size = 16 + test_random() % 600;
+        void *p = em_alloc_aligned(em, size, sizeof(uintptr_t));
+        Block *block = block_from_data(p);
+        if (p == NULL || get_size(block) < size) fitting = false;
+        if ((uintptr_t)block >= (uintptr_t)em_get_tail(em)) from_holes = false;
+    }
+    ASSERT(fitting, "Every block holds its request");
+    ASSERT(from_holes, "Requests are served from the holes");
+    ASSERT(em_verify(em).reason == NULL, "Splits put their remainders back into the lists");
+    em_destroy(em);
+}
+
+static void test_aligned_over_request(void) {
+    TEST_CASE("Aligned requests over-request and split");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *live[64];
+    for (size_t i = 0; i < 64; i++) live[i] = em_alloc(em, 400);
+    for (size_t i = 0; i < 64; i += 2) em_free(live[i]);
+
+    bool aligned = true;
+    void *taken[16];
+    for (size_t i = 0; i < 16; i++) {
+        size_t alignment = (size_t)32 << (i % 4);
+        taken[i] = em_alloc_aligned(em, 100, alignment);
+        if (taken[i] == NULL || ((uintptr_t)taken[i] & (alignment - 1)) != 0) aligned = false;
+        if (taken[i] != NULL && (uintptr_t)block_from_data(taken[i]) >= (uintptr_t)em_get_tail(em)) aligned = false;
+    }
+    ASSERT(aligned, "Holes serve aligned requests at their alignment");
+    ASSERT(em_verify(em).reason == NULL, "Alignment gaps are recycled into the lists");
+
+    for (size_t i = 0; i < 16; i++) em_free(taken[i]);
+    for (size_t i = 1; i < 64; i += 2) em_free(live[i]);
+    ASSERT(em_get_stats(em).free_tree_blocks == 0 && lists_of(em)->fl_bitmap == 0, "Everything merged back into the tail");
+    em_destroy(em);
+}
+
+static void test_randomized(void) {
+    TEST_CASE("Random workload keeps the lists and bitmaps consistent");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *live[MAX_LIVE] = { 0 };
+    size_t failures = 0;
+
+    for (size_t i = 0; i < ITERATIONS; i++) {
+        size_t slot = test_random() % MAX_LIVE;
+        if (live[slot] != NULL) {
+            em_free(live[slot]);
+            live[slot] = NULL;
+        }
+
+        uint32_t op = test_random() % 8;
+        if (op < 4) live[slot] = em_alloc(em, 1 + test_random() % 1200);
+        else if (op < 6) live[slot] = em_alloc_aligned(em, 1 + test_random() % 300, (size_t)16 << (test_random() % 5));
+
+        if (i % 97 == 0 && em_verify(em).reason != NULL) failures++;
+    }
+    ASSERT(failures == 0, "The arena verified clean throughout");
+    ASSERT(em_get_stats(em).largest_free_block >= free_size_in_tail(em), "The largest free block is reported");
+
+    for (size_t i = 0; i < MAX_LIVE; i++) {
+        if (live[i] != NULL) em_free(live[i]);
+    }
+    ASSERT(lists_of(em)->fl_bitmap == 0 && em_verify(em).reason == NULL, "Everything merged back into the tail");
+
+    em_reset(em);
+    ASSERT(lists_of(em)->fl_bitmap == 0 && lists_of(em)->heads[0][0] == NULL, "A reset empties the lists");
+    em_destroy(em);
+}
+
+static void test_size_limit(void) {
+    TEST_CASE("Arenas beyond the largest class are refused");
+
+#if EM_SAFETY_POLICY == EM_POLICY_DEFENSIVE
+    ASSERT(em_create_static(arena_memory, EM_TLSF_MAX_SIZE + 1) == NULL, "An arena past EM_TLSF_MAX_SIZE is refused");
+#endif
+}
+
+static void test_small_arenas(void) {
+    TEST_CASE("Nested, scratch and small arenas keep the free tree");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    ASSERT(lists_of(em) != NULL && (uintptr_t)em_get_first_block(em) >= (uintptr_t)em + EM_HEADER_SIZE + sizeof(EMTlsf), "A large root arena keeps the lists after its header");
+
+    EM *nested = em_create_nested(em, 1024);
+    EM *scratch = em_create_scratch(em, 512);
+    ASSERT(nested != NULL && scratch != NULL, "1 KiB nested and 512 byte scratch arenas are created");
+    ASSERT(lists_of(nested) == NULL && lists_of(scratch) == NULL, "Neither keeps class lists");
+
+    void *a = em_alloc(nested, 128);
+    void *b = em_alloc(nested, 128);
+    void *c = em_alloc(nested, 128);
+    em_free(b);
+    ASSERT(a != NULL && c != NULL && em_get_free_blocks(nested) != NULL, "Freed blocks of a nested arena enter its free tree");
+    ASSERT(em_alloc(nested, 100) == b && em_verify(nested).reason == NULL, "The nested arena reuses the hole and verifies");
+
+    void *d = em_alloc(scratch, 64);
+    ASSERT(d != NULL && em_verify(scratch).reason == NULL, "The scratch arena allocates and verifies");
+    em_destroy(scratch);
+    em_destroy(nested);
+    ASSERT(em_verify(em).reason == NULL, "The root arena verifies after both are gone");
+    em_destroy(em);
+
+    EM *small = em_create(EM_TLSF_MIN_ARENA / 2);
+    ASSERT(small != NULL && lists_of(small) == NULL && em_verify(small).reason == NULL, "A small root arena keeps the free tree");
+    em_destroy(small);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_class_mapping();
+    test_good_fit();
+    test_aligned_over_request();
+    test_randomized();
+    test_size_limit();
+    test_small_arenas();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,277 @@
+#define EM_TRACE
+#define EM_HANDLES
+#define EM_LIFETIME
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "test_utils.h"
+
+/*
+ * In-memory trace sink and a reference decoder for the format described
+ * in easy_memory.h (ALLOCATION TRACE FORMAT).
+*/
+#define TRACE_CAPACITY (1 << 16)
+#define MAX_EVENTS     (512)
+
+typedef struct {
+    uint8_t data[TRACE_CAPACITY];
+    size_t length;
+} TraceBuffer;
+
+typedef struct {
+    size_t op;
+    uintptr_t object;
+    uintptr_t result;
+    size_t size;
+    size_t extra;
+} TraceEvent;
+
+static TraceBuffer trace_buffer;
+static TraceEvent events[MAX_EVENTS];
+static size_t event_count;
+
+static uint8_t arena_memory[1 << 15];
+
+static void buffer_writer(const void *data, size_t size, void *context) {
+    TraceBuffer *buffer = (TraceBuffer *)context;
+    if (buffer->length + size > TRACE_CAPACITY) return;
+    memcpy(buffer->data + buffer->length, data, size);
+    buffer->length += size;
+}
+
+static bool read_varint(size_t *cursor, uintptr_t *value) {
+    uintptr_t result = 0;
+    unsigned shift = 0;
+    while (*cursor < trace_buffer.length) {
+        uint8_t byte = trace_buffer.data[(*cursor)++];
+        result |= (uintptr_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return true;
+        }
+        shift += 7;
+    }
+    return false;
+}
+
+static bool read_address(size_t *cursor, uintptr_t *last, uintptr_t *address) {
+    uintptr_t encoded;
+    if (!read_varint(cursor, &encoded)) return false;
+    if (encoded == 0) {
+        *address = 0;
+        return true;
+    }
+    encoded -= 1;
+    uintptr_t delta = (encoded >> 1) ^ ((uintptr_t)0 - (encoded & 1));
+    *last += delta;
+    *address = *last;
+    return true;
+}
+
+static bool decode_trace(void) {
+    event_count = 0;
+    if (trace_buffer.length < 6 || memcmp(trace_buffer.data, "EMTR", 4) != 0) return false;
+    if (trace_buffer.data[4] != EM_TRACE_VERSION || trace_buffer.data[5] != sizeof(uintptr_t)) return false;
+
+    uintptr_t last_handle = 0, last_pointer = 0;
+    size_t cursor = 6;
+    while (cursor < trace_buffer.length) {
+        if (event_count >= MAX_EVENTS) return false;
+        TraceEvent *event = &events[event_count++];
+        uintptr_t op, size, extra;
+        if (!read_varint(&cursor, &op)) return false;
+        if (op == 0 || op >= EM_TRACE_OP_COUNT) return false;
+        if (!read_address(&cursor, &last_handle, &event->object)) return false;
+        uintptr_t *result_last = EM_TRACE_RESULT_IS_HANDLE(op) ? &last_handle : &last_pointer;
+        if (!read_address(&cursor, result_last, &event->result)) return false;
+        if (!read_varint(&cursor, &size) || !read_varint(&cursor, &extra)) return false;
+        event->op = (size_t)op;
+        event->size = (size_t)size;
+        event->extra = (size_t)extra;
+    }
+    return true;
+}
+
+static void start_recording(void) {
+    trace_buffer.length = 0;
+    em_trace_set_writer(buffer_writer, &trace_buffer);
+}
+
+static bool event_is(size_t index, EMTraceOp op, const void *object, const void *result) {
+    if (index >= event_count) return false;
+    return events[index].op == (size_t)op &&
+           events[index].object == (uintptr_t)object &&
+           events[index].result == (uintptr_t)result;
+}
+
+static void test_header_and_disable(void) {
+    TEST_CASE("Stream header and disabling the writer");
+
+    start_recording();
+    ASSERT(decode_trace(), "Fresh stream carries a valid header");
+    ASSERT(event_count == 0, "Header alone contains no events");
+
+    em_trace_set_writer(NULL, NULL);
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    ASSERT(em != NULL, "Arena creation should succeed");
+    ASSERT(trace_buffer.length == 6, "Nothing is recorded without a writer");
+}
+
+static void test_core_events(void) {
+    TEST_CASE("Core API events are recorded once each");
+
+    start_recording();
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *a = em_alloc(em, 100);
+    void *b = em_alloc_aligned(em, 40, 64);
+    void *c = em_calloc(em, 4, 10);
+    void *s = em_alloc_scratch(em, 256);
+    void *huge = em_alloc(em, sizeof(arena_memory));
+    em_free(b);
+    em_free(s);
+    em_reset_zero(em);
+
+    ASSERT(decode_trace(), "Trace decodes cleanly");
+    ASSERT(event_count == 9, "Forwarding wrappers do not duplicate events");
+    ASSERT(event_is(0, EM_TRACE_CREATE_STATIC, NULL, em), "Static creation is recorded with the arena handle");
+    ASSERT(events[0].size == sizeof(arena_memory), "Creation records the requested size");
+    ASSERT(event_is(1, EM_TRACE_ALLOC, em, a) && events[1].size == 100, "em_alloc is recorded as one ALLOC");
+    ASSERT(events[1].extra == EM_DEFAULT_ALIGNMENT, "Default alignment is recorded");
+    ASSERT(event_is(2, EM_TRACE_ALLOC, em, b) && events[2].extra == 64, "Aligned allocation records its alignment");
+    ASSERT(event_is(3, EM_TRACE_CALLOC, em, c) && events[3].size == 4 && events[3].extra == 10,
+           "em_calloc records element count and size without an inner ALLOC");
+    ASSERT(event_is(4, EM_TRACE_ALLOC_SCRATCH, em, s), "Scratch allocation is recorded");
+    ASSERT(huge == NULL && event_is(5, EM_TRACE_ALLOC, em, NULL), "Failed allocation is recorded with a NULL result");
+    ASSERT(event_is(6, EM_TRACE_FREE, em, b), "Free records the owning arena and pointer");
+    ASSERT(event_is(7, EM_TRACE_FREE, em, s), "Freeing scratch goes through em_free");
+    ASSERT(event_is(8, EM_TRACE_RESET_ZERO, em, NULL), "em_reset_zero is recorded once, not as RESET");
+
+    em_trace_set_writer(NULL, NULL);
+}
+
+static void test_nested_and_sub_allocators(void) {
+    TEST_CASE("Nested arenas and sub-allocators");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    start_recording();
+
+    EM *nested = em_create_nested(em, 2048);
+    Bump *bump = em_bump_create(nested, 512);
+    void *b1 = em_bump_alloc(bump, 24);
+    em_bump_trim(bump);
+    Slab *slab = em_slab_create(em, 512, 32);
+    void *chunk = em_slab_alloc(slab);
+    em_slab_free(slab, chunk);
+    em_slab_reset_zero(slab);
+    Stack *stack = em_stack_create(em, 512);
+    StackMarker marker = em_stack_get_marker(stack);
+    void *frame = em_stack_alloc(stack, 48);
+    em_stack_free_to_marker(stack, marker);
+    em_stack_destroy(stack);
+    em_destroy(nested);
+
+    ASSERT(decode_trace(), "Trace decodes cleanly");
+    ASSERT(event_count == 13, "Every call produces exactly one event");
+    ASSERT(event_is(0, EM_TRACE_CREATE_NESTED, em, nested) && events[0].size == 2048, "Nested creation is recorded once");
+    ASSERT(event_is(1, EM_TRACE_BUMP_CREATE, nested, bump), "Bump creation records its parent");
+    ASSERT(event_is(2, EM_TRACE_BUMP_ALLOC, bump, b1) && events[2].size == 24, "Bump allocation is recorded once");
+    ASSERT(event_is(3, EM_TRACE_BUMP_TRIM, bump, NULL), "Bump trim is recorded");
+    ASSERT(event_is(4, EM_TRACE_SLAB_CREATE, em, slab) && events[4].extra == 32, "Slab creation records chunk size");
+    ASSERT(event_is(5, EM_TRACE_SLAB_ALLOC, slab, chunk), "Slab allocation is recorded");
+    ASSERT(event_is(6, EM_TRACE_SLAB_FREE, slab, chunk), "Slab free is recorded");
+    ASSERT(event_is(7, EM_TRACE_SLAB_RESET_ZERO, slab, NULL), "Slab zero reset is not recorded as plain reset");
+    ASSERT(event_is(8, EM_TRACE_STACK_CREATE, em, stack), "Stack creation is recorded");
+    ASSERT(event_is(9, EM_TRACE_STACK_ALLOC, stack, frame) && events[9].extra == EMMIN_ALIGNMENT,
+           "em_stack_alloc forwards to a single aligned event");
+    ASSERT(event_is(10, EM_TRACE_STACK_FREE_TO_MARKER, stack, NULL) && events[10].size == 0,
+           "Marker rollback records the target depth");
+    ASSERT(event_is(11, EM_TRACE_STACK_DESTROY, stack, NULL), "Stack destruction is recorded");
+    ASSERT(event_is(12, EM_TRACE_DESTROY, nested, NULL), "Nested destruction is recorded");
+
+    em_trace_set_writer(NULL, NULL);
+}
+
+static void test_handle_events(void) {
+    TEST_CASE("Handle entry points");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    start_recording();
+
+    em_handles_create(em, 4, NULL, NULL);
+    EMHandle a = em_halloc(em, 40);
+    EMHandle b = em_halloc(em, 24);
+    void *first = em_hget(em, a);
+    void *second = em_hget(em, b);
+    em_hfree(em, a);
+    size_t moved = em_compact(em, SIZE_MAX);
+    void *moved_to = em_hget(em, b);
+    em_hfree(em, b);
+    em_handles_destroy(em);
+
+    ASSERT(decode_trace(), "Trace decodes cleanly");
+    ASSERT(event_count == 7, "em_hget is not recorded, the table's own block is not an allocation");
+    ASSERT(event_is(0, EM_TRACE_HANDLES_CREATE, em, NULL) && events[0].size == 4, "Table creation records its capacity");
+    ASSERT(event_is(1, EM_TRACE_HALLOC, em, first) && events[1].size == 40 && events[1].extra == a,
+           "em_halloc records the block and its handle");
+    ASSERT(event_is(2, EM_TRACE_HALLOC, em, second) && events[2].extra == b, "Each handle gets its own event");
+    ASSERT(event_is(3, EM_TRACE_HFREE, em, first) && events[3].extra == a, "em_hfree records the handle it releases");
+    ASSERT(event_is(4, EM_TRACE_COMPACT, em, NULL) && events[4].size == SIZE_MAX && events[4].extra == moved && moved > 0,
+           "em_compact records its budget and the bytes it moved");
+    ASSERT(event_is(5, EM_TRACE_HFREE, em, moved_to) && events[5].extra == b, "A moved block is released at its new address");
+    ASSERT(event_is(6, EM_TRACE_HANDLES_DESTROY, em, NULL), "Table destruction is recorded");
+
+    em_trace_set_writer(NULL, NULL);
+}
+
+static void test_alloc_near_event(void) {
+    TEST_CASE("Locality hints");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *parent = em_alloc(em, 64);
+    start_recording();
+
+    void *child = em_alloc_near(em, 32, parent);
+    void *orphan = em_alloc_near(em, 32, NULL);
+
+    ASSERT(decode_trace(), "Trace decodes cleanly");
+    ASSERT(event_count == 2, "em_alloc_near is recorded once, not as ALLOC");
+    ASSERT(event_is(0, EM_TRACE_ALLOC_NEAR, em, child) && events[0].size == 32 &&
+           events[0].extra == (uintptr_t)parent - (uintptr_t)em + 1, "The hint is recorded as its offset in the arena");
+    ASSERT(event_is(1, EM_TRACE_ALLOC_NEAR, em, orphan) && events[1].extra == 0, "A NULL hint is recorded as 0");
+
+    em_trace_set_writer(NULL, NULL);
+}
+
+static void test_lifetime_events(void) {
+    TEST_CASE("Lifetime hints");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    start_recording();
+
+    void *temporary = em_alloc_ex(em, 48, 32, EM_LIFETIME_SHORT);
+    void *survivor = em_alloc_ex(em, 48, 32, EM_LIFETIME_LONG);
+    em_free(temporary);
+
+    ASSERT(decode_trace(), "Trace decodes cleanly");
+    ASSERT(event_count == 3, "Every call produces exactly one event");
+    ASSERT(event_is(0, EM_TRACE_ALLOC_SHORT, em, temporary) && events[0].size == 48 && events[0].extra == 32,
+           "A short-lived request is recorded with its own kind and alignment");
+    ASSERT(event_is(1, EM_TRACE_ALLOC, em, survivor) && events[1].extra == 32, "A long-lived request is a plain aligned ALLOC");
+    ASSERT(event_is(2, EM_TRACE_FREE, em, temporary), "Short-lived blocks are released through em_free");
+
+    em_trace_set_writer(NULL, NULL);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_header_and_disable();
+    test_core_events();
+    test_nested_and_sub_allocators();
+    test_handle_events();
+    test_alloc_near_event();
+    test_lifetime_events();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
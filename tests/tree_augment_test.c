@@ -0,0 +1,221 @@
+#ifndef EM_FREE_TLSF  // `make tests_tlsf` builds every test with EM_FREE_TLSF, which has no tree
+#define EM_FREE_TREE_AUGMENT
+#endif
+#define EM_VERIFY
+#define EM_PROFILE
+
+// Count the free tree nodes every search visits
+static unsigned long search_calls;
+static unsigned long search_visits;
+#define EM_COST_PROBE(site, value) \
+    do { if ((site) == 1) { search_calls++; search_visits += (unsigned long)(value); } } while (0)
+
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "test_utils.h"
+
+#ifdef EM_FREE_TREE_AUGMENT
+
+#define ARENA_SIZE   (1 << 18)
+#define MAX_LIVE     (512)
+#define ITERATIONS   (20000)
+#define VINE_LENGTH  (EM_MAX_TREE_HEIGHT + 1)
+
+static uint8_t arena_memory[ARENA_SIZE];
+static Block vine[VINE_LENGTH + 1];
+
+/*
+ * The search without bounds: the same descent, walked to the end
+*/
+static Block *plain_best_fit(Block *current, size_t size, size_t alignment) {
+    Block *best = NULL;
+    while (current != NULL) {
+        size_t current_size = get_size(current);
+        if (current_size < size) {
+            current = get_right_tree(current);
+            continue;
+        }
+        uintptr_t data_ptr = (uintptr_t)block_data(current);
+        size_t padding = align_up(data_ptr, alignment) - data_ptr;
+        if (current_size >= size + padding) {
+            if (best == NULL || current_size < get_size(best)) best = current;
+            current = get_left_tree(current);
+        } else {
+            current = get_right_tree(current);
+        }
+    }
+    return best;
+}
+
+/*
+ * Every node holds exactly the best quality of its subtree, as after an insert path or a rebuild
+*/
+static bool bounds_exact(Block *root) {
+    Block *stack[EM_MAX_TREE_HEIGHT + 2];
+    size_t depth = 0;
+    if (root != NULL) stack[depth++] = root;
+    while (depth > 0) {
+        Block *node = stack[--depth];
+        size_t expected = tree_quality_of(node);
+        if (get_tree_bound(get_left_tree(node)) > expected) expected = get_tree_bound(get_left_tree(node));
+        if (get_tree_bound(get_right_tree(node)) > expected) expected = get_tree_bound(get_right_tree(node));
+        if (get_tree_bound(node) != expected) return false;
+        if (get_right_tree(node) != NULL) stack[depth++] = get_right_tree(node);
+        if (get_left_tree(node) != NULL) stack[depth++] = get_left_tree(node);
+    }
+    return true;
+}
+
+static EM *fragmented_arena(void **live, size_t count) {
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    for (size_t i = 0; i < count; i++) live[i] = em_alloc(em, 16 + test_random() % 480);
+    for (size_t i = 0; i < count; i += 2) em_free(live[i]);
+    return em;
+}
+
+static void test_rejection(void) {
+    TEST_CASE("Requests larger than every free block skip the tree");
+
+    void *live[MAX_LIVE];
+    EM *em = fragmented_arena(live, MAX_LIVE);
+    ASSERT(em_get_extension(em)->free_tree_largest > 0 && em_verify(em).reason == NULL, "The cached largest block matches the tree");
+
+    search_calls = 0;
+    search_visits = 0;
+    size_t tree_hits = em_get_profile(em).tree_hits;
+    void *big = em_alloc(em, em_get_extension(em)->free_tree_largest + 1);
+    ASSERT(big != NULL && em_get_profile(em).tree_hits == tree_hits, "The request is served from the tail");
+    ASSERT(search_calls == 0 && search_visits == 0, "No tree node is visited");
+    em_free(big);
+
+    void *fits = em_alloc_aligned(em, em_get_extension(em)->free_tree_largest, sizeof(uintptr_t));
+    ASSERT(fits != NULL && em_get_profile(em).tree_hits == tree_hits + 1, "The largest block itself is still found");
+    ASSERT(em_verify(em).reason == NULL, "Taking the largest block refreshes the cache");
+
+    em_reset(em);
+    ASSERT(em_get_extension(em)->free_tree_largest == 0, "A reset empties the cache");
+    em_destroy(em);
+}
+
+static void test_same_result(void) {
+    TEST_CASE("Pruned searches return the block of the plain search");
+
+    void *live[MAX_LIVE];
+    EM *em = fragmented_arena(live, MAX_LIVE);
+    Block *root = em_get_free_blocks(em);
+
+    bool same = true;
+    unsigned long plain_visits = 0;
+    search_visits = 0;
+    for (size_t i = 0; i < 4000; i++) {
+        size_t size = align_up(8 + test_random() % 520, sizeof(uintptr_t));
+        size_t alignment = (size_t)EMMIN_ALIGNMENT << (test_random() % 9);
+        Block *parent = NULL;
+        Block *expected = plain_best_fit(root, size, alignment);
+        if (find_best_fit(root, size, alignment, &parent) != expected) same = false;
+
+        for (Block *node = root; node != NULL;) {
+            plain_visits++;
+            uintptr_t data_ptr = (uintptr_t)block_data(node);
+            size_t padding = align_up(data_ptr, alignment) - data_ptr;
+            node = (get_size(node) >= size + padding) ? get_left_tree(node) : get_right_tree(node);
+        }
+    }
+    ASSERT(same, "Every request gets the same block");
+    ASSERT(search_visits <= plain_visits, "The pruned searches visit no more nodes");
+    em_destroy(em);
+}
+
+static void test_randomized(void) {
+    TEST_CASE("Random workload keeps the bounds and the cache consistent");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *live[MAX_LIVE] = { 0 };
+    size_t failures = 0;
+
+    for (size_t i = 0; i < ITERATIONS; i++) {
+        size_t slot = test_random() % MAX_LIVE;
+        if (live[slot] != NULL) {
+            em_free(live[slot]);
+            live[slot] = NULL;
+        }
+
+        uint32_t op = test_random() % 8;
+        if (op < 4) live[slot] = em_alloc(em, 1 + test_random() % 600);
+        else if (op < 6) live[slot] = em_alloc_aligned(em, 1 + test_random() % 300, (size_t)16 << (test_random() % 6));
+
+        if (i % 97 == 0 && em_verify(em).reason != NULL) failures++;
+    }
+    ASSERT(failures == 0, "The arena verified clean throughout");
+
+    Block *root = em_get_free_blocks(em);
+    ASSERT(root == NULL || get_tree_bound(root) >= tree_quality_of(root), "The root bound covers the root");
+
+    for (size_t i = 0; i < MAX_LIVE; i++) {
+        if (live[i] != NULL) em_free(live[i]);
+    }
+    ASSERT(em_get_free_blocks(em) == NULL && em_get_extension(em)->free_tree_largest == 0, "Everything merged back into the tail");
+    em_destroy(em);
+}
+
+static void test_rebuild_bounds(void) {
+    TEST_CASE("A rebuilt tree gets exact bounds");
+
+    for (size_t i = 0; i <= VINE_LENGTH; i++) {
+        set_reserved_bits(&vine[i], 0);
+        set_size(&vine[i], (i + 1) * 16);
+        set_left_tree(&vine[i], NULL);
+        set_right_tree(&vine[i], (i + 1 < VINE_LENGTH) ? &vine[i + 1] : NULL);
+        set_color(&vine[i], EMBLACK);
+    }
+
+    EMProfile profile;
+    memset(&profile, 0, sizeof(profile));
+    Block *root = insert_block(&vine[0], &vine[VINE_LENGTH], &profile);
+    ASSERT(profile.tree_rebuilds == 1, "The overflowing insert triggers one rebuild");
+    ASSERT(bounds_exact(root), "Every node holds the best quality of its subtree");
+}
+
+static void test_verify_bounds(void) {
+    TEST_CASE("em_verify catches broken bounds and a stale cache");
+
+    void *live[64];
+    EM *em = fragmented_arena(live, 64);
+    Block *root = em_get_free_blocks(em);
+    ASSERT(root != NULL && em_verify(em).reason == NULL, "The arena starts clean");
+
+    size_t bound = get_tree_bound(root);
+    set_reserved_bits(root, 0);
+    EMVerifyReport report = em_verify(em);
+    ASSERT(report.block == root && report.reason != NULL, "A bound below the node's own quality is reported");
+    set_reserved_bits(root, bound);
+
+    size_t largest = em_get_extension(em)->free_tree_largest;
+    em_get_extension(em)->free_tree_largest = largest + sizeof(uintptr_t);
+    report = em_verify(em);
+    ASSERT(report.block == em && report.reason != NULL, "A stale largest block is reported");
+    em_get_extension(em)->free_tree_largest = largest;
+
+    ASSERT(em_verify(em).reason == NULL, "The repaired arena verifies");
+    em_destroy(em);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+    seed_test_random(0x68E31DA4u);
+
+    test_rejection();
+    test_same_result();
+    test_randomized();
+    test_rebuild_bounds();
+    test_verify_bounds();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
+#else
+int main(void) {
+    return 0;
+}
+#endif // EM_FREE_TREE_AUGMENT
@@ -0,0 +1,116 @@
+#define EM_USDT
+#define EM_TRACE
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (1 << 16)
+
+static uint8_t arena_memory[ARENA_SIZE];
+static size_t traced_events;
+
+static void count_writer(const void *data, size_t size, void *context) {
+    (void)data;
+    (void)size;
+    (void)context;
+    traced_events++;
+}
+
+static void test_operations_with_probes(void) {
+    TEST_CASE("Every entry point works with probes compiled in");
+
+    em_trace_set_writer(count_writer, NULL);  // Header event
+    traced_events = 0;
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *a = em_alloc_aligned(em, 100, 64);
+    void *s = em_alloc_scratch(em, 48);
+    ASSERT(em && a && s && ((uintptr_t)a % 64) == 0, "Arena, aligned and scratch allocations succeed");
+
+    Bump *bump = em_bump_create(em, 512);
+    Slab *slab = em_slab_create(em, 512, 32);
+    Stack *stack = em_stack_create(em, 512);
+    ASSERT(bump && slab && stack, "Sub-allocators are created");
+
+    void *b = em_bump_alloc(bump, 24);
+    void *c = em_slab_alloc(slab);
+    void *d = em_stack_alloc(stack, 40);
+    ASSERT(b && c && d, "Sub-allocators allocate");
+    em_slab_free(slab, c);
+    em_stack_free(stack, d);
+    em_bump_reset(bump);
+    em_slab_reset(slab);
+    em_stack_reset(stack);
+
+    em_free(s);
+    em_free(a);
+    em_bump_destroy(bump);
+    em_slab_destroy(slab);
+    em_stack_destroy(stack);
+    ASSERT(em_alloc(em, ARENA_SIZE / 2) != NULL, "Everything was released back to the arena");
+    em_reset(em);
+
+    em_trace_set_writer(NULL, NULL);
+    ASSERT(traced_events == 21, "Trace records are still emitted next to the probes");
+}
+
+/*
+ * The probe descriptors live in the executable: look for the provider and a few names
+ * as laid out in a .note.stapsdt entry ("easy_memory\0<name>\0").
+*/
+static bool executable_has_probe(const uint8_t *image, size_t length, const char *name) {
+    static const char provider[] = "easy_memory";
+    size_t name_length = strlen(name) + 1;
+    for (size_t i = 0; i + sizeof(provider) + name_length <= length; i++) {
+        if (memcmp(image + i, provider, sizeof(provider)) == 0 &&
+            memcmp(image + i + sizeof(provider), name, name_length) == 0) return true;
+    }
+    return false;
+}
+
+static void test_probe_descriptors(void) {
+    TEST_CASE("Probe descriptors are emitted into the executable");
+
+#if defined(EM_USDT_FIRE) && defined(__linux__)
+    FILE *file = fopen("/proc/self/exe", "rb");
+    ASSERT(file != NULL, "The executable can be read back");
+    if (!file) return;
+
+    size_t capacity = 1 << 20, length = 0;
+    uint8_t *image = (uint8_t *)malloc(capacity);
+    size_t got;
+    while (image && (got = fread(image + length, 1, capacity - length, file)) > 0) {
+        length += got;
+        if (length == capacity) {
+            uint8_t *grown = (uint8_t *)realloc(image, capacity * 2);
+            if (!grown) break;
+            image = grown;
+            capacity *= 2;
+        }
+    }
+    fclose(file);
+    ASSERT(image != NULL && length > 0, "The executable is loaded");
+    if (!image) return;
+
+    ASSERT(executable_has_probe(image, length, "alloc"), "easy_memory:alloc is present");
+    ASSERT(executable_has_probe(image, length, "free"), "easy_memory:free is present");
+    ASSERT(executable_has_probe(image, length, "create_static"), "easy_memory:create_static is present");
+    ASSERT(executable_has_probe(image, length, "slab_alloc"), "easy_memory:slab_alloc is present");
+    ASSERT(executable_has_probe(image, length, "stack_reset"), "easy_memory:stack_reset is present");
+    ASSERT(!executable_has_probe(image, length, "no_such_probe"), "Unknown names are not found");
+    free(image);
+#else
+    ASSERT(true, "No probe definition for this target, probes compile to nothing");
+#endif
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_operations_with_probes();
+    test_probe_descriptors();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
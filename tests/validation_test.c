@@ -136,7 +136,7 @@ static void test_boundary_conditions(void) {
 
 #if EM_SAFETY_POLICY == EM_POLICY_DEFENSIVE
     TEST_CASE("EM size just below minimum");
-    EM *below_min_em = em_create(min_size - 1 - sizeof(EM));
+    EM *below_min_em = em_create(min_size - 1 - EM_HEADER_SIZE);
     ASSERT(below_min_em == NULL, "EM with size below minimum should fail");
 #endif
 
@@ -611,7 +611,10 @@ static size_t count_blocks_in_em(EM *em) {
 
 
 static void test_alignment_alloc(void) {
-    void *buffer = get_exact_alignment_ptr(8);
+    // A header extension moves the first block: start the arena that much earlier (modulo the
+    // base alignment) so the first block lands where it does behind the bare header
+    size_t extension_size = EM_HEADER_SIZE - sizeof(EM);
+    void *buffer = get_exact_alignment_ptr(8 + (TEST_BASE_ALIGNMENT - extension_size % TEST_BASE_ALIGNMENT) % TEST_BASE_ALIGNMENT);
     size_t size = get_buffer_size(buffer);
 
     ASSERT(((uintptr_t)(buffer) % 8 == 0),   "Allocation should     be   8-byte aligned");
@@ -0,0 +1,245 @@
+#define EM_VERIFY
+#define EM_STATS
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE  (1 << 16)
+#define MAX_LIVE    (64)
+#define ITERATIONS  (4000)
+
+static uint8_t arena_memory[ARENA_SIZE];
+
+static void test_intact_arena(void) {
+    TEST_CASE("A fresh and a busy arena verify clean");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    EMVerifyReport report = em_verify(em);
+    ASSERT(report.block == NULL && report.reason == NULL, "Fresh arena is intact");
+    ASSERT(report.checked == 1 && report.passes == 1, "Only the tail is checked");
+
+    void *a = em_alloc(em, 100);
+    void *b = em_alloc_aligned(em, 40, 256);
+    void *c = em_alloc(em, 24);
+    void *s = em_alloc_scratch(em, 300);
+    em_free(a);
+    report = em_verify(em);
+    ASSERT(report.reason == NULL, "Free tree, aligned and scratch blocks verify");
+    size_t chain = 1;
+    for (Block *block = em_get_first_block(em); block != em_get_tail(em); block = next_block_unsafe(block)) chain++;
+    ASSERT(report.checked == chain && chain >= 4, "Every block of the chain is checked");
+
+    em_free(b);
+    em_free(c);
+    em_free(s);
+    report = em_verify(em);
+    ASSERT(report.reason == NULL && report.checked == 1, "Everything merged back into the tail");
+    em_destroy(em);
+}
+
+static void test_step_budget(void) {
+    TEST_CASE("em_verify_step resumes from its cursor");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *blocks[6];
+    for (size_t i = 0; i < 6; i++) blocks[i] = em_alloc(em, 32 + i * 8);
+
+    EMVerifyReport report = em_verify_step(em, 3);
+    ASSERT(report.reason == NULL && report.checked == 3 && report.passes == 0, "First step stops at its budget");
+    report = em_verify_step(em, 3);
+    ASSERT(report.checked == 3 && report.passes == 0, "Second step continues");
+    report = em_verify_step(em, 3);
+    ASSERT(report.checked == 1 && report.passes == 1, "Third step reaches the tail");
+    report = em_verify_step(em, 100);
+    ASSERT(report.checked == 7 && report.passes == 1, "Next step starts a new pass");
+
+    // Park the cursor on a block, then merge it away
+    em_verify_step(em, 2);
+    em_free(blocks[1]);
+    em_free(blocks[2]);
+    em_free(blocks[0]);
+    report = em_verify_step(em, 100);
+    ASSERT(report.reason == NULL && report.passes == 1, "The cursor survives the merge of its block");
+
+    em_verify_step(em, 6);
+    for (size_t i = 3; i < 6; i++) em_free(blocks[i]);
+    report = em_verify_step(em, 100);
+    ASSERT(report.reason == NULL && report.passes == 1, "The cursor survives the merge of the tail");
+
+    em_verify_step(em, 1);
+    em_reset(em);
+    report = em_verify_step(em, 100);
+    ASSERT(report.reason == NULL && report.checked == 1, "Reset restarts the pass");
+    em_destroy(em);
+}
+
+static void test_randomized_operations(void) {
+    TEST_CASE("Incremental verification stays clean under random operations");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *live[MAX_LIVE] = { 0 };
+    void *scratch = NULL;
+    EM *nested = NULL;
+    Bump *bump = NULL;
+    Slab *slab = NULL;
+    Stack *stack = NULL;
+    size_t failures = 0;
+    size_t passes = 0;
+
+    for (size_t i = 0; i < ITERATIONS; i++) {
+        size_t slot = test_random() % MAX_LIVE;
+        uint32_t op = test_random() % 16;
+
+        if (op < 6) {
+            if (live[slot] != NULL) em_free(live[slot]);
+            size_t size = 1 + test_random() % 700;
+            live[slot] = (op < 2) ? em_alloc_aligned(em, size, (size_t)16 << (test_random() % 5)) : em_alloc(em, size);
+        }
+        else if (op < 10) {
+            if (live[slot] != NULL) em_free(live[slot]);
+            live[slot] = NULL;
+        }
+        else if (op == 10) {
+            if (scratch != NULL) em_free(scratch);
+            scratch = (scratch == NULL) ? em_alloc_scratch(em, 64 + test_random() % 512) : NULL;
+        }
+        else if (op == 11) {
+            if (nested != NULL) {
+                em_destroy(nested);
+                nested = NULL;
+            }
+            else if ((nested = em_create_nested(em, 2048)) != NULL) {
+                em_alloc(nested, 100);
+                ASSERT(em_verify(nested).reason == NULL, "Nested arena verifies on its own");
+            }
+        }
+        else if (op == 12) {
+            if (bump != NULL) {
+                em_bump_trim(bump);
+                em_bump_destroy(bump);
+                bump = NULL;
+            }
+            else if ((bump = em_bump_create(em, 1024)) != NULL) {
+                em_bump_alloc(bump, 100);
+                em_bump_trim(bump);
+            }
+        }
+        else if (op == 13) {
+            if (slab != NULL) {
+                em_slab_destroy(slab);
+                slab = NULL;
+            }
+            else if ((slab = em_slab_create(em, 512, 32)) != NULL) {
+                em_slab_alloc(slab);
+            }
+        }
+        else if (op == 14) {
+            if (stack != NULL) {
+                em_stack_destroy(stack);
+                stack = NULL;
+            }
+            else if ((stack = em_stack_create(em, 512)) != NULL) {
+                em_stack_alloc(stack, 64);
+            }
+        }
+        else if (test_random() % 64 == 0) {
+            for (size_t j = 0; j < MAX_LIVE; j++) live[j] = NULL;
+            scratch = NULL;
+            nested = NULL;
+            bump = NULL;
+            slab = NULL;
+            stack = NULL;
+            em_reset(em);
+        }
+
+        EMVerifyReport report = em_verify_step(em, 1 + test_random() % 3);
+        if (report.reason != NULL) failures++;
+        passes += report.passes;
+
+        if (i % 64 == 0 && em_verify(em).reason != NULL) failures++;
+    }
+
+    ASSERT(failures == 0, "No corruption is reported for a healthy arena");
+    ASSERT(passes > 10, "The incremental checker completes full passes");
+    em_destroy(em);
+}
+
+static void test_detects_corruption(void) {
+    TEST_CASE("Damaged headers are reported with their address");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *a = em_alloc(em, 64);
+    void *b = em_alloc(em, 64);
+    void *c = em_alloc(em, 64);
+    void *d = em_alloc(em, 64);
+    em_free(c);
+
+    Block *block = block_from_data(b);
+    uintptr_t saved = block->as.occupied.magic;
+    block->as.occupied.magic ^= 0x40;
+    EMVerifyReport report = em_verify(em);
+    ASSERT(report.block == block && report.reason != NULL, "A broken XOR magic names its block");
+    report = em_verify_step(em, 100);
+    ASSERT(report.block == block, "The incremental checker finds it too");
+    report = em_verify_step(em, 100);
+    ASSERT(report.block == block && report.checked == 1, "The report is sticky: the cursor stays on the damage");
+    block->as.occupied.magic = saved;
+
+    block = block_from_data(d);
+    saved = block->size_and_reserved;
+    block->size_and_reserved += 4096;
+    report = em_verify(em);
+    ASSERT(report.block == block && report.reason != NULL, "A grown size is caught by the linkage checks");
+    block->size_and_reserved = saved;
+
+    Block *hole = block_from_data(c);
+    Block *saved_prev = hole->prev;
+    hole->prev = hole;
+    report = em_verify(em);
+    ASSERT(report.block == hole && report.reason != NULL, "A wrong previous link is caught");
+    hole->prev = saved_prev;
+
+    #ifdef EM_FREE_TLSF
+    EMTlsf *tlsf = em_get_extension(em)->tlsf;
+    EMTlsf saved_lists = *tlsf;
+    tlsf->fl_bitmap = 0;
+    memset(tlsf->sl_bitmap, 0, sizeof(tlsf->sl_bitmap));
+    memset(tlsf->heads, 0, sizeof(tlsf->heads));
+    report = em_verify(em);
+    ASSERT(report.block == hole && report.reason != NULL, "A free block missing from the free lists is caught");
+    *tlsf = saved_lists;
+    tlsf->heads[0][0] = block_from_data(a);
+    tlsf->fl_bitmap |= 1;
+    tlsf->sl_bitmap[0] |= 1;
+    report = em_verify(em);
+    ASSERT(report.reason != NULL, "An occupied block linked into the free lists is caught");
+    *tlsf = saved_lists;
+    #else
+    Block *saved_root = em_get_free_blocks(em);
+    em_set_free_blocks(em, NULL);
+    report = em_verify(em);
+    ASSERT(report.block == hole && report.reason != NULL, "A free block missing from the tree is caught");
+    em_set_free_blocks(em, block_from_data(a));
+    report = em_verify(em);
+    ASSERT(report.reason != NULL, "An occupied block linked into the tree is caught");
+    em_set_free_blocks(em, saved_root);
+    #endif
+
+    ASSERT(em_verify(em).reason == NULL, "Restoring the headers makes the arena intact again");
+    em_verify_step(em, 100);
+    ASSERT(em_verify_step(em, 100).reason == NULL, "The incremental checker recovers as well");
+    em_destroy(em);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_intact_arena();
+    test_step_budget();
+    test_randomized_operations();
+    test_detects_corruption();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
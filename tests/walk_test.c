@@ -0,0 +1,277 @@
+#define EM_WALK
+#define EASY_MEMORY_IMPLEMENTATION
+#define EM_NO_ATTRIBUTES
+#include "easy_memory.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE   (1 << 16)
+#define DUMP_SIZE    (1 << 14)
+#define MAX_ENTRIES  (256)
+
+static uint8_t arena_memory[ARENA_SIZE];
+
+/*
+ * Walk recorder: keeps every entry so tests can inspect the exact sequence.
+*/
+typedef struct {
+    EMWalkEntry entries[MAX_ENTRIES];
+    size_t count;
+    size_t limit;
+} WalkLog;
+
+static WalkLog walk_log;
+
+static bool record_entry(const EMWalkEntry *entry, void *context) {
+    WalkLog *log = (WalkLog *)context;
+    if (log->count < MAX_ENTRIES) log->entries[log->count] = *entry;
+    log->count++;
+    return log->limit == 0 || log->count < log->limit;
+}
+
+static bool walk_into_log(EM *em, size_t limit) {
+    walk_log.count = 0;
+    walk_log.limit = limit;
+    return em_walk(em, record_entry, &walk_log);
+}
+
+static size_t count_kind(EMWalkKind kind) {
+    size_t count = 0;
+    for (size_t i = 0; i < walk_log.count; i++) {
+        if (walk_log.entries[i].kind == kind) count++;
+    }
+    return count;
+}
+
+static const EMWalkEntry *find_entry(EMWalkKind kind, const void *address) {
+    for (size_t i = 0; i < walk_log.count; i++) {
+        if (walk_log.entries[i].kind == kind && walk_log.entries[i].address == address) return &walk_log.entries[i];
+    }
+    return NULL;
+}
+
+/*
+ * Blocks of one level, each with its header, must tile the arena up to the end of the tail
+*/
+static bool level_is_contiguous(EM *em) {
+    uintptr_t expected = (uintptr_t)em_get_first_block(em);
+    for (size_t i = 0; i < walk_log.count; i++) {
+        const EMWalkEntry *entry = &walk_log.entries[i];
+        if (entry->owner != em || entry->kind == EM_WALK_SUB_USED || entry->kind == EM_WALK_SUB_FREE) continue;
+        if (entry->kind == EM_WALK_SCRATCH) break;
+        if ((uintptr_t)entry->address != expected) return false;
+        expected += sizeof(Block) + entry->size;
+    }
+    return expected == (uintptr_t)em + em_get_capacity(em);
+}
+
+/*
+ * Dump sink and a reference decoder for the format described in easy_memory.h (HEAP DUMP FORMAT).
+*/
+typedef struct {
+    uint8_t data[DUMP_SIZE];
+    size_t length;
+    size_t writes;
+} DumpBuffer;
+
+static DumpBuffer dump_buffer;
+
+static void buffer_writer(const void *data, size_t size, void *context) {
+    DumpBuffer *buffer = (DumpBuffer *)context;
+    buffer->writes++;
+    if (buffer->length + size > DUMP_SIZE) return;
+    memcpy(buffer->data + buffer->length, data, size);
+    buffer->length += size;
+}
+
+static bool read_varint(size_t *cursor, uintptr_t *value) {
+    uintptr_t result = 0;
+    unsigned shift = 0;
+    while (*cursor < dump_buffer.length) {
+        uint8_t byte = dump_buffer.data[(*cursor)++];
+        result |= (uintptr_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return true;
+        }
+        shift += 7;
+    }
+    return false;
+}
+
+static bool dump_matches_walk(EM *em) {
+    if (dump_buffer.length < 6 || memcmp(dump_buffer.data, "EMHD", 4) != 0) return false;
+    if (dump_buffer.data[4] != EM_DUMP_VERSION || dump_buffer.data[5] != sizeof(uintptr_t)) return false;
+
+    size_t cursor = 6;
+    uintptr_t root, capacity;
+    if (!read_varint(&cursor, &root) || !read_varint(&cursor, &capacity)) return false;
+    if (root != (uintptr_t)em || capacity != em_get_capacity(em)) return false;
+
+    uintptr_t last = root;
+    size_t index = 0;
+    while (cursor < dump_buffer.length) {
+        uintptr_t tag, encoded, size;
+        if (!read_varint(&cursor, &tag) || !read_varint(&cursor, &encoded) || !read_varint(&cursor, &size)) return false;
+        if (encoded == 0 || index >= walk_log.count) return false;
+        encoded -= 1;
+        last += (encoded >> 1) ^ ((uintptr_t)0 - (encoded & 1));
+
+        const EMWalkEntry *entry = &walk_log.entries[index++];
+        if ((tag & 0xF) != (uintptr_t)entry->kind || (tag >> 4) != entry->depth) return false;
+        if (last != (uintptr_t)entry->address || size != entry->size) return false;
+    }
+    return index == walk_log.count;
+}
+
+static void test_plain_blocks(void) {
+    TEST_CASE("Used, free, tail and scratch blocks");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *a = em_alloc(em, 100);
+    void *b = em_alloc(em, 200);
+    void *c = em_alloc(em, 300);
+    void *s = em_alloc_scratch(em, 400);
+    ASSERT(a && b && c && s, "Setup allocations succeed");
+    em_free(b);
+
+    ASSERT(walk_into_log(em, 0), "Walk completes");
+    ASSERT(walk_log.count == 5, "Three blocks, the tail space and the scratch block are reported");
+    ASSERT(walk_log.entries[0].kind == EM_WALK_USED && walk_log.entries[0].owner == em, "First block is used");
+    ASSERT(walk_log.entries[1].kind == EM_WALK_FREE && walk_log.entries[1].size == get_size(block_from_data(b)),
+           "Freed block is reported with its size");
+    ASSERT(walk_log.entries[3].kind == EM_WALK_TAIL && walk_log.entries[3].size == free_size_in_tail(em),
+           "Tail space follows the last block");
+    ASSERT(walk_log.entries[4].kind == EM_WALK_SCRATCH, "Scratch block is reported last");
+
+    bool ordered = true;
+    for (size_t i = 1; i + 1 < walk_log.count; i++) {
+        if ((uintptr_t)walk_log.entries[i].address <= (uintptr_t)walk_log.entries[i - 1].address) ordered = false;
+    }
+    ASSERT(ordered, "Entries come in address order");
+    const EMWalkEntry *scratch = &walk_log.entries[4];
+    ASSERT((uintptr_t)scratch->address + sizeof(Block) + scratch->size <= (uintptr_t)em + em_get_capacity(em),
+           "Scratch block lies inside the arena");
+
+    em_free(s);
+    ASSERT(walk_into_log(em, 0) && level_is_contiguous(em), "Without scratch the blocks tile the whole arena");
+}
+
+static void test_nested_and_sub_allocators(void) {
+    TEST_CASE("Nested arenas and sub-allocators are walked");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    EM *nested = em_create_nested(em, 4096);
+    void *inner = em_alloc(nested, 128);
+    EM *deep = em_create_nested(nested, 1024 + EM_HEADER_SIZE);
+    void *deepest = em_alloc(deep, 32);
+
+    Bump *bump = em_bump_create(em, 1024);
+    void *item = em_bump_alloc(bump, 100);
+
+    Slab *slab = em_slab_create(em, 1024, 32);
+    void *chunks[3];
+    for (int i = 0; i < 3; i++) chunks[i] = em_slab_alloc(slab);
+    em_slab_free(slab, chunks[1]);
+
+    Stack *stack = em_stack_create(em, 1024);
+    void *frame_a = em_stack_alloc(stack, 64);
+    void *frame_b = em_stack_alloc(stack, 48);
+    void *after = em_alloc(em, 64);
+    ASSERT(inner && deepest && item && chunks[2] && frame_a && frame_b && after, "Setup allocations succeed");
+
+    ASSERT(walk_into_log(em, 0), "Walk completes");
+    const EMWalkEntry *entry = find_entry(EM_WALK_NESTED, nested);
+    ASSERT(entry != NULL && entry->depth == 0 && entry->size == em_get_capacity(nested), "Nested arena is reported");
+    entry = find_entry(EM_WALK_NESTED, deep);
+    ASSERT(entry != NULL && entry->depth == 1 && entry->owner == nested, "Second level arena is reported");
+    entry = find_entry(EM_WALK_USED, block_from_data(deepest));
+    ASSERT(entry != NULL && entry->depth == 2 && entry->owner == deep, "Blocks of the deepest arena are at depth 2");
+    entry = find_entry(EM_WALK_USED, block_from_data(after));
+    ASSERT(entry != NULL && entry->depth == 0, "Walk returns to the root after the nested arenas");
+
+    ASSERT(find_entry(EM_WALK_BUMP, bump) != NULL, "Bump header is recognised");
+    entry = find_entry(EM_WALK_SUB_USED, item);
+    ASSERT(entry != NULL && entry->depth == 1 && entry->size >= 100, "Bump usage is reported");
+
+    ASSERT(find_entry(EM_WALK_SLAB, slab) != NULL, "Slab header is recognised");
+    size_t slab_used = 0;
+    for (size_t i = 0; i < walk_log.count; i++) {
+        if (walk_log.entries[i].kind == EM_WALK_SUB_USED && walk_log.entries[i].address == chunks[0]) {
+            slab_used = walk_log.entries[i].size;
+        }
+    }
+    ASSERT(slab_used == 2 * slab_get_chunk_size(slab), "Two live chunks are counted");
+
+    ASSERT(find_entry(EM_WALK_STACK, stack) != NULL, "Stack header is recognised");
+    ASSERT(find_entry(EM_WALK_SUB_USED, frame_a) != NULL && find_entry(EM_WALK_SUB_USED, frame_b) != NULL,
+           "Every stack frame is reported");
+
+    ASSERT(level_is_contiguous(em) && level_is_contiguous(nested) && level_is_contiguous(deep),
+           "Every level tiles its arena");
+    ASSERT(walk_into_log(nested, 0) && walk_log.entries[0].owner == nested && walk_log.entries[0].depth == 0,
+           "A nested arena can be walked on its own");
+
+    em_stack_destroy(stack);
+    em_slab_destroy(slab);
+    em_bump_destroy(bump);
+    void *reuse = em_alloc(em, 1024);
+    ASSERT(walk_into_log(em, 0), "Walk completes after destruction");
+    ASSERT(count_kind(EM_WALK_BUMP) == 0 && count_kind(EM_WALK_SLAB) == 0 && count_kind(EM_WALK_STACK) == 0,
+           "Destroyed sub-allocators leave no tags behind");
+    ASSERT(reuse != NULL && find_entry(EM_WALK_USED, block_from_data(reuse)) != NULL, "Reused space is a plain block");
+}
+
+static void test_early_stop(void) {
+    TEST_CASE("Callback can stop the walk");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    EM *nested = em_create_nested(em, 2048);
+    for (int i = 0; i < 4; i++) {
+        ASSERT(em_alloc(nested, 64) != NULL, "Nested allocation succeeds");
+    }
+
+    ASSERT(!walk_into_log(em, 3), "Stopped walk reports false");
+    ASSERT(walk_log.count == 3, "No entries are delivered after the stop");
+
+    Bump *bump = em_bump_create(em, 512);
+    ASSERT(bump != NULL && !walk_into_log(em, 8), "Stopping inside a sub-allocator is honoured");
+    ASSERT(walk_log.count == 8, "Stop count is exact");
+}
+
+static void test_dump_round_trip(void) {
+    TEST_CASE("Binary dump decodes to the walk sequence");
+
+    EM *em = em_create_static(arena_memory, sizeof(arena_memory));
+    void *pointers[160];
+    for (int i = 0; i < 160; i++) pointers[i] = em_alloc(em, (size_t)(16 + (i % 32) * 8));
+    for (int i = 0; i < 160; i += 3) em_free(pointers[i]);
+    EM *nested = em_create_nested(em, 4096);
+    ASSERT(nested != NULL && em_alloc(nested, 100) != NULL, "Nested allocation succeeds");
+    Stack *stack = em_stack_create(em, 512);
+    ASSERT(stack != NULL && em_stack_alloc(stack, 32) != NULL, "Stack allocation succeeds");
+
+    dump_buffer.length = 0;
+    dump_buffer.writes = 0;
+    ASSERT(em_dump(em, buffer_writer, &dump_buffer), "Dump succeeds");
+    ASSERT(walk_into_log(em, 0) && walk_log.count > 160, "Walk has enough entries to span several buffers");
+    ASSERT(dump_buffer.writes > 1, "Output is flushed in chunks");
+    ASSERT(dump_matches_walk(em), "Decoded dump equals the walk");
+
+    em_reset(em);
+    dump_buffer.length = 0;
+    ASSERT(em_dump(em, buffer_writer, &dump_buffer) && walk_into_log(em, 0), "Dump of a reset arena succeeds");
+    ASSERT(walk_log.count == 1 && walk_log.entries[0].kind == EM_WALK_TAIL, "Reset arena is a single tail region");
+    ASSERT(dump_matches_walk(em), "Decoded dump equals the walk after reset");
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_plain_blocks();
+    test_nested_and_sub_allocators();
+    test_early_stop();
+    test_dump_round_trip();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
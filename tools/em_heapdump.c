@@ -0,0 +1,349 @@
+/*
+ * em_heapdump: analyze an em_dump heap snapshot offline.
+ *
+ * The dump (see HEAP DUMP FORMAT in easy_memory.h) is decoded in a single streaming
+ * pass; entries are never stored, so the cost is a few counters per entry and dumps
+ * of arenas with millions of blocks are analyzed in milliseconds.
+ *
+ * Leaf entries are classified as used (USED, SCRATCH, SUB_USED) or free (FREE, TAIL,
+ * SUB_FREE); container headers (NESTED, BUMP, SLAB, STACK) are only counted, their
+ * contents follow as leaves. Reported as one JSON line:
+ *   - entry count and bytes per kind, and the deepest nesting level,
+ *   - log2 size histograms of used and free leaves (bucket b holds sizes in [2^b, 2^(b+1))),
+ *   - fragmentation per address region: the root arena is split into --regions equal
+ *     slices, every leaf is charged to the slice holding its first byte, and each slice
+ *     reports used, free, largest free and 1 - largest_free / free,
+ *   - the --top largest free runs with their address and depth.
+ *
+ * Usage: em_heapdump [--regions N] [--top K] dump.emhd
+ *        em_heapdump --demo dump.emhd   (writes a dump of a synthetic fragmented arena)
+*/
+
+#define EM_WALK
+#define EASY_MEMORY_IMPLEMENTATION
+#include "easy_memory.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HEAPDUMP_DEFAULT_REGIONS  16
+#define HEAPDUMP_DEFAULT_TOP      10
+#define HEAPDUMP_MAX_TOP          256
+#define HEAPDUMP_BUCKETS          (sizeof(uintptr_t) * 8)
+#define HEAPDUMP_DEMO_SIZE        (1 << 22)
+#define HEAPDUMP_DEMO_BLOCKS      4000
+
+static const char *const kind_names[EM_WALK_KIND_COUNT] = {
+    "used", "free", "tail", "scratch", "nested", "bump", "slab", "stack", "sub_used", "sub_free"
+};
+
+typedef struct {
+    size_t used;
+    size_t free;
+    size_t largest_free;
+} Region;
+
+typedef struct {
+    uintptr_t address;
+    size_t size;
+    unsigned depth;
+    EMWalkKind kind;
+} FreeRun;
+
+typedef struct {
+    uintptr_t root;
+    size_t capacity;
+    size_t entries;
+    size_t max_depth;
+    size_t kind_count[EM_WALK_KIND_COUNT];
+    size_t kind_bytes[EM_WALK_KIND_COUNT];
+    size_t used_histogram[HEAPDUMP_BUCKETS];
+    size_t free_histogram[HEAPDUMP_BUCKETS];
+    Region *regions;
+    size_t region_count;
+    size_t region_size;
+    FreeRun top[HEAPDUMP_MAX_TOP];
+    size_t top_count;
+    size_t top_limit;
+} Analysis;
+
+static bool read_varint(const uint8_t *data, size_t length, size_t *cursor, uintptr_t *value) {
+    uintptr_t result = 0;
+    unsigned shift = 0;
+    while (*cursor < length && shift < sizeof(uintptr_t) * 8) {
+        uint8_t byte = data[(*cursor)++];
+        result |= (uintptr_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return true;
+        }
+        shift += 7;
+    }
+    return false;
+}
+
+static bool read_address(const uint8_t *data, size_t length, size_t *cursor, uintptr_t *last, uintptr_t *address) {
+    uintptr_t encoded;
+    if (!read_varint(data, length, cursor, &encoded) || encoded == 0) return false;
+    encoded -= 1;
+    *last += (encoded >> 1) ^ ((uintptr_t)0 - (encoded & 1));
+    *address = *last;
+    return true;
+}
+
+static size_t size_bucket(size_t size) {
+    size_t bucket = 0;
+    while (size > 1) {
+        size >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static bool kind_is_used(EMWalkKind kind) {
+    return kind == EM_WALK_USED || kind == EM_WALK_SCRATCH || kind == EM_WALK_SUB_USED;
+}
+
+static bool kind_is_free(EMWalkKind kind) {
+    return kind == EM_WALK_FREE || kind == EM_WALK_TAIL || kind == EM_WALK_SUB_FREE;
+}
+
+// Keep the K largest free runs sorted by size, largest first (K is small, insertion is fine)
+static void top_insert(Analysis *a, uintptr_t address, size_t size, unsigned depth, EMWalkKind kind) {
+    if (a->top_limit == 0) return;
+    if (a->top_count == a->top_limit && size <= a->top[a->top_count - 1].size) return;
+
+    size_t i = (a->top_count < a->top_limit) ? a->top_count++ : a->top_count - 1;
+    while (i > 0 && a->top[i - 1].size < size) {
+        a->top[i] = a->top[i - 1];
+        i--;
+    }
+    a->top[i].address = address;
+    a->top[i].size = size;
+    a->top[i].depth = depth;
+    a->top[i].kind = kind;
+}
+
+static void account_entry(Analysis *a, EMWalkKind kind, unsigned depth, uintptr_t address, size_t size) {
+    a->entries++;
+    a->kind_count[kind]++;
+    a->kind_bytes[kind] += size;
+    if (depth > a->max_depth) a->max_depth = depth;
+
+    bool used = kind_is_used(kind);
+    bool free_run = kind_is_free(kind);
+    if (!used && !free_run) return;
+
+    if (used) a->used_histogram[size_bucket(size)]++;
+    else a->free_histogram[size_bucket(size)]++;
+
+    if (address >= a->root && address - a->root < a->capacity) {
+        Region *region = &a->regions[(address - a->root) / a->region_size];
+        if (used) {
+            region->used += size;
+        } else {
+            region->free += size;
+            if (size > region->largest_free) region->largest_free = size;
+        }
+    }
+
+    if (free_run) top_insert(a, address, size, depth, kind);
+}
+
+static bool analyze_dump(const uint8_t *data, size_t length, Analysis *a) {
+    if (length < 6 || memcmp(data, "EMHD", 4) != 0) {
+        fprintf(stderr, "em_heapdump: not an EM heap dump\n");
+        return false;
+    }
+    if (data[4] != EM_DUMP_VERSION || data[5] != sizeof(uintptr_t)) {
+        fprintf(stderr, "em_heapdump: dump version %u / word size %u not supported by this build\n", data[4], data[5]);
+        return false;
+    }
+
+    size_t cursor = 6;
+    uintptr_t root, capacity;
+    if (!read_varint(data, length, &cursor, &root) || !read_varint(data, length, &cursor, &capacity) || capacity == 0) {
+        fprintf(stderr, "em_heapdump: truncated header\n");
+        return false;
+    }
+    a->root = root;
+    a->capacity = (size_t)capacity;
+    if (a->region_count > a->capacity) a->region_count = a->capacity;
+    a->region_size = (a->capacity + a->region_count - 1) / a->region_count;
+    a->regions = (Region *)calloc(a->region_count, sizeof(Region));
+    if (!a->regions) {
+        fprintf(stderr, "em_heapdump: out of memory\n");
+        return false;
+    }
+
+    uintptr_t last = root;
+    while (cursor < length) {
+        uintptr_t tag, address, size;
+        if (!read_varint(data, length, &cursor, &tag) ||
+            !read_address(data, length, &cursor, &last, &address) ||
+            !read_varint(data, length, &cursor, &size) ||
+            (tag & 0xF) >= EM_WALK_KIND_COUNT) {
+            fprintf(stderr, "em_heapdump: truncated or corrupted entry at byte %zu\n", cursor);
+            return false;
+        }
+        account_entry(a, (EMWalkKind)(tag & 0xF), (unsigned)(tag >> 4), address, (size_t)size);
+    }
+    return true;
+}
+
+static double fragmentation(size_t free_bytes, size_t largest_free) {
+    return free_bytes ? 1.0 - (double)largest_free / (double)free_bytes : 0.0;
+}
+
+static void print_histogram(const char *name, const size_t *histogram) {
+    size_t last = 0;
+    for (size_t b = 0; b < HEAPDUMP_BUCKETS; b++) {
+        if (histogram[b]) last = b + 1;
+    }
+    printf(",\"%s\":[", name);
+    for (size_t b = 0; b < last; b++) printf("%s%zu", b ? "," : "", histogram[b]);
+    printf("]");
+}
+
+static void report(const Analysis *a, const char *path) {
+    size_t used = 0, free_bytes = 0;
+    for (size_t k = 0; k < EM_WALK_KIND_COUNT; k++) {
+        if (kind_is_used((EMWalkKind)k)) used += a->kind_bytes[k];
+        if (kind_is_free((EMWalkKind)k)) free_bytes += a->kind_bytes[k];
+    }
+
+    printf("{\"tool\":\"em_heapdump\",\"dump\":\"%s\",\"root\":\"0x%llx\",\"capacity\":%zu,\"entries\":%zu,\"max_depth\":%zu,"
+           "\"used\":%zu,\"free\":%zu,\"fragmentation\":%.4f,\"kinds\":{",
+           path, (unsigned long long)a->root, a->capacity, a->entries, a->max_depth,
+           used, free_bytes, fragmentation(free_bytes, a->top_count ? a->top[0].size : 0));
+    for (size_t k = 0; k < EM_WALK_KIND_COUNT; k++) {
+        printf("%s\"%s\":{\"count\":%zu,\"bytes\":%zu}", k ? "," : "", kind_names[k], a->kind_count[k], a->kind_bytes[k]);
+    }
+    printf("}");
+
+    print_histogram("used_log2_histogram", a->used_histogram);
+    print_histogram("free_log2_histogram", a->free_histogram);
+
+    printf(",\"region_size\":%zu,\"regions\":[", a->region_size);
+    for (size_t r = 0; r < a->region_count; r++) {
+        const Region *region = &a->regions[r];
+        printf("%s{\"offset\":%zu,\"used\":%zu,\"free\":%zu,\"largest_free\":%zu,\"fragmentation\":%.4f}",
+               r ? "," : "", r * a->region_size, region->used, region->free, region->largest_free,
+               fragmentation(region->free, region->largest_free));
+    }
+
+    printf("],\"largest_free_runs\":[");
+    for (size_t i = 0; i < a->top_count; i++) {
+        const FreeRun *run = &a->top[i];
+        printf("%s{\"offset\":%lld,\"size\":%zu,\"depth\":%u,\"kind\":\"%s\"}", i ? "," : "",
+               (long long)(run->address - a->root), run->size, run->depth, kind_names[run->kind]);
+    }
+    printf("]}\n");
+}
+
+static uint8_t *read_file(const char *path, size_t *length) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+    uint8_t *data = NULL;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long end = ftell(file);
+        if (end > 0 && fseek(file, 0, SEEK_SET) == 0) {
+            data = (uint8_t *)malloc((size_t)end);
+            if (data && fread(data, 1, (size_t)end, file) != (size_t)end) {
+                free(data);
+                data = NULL;
+            }
+            *length = (size_t)end;
+        }
+    }
+    fclose(file);
+    return data;
+}
+
+static void file_writer(const void *data, size_t size, void *context) {
+    fwrite(data, 1, size, (FILE *)context);
+}
+
+// Synthetic workload: random sizes with every third block freed, plus one of each sub-allocator
+static int write_demo(const char *path) {
+    FILE *file = fopen(path, "wb");
+    EM *em = em_create(HEAPDUMP_DEMO_SIZE);
+    if (!file || !em) {
+        fprintf(stderr, "em_heapdump: cannot create demo dump '%s'\n", path);
+        if (file) fclose(file);
+        if (em) em_destroy(em);
+        return 1;
+    }
+
+    EM *nested = em_create_nested(em, HEAPDUMP_DEMO_SIZE / 8);
+    Bump *bump = em_bump_create(em, 4096);
+    Slab *slab = em_slab_create(em, 4096, 64);
+    Stack *stack = em_stack_create(em, 4096);
+    static void *pointers[HEAPDUMP_DEMO_BLOCKS];
+    unsigned seed = 2024;
+    for (int i = 0; i < HEAPDUMP_DEMO_BLOCKS; i++) {
+        seed = seed * 1103515245u + 12345u;
+        pointers[i] = em_alloc(i % 4 == 0 && nested ? nested : em, 16 + (seed >> 8) % 1500);
+    }
+    for (int i = 0; i < HEAPDUMP_DEMO_BLOCKS; i += 3) {
+        if (pointers[i]) em_free(pointers[i]);
+    }
+    for (int i = 0; i < 8; i++) {
+        if (bump && !em_bump_alloc(bump, 100)) break;
+        if (slab && !em_slab_alloc(slab)) break;
+        if (stack && !em_stack_alloc(stack, 64)) break;
+    }
+
+    em_dump(em, file_writer, file);
+    em_destroy(em);
+    fclose(file);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    size_t regions = HEAPDUMP_DEFAULT_REGIONS, top = HEAPDUMP_DEFAULT_TOP;
+    const char *path = NULL;
+    bool demo = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--regions") == 0 && i + 1 < argc) {
+            long value = strtol(argv[++i], NULL, 10);
+            regions = value > 0 ? (size_t)value : HEAPDUMP_DEFAULT_REGIONS;
+        } else if (strcmp(argv[i], "--top") == 0 && i + 1 < argc) {
+            long value = strtol(argv[++i], NULL, 10);
+            top = value >= 0 ? (size_t)value : HEAPDUMP_DEFAULT_TOP;
+            if (top > HEAPDUMP_MAX_TOP) top = HEAPDUMP_MAX_TOP;
+        } else if (strcmp(argv[i], "--demo") == 0) {
+            demo = true;
+        } else if (argv[i][0] != '-' && path == NULL) {
+            path = argv[i];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "usage: %s [--regions N] [--top K] dump.emhd\n"
+                        "       %s --demo dump.emhd\n", argv[0], argv[0]);
+        return 2;
+    }
+    if (demo) return write_demo(path);
+
+    size_t length = 0;
+    uint8_t *data = read_file(path, &length);
+    if (!data) {
+        fprintf(stderr, "em_heapdump: cannot read '%s'\n", path);
+        return 1;
+    }
+
+    static Analysis analysis;
+    analysis.region_count = regions;
+    analysis.top_limit = top;
+    bool ok = analyze_dump(data, length, &analysis);
+    free(data);
+    if (ok) report(&analysis, path);
+
+    free(analysis.regions);
+    return ok ? 0 : 1;
+}
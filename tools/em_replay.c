@@ -0,0 +1,750 @@
+/*
+ * em_replay: replay an EM_TRACE allocation trace against easy_memory and malloc.
+ *
+ * The trace (see ALLOCATION TRACE FORMAT in easy_memory.h) is decoded once into a
+ * dense operation array: every arena, sub-allocator and allocation gets a slot id,
+ * so the replay loop never hashes addresses. The same operations are then executed
+ *
+ *   - against easy_memory, built with whatever configuration this file is compiled
+ *     with (make tools/em_replay EXTRA_CFLAGS="-DEM_SAFETY_POLICY=0 ..."), and
+ *   - against the system allocator, where arenas are bookkeeping only: every
+ *     allocation is a malloc/posix_memalign, and destroy/reset free all children.
+ *
+ * Reported per implementation (one JSON line each):
+ *   - ns/op overall and per operation class (calibrated timer overhead removed),
+ *   - peak footprint: EM = touched part of the root arenas (tail offset plus scratch),
+ *     malloc = sum of usable sizes plus one header word per live block,
+ *   - peak live bytes requested by the program,
+ *   - fragmentation of the root arenas, sampled every --frag-every operations as
+ *     1 - largest_free / total_free over a physical block walk (EM only).
+ *
+ * Usage: em_replay [--em | --malloc] [--reps N] [--frag-every N] trace.emtr
+*/
+
+#define EASY_MEMORY_IMPLEMENTATION
+#include "easy_memory.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__GLIBC__)
+#   include <malloc.h>
+#   define REPLAY_USABLE_SIZE(ptr, size) malloc_usable_size(ptr)
+#else
+#   define REPLAY_USABLE_SIZE(ptr, size) (size)
+#endif
+
+#define NO_SLOT               UINT32_MAX
+#define REPLAY_MALLOC_ALIGN   (2 * sizeof(void *))  // Alignment malloc already guarantees
+#define REPLAY_DEFAULT_REPS   5
+#define REPLAY_DEFAULT_FRAG   1024
+#define REPLAY_PHASE          4096                  // Root arenas keep their recorded address modulo this
+
+enum {
+    CLASS_CREATE,
+    CLASS_ALLOC,
+    CLASS_FREE,
+    CLASS_RESET,
+    CLASS_DESTROY,
+    CLASS_OTHER,
+    CLASS_COUNT
+};
+
+static const char *const class_names[CLASS_COUNT] = { "create", "alloc", "free", "reset", "destroy", "other" };
+
+static const uint8_t op_class[EM_TRACE_OP_COUNT] = {
+    [EM_TRACE_CREATE]               = CLASS_CREATE,
+    [EM_TRACE_CREATE_STATIC]        = CLASS_CREATE,
+    [EM_TRACE_CREATE_NESTED]        = CLASS_CREATE,
+    [EM_TRACE_CREATE_SCRATCH]       = CLASS_CREATE,
+    [EM_TRACE_DESTROY]              = CLASS_DESTROY,
+    [EM_TRACE_RESET]                = CLASS_RESET,
+    [EM_TRACE_RESET_ZERO]           = CLASS_RESET,
+    [EM_TRACE_ALLOC]                = CLASS_ALLOC,
+    [EM_TRACE_ALLOC_SCRATCH]        = CLASS_ALLOC,
+    [EM_TRACE_CALLOC]               = CLASS_ALLOC,
+    [EM_TRACE_FREE]                 = CLASS_FREE,
+    [EM_TRACE_BUMP_CREATE]          = CLASS_CREATE,
+    [EM_TRACE_BUMP_CREATE_SCRATCH]  = CLASS_CREATE,
+    [EM_TRACE_BUMP_ALLOC]           = CLASS_ALLOC,
+    [EM_TRACE_BUMP_TRIM]            = CLASS_OTHER,
+    [EM_TRACE_BUMP_RESET]           = CLASS_RESET,
+    [EM_TRACE_BUMP_DESTROY]         = CLASS_DESTROY,
+    [EM_TRACE_SLAB_CREATE]          = CLASS_CREATE,
+    [EM_TRACE_SLAB_CREATE_SCRATCH]  = CLASS_CREATE,
+    [EM_TRACE_SLAB_ALLOC]           = CLASS_ALLOC,
+    [EM_TRACE_SLAB_FREE]            = CLASS_FREE,
+    [EM_TRACE_SLAB_RESET]           = CLASS_RESET,
+    [EM_TRACE_SLAB_RESET_ZERO]      = CLASS_RESET,
+    [EM_TRACE_SLAB_DESTROY]         = CLASS_DESTROY,
+    [EM_TRACE_STACK_CREATE]         = CLASS_CREATE,
+    [EM_TRACE_STACK_CREATE_SCRATCH] = CLASS_CREATE,
+    [EM_TRACE_STACK_ALLOC]          = CLASS_ALLOC,
+    [EM_TRACE_STACK_FREE]           = CLASS_FREE,
+    [EM_TRACE_STACK_FREE_TO_MARKER] = CLASS_FREE,
+    [EM_TRACE_STACK_RESET]          = CLASS_RESET,
+    [EM_TRACE_STACK_RESET_ZERO]     = CLASS_RESET,
+    [EM_TRACE_STACK_DESTROY]        = CLASS_DESTROY,
+    [EM_TRACE_HANDLES_CREATE]       = CLASS_OTHER,
+    [EM_TRACE_HANDLES_DESTROY]      = CLASS_FREE,
+    [EM_TRACE_HALLOC]               = CLASS_ALLOC,
+    [EM_TRACE_HFREE]                = CLASS_FREE,
+    [EM_TRACE_COMPACT]              = CLASS_OTHER,
+    [EM_TRACE_ALLOC_NEAR]           = CLASS_ALLOC,
+    [EM_TRACE_ALLOC_SHORT]          = CLASS_ALLOC,
+};
+
+typedef struct {
+    size_t size;
+    size_t extra;         // em_alloc_near: slot of the hint plus one (0 = no live hint)
+    uint32_t object;      // Slot of the arena / sub-allocator the call was made on
+    uint32_t result;      // Slot produced (creates, allocations) or released (frees)
+    uint32_t phase;       // Recorded address of a root arena modulo REPLAY_PHASE
+    uint8_t op;
+    bool failed;          // The recorded call returned NULL
+    uint8_t padding[2];
+} ReplayOp;
+
+typedef struct {
+    ReplayOp *ops;
+    size_t op_count;
+    size_t slot_count;
+} ReplayTrace;
+
+typedef struct {
+    void *value;          // Live object in the replay, NULL when dead or never created
+    void *buffer;         // Backing memory of a static root arena
+    size_t bytes;         // Requested bytes counted as live
+    size_t footprint;     // malloc: usable size + header word; EM root: last measured footprint
+    size_t chunk;         // Chunk size of a Slab handle
+    size_t handle;        // Handle of an em_halloc block in this replay
+    uint32_t parent;
+    uint32_t first_child;
+    uint32_t next_sibling;
+    uint32_t prev_sibling;
+    uint32_t children;    // Live children (for a Stack: current depth)
+    uint32_t root;        // Root arena this slot lives in
+    bool is_handle;
+    bool is_root;
+    bool is_relocatable;  // Allocated by em_halloc: released by em_hfree or em_handles_destroy
+    uint8_t padding[sizeof(size_t) - 3];
+} ReplaySlot;
+
+typedef struct {
+    ReplaySlot *slots;
+    uint32_t *roots;
+    size_t root_count;
+    size_t live_bytes;
+    size_t peak_live;
+    size_t footprint;
+    size_t peak_footprint;
+    size_t diverged;      // Calls whose success differs from the recording
+    size_t skipped;       // Calls on objects that do not exist in this replay
+    size_t frag_every;
+    size_t frag_samples;
+    double frag_sum;
+    double frag_max;
+    double timer_overhead;
+    double total_ns;
+    double class_ns[CLASS_COUNT];
+    size_t class_count[CLASS_COUNT];
+    bool use_malloc;
+    uint8_t padding[sizeof(size_t) - 1];
+} Replay;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static double calibrate_timer(void) {
+    double best = 1e9;
+    for (int i = 0; i < 1000; i++) {
+        double start = now_ns();
+        double elapsed = now_ns() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+/*
+ * Trace decoding
+*/
+typedef struct {
+    uintptr_t *keys;
+    uint32_t *values;
+    size_t mask;
+} AddressMap;
+
+static size_t address_hash(uintptr_t address, size_t mask) {
+    return (size_t)(((uint64_t)(address >> 3) * 0x9E3779B97F4A7C15ULL) >> 17) & mask;
+}
+
+static uint32_t *address_slot(AddressMap *map, uintptr_t address) {
+    size_t index = address_hash(address, map->mask);
+    while (map->keys[index] != 0 && map->keys[index] != address) index = (index + 1) & map->mask;
+    map->keys[index] = address;
+    return &map->values[index];
+}
+
+static bool read_varint(const uint8_t *data, size_t length, size_t *cursor, uintptr_t *value) {
+    uintptr_t result = 0;
+    unsigned shift = 0;
+    while (*cursor < length && shift < sizeof(uintptr_t) * 8) {
+        uint8_t byte = data[(*cursor)++];
+        result |= (uintptr_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return true;
+        }
+        shift += 7;
+    }
+    return false;
+}
+
+static bool read_address(const uint8_t *data, size_t length, size_t *cursor, uintptr_t *last, uintptr_t *address) {
+    uintptr_t encoded;
+    if (!read_varint(data, length, cursor, &encoded)) return false;
+    if (encoded == 0) {
+        *address = 0;
+        return true;
+    }
+    encoded -= 1;
+    *last += (encoded >> 1) ^ ((uintptr_t)0 - (encoded & 1));
+    *address = *last;
+    return true;
+}
+
+static uintptr_t handle_key(uint32_t object, uintptr_t handle) {
+    // Handles are small slot numbers; the arena slot goes in the upper half of the word
+    return (handle + 1) ^ ((uintptr_t)object << (sizeof(uintptr_t) * 4));
+}
+
+static bool op_releases_result(size_t op) {
+    return op == EM_TRACE_FREE || op == EM_TRACE_SLAB_FREE || op == EM_TRACE_STACK_FREE || op == EM_TRACE_HFREE;
+}
+
+static bool op_produces_result(size_t op) {
+    size_t class_id = op_class[op];
+    return class_id == CLASS_CREATE || class_id == CLASS_ALLOC;
+}
+
+static bool decode_trace(const uint8_t *data, size_t length, ReplayTrace *trace) {
+    if (length < 6 || memcmp(data, "EMTR", 4) != 0) {
+        fprintf(stderr, "em_replay: not an EM trace\n");
+        return false;
+    }
+    if (data[4] != EM_TRACE_VERSION || data[5] != sizeof(uintptr_t)) {
+        fprintf(stderr, "em_replay: trace version %u / word size %u not supported by this build\n", data[4], data[5]);
+        return false;
+    }
+
+    size_t max_ops = (length - 6) / 5 + 1;  // Every event takes at least five bytes
+    size_t map_size = 16;
+    while (map_size < 4 * max_ops) map_size <<= 1;
+
+    // em_compact moves handle blocks, so em_hfree finds its block by (arena slot, handle) instead
+    AddressMap map, handles;
+    map.keys = (uintptr_t *)calloc(map_size, sizeof(uintptr_t));
+    map.values = (uint32_t *)calloc(map_size, sizeof(uint32_t));
+    map.mask = map_size - 1;
+    handles.keys = (uintptr_t *)calloc(map_size, sizeof(uintptr_t));
+    handles.values = (uint32_t *)calloc(map_size, sizeof(uint32_t));
+    handles.mask = map_size - 1;
+    trace->ops = (ReplayOp *)calloc(max_ops, sizeof(ReplayOp));
+    trace->op_count = 0;
+    trace->slot_count = 0;
+    if (!map.keys || !map.values || !handles.keys || !handles.values || !trace->ops) {
+        fprintf(stderr, "em_replay: out of memory\n");
+        free(map.keys);
+        free(map.values);
+        free(handles.keys);
+        free(handles.values);
+        return false;
+    }
+
+    uintptr_t last_handle = 0, last_pointer = 0;
+    size_t cursor = 6;
+    bool ok = true;
+    while (cursor < length) {
+        uintptr_t op, object, result, size, extra;
+        if (!read_varint(data, length, &cursor, &op) || op == 0 || op >= EM_TRACE_OP_COUNT ||
+            !read_address(data, length, &cursor, &last_handle, &object) ||
+            !read_address(data, length, &cursor, EM_TRACE_RESULT_IS_HANDLE(op) ? &last_handle : &last_pointer, &result) ||
+            !read_varint(data, length, &cursor, &size) ||
+            !read_varint(data, length, &cursor, &extra)) {
+            fprintf(stderr, "em_replay: truncated or corrupted event at byte %zu\n", cursor);
+            ok = false;
+            break;
+        }
+
+        ReplayOp *entry = &trace->ops[trace->op_count++];
+        entry->op = (uint8_t)op;
+        entry->size = (size_t)size;
+        entry->extra = (size_t)extra;
+        entry->failed = (result == 0);
+        entry->phase = (uint32_t)(result % REPLAY_PHASE);
+        entry->object = NO_SLOT;
+        entry->result = NO_SLOT;
+
+        if (object != 0) {
+            // Objects seen before their creation (trace started mid-run) get a slot that never comes alive
+            uint32_t *slot = address_slot(&map, object);
+            if (*slot == 0) *slot = (uint32_t)++trace->slot_count;
+            entry->object = *slot - 1;
+        }
+
+        if (op == EM_TRACE_ALLOC_NEAR && extra != 0) {
+            // The hint is replayed as the allocation it named, wherever that landed in this replay
+            entry->extra = *address_slot(&map, object + extra - 1);
+        }
+
+        if (op_produces_result((size_t)op)) {
+            uint32_t fresh = (uint32_t)trace->slot_count++;
+            if (result != 0) *address_slot(&map, result) = fresh + 1;
+            if (op == EM_TRACE_HALLOC && result != 0) *address_slot(&handles, handle_key(entry->object, extra)) = fresh + 1;
+            entry->result = fresh;
+        } else if (op == EM_TRACE_HFREE) {
+            uint32_t *slot = address_slot(&handles, handle_key(entry->object, extra));
+            if (*slot == 0) *slot = (uint32_t)++trace->slot_count;
+            entry->result = *slot - 1;
+            *slot = 0;
+        } else if (op_releases_result((size_t)op) && result != 0) {
+            uint32_t *slot = address_slot(&map, result);
+            if (*slot == 0) *slot = (uint32_t)++trace->slot_count;
+            entry->result = *slot - 1;
+        }
+    }
+
+    free(map.keys);
+    free(map.values);
+    free(handles.keys);
+    free(handles.values);
+    return ok;
+}
+
+/*
+ * Ownership bookkeeping (shared by both implementations)
+*/
+static void slot_link(Replay *r, uint32_t parent, uint32_t id) {
+    ReplaySlot *slot = &r->slots[id];
+    ReplaySlot *owner = &r->slots[parent];
+    slot->parent = parent;
+    slot->root = owner->root;
+    slot->prev_sibling = NO_SLOT;
+    slot->next_sibling = owner->first_child;
+    if (owner->first_child != NO_SLOT) r->slots[owner->first_child].prev_sibling = id;
+    owner->first_child = id;
+    owner->children++;
+}
+
+static void slot_kill(Replay *r, uint32_t id);
+
+static void slot_kill_children(Replay *r, uint32_t id) {
+    while (r->slots[id].first_child != NO_SLOT) slot_kill(r, r->slots[id].first_child);
+}
+
+static void slot_kill(Replay *r, uint32_t id) {
+    slot_kill_children(r, id);
+
+    ReplaySlot *slot = &r->slots[id];
+    if (r->use_malloc && !slot->is_handle) free(slot->value);
+    if (slot->buffer) free(slot->buffer);
+
+    r->live_bytes -= slot->bytes;
+    r->footprint -= slot->footprint;
+
+    if (slot->parent != NO_SLOT) {
+        ReplaySlot *owner = &r->slots[slot->parent];
+        if (slot->prev_sibling != NO_SLOT) r->slots[slot->prev_sibling].next_sibling = slot->next_sibling;
+        else owner->first_child = slot->next_sibling;
+        if (slot->next_sibling != NO_SLOT) r->slots[slot->next_sibling].prev_sibling = slot->prev_sibling;
+        owner->children--;
+    }
+
+    memset(slot, 0, sizeof(*slot));
+    slot->parent = slot->first_child = slot->next_sibling = slot->prev_sibling = slot->root = NO_SLOT;
+}
+
+static void slot_adopt(Replay *r, const ReplayOp *op, void *value, bool is_handle, size_t bytes) {
+    ReplaySlot *slot = &r->slots[op->result];
+    slot->value = value;
+    slot->is_handle = is_handle;
+
+    if (op->object == NO_SLOT) {
+        slot->is_root = true;
+        slot->root = op->result;
+        r->roots[r->root_count++] = op->result;
+    } else {
+        slot_link(r, op->object, op->result);
+    }
+
+    if (!is_handle) {
+        slot->bytes = bytes;
+        r->live_bytes += bytes;
+        if (r->live_bytes > r->peak_live) r->peak_live = r->live_bytes;
+        if (r->use_malloc) {
+            slot->footprint = REPLAY_USABLE_SIZE(value, bytes) + sizeof(size_t);
+            r->footprint += slot->footprint;
+        }
+    }
+}
+
+/*
+ * Implementations
+*/
+static void *malloc_aligned(size_t size, size_t alignment) {
+    if (alignment <= REPLAY_MALLOC_ALIGN) return malloc(size);
+    void *ptr = NULL;
+    return posix_memalign(&ptr, alignment, size) == 0 ? ptr : NULL;
+}
+
+/*
+ * Root arenas are always rebuilt over a replay-owned buffer placed at the recorded
+ * address phase: alignment padding inside the arena depends on the base address,
+ * so an arena at a different phase may fail (or succeed) where the recording did not.
+ * A dynamic arena gets the same capacity em_create_aligned would have given it.
+*/
+static EM *replay_create_root(ReplaySlot *slot, const ReplayOp *op) {
+    size_t size = (op->op == EM_TRACE_CREATE) ? op->size + EM_HEADER_SIZE + EM_TLSF_LISTS_SIZE(op->size + EM_HEADER_SIZE) : op->size;
+    uint8_t *buffer = (uint8_t *)malloc(size + REPLAY_PHASE);
+    if (!buffer) return NULL;
+
+    uint8_t *memory = buffer + ((op->phase - (uintptr_t)buffer) & (REPLAY_PHASE - 1));
+    EM *em = em_create_static_aligned(memory, size, op->extra);
+    if (em) slot->buffer = buffer;
+    else free(buffer);
+    return em;
+}
+
+static void *replay_em(Replay *r, const ReplayOp *op, void *object, void *released) {
+    switch (op->op) {
+        case EM_TRACE_CREATE:
+        case EM_TRACE_CREATE_STATIC:   return replay_create_root(&r->slots[op->result], op);
+        case EM_TRACE_CREATE_NESTED:   return em_create_nested_aligned((EM *)object, op->size, op->extra);
+        case EM_TRACE_CREATE_SCRATCH:  return em_create_scratch_aligned((EM *)object, op->size, op->extra);
+        case EM_TRACE_DESTROY:         em_destroy((EM *)object); return NULL;
+        case EM_TRACE_RESET:           em_reset((EM *)object); return NULL;
+        case EM_TRACE_RESET_ZERO:      em_reset_zero((EM *)object); return NULL;
+        case EM_TRACE_ALLOC:           return em_alloc_aligned((EM *)object, op->size, op->extra);
+        case EM_TRACE_ALLOC_SCRATCH:   return em_alloc_scratch_aligned((EM *)object, op->size, op->extra);
+        case EM_TRACE_CALLOC:          return em_calloc((EM *)object, op->size, op->extra);
+        case EM_TRACE_ALLOC_NEAR:      return em_alloc_near((EM *)object, op->size, op->extra ? r->slots[op->extra - 1].value : NULL);
+#ifdef EM_LIFETIME
+        case EM_TRACE_ALLOC_SHORT:     return em_alloc_ex((EM *)object, op->size, op->extra, EM_LIFETIME_SHORT);
+#else
+        // Built without EM_LIFETIME: short-lived requests take the normal placement
+        case EM_TRACE_ALLOC_SHORT:     return em_alloc_aligned((EM *)object, op->size, op->extra);
+#endif
+        case EM_TRACE_FREE:            em_free(released); return NULL;
+
+        case EM_TRACE_BUMP_CREATE:         return em_bump_create((EM *)object, op->size);
+        case EM_TRACE_BUMP_CREATE_SCRATCH: return em_bump_create_scratch((EM *)object, op->size);
+        case EM_TRACE_BUMP_ALLOC:
+            if (op->extra == 0) return em_bump_alloc((Bump *)object, op->size);
+            return em_bump_alloc_aligned((Bump *)object, op->size, op->extra);
+        case EM_TRACE_BUMP_TRIM:           em_bump_trim((Bump *)object); return NULL;
+        case EM_TRACE_BUMP_RESET:          em_bump_reset((Bump *)object); return NULL;
+        case EM_TRACE_BUMP_DESTROY:        em_bump_destroy((Bump *)object); return NULL;
+
+        case EM_TRACE_SLAB_CREATE:         return em_slab_create((EM *)object, op->size, op->extra);
+        case EM_TRACE_SLAB_CREATE_SCRATCH: return em_slab_create_scratch((EM *)object, op->size, op->extra);
+        case EM_TRACE_SLAB_ALLOC:          return em_slab_alloc((Slab *)object);
+        case EM_TRACE_SLAB_FREE:           em_slab_free((Slab *)object, released); return NULL;
+        case EM_TRACE_SLAB_RESET:          em_slab_reset((Slab *)object); return NULL;
+        case EM_TRACE_SLAB_RESET_ZERO:     em_slab_reset_zero((Slab *)object); return NULL;
+        case EM_TRACE_SLAB_DESTROY:        em_slab_destroy((Slab *)object); return NULL;
+
+        case EM_TRACE_STACK_CREATE:         return em_stack_create((EM *)object, op->size);
+        case EM_TRACE_STACK_CREATE_SCRATCH: return em_stack_create_scratch((EM *)object, op->size);
+        case EM_TRACE_STACK_ALLOC:          return em_stack_alloc_aligned((Stack *)object, op->size, op->extra);
+        case EM_TRACE_STACK_FREE:           em_stack_free((Stack *)object, released); return NULL;
+        case EM_TRACE_STACK_FREE_TO_MARKER: {
+            Stack *stack = (Stack *)object;
+            StackMarker marker;
+            marker.index = op->size ^ (uintptr_t)stack;
+            marker.magic = (uintptr_t)stack_get_em(stack) ^ (uintptr_t)stack;
+            em_stack_free_to_marker(stack, marker);
+            return NULL;
+        }
+        case EM_TRACE_STACK_RESET:          em_stack_reset((Stack *)object); return NULL;
+        case EM_TRACE_STACK_RESET_ZERO:     em_stack_reset_zero((Stack *)object); return NULL;
+        case EM_TRACE_STACK_DESTROY:        em_stack_destroy((Stack *)object); return NULL;
+
+#ifdef EM_HANDLES
+        // The relocation hook is not recorded: compaction replays with memmove
+        case EM_TRACE_HANDLES_CREATE:  em_handles_create((EM *)object, op->size, NULL, NULL); return NULL;
+        case EM_TRACE_HANDLES_DESTROY: em_handles_destroy((EM *)object); return NULL;
+        case EM_TRACE_HALLOC: {
+            EMHandle handle = em_halloc((EM *)object, op->size);
+            if (handle == 0) return NULL;
+            r->slots[op->result].handle = handle;
+            return em_hget((EM *)object, handle);
+        }
+        case EM_TRACE_HFREE:           em_hfree((EM *)object, r->slots[op->result].handle); return NULL;
+        case EM_TRACE_COMPACT:         em_compact((EM *)object, op->size); return NULL;
+#else
+        // Built without EM_HANDLES: handle blocks become plain blocks that never move
+        case EM_TRACE_HANDLES_DESTROY:
+            for (uint32_t id = r->slots[op->object].first_child; id != NO_SLOT; id = r->slots[id].next_sibling) {
+                if (r->slots[id].is_relocatable) em_free(r->slots[id].value);
+            }
+            return NULL;
+        case EM_TRACE_HALLOC:          return em_alloc((EM *)object, op->size);
+        case EM_TRACE_HFREE:           em_free(released); return NULL;
+#endif
+        default:                            return NULL;
+    }
+}
+
+static void *replay_malloc(Replay *r, const ReplayOp *op) {
+    switch (op_class[op->op]) {
+        case CLASS_CREATE:
+            return &r->slots[op->result];  // Arenas exist only as ownership records
+        case CLASS_ALLOC:
+            switch (op->op) {
+                case EM_TRACE_CALLOC:     return calloc(op->size, op->extra);
+                case EM_TRACE_SLAB_ALLOC: return malloc(r->slots[op->object].chunk);
+                case EM_TRACE_HALLOC:
+                case EM_TRACE_ALLOC_NEAR: return malloc(op->size);
+                default:                  return malloc_aligned(op->size, op->extra);
+            }
+        default:
+            return NULL;  // Releases are handled by the ownership bookkeeping
+    }
+}
+
+static size_t requested_bytes(const Replay *r, const ReplayOp *op) {
+    switch (op->op) {
+        case EM_TRACE_CALLOC:     return op->size * op->extra;
+        case EM_TRACE_SLAB_ALLOC: return r->slots[op->object].chunk;
+        default:                  return op->size;
+    }
+}
+
+static size_t em_root_footprint(EM *em) {
+    return em_get_capacity(em) - free_size_in_tail(em);
+}
+
+static void sample_fragmentation(Replay *r) {
+    size_t total_free = 0, largest_free = 0;
+    for (size_t i = 0; i < r->root_count; i++) {
+        EM *em = (EM *)r->slots[r->roots[i]].value;
+        if (!em) continue;
+
+        Block *tail = em_get_tail(em);
+        for (Block *block = em_get_first_block(em); block && block != tail; block = next_block(em, block)) {
+            if (!get_is_free(block)) continue;
+            size_t size = get_size(block);
+            total_free += size;
+            if (size > largest_free) largest_free = size;
+        }
+        size_t tail_free = free_size_in_tail(em);
+        total_free += tail_free;
+        if (tail_free > largest_free) largest_free = tail_free;
+    }
+    if (total_free == 0) return;
+
+    double fragmentation = 1.0 - (double)largest_free / (double)total_free;
+    r->frag_sum += fragmentation;
+    if (fragmentation > r->frag_max) r->frag_max = fragmentation;
+    r->frag_samples++;
+}
+
+static void replay_step(Replay *r, const ReplayOp *op) {
+    ReplaySlot *object = (op->object != NO_SLOT) ? &r->slots[op->object] : NULL;
+    if (object && (!object->value || !object->is_handle)) {
+        r->skipped++;
+        return;
+    }
+    void *released = NULL;
+    if (op_releases_result(op->op)) {
+        if (op->result == NO_SLOT || !r->slots[op->result].value) {
+            r->skipped++;
+            return;
+        }
+        released = r->slots[op->result].value;
+    }
+    size_t class_id = op_class[op->op];
+    uint32_t root_id = object ? object->root : NO_SLOT;
+
+    double start = now_ns();
+
+    void *produced = r->use_malloc ? replay_malloc(r, op) : replay_em(r, op, object ? object->value : NULL, released);
+
+    if (op_produces_result(op->op)) {
+        if (produced) {
+            slot_adopt(r, op, produced, class_id == CLASS_CREATE, requested_bytes(r, op));
+            if (op->op == EM_TRACE_SLAB_CREATE || op->op == EM_TRACE_SLAB_CREATE_SCRATCH) r->slots[op->result].chunk = op->extra;
+            if (op->op == EM_TRACE_HALLOC) r->slots[op->result].is_relocatable = true;
+        }
+        if ((produced == NULL) != op->failed) r->diverged++;
+    } else if (op_releases_result(op->op)) {
+        slot_kill(r, op->result);
+    } else if (class_id == CLASS_DESTROY) {
+        slot_kill(r, op->object);
+    } else if (class_id == CLASS_RESET) {
+        slot_kill_children(r, op->object);
+    } else if (op->op == EM_TRACE_STACK_FREE_TO_MARKER) {
+        while (object->children > op->size) slot_kill(r, object->first_child);
+    } else if (op->op == EM_TRACE_HANDLES_DESTROY) {
+        for (uint32_t id = object->first_child; id != NO_SLOT;) {
+            uint32_t next = r->slots[id].next_sibling;
+            if (r->slots[id].is_relocatable) slot_kill(r, id);
+            id = next;
+        }
+    }
+
+    double elapsed = now_ns() - start - r->timer_overhead;
+    if (elapsed < 0.0) elapsed = 0.0;
+    r->class_ns[class_id] += elapsed;
+    r->class_count[class_id]++;
+    r->total_ns += elapsed;
+
+    if (!r->use_malloc) {
+        if (root_id == NO_SLOT && op->result != NO_SLOT) root_id = r->slots[op->result].root;
+        if (root_id != NO_SLOT && r->slots[root_id].value) {
+            ReplaySlot *root = &r->slots[root_id];
+            size_t footprint = em_root_footprint((EM *)root->value);
+            r->footprint = r->footprint - root->footprint + footprint;
+            root->footprint = footprint;
+        }
+    }
+    if (r->footprint > r->peak_footprint) r->peak_footprint = r->footprint;
+}
+
+static bool replay_run(Replay *r, const ReplayTrace *trace, bool use_malloc, size_t frag_every) {
+    memset(r, 0, sizeof(*r));
+    r->use_malloc = use_malloc;
+    r->frag_every = frag_every;
+    r->timer_overhead = calibrate_timer();
+    r->slots = (ReplaySlot *)calloc(trace->slot_count + 1, sizeof(ReplaySlot));
+    r->roots = (uint32_t *)calloc(trace->op_count + 1, sizeof(uint32_t));
+    if (!r->slots || !r->roots) return false;
+    for (size_t i = 0; i < trace->slot_count; i++) {
+        ReplaySlot *slot = &r->slots[i];
+        slot->parent = slot->first_child = slot->next_sibling = slot->prev_sibling = slot->root = NO_SLOT;
+    }
+
+    for (size_t i = 0; i < trace->op_count; i++) {
+        replay_step(r, &trace->ops[i]);
+        if (!use_malloc && frag_every && (i + 1) % frag_every == 0) sample_fragmentation(r);
+    }
+
+    // Release whatever the trace left alive
+    for (size_t i = 0; i < r->root_count; i++) {
+        ReplaySlot *root = &r->slots[r->roots[i]];
+        if (!root->value) continue;
+        if (!use_malloc) em_destroy((EM *)root->value);
+        slot_kill(r, r->roots[i]);
+    }
+    return true;
+}
+
+static void replay_report(const Replay *r, const ReplayTrace *trace, const char *path) {
+    size_t ops = trace->op_count - r->skipped;
+    printf("{\"tool\":\"em_replay\",\"trace\":\"%s\",\"impl\":\"%s\",\"events\":%zu,\"skipped\":%zu,\"diverged\":%zu,"
+           "\"ns_per_op\":%.3f,\"classes\":{",
+           path, r->use_malloc ? "malloc" : "em", trace->op_count, r->skipped, r->diverged,
+           ops ? r->total_ns / (double)ops : 0.0);
+    for (size_t c = 0; c < CLASS_COUNT; c++) {
+        printf("%s\"%s\":{\"count\":%zu,\"ns_per_op\":%.3f}", c ? "," : "", class_names[c], r->class_count[c],
+               r->class_count[c] ? r->class_ns[c] / (double)r->class_count[c] : 0.0);
+    }
+    printf("},\"peak_footprint\":%zu,\"peak_live\":%zu", r->peak_footprint, r->peak_live);
+    if (!r->use_malloc) {
+        printf(",\"fragmentation\":{\"samples\":%zu,\"mean\":%.4f,\"max\":%.4f}", r->frag_samples,
+               r->frag_samples ? r->frag_sum / (double)r->frag_samples : 0.0, r->frag_max);
+    }
+    printf(",\"config\":{\"safety_policy\":%d,\"default_alignment\":%zu}}\n", EM_SAFETY_POLICY, (size_t)EM_DEFAULT_ALIGNMENT);
+}
+
+static uint8_t *read_file(const char *path, size_t *length) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+    uint8_t *data = NULL;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long end = ftell(file);
+        if (end > 0 && fseek(file, 0, SEEK_SET) == 0) {
+            data = (uint8_t *)malloc((size_t)end);
+            if (data && fread(data, 1, (size_t)end, file) != (size_t)end) {
+                free(data);
+                data = NULL;
+            }
+            *length = (size_t)end;
+        }
+    }
+    fclose(file);
+    return data;
+}
+
+int main(int argc, char **argv) {
+    bool run_em = true, run_malloc = true;
+    size_t reps = REPLAY_DEFAULT_REPS, frag_every = REPLAY_DEFAULT_FRAG;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--em") == 0) {
+            run_malloc = false;
+        } else if (strcmp(argv[i], "--malloc") == 0) {
+            run_em = false;
+        } else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            long value = strtol(argv[++i], NULL, 10);
+            reps = value > 0 ? (size_t)value : REPLAY_DEFAULT_REPS;
+        } else if (strcmp(argv[i], "--frag-every") == 0 && i + 1 < argc) {
+            long value = strtol(argv[++i], NULL, 10);
+            frag_every = value >= 0 ? (size_t)value : REPLAY_DEFAULT_FRAG;
+        } else if (argv[i][0] != '-' && path == NULL) {
+            path = argv[i];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "usage: %s [--em | --malloc] [--reps N] [--frag-every N] trace.emtr\n", argv[0]);
+        return 2;
+    }
+
+    size_t length = 0;
+    uint8_t *data = read_file(path, &length);
+    if (!data) {
+        fprintf(stderr, "em_replay: cannot read '%s'\n", path);
+        return 1;
+    }
+
+    ReplayTrace trace = { NULL, 0, 0 };
+    bool decoded = decode_trace(data, length, &trace);
+    free(data);
+    if (!decoded) {
+        free(trace.ops);
+        return 1;
+    }
+
+    // Keep the fastest repetition: the workload is deterministic, only timing noise varies
+    for (int impl = 0; impl < 2; impl++) {
+        bool use_malloc = (impl == 1);
+        if ((use_malloc && !run_malloc) || (!use_malloc && !run_em)) continue;
+
+        Replay best, current;
+        memset(&best, 0, sizeof(best));
+        for (size_t rep = 0; rep < reps; rep++) {
+            if (!replay_run(&current, &trace, use_malloc, frag_every)) {
+                fprintf(stderr, "em_replay: out of memory\n");
+                return 1;
+            }
+            free(current.slots);
+            free(current.roots);
+            current.slots = NULL;
+            current.roots = NULL;
+            if (rep == 0 || current.total_ns < best.total_ns) best = current;
+        }
+        replay_report(&best, &trace, path);
+    }
+
+    free(trace.ops);
+    return 0;
+}
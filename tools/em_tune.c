@@ -0,0 +1,696 @@
+/*
+ * em_tune: search the easy_memory build configuration for a recorded workload.
+ *
+ * EM_MIN_BUFFER_SIZE, EM_DEFAULT_ALIGNMENT and EM_PLACEMENT_POLICY are compile-time
+ * settings, so every candidate is a rebuild: em_tune compiles tools/em_replay.c once
+ * per point of the grid below (with --cc and --cflags, e.g. a fixed EM_SAFETY_POLICY),
+ * replays the trace with it and keeps the fastest and the smallest configuration.
+ * Builds the compiler rejects (static assertions on this target) are reported and
+ * skipped; configurations whose allocations fail more often than the best candidate
+ * cannot be the answer for either goal.
+ *
+ * Independently of the search, the trace is analyzed once:
+ *   - Slab chunk classes: the request size histogram (sizes up to --slab-max, rounded
+ *     to the machine word like Slab does) is split into --classes chunk sizes that
+ *     minimize the bytes wasted by rounding requests up to their class. Each class
+ *     reports its share of the requests, the waste and the peak number of live chunks,
+ *     which gives the slab_size for em_slab_create.
+ *   - Arena capacity: the peak footprint of the smallest configuration plus 1/8 of
+ *     headroom, rounded to 4 KiB, next to the capacity the recording actually reserved
+ *     (for a profile, the planned footprint of its live allocations).
+ *
+ * Without a trace, --profile takes a live heap profile instead: the folded output of
+ * em_sample_write with a sampling rate of 0, where every line is one live allocation
+ * and its weight is the requested size. Only the analysis runs in that mode.
+ *
+ * Output is one JSON line per candidate and a final summary line.
+ *
+ * Usage: em_tune [--cc CC] [--cflags FLAGS] [--replay SOURCE] [--reps N] [--classes N]
+ *                [--slab-max BYTES] [--no-search] trace.emtr
+ *        em_tune --profile heap.folded [--classes N] [--slab-max BYTES]
+*/
+
+#include "easy_memory.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TUNE_DEFAULT_CC       "cc"
+#define TUNE_DEFAULT_CFLAGS   "-O2 -DNDEBUG -D_GNU_SOURCE -I."
+#define TUNE_DEFAULT_REPLAY   "tools/em_replay.c"
+#define TUNE_DEFAULT_REPS     3
+#define TUNE_DEFAULT_CLASSES  4
+#define TUNE_MAX_CLASSES      16
+#define TUNE_DEFAULT_SLAB_MAX 512
+#define TUNE_MAX_SLAB_MAX     4096
+#define TUNE_ARENA_GRANULE    4096
+#define TUNE_COMMAND_MAX      4096
+#define NO_CLASS              UINT32_MAX
+
+#define TUNE_WORD ((size_t)sizeof(uintptr_t))
+
+/*
+ * Search grid. Values below the machine word or above the maximum alignment are
+ * rejected by the library's static assertions and show up as build failures.
+*/
+static const size_t grid_min_buffer[] = { TUNE_WORD, 2 * TUNE_WORD, 4 * TUNE_WORD, 8 * TUNE_WORD };
+static const size_t grid_alignment[]  = { TUNE_WORD, 16, 32 };
+static const int    grid_placement[]  = { 0, 1 };
+
+#define GRID_COUNT(array) (sizeof(array) / sizeof((array)[0]))
+
+typedef struct {
+    size_t min_buffer;
+    size_t alignment;
+    size_t diverged;
+    size_t peak_footprint;
+    double ns_per_op;
+    int placement;
+    bool built;
+    uint8_t padding[3];
+} Candidate;
+
+typedef struct {
+    size_t chunk;
+    size_t requests;
+    size_t requested_bytes;
+    size_t live;
+    size_t peak_live;
+} ChunkClass;
+
+typedef struct {
+    size_t size;
+    size_t count;
+} SizeBin;
+
+typedef struct {
+    const char *cc;
+    const char *cflags;
+    const char *replay;
+    size_t reps;
+    size_t classes;
+    size_t slab_max;
+    bool search;
+    uint8_t padding[7];
+} TuneOptions;
+
+/*
+ * Trace decoding (same stream layout as em_replay, see ALLOCATION TRACE FORMAT)
+*/
+typedef struct {
+    uintptr_t op;
+    uintptr_t object;
+    uintptr_t result;
+    uintptr_t size;
+    uintptr_t extra;
+} TraceEvent;
+
+typedef struct {
+    const uint8_t *data;
+    size_t length;
+    size_t cursor;
+    uintptr_t last_handle;
+    uintptr_t last_pointer;
+} TraceReader;
+
+static bool read_varint(TraceReader *reader, uintptr_t *value) {
+    uintptr_t result = 0;
+    unsigned shift = 0;
+    while (reader->cursor < reader->length && shift < sizeof(uintptr_t) * 8) {
+        uint8_t byte = reader->data[reader->cursor++];
+        result |= (uintptr_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return true;
+        }
+        shift += 7;
+    }
+    return false;
+}
+
+static bool read_address(TraceReader *reader, uintptr_t *last, uintptr_t *address) {
+    uintptr_t encoded;
+    if (!read_varint(reader, &encoded)) return false;
+    if (encoded == 0) {
+        *address = 0;
+        return true;
+    }
+    encoded -= 1;
+    *last += (encoded >> 1) ^ ((uintptr_t)0 - (encoded & 1));
+    *address = *last;
+    return true;
+}
+
+static bool trace_open(TraceReader *reader, const uint8_t *data, size_t length) {
+    memset(reader, 0, sizeof(*reader));
+    reader->data = data;
+    reader->length = length;
+    reader->cursor = 6;
+    if (length < 6 || memcmp(data, "EMTR", 4) != 0) {
+        fprintf(stderr, "em_tune: not an EM trace\n");
+        return false;
+    }
+    if (data[4] != EM_TRACE_VERSION || data[5] != sizeof(uintptr_t)) {
+        fprintf(stderr, "em_tune: trace version %u / word size %u not supported by this build\n", data[4], data[5]);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Returns false at the end of the stream; a corrupted tail is reported and ends it too.
+*/
+static bool trace_next(TraceReader *reader, TraceEvent *event) {
+    if (reader->cursor >= reader->length) return false;
+    if (!read_varint(reader, &event->op) || event->op == 0 || event->op >= EM_TRACE_OP_COUNT ||
+        !read_address(reader, &reader->last_handle, &event->object) ||
+        !read_address(reader, EM_TRACE_RESULT_IS_HANDLE(event->op) ? &reader->last_handle : &reader->last_pointer, &event->result) ||
+        !read_varint(reader, &event->size) ||
+        !read_varint(reader, &event->extra)) {
+        fprintf(stderr, "em_tune: truncated or corrupted event at byte %zu\n", reader->cursor);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Requested bytes of a general-purpose allocation, 0 for every other event.
+ * Only these requests could move to a Slab; bump, slab and stack traffic already has a home.
+*/
+static size_t event_request(const TraceEvent *event) {
+    switch (event->op) {
+        case EM_TRACE_ALLOC:
+        case EM_TRACE_ALLOC_NEAR:
+        case EM_TRACE_ALLOC_SHORT:
+        case EM_TRACE_ALLOC_SCRATCH: return (size_t)event->size;
+        case EM_TRACE_CALLOC:        return (size_t)event->size * (size_t)event->extra;
+        default:                     return 0;
+    }
+}
+
+/*
+ * Live pointer map: pointer -> (class, arena), linear probing with backward-shift erase.
+*/
+typedef struct {
+    uintptr_t *keys;
+    uintptr_t *arenas;
+    uint32_t *classes;
+    size_t mask;
+} LiveMap;
+
+static size_t live_hash(uintptr_t address, size_t mask) {
+    return (size_t)(((uint64_t)(address >> 3) * 0x9E3779B97F4A7C15ULL) >> 17) & mask;
+}
+
+static bool live_init(LiveMap *map, size_t entries) {
+    size_t size = 16;
+    while (size < 2 * entries) size <<= 1;
+    map->keys = (uintptr_t *)calloc(size, sizeof(uintptr_t));
+    map->arenas = (uintptr_t *)calloc(size, sizeof(uintptr_t));
+    map->classes = (uint32_t *)calloc(size, sizeof(uint32_t));
+    map->mask = size - 1;
+    return map->keys && map->arenas && map->classes;
+}
+
+static void live_free(LiveMap *map) {
+    free(map->keys);
+    free(map->arenas);
+    free(map->classes);
+}
+
+static void live_erase_at(LiveMap *map, size_t hole) {
+    size_t index = hole;
+    for (;;) {
+        index = (index + 1) & map->mask;
+        if (map->keys[index] == 0) break;
+        size_t home = live_hash(map->keys[index], map->mask);
+        // Move the entry back unless its home lies cyclically in (hole, index]
+        bool stays = (hole <= index) ? (hole < home && home <= index) : (hole < home || home <= index);
+        if (stays) continue;
+        map->keys[hole] = map->keys[index];
+        map->arenas[hole] = map->arenas[index];
+        map->classes[hole] = map->classes[index];
+        hole = index;
+    }
+    map->keys[hole] = 0;
+}
+
+static void live_insert(LiveMap *map, uintptr_t address, uintptr_t arena, uint32_t class_id) {
+    size_t index = live_hash(address, map->mask);
+    while (map->keys[index] != 0 && map->keys[index] != address) index = (index + 1) & map->mask;
+    map->keys[index] = address;
+    map->arenas[index] = arena;
+    map->classes[index] = class_id;
+}
+
+static uint32_t live_remove(LiveMap *map, uintptr_t address) {
+    size_t index = live_hash(address, map->mask);
+    while (map->keys[index] != 0) {
+        if (map->keys[index] == address) {
+            uint32_t class_id = map->classes[index];
+            live_erase_at(map, index);
+            return class_id;
+        }
+        index = (index + 1) & map->mask;
+    }
+    return NO_CLASS;
+}
+
+/*
+ * Size histogram and chunk classes
+*/
+static int compare_sizes(const void *a, const void *b) {
+    size_t x = *(const size_t *)a;
+    size_t y = *(const size_t *)b;
+    return (x > y) - (x < y);
+}
+
+static size_t build_histogram(size_t *sizes, size_t count, SizeBin *bins) {
+    qsort(sizes, count, sizeof(size_t), compare_sizes);
+    size_t bin_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (bin_count == 0 || bins[bin_count - 1].size != sizes[i]) {
+            bins[bin_count].size = sizes[i];
+            bins[bin_count].count = 0;
+            bin_count++;
+        }
+        bins[bin_count - 1].count++;
+    }
+    return bin_count;
+}
+
+/*
+ * Optimal chunk classes for a sorted histogram: every class is one of the observed sizes,
+ * the largest size is always a class, and each request uses the smallest class that holds it.
+ * Dynamic programming over (classes used, last bin covered), O(classes * bins^2) with the
+ * bins capped by TUNE_MAX_SLAB_MAX / TUNE_WORD.
+*/
+static size_t choose_classes(const SizeBin *bins, size_t bin_count, size_t wanted, ChunkClass *classes) {
+    if (bin_count == 0) return 0;
+    if (wanted > bin_count) wanted = bin_count;
+
+    size_t cells = (wanted + 1) * bin_count;
+    double *waste = (double *)malloc(cells * sizeof(double));
+    size_t *split = (size_t *)malloc(cells * sizeof(size_t));
+    if (!waste || !split) {
+        free(waste);
+        free(split);
+        return 0;
+    }
+
+    // waste[k * bin_count + j]: least waste covering bins 0..j with k classes, the last one at bin j
+    for (size_t j = 0; j < bin_count; j++) {
+        double cost = 0.0;
+        for (size_t t = 0; t <= j; t++) cost += (double)bins[t].count * (double)(bins[j].size - bins[t].size);
+        waste[1 * bin_count + j] = cost;
+        split[1 * bin_count + j] = 0;
+    }
+    for (size_t k = 2; k <= wanted; k++) {
+        for (size_t j = 0; j < bin_count; j++) {
+            double best = waste[(k - 1) * bin_count + j];
+            size_t best_split = split[(k - 1) * bin_count + j];
+            double cost = 0.0;  // Waste of bins i..j rounded up to bin j
+            for (size_t i = j; i >= 1; i--) {
+                cost += (double)bins[i].count * (double)(bins[j].size - bins[i].size);
+                double total = waste[(k - 1) * bin_count + (i - 1)] + cost;
+                if (total < best) {
+                    best = total;
+                    best_split = i;
+                }
+            }
+            waste[k * bin_count + j] = best;
+            split[k * bin_count + j] = best_split;
+        }
+    }
+
+    // Walk the splits back from the last bin, then restore ascending order
+    size_t count = 0;
+    size_t j = bin_count - 1;
+    for (size_t k = wanted; k >= 1 && count < wanted; k--) {
+        classes[count++].chunk = bins[j].size;
+        size_t first = split[k * bin_count + j];
+        if (first == 0) break;
+        j = first - 1;
+    }
+    for (size_t i = 0; i < count / 2; i++) {
+        size_t chunk = classes[i].chunk;
+        classes[i].chunk = classes[count - 1 - i].chunk;
+        classes[count - 1 - i].chunk = chunk;
+    }
+
+    free(waste);
+    free(split);
+    return count;
+}
+
+static uint32_t class_of(const ChunkClass *classes, size_t class_count, size_t size) {
+    for (size_t c = 0; c < class_count; c++) {
+        if (size <= classes[c].chunk) return (uint32_t)c;
+    }
+    return NO_CLASS;
+}
+
+static size_t slab_chunk(size_t size) {
+    return EM_PLAN_ALIGN_UP(size > 0 ? size : 1, EMMIN_ALIGNMENT);
+}
+
+/*
+ * Workload analysis
+*/
+typedef struct {
+    ChunkClass classes[TUNE_MAX_CLASSES];
+    size_t class_count;
+    size_t events;
+    size_t requests;
+    size_t slab_requests;
+    size_t recorded_capacity;   // Sum of root arena capacities the recording created
+    size_t planned_footprint;   // Profile only: arena footprint of the live allocations
+} Analysis;
+
+static void count_requests(Analysis *analysis, const TuneOptions *options, size_t *sizes, size_t count) {
+    SizeBin *bins = (SizeBin *)malloc((count + 1) * sizeof(SizeBin));
+    if (!bins) return;
+    size_t bin_count = build_histogram(sizes, count, bins);
+    analysis->class_count = choose_classes(bins, bin_count, options->classes, analysis->classes);
+    for (size_t b = 0; b < bin_count; b++) {
+        uint32_t class_id = class_of(analysis->classes, analysis->class_count, bins[b].size);
+        if (class_id == NO_CLASS) continue;
+        analysis->classes[class_id].requests += bins[b].count;
+        analysis->classes[class_id].requested_bytes += bins[b].count * bins[b].size;
+    }
+    free(bins);
+}
+
+static bool analyze_trace(const uint8_t *data, size_t length, const TuneOptions *options, Analysis *analysis) {
+    TraceReader reader;
+    TraceEvent event;
+    if (!trace_open(&reader, data, length)) return false;
+
+    // Pass 1: histogram of slab-sized requests
+    size_t max_events = (length - 6) / 5 + 1;  // Every event takes at least five bytes
+    size_t *sizes = (size_t *)malloc(max_events * sizeof(size_t));
+    if (!sizes) return false;
+    size_t size_count = 0;
+    while (trace_next(&reader, &event)) {
+        analysis->events++;
+        if (event.op == EM_TRACE_CREATE || event.op == EM_TRACE_CREATE_STATIC) analysis->recorded_capacity += (size_t)event.size;
+        size_t request = event_request(&event);
+        if (request == 0) continue;
+        analysis->requests++;
+        if (request <= options->slab_max) sizes[size_count++] = slab_chunk(request);
+    }
+    analysis->slab_requests = size_count;
+    count_requests(analysis, options, sizes, size_count);
+    free(sizes);
+
+    // Pass 2: peak live chunks per class. Resets and destroys release what the arena held;
+    // nested children of a destroyed arena are not followed, so peaks are an upper bound.
+    LiveMap map;
+    if (!live_init(&map, size_count)) {
+        live_free(&map);
+        return false;
+    }
+    trace_open(&reader, data, length);
+    while (trace_next(&reader, &event)) {
+        size_t request = event_request(&event);
+        if (request != 0 && request <= options->slab_max && event.result != 0) {
+            uint32_t class_id = class_of(analysis->classes, analysis->class_count, slab_chunk(request));
+            if (class_id == NO_CLASS) continue;
+            ChunkClass *chunk_class = &analysis->classes[class_id];
+            if (++chunk_class->live > chunk_class->peak_live) chunk_class->peak_live = chunk_class->live;
+            live_insert(&map, event.result, event.object, class_id);
+        } else if (event.op == EM_TRACE_FREE && event.result != 0) {
+            uint32_t class_id = live_remove(&map, event.result);
+            if (class_id != NO_CLASS) analysis->classes[class_id].live--;
+        } else if (event.op == EM_TRACE_RESET || event.op == EM_TRACE_RESET_ZERO || event.op == EM_TRACE_DESTROY) {
+            for (size_t index = 0; index <= map.mask;) {
+                if (map.keys[index] != 0 && map.arenas[index] == event.object) {
+                    analysis->classes[map.classes[index]].live--;
+                    live_erase_at(&map, index);  // May pull another entry into 'index'
+                } else {
+                    index++;
+                }
+            }
+        }
+    }
+    live_free(&map);
+    return true;
+}
+
+/*
+ * Folded heap profile: "frame;frame;... weight" per line, one live allocation each.
+*/
+static bool analyze_profile(const char *path, const TuneOptions *options, Analysis *analysis) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "em_tune: cannot read '%s'\n", path);
+        return false;
+    }
+    size_t capacity = 1024, count = 0;
+    size_t *sizes = (size_t *)malloc(capacity * sizeof(size_t));
+    char line[4096];
+    while (sizes && fgets(line, sizeof(line), file)) {
+        char *weight = strrchr(line, ' ');
+        if (!weight) continue;
+        size_t request = (size_t)strtoull(weight + 1, NULL, 10);
+        if (request == 0) continue;
+        analysis->requests++;
+        analysis->planned_footprint += EM_PLAN_ALLOC(request, EM_DEFAULT_ALIGNMENT, EM_DEFAULT_ALIGNMENT);
+        if (request > options->slab_max) continue;
+        if (count == capacity) {
+            size_t *grown = (size_t *)realloc(sizes, 2 * capacity * sizeof(size_t));
+            if (!grown) break;
+            sizes = grown;
+            capacity *= 2;
+        }
+        sizes[count++] = slab_chunk(request);
+    }
+    fclose(file);
+    if (!sizes) return false;
+
+    analysis->slab_requests = count;
+    count_requests(analysis, options, sizes, count);
+    // A snapshot is all live at once
+    for (size_t c = 0; c < analysis->class_count; c++) analysis->classes[c].peak_live = analysis->classes[c].requests;
+    free(sizes);
+    return true;
+}
+
+/*
+ * Configuration search
+*/
+static void candidate_flags(const Candidate *candidate, char *buffer, size_t size) {
+    snprintf(buffer, size, "-DEM_MIN_BUFFER_SIZE=%zu -DEM_DEFAULT_ALIGNMENT=%zu -DEM_PLACEMENT_POLICY=%d",
+             candidate->min_buffer, candidate->alignment, candidate->placement);
+}
+
+static bool json_number(const char *line, const char *key, double *value) {
+    const char *found = strstr(line, key);  // First match is the top-level field
+    if (!found) return false;
+    *value = strtod(found + strlen(key), NULL);
+    return true;
+}
+
+static void evaluate(Candidate *candidate, const TuneOptions *options, const char *binary, const char *trace) {
+    char flags[256], command[TUNE_COMMAND_MAX];
+    candidate_flags(candidate, flags, sizeof(flags));
+
+    snprintf(command, sizeof(command), "%s %s %s '%s' -o '%s' 2>/dev/null",
+             options->cc, options->cflags, flags, options->replay, binary);
+    candidate->built = (system(command) == 0);
+    if (!candidate->built) return;
+
+    snprintf(command, sizeof(command), "'%s' --em --reps %zu --frag-every 0 '%s'", binary, options->reps, trace);
+    FILE *output = popen(command, "r");
+    char line[4096];
+    double ns = 0.0, footprint = 0.0, diverged = 0.0;
+    bool parsed = output && fgets(line, sizeof(line), output) &&
+                  json_number(line, "\"ns_per_op\":", &ns) &&
+                  json_number(line, "\"peak_footprint\":", &footprint) &&
+                  json_number(line, "\"diverged\":", &diverged);
+    if (output) pclose(output);
+    candidate->built = parsed;
+    candidate->ns_per_op = ns;
+    candidate->peak_footprint = (size_t)footprint;
+    candidate->diverged = (size_t)diverged;
+}
+
+static void report_candidate(const Candidate *candidate) {
+    char flags[256];
+    candidate_flags(candidate, flags, sizeof(flags));
+    if (!candidate->built) {
+        printf("{\"tool\":\"em_tune\",\"flags\":\"%s\",\"status\":\"build_failed\"}\n", flags);
+    } else {
+        printf("{\"tool\":\"em_tune\",\"flags\":\"%s\",\"status\":\"ok\",\"ns_per_op\":%.3f,\"peak_footprint\":%zu,\"diverged\":%zu}\n",
+               flags, candidate->ns_per_op, candidate->peak_footprint, candidate->diverged);
+    }
+    fflush(stdout);
+}
+
+static size_t search(const TuneOptions *options, const char *trace, Candidate *candidates) {
+    char directory[] = "/tmp/em_tune_XXXXXX";
+    if (!mkdtemp(directory)) {
+        fprintf(stderr, "em_tune: cannot create a build directory\n");
+        return 0;
+    }
+    char binary[sizeof(directory) + 16];
+    snprintf(binary, sizeof(binary), "%s/em_replay", directory);
+
+    size_t count = 0;
+    for (size_t m = 0; m < GRID_COUNT(grid_min_buffer); m++) {
+        for (size_t a = 0; a < GRID_COUNT(grid_alignment); a++) {
+            if (a > 0 && grid_alignment[a] <= grid_alignment[a - 1]) continue;  // TUNE_WORD may equal 16
+            for (size_t p = 0; p < GRID_COUNT(grid_placement); p++) {
+                Candidate *candidate = &candidates[count++];
+                memset(candidate, 0, sizeof(*candidate));
+                candidate->min_buffer = grid_min_buffer[m];
+                candidate->alignment = grid_alignment[a];
+                candidate->placement = grid_placement[p];
+                evaluate(candidate, options, binary, trace);
+                report_candidate(candidate);
+            }
+        }
+    }
+    remove(binary);
+    rmdir(directory);
+    return count;
+}
+
+/*
+ * Summary
+*/
+static void report_best(const char *name, const Candidate *candidate) {
+    if (!candidate) {
+        printf(",\"%s\":null", name);
+        return;
+    }
+    char flags[256];
+    candidate_flags(candidate, flags, sizeof(flags));
+    printf(",\"%s\":{\"flags\":\"%s\",\"ns_per_op\":%.3f,\"peak_footprint\":%zu}",
+           name, flags, candidate->ns_per_op, candidate->peak_footprint);
+}
+
+static void report_summary(const char *source, const Analysis *analysis, const Candidate *candidates, size_t count) {
+    // Only candidates that fail no more allocations than the best one are eligible
+    size_t least_diverged = SIZE_MAX;
+    for (size_t i = 0; i < count; i++) {
+        if (candidates[i].built && candidates[i].diverged < least_diverged) least_diverged = candidates[i].diverged;
+    }
+    const Candidate *fastest = NULL, *smallest = NULL, *defaults = NULL;
+    for (size_t i = 0; i < count; i++) {
+        const Candidate *c = &candidates[i];
+        if (!c->built || c->diverged != least_diverged) continue;
+        if (!fastest || c->ns_per_op < fastest->ns_per_op) fastest = c;
+        if (!smallest || c->peak_footprint < smallest->peak_footprint ||
+            (c->peak_footprint == smallest->peak_footprint && c->ns_per_op < smallest->ns_per_op)) smallest = c;
+        if (c->min_buffer == 2 * TUNE_WORD && c->alignment == 16 && c->placement == 0) defaults = c;
+    }
+
+    printf("{\"tool\":\"em_tune\",\"source\":\"%s\",\"events\":%zu,\"requests\":%zu,\"slab_requests\":%zu,\"configs\":%zu",
+           source, analysis->events, analysis->requests, analysis->slab_requests, count);
+    if (count > 0) {
+        report_best("default", defaults);
+        report_best("best_throughput", fastest);
+        report_best("best_footprint", smallest);
+    }
+
+    size_t footprint = smallest ? smallest->peak_footprint : analysis->planned_footprint;
+    size_t arena_capacity = footprint ? EM_PLAN_ALIGN_UP(footprint + footprint / 8, TUNE_ARENA_GRANULE) : 0;
+    printf(",\"arena_capacity\":%zu,\"recorded_capacity\":%zu,\"slab_classes\":[", arena_capacity, analysis->recorded_capacity);
+    for (size_t c = 0; c < analysis->class_count; c++) {
+        const ChunkClass *chunk_class = &analysis->classes[c];
+        size_t chunk_bytes = chunk_class->requests * chunk_class->chunk;
+        double waste = chunk_bytes ? 1.0 - (double)chunk_class->requested_bytes / (double)chunk_bytes : 0.0;
+        double share = analysis->requests ? (double)chunk_class->requests / (double)analysis->requests : 0.0;
+        printf("%s{\"chunk\":%zu,\"requests\":%zu,\"share\":%.4f,\"waste\":%.4f,\"peak_live\":%zu,\"slab_size\":%zu}",
+               c ? "," : "", chunk_class->chunk, chunk_class->requests, share, waste, chunk_class->peak_live,
+               (size_t)EM_PLAN_SLAB_SIZE(chunk_class->chunk, chunk_class->peak_live > 0 ? chunk_class->peak_live : 1));
+    }
+    printf("]}\n");
+}
+
+static uint8_t *read_file(const char *path, size_t *length) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+    uint8_t *data = NULL;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long end = ftell(file);
+        if (end > 0 && fseek(file, 0, SEEK_SET) == 0) {
+            data = (uint8_t *)malloc((size_t)end);
+            if (data && fread(data, 1, (size_t)end, file) != (size_t)end) {
+                free(data);
+                data = NULL;
+            }
+            *length = (size_t)end;
+        }
+    }
+    fclose(file);
+    return data;
+}
+
+int main(int argc, char **argv) {
+    TuneOptions options = { TUNE_DEFAULT_CC, TUNE_DEFAULT_CFLAGS, TUNE_DEFAULT_REPLAY,
+                            TUNE_DEFAULT_REPS, TUNE_DEFAULT_CLASSES, TUNE_DEFAULT_SLAB_MAX, true, {0} };
+    const char *path = NULL, *profile = NULL;
+    bool usage = false;
+
+    for (int i = 1; i < argc && !usage; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--cc") == 0 && has_value) {
+            options.cc = argv[++i];
+        } else if (strcmp(argv[i], "--cflags") == 0 && has_value) {
+            options.cflags = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && has_value) {
+            options.replay = argv[++i];
+        } else if (strcmp(argv[i], "--reps") == 0 && has_value) {
+            long value = strtol(argv[++i], NULL, 10);
+            options.reps = value > 0 ? (size_t)value : TUNE_DEFAULT_REPS;
+        } else if (strcmp(argv[i], "--classes") == 0 && has_value) {
+            long value = strtol(argv[++i], NULL, 10);
+            options.classes = (value > 0 && value <= TUNE_MAX_CLASSES) ? (size_t)value : TUNE_DEFAULT_CLASSES;
+        } else if (strcmp(argv[i], "--slab-max") == 0 && has_value) {
+            long value = strtol(argv[++i], NULL, 10);
+            options.slab_max = (value > 0 && value <= TUNE_MAX_SLAB_MAX) ? (size_t)value : TUNE_DEFAULT_SLAB_MAX;
+        } else if (strcmp(argv[i], "--no-search") == 0) {
+            options.search = false;
+        } else if (strcmp(argv[i], "--profile") == 0 && has_value) {
+            profile = argv[++i];
+        } else if (argv[i][0] != '-' && path == NULL) {
+            path = argv[i];
+        } else {
+            usage = true;
+        }
+    }
+    if (usage || (path == NULL) == (profile == NULL) || (path && strchr(path, '\''))) {
+        fprintf(stderr, "usage: %s [--cc CC] [--cflags FLAGS] [--replay SOURCE] [--reps N] [--classes N]\n"
+                        "       %*s [--slab-max BYTES] [--no-search] trace.emtr\n"
+                        "       %s --profile heap.folded [--classes N] [--slab-max BYTES]\n",
+                argv[0], (int)strlen(argv[0]), "", argv[0]);
+        return 2;
+    }
+
+    Analysis analysis;
+    memset(&analysis, 0, sizeof(analysis));
+    if (profile) {
+        if (!analyze_profile(profile, &options, &analysis)) return 1;
+        report_summary(profile, &analysis, NULL, 0);
+        return 0;
+    }
+
+    size_t length = 0;
+    uint8_t *data = read_file(path, &length);
+    if (!data) {
+        fprintf(stderr, "em_tune: cannot read '%s'\n", path);
+        return 1;
+    }
+    bool analyzed = analyze_trace(data, length, &options, &analysis);
+    free(data);
+    if (!analyzed) return 1;
+
+    Candidate candidates[GRID_COUNT(grid_min_buffer) * GRID_COUNT(grid_alignment) * GRID_COUNT(grid_placement)];
+    size_t count = options.search ? search(&options, path, candidates) : 0;
+    report_summary(path, &analysis, candidates, count);
+    return 0;
+}
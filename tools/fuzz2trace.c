@@ -0,0 +1,66 @@
+/*
+ * fuzz2trace: turn a fuzzer input into an EM_TRACE allocation trace.
+ *
+ * The fuzz target is compiled with tracing enabled and driven once by a plain
+ * main() instead of libFuzzer, so any corpus entry or crash file becomes a
+ * replayable workload for em_replay:
+ *
+ *   make tools/fuzz2trace_basic
+ *   ./tools/fuzz2trace_basic input.bin trace.emtr
+ *   ./tools/em_replay trace.emtr
+ *
+ * FUZZ_SOURCE selects the fuzzer (set by the Makefile).
+*/
+
+#define EM_TRACE
+#include FUZZ_SOURCE
+
+#include <stdlib.h>
+
+int main(int argc, char **argv);
+
+static void file_writer(const void *data, size_t size, void *context) {
+    fwrite(data, 1, size, (FILE *)context);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s fuzz-input trace-output\n", argv[0]);
+        return 2;
+    }
+
+    FILE *input = fopen(argv[1], "rb");
+    if (!input) {
+        fprintf(stderr, "fuzz2trace: cannot read '%s'\n", argv[1]);
+        return 1;
+    }
+    uint8_t *data = NULL;
+    size_t size = 0, capacity = 0;
+    for (;;) {
+        if (size == capacity) {
+            capacity = capacity ? capacity * 2 : 4096;
+            uint8_t *grown = (uint8_t *)realloc(data, capacity);
+            if (!grown) break;
+            data = grown;
+        }
+        size_t got = fread(data + size, 1, capacity - size, input);
+        if (got == 0) break;
+        size += got;
+    }
+    fclose(input);
+
+    FILE *output = fopen(argv[2], "wb");
+    if (!output) {
+        fprintf(stderr, "fuzz2trace: cannot write '%s'\n", argv[2]);
+        free(data);
+        return 1;
+    }
+
+    em_trace_set_writer(file_writer, output);
+    LLVMFuzzerTestOneInput(data, size);
+    em_trace_set_writer(NULL, NULL);
+
+    fclose(output);
+    free(data);
+    return 0;
+}